@@ -0,0 +1,425 @@
+//! # IFC Import/Export Benchmarks
+//!
+//! Criterion groups for the IFC hot paths: lexing, registry population,
+//! domain resolution, mesh extraction, STEP export and building merge.
+//!
+//! Inputs are synthetic models generated through the exporter at nominal
+//! sizes of 10k/100k/1M entities plus every fixture under
+//! `tests/fixtures/ifc`. Throughput is reported by Criterion; peak heap per
+//! workload is measured with a counting allocator and printed alongside.
+//!
+//! `ARX_BENCH_SIZES=10000,100000` limits the synthetic sizes.
+
+use std::alloc::{GlobalAlloc, Layout, System};
+use std::path::{Path, PathBuf};
+use std::sync::atomic::{AtomicUsize, Ordering};
+
+use arxos::core::spatial::mesh::Mesh;
+use arxos::core::{Building, Dimensions, Equipment, EquipmentType, Floor, Room, RoomType, Wing};
+use arxos::export::ifc::IFCExporter;
+use arxos::ifc::mapping::merge_building;
+use arxos::ifc::parser::geometry::{GeometryCache, GeometryResolver, Transform3D};
+use arxos::ifc::parser::mesh::MeshResolver;
+use arxos::ifc::parser::{EntityRegistry, IfcResolver, StepLexer};
+use criterion::{
+    black_box, criterion_group, criterion_main, BatchSize, BenchmarkId, Criterion, Throughput,
+};
+
+// --- Memory accounting ---
+
+/// System allocator wrapper tracking live and peak heap bytes.
+struct CountingAlloc;
+
+static LIVE_BYTES: AtomicUsize = AtomicUsize::new(0);
+static PEAK_BYTES: AtomicUsize = AtomicUsize::new(0);
+
+// SAFETY: delegates every call to `System` unchanged; only counters are added.
+#[allow(unsafe_code)]
+unsafe impl GlobalAlloc for CountingAlloc {
+    unsafe fn alloc(&self, layout: Layout) -> *mut u8 {
+        let ptr = System.alloc(layout);
+        if !ptr.is_null() {
+            let live = LIVE_BYTES.fetch_add(layout.size(), Ordering::Relaxed) + layout.size();
+            PEAK_BYTES.fetch_max(live, Ordering::Relaxed);
+        }
+        ptr
+    }
+
+    unsafe fn dealloc(&self, ptr: *mut u8, layout: Layout) {
+        System.dealloc(ptr, layout);
+        LIVE_BYTES.fetch_sub(layout.size(), Ordering::Relaxed);
+    }
+}
+
+#[global_allocator]
+static GLOBAL: CountingAlloc = CountingAlloc;
+
+/// Run `work` once and print the heap high-water mark above the baseline.
+fn report_peak_memory<T>(label: &str, work: impl FnOnce() -> T) {
+    let baseline = LIVE_BYTES.load(Ordering::Relaxed);
+    PEAK_BYTES.store(baseline, Ordering::Relaxed);
+    let result = work();
+    let peak = PEAK_BYTES.load(Ordering::Relaxed).saturating_sub(baseline);
+    drop(result);
+    println!(
+        "memory {:<48} peak {:>10.2} MiB",
+        label,
+        peak as f64 / (1024.0 * 1024.0)
+    );
+}
+
+// --- Inputs ---
+
+/// One benchmark input: a STEP file and its entity count.
+struct IfcInput {
+    label: String,
+    bytes: Vec<u8>,
+    entities: u64,
+}
+
+fn count_entities(bytes: &[u8]) -> u64 {
+    let mut lexer = StepLexer::from_bytes(bytes);
+    let mut count = 0;
+    while lexer.next_entity_header().is_some() {
+        count += 1;
+    }
+    count
+}
+
+/// Synthetic building sized to roughly `target_entities` exported entities.
+///
+/// Each equipment item (tetrahedron body, placement, identity pset) exports
+/// to about 14 entities; rooms and storeys add the rest.
+fn synthetic_building(target_entities: usize) -> Building {
+    const ENTITIES_PER_EQUIPMENT: usize = 14;
+    const EQUIPMENT_PER_ROOM: usize = 10;
+    const ROOMS_PER_FLOOR: usize = 20;
+
+    let equipment_total = (target_entities / ENTITIES_PER_EQUIPMENT).max(1);
+    let rooms_total = equipment_total.div_ceil(EQUIPMENT_PER_ROOM);
+    let floors_total = rooms_total.div_ceil(ROOMS_PER_FLOOR);
+
+    let mut building = Building::new("Bench Campus".to_string(), "".to_string());
+    let mut equipment_left = equipment_total;
+    let mut rooms_left = rooms_total;
+    for f in 0..floors_total {
+        let mut floor = Floor::new(format!("Level {}", f), f as i32);
+        floor.elevation = Some(f as f64 * 3.5);
+        let mut wing = Wing::new("Main".to_string());
+        for r in 0..ROOMS_PER_FLOOR.min(rooms_left) {
+            let mut room = Room::new(format!("Room {}-{}", f, r), RoomType::Office);
+            room.spatial_properties.position.x = (r % 5) as f64 * 6.0;
+            room.spatial_properties.position.y = (r / 5) as f64 * 6.0;
+            room.spatial_properties.position.z = f as f64 * 3.5;
+            room.spatial_properties.dimensions = Dimensions {
+                width: 5.0,
+                depth: 5.0,
+                height: 3.0,
+            };
+            for e in 0..EQUIPMENT_PER_ROOM.min(equipment_left) {
+                let mut eq = Equipment::new(
+                    format!("VAV-{}-{}-{}", f, r, e),
+                    "".to_string(),
+                    EquipmentType::HVAC,
+                );
+                eq.position.x = room.spatial_properties.position.x + e as f64 * 0.4;
+                eq.position.y = room.spatial_properties.position.y + 1.0;
+                eq.position.z = room.spatial_properties.position.z + 2.7;
+                eq.mesh = Some(Mesh::tetrahedron(0.3));
+                room.equipment.push(eq);
+            }
+            equipment_left = equipment_left.saturating_sub(EQUIPMENT_PER_ROOM);
+            wing.rooms.push(room);
+        }
+        rooms_left = rooms_left.saturating_sub(ROOMS_PER_FLOOR);
+        floor.wings.push(wing);
+        building.add_floor(floor);
+    }
+    building
+}
+
+fn export_bytes(building: &Building) -> Vec<u8> {
+    IFCExporter::new(building.clone())
+        .export_to_writer(Vec::new(), "bench.ifc")
+        .expect("synthetic export")
+}
+
+fn synthetic_sizes() -> Vec<usize> {
+    std::env::var("ARX_BENCH_SIZES")
+        .ok()
+        .map(|sizes| {
+            sizes
+                .split(',')
+                .filter_map(|s| s.trim().parse().ok())
+                .collect()
+        })
+        .unwrap_or_else(|| vec![10_000, 100_000, 1_000_000])
+}
+
+fn size_label(entities: usize) -> String {
+    match entities {
+        n if n >= 1_000_000 && n % 1_000_000 == 0 => format!("synthetic_{}m", n / 1_000_000),
+        n if n >= 1_000 && n % 1_000 == 0 => format!("synthetic_{}k", n / 1_000),
+        n => format!("synthetic_{}", n),
+    }
+}
+
+fn fixture_paths() -> Vec<PathBuf> {
+    let root = Path::new(env!("CARGO_MANIFEST_DIR")).join("tests/fixtures/ifc");
+    let mut paths = Vec::new();
+    for dir in [
+        root.clone(),
+        root.join("buildingsmart"),
+        root.join("vendor"),
+    ] {
+        if let Ok(entries) = std::fs::read_dir(&dir) {
+            for entry in entries.flatten() {
+                let path = entry.path();
+                let is_ifc = path
+                    .extension()
+                    .is_some_and(|ext| ext.eq_ignore_ascii_case("ifc"));
+                if is_ifc {
+                    paths.push(path);
+                }
+            }
+        }
+    }
+    paths.sort();
+    paths
+}
+
+/// Synthetic models plus repository fixtures, generated once per run.
+fn inputs() -> &'static [IfcInput] {
+    static INPUTS: std::sync::OnceLock<Vec<IfcInput>> = std::sync::OnceLock::new();
+    INPUTS.get_or_init(|| {
+        let mut inputs = Vec::new();
+        for size in synthetic_sizes() {
+            let bytes = export_bytes(&synthetic_building(size));
+            inputs.push(IfcInput {
+                label: size_label(size),
+                entities: count_entities(&bytes),
+                bytes,
+            });
+        }
+        for path in fixture_paths() {
+            if let Ok(bytes) = std::fs::read(&path) {
+                inputs.push(IfcInput {
+                    label: path
+                        .file_stem()
+                        .unwrap_or_default()
+                        .to_string_lossy()
+                        .into_owned(),
+                    entities: count_entities(&bytes),
+                    bytes,
+                });
+            }
+        }
+        inputs
+    })
+}
+
+/// Fewer samples for inputs where one iteration takes a noticeable time.
+fn configure_for(group: &mut criterion::BenchmarkGroup<'_, criterion::measurement::WallTime>) {
+    group.sample_size(10);
+}
+
+fn populated(bytes: &[u8]) -> EntityRegistry {
+    let mut registry = EntityRegistry::new();
+    registry.populate_parallel(bytes);
+    registry
+}
+
+// --- Benchmarks ---
+
+fn benchmark_lexer(c: &mut Criterion) {
+    let mut group = c.benchmark_group("ifc_lexer_next_entity");
+    configure_for(&mut group);
+    for input in inputs() {
+        group.throughput(Throughput::Bytes(input.bytes.len() as u64));
+        report_peak_memory(&format!("ifc_lexer_next_entity/{}", input.label), || {
+            let mut lexer = StepLexer::from_bytes(&input.bytes);
+            let mut entities = Vec::new();
+            while let Some(entity) = lexer.next_entity() {
+                entities.push(entity);
+            }
+            entities
+        });
+        group.bench_with_input(
+            BenchmarkId::from_parameter(&input.label),
+            input,
+            |b, input| {
+                b.iter(|| {
+                    let mut lexer = StepLexer::from_bytes(black_box(&input.bytes));
+                    let mut count = 0usize;
+                    while let Some(entity) = lexer.next_entity() {
+                        black_box(&entity);
+                        count += 1;
+                    }
+                    count
+                });
+            },
+        );
+    }
+    group.finish();
+}
+
+fn benchmark_registry(c: &mut Criterion) {
+    let mut group = c.benchmark_group("ifc_registry_populate");
+    configure_for(&mut group);
+    for input in inputs() {
+        group.throughput(Throughput::Bytes(input.bytes.len() as u64));
+        report_peak_memory(&format!("ifc_registry_populate/{}", input.label), || {
+            populated(&input.bytes)
+        });
+        group.bench_with_input(
+            BenchmarkId::new("from_lexer", &input.label),
+            input,
+            |b, input| {
+                b.iter(|| {
+                    let mut registry = EntityRegistry::new();
+                    registry.populate_from_lexer(StepLexer::from_bytes(black_box(&input.bytes)));
+                    registry
+                });
+            },
+        );
+        group.bench_with_input(
+            BenchmarkId::new("parallel", &input.label),
+            input,
+            |b, input| b.iter(|| populated(black_box(&input.bytes))),
+        );
+    }
+    group.finish();
+}
+
+fn benchmark_resolve_all(c: &mut Criterion) {
+    let mut group = c.benchmark_group("ifc_resolve_all");
+    configure_for(&mut group);
+    for input in inputs() {
+        group.throughput(Throughput::Elements(input.entities));
+        report_peak_memory(&format!("ifc_resolve_all/{}", input.label), || {
+            let mut registry = populated(&input.bytes);
+            IfcResolver::new(&mut registry).resolve_all().ok()
+        });
+        group.bench_with_input(
+            BenchmarkId::from_parameter(&input.label),
+            input,
+            |b, input| {
+                b.iter_batched(
+                    || populated(&input.bytes),
+                    |mut registry| IfcResolver::new(&mut registry).resolve_all().ok(),
+                    BatchSize::LargeInput,
+                );
+            },
+        );
+    }
+    group.finish();
+}
+
+fn benchmark_mesh_extraction(c: &mut Criterion) {
+    let mut group = c.benchmark_group("ifc_mesh_extraction");
+    configure_for(&mut group);
+    for input in inputs() {
+        let registry = populated(&input.bytes);
+        let shapes = registry.get_by_class("IFCPRODUCTDEFINITIONSHAPE").to_vec();
+        if shapes.is_empty() {
+            continue;
+        }
+        let extract_all = |cache: Option<&GeometryCache>| {
+            let geometry = match cache {
+                Some(cache) => GeometryResolver::with_cache(&registry, cache),
+                None => GeometryResolver::new(&registry),
+            };
+            let meshes = MeshResolver::new(&registry, &geometry);
+            let identity = Transform3D::identity();
+            shapes
+                .iter()
+                .filter_map(|&id| meshes.extract_mesh_from_shape(id, &identity))
+                .map(|mesh| mesh.indices.len())
+                .sum::<usize>()
+        };
+
+        group.throughput(Throughput::Elements(shapes.len() as u64));
+        report_peak_memory(&format!("ifc_mesh_extraction/{}", input.label), || {
+            extract_all(Some(&GeometryCache::new()))
+        });
+        group.bench_function(BenchmarkId::new("uncached", &input.label), |b| {
+            b.iter(|| extract_all(None))
+        });
+        group.bench_function(BenchmarkId::new("cached", &input.label), |b| {
+            b.iter(|| extract_all(Some(&GeometryCache::new())))
+        });
+    }
+    group.finish();
+}
+
+fn benchmark_export(c: &mut Criterion) {
+    let mut group = c.benchmark_group("ifc_export");
+    configure_for(&mut group);
+    for size in synthetic_sizes() {
+        let building = synthetic_building(size);
+        let label = size_label(size);
+        let exported = export_bytes(&building);
+        group.throughput(Throughput::Bytes(exported.len() as u64));
+        report_peak_memory(&format!("ifc_export/{}", label), || {
+            IFCExporter::new(building.clone()).export_to_writer(std::io::sink(), "bench.ifc")
+        });
+        let exporter = IFCExporter::new(building);
+        group.bench_function(BenchmarkId::new("to_sink", &label), |b| {
+            b.iter(|| exporter.export_to_writer(std::io::sink(), "bench.ifc"))
+        });
+        let dir = tempfile::tempdir().expect("tempdir");
+        let path = dir.path().join("bench.ifc");
+        group.bench_function(BenchmarkId::new("to_file", &label), |b| {
+            b.iter(|| exporter.export(&path))
+        });
+    }
+    group.finish();
+}
+
+fn benchmark_merge(c: &mut Criterion) {
+    let mut group = c.benchmark_group("ifc_merge_building");
+    configure_for(&mut group);
+    for size in synthetic_sizes() {
+        let existing = synthetic_building(size);
+        // Incoming re-import: same identities, every tenth item moved.
+        let mut incoming = existing.clone();
+        let mut items = 0u64;
+        for floor in &mut incoming.floors {
+            for wing in &mut floor.wings {
+                for room in &mut wing.rooms {
+                    for (i, eq) in room.equipment.iter_mut().enumerate() {
+                        items += 1;
+                        if i % 10 == 0 {
+                            eq.position.x += 0.25;
+                        }
+                    }
+                }
+            }
+        }
+        let label = size_label(size);
+        group.throughput(Throughput::Elements(items));
+        report_peak_memory(&format!("ifc_merge_building/{}", label), || {
+            merge_building(&existing, incoming.clone())
+        });
+        group.bench_function(BenchmarkId::from_parameter(&label), |b| {
+            b.iter_batched(
+                || incoming.clone(),
+                |incoming| merge_building(&existing, incoming),
+                BatchSize::LargeInput,
+            );
+        });
+    }
+    group.finish();
+}
+
+criterion_group!(
+    benches,
+    benchmark_lexer,
+    benchmark_registry,
+    benchmark_resolve_all,
+    benchmark_mesh_extraction,
+    benchmark_export,
+    benchmark_merge
+);
+
+criterion_main!(benches);
@@ -82,15 +82,16 @@ pub fn ensure_capability(action: &str, capabilities: &[String]) -> Result<()> {
 fn action_required_capability(action: &str) -> Option<&'static str> {
     match action {
         "git.status" => Some("git.status"),
-        "git.diff" => Some("git.diff"),
+        "git.diff" | "git.entity_history" => Some("git.diff"),
         "git.commit" => Some("git.commit"),
         "files.read" => Some("files.read"),
-        "building.get" => Some("building.get"),
+        "building.get" | "building.subtree" | "building.delta" => Some("building.get"),
         "ifc.import" => Some("ifc.import"),
         "ifc.export" => Some("ifc.export"),
         "auth.rotate" | "auth.negotiate" => Some("auth.manage"),
         "collab.sync" => Some("collab.sync"),
         "collab.config.get" | "collab.config.set" => Some("collab.config"),
+        "sync.apply_batch" => Some("sync.apply"),
         _ => None,
     }
 }
@@ -1,21 +1,32 @@
 //! Read-only building snapshot for PWA review (Batch B1).
 //!
 //! Thin wrapper around `load_building_at` + `summarize_review` — no IFC spine changes.
+//! [`BuildingCache`] keeps the last result in memory so polling clients do not
+//! re-parse `building.yaml` on every request.
 
 use std::path::Path;
+use std::sync::atomic::{AtomicU64, Ordering};
+use std::sync::{Arc, OnceLock};
 
 use anyhow::{anyhow, Result};
+use arc_swap::ArcSwapOption;
 use serde::Serialize;
 
+use crate::agent::git;
+use crate::agent::subtree::{RevisionCache, RevisionDigest};
 use crate::core::review::{equipment_review_status, room_review_status, ReviewStatus};
 use crate::core::{summarize_review, Building};
+use crate::git::SemanticDiffCache;
 use crate::persistence::{load_building_at, BUILDING_YAML};
 
 /// JSON result for `building.get`.
-#[derive(Debug, Serialize)]
+#[derive(Debug, Clone, Serialize)]
 pub struct BuildingGetResult {
-    pub building: Building,
+    pub building: Arc<Building>,
     pub yaml_path: String,
+    /// `HEAD` commit, when the working `building.yaml` is exactly what it
+    /// committed (usable as `since` for `building.delta`).
+    pub revision: Option<String>,
     /// Human-readable review warning lines (proposed / rejected LiDAR autos).
     pub review_warnings: Vec<String>,
     pub proposed_rooms: usize,
@@ -23,10 +34,26 @@ pub struct BuildingGetResult {
     pub floors: usize,
     pub rooms: usize,
     pub equipment: usize,
+    #[serde(skip)]
+    digest: OnceLock<Arc<RevisionDigest>>,
+}
+
+impl BuildingGetResult {
+    /// Per-floor fingerprints of this snapshot, computed on first use.
+    pub fn digest(&self) -> Result<Arc<RevisionDigest>> {
+        if let Some(digest) = self.digest.get() {
+            return Ok(digest.clone());
+        }
+        let digest = Arc::new(RevisionDigest::of(&self.building)?);
+        Ok(self.digest.get_or_init(|| digest).clone())
+    }
 }
 
 /// Load durable `building.yaml` and attach review summary for the phone Review UI.
 pub fn get_building(repo_root: &Path) -> Result<BuildingGetResult> {
+    // Taken before the load: if the file changes in between, the watcher
+    // invalidates this result anyway.
+    let revision = git::clean_head_revision(repo_root, BUILDING_YAML);
     let building = load_building_at(repo_root)
         .map_err(|e| anyhow!("Failed to load {}: {}", BUILDING_YAML, e))?;
 
@@ -47,17 +74,65 @@ pub fn get_building(repo_root: &Path) -> Result<BuildingGetResult> {
     let review_warnings = summary.warning_lines();
 
     Ok(BuildingGetResult {
-        building,
+        building: Arc::new(building),
         yaml_path: BUILDING_YAML.to_string(),
+        revision,
         review_warnings,
         proposed_rooms,
         proposed_equipment,
         floors,
         rooms,
         equipment,
+        digest: OnceLock::new(),
     })
 }
 
+/// Shared `building.get` result, published RCU-style.
+///
+/// Readers take an `Arc` snapshot without locking; a miss (first request, or
+/// after [`invalidate`](Self::invalidate)) parses `building.yaml` once and
+/// publishes the result. The agent invalidates when its YAML watcher fires,
+/// after a git commit, and after any RPC that rewrites `building.yaml`.
+#[derive(Debug, Default)]
+pub struct BuildingCache {
+    current: ArcSwapOption<BuildingGetResult>,
+    /// Bumped by every invalidation; a load that raced one is not kept.
+    epoch: AtomicU64,
+    /// Fingerprints of committed states, for `building.delta`.
+    pub revisions: RevisionCache,
+    /// Entity-level diffs between commits, for `git.diff` with `semantic`.
+    pub diffs: SemanticDiffCache,
+}
+
+impl BuildingCache {
+    /// Current snapshot, loading it from `repo_root` on a miss.
+    pub fn get(&self, repo_root: &Path) -> Result<Arc<BuildingGetResult>> {
+        match self.current.load_full() {
+            Some(cached) => Ok(cached),
+            None => self.refresh(repo_root),
+        }
+    }
+
+    /// Re-read `building.yaml` and publish the result.
+    pub fn refresh(&self, repo_root: &Path) -> Result<Arc<BuildingGetResult>> {
+        let epoch = self.epoch.load(Ordering::Acquire);
+        let loaded = Arc::new(get_building(repo_root)?);
+        self.current.store(Some(loaded.clone()));
+        // The file may have changed while it was being parsed; drop what we
+        // just published so the next reader loads again.
+        if self.epoch.load(Ordering::Acquire) != epoch {
+            self.current.store(None);
+        }
+        Ok(loaded)
+    }
+
+    /// Forget the snapshot; the next [`get`](Self::get) reloads from disk.
+    pub fn invalidate(&self) {
+        self.epoch.fetch_add(1, Ordering::AcqRel);
+        self.current.store(None);
+    }
+}
+
 #[cfg(test)]
 mod tests {
     use super::*;
@@ -84,4 +159,24 @@ mod tests {
         assert_eq!(got.building.name, "Pilot");
         assert!(!got.review_warnings.is_empty());
     }
+
+    #[test]
+    fn cache_serves_snapshot_until_invalidated() {
+        let dir = tempdir().unwrap();
+        save_building_at(dir.path(), &Building::new("Pilot".into(), "/pilot".into())).unwrap();
+
+        let cache = BuildingCache::default();
+        let first = cache.get(dir.path()).unwrap();
+        assert!(Arc::ptr_eq(&first, &cache.get(dir.path()).unwrap()));
+
+        save_building_at(
+            dir.path(),
+            &Building::new("Renamed".into(), "/pilot".into()),
+        )
+        .unwrap();
+        assert_eq!(cache.get(dir.path()).unwrap().building.name, "Pilot");
+
+        cache.invalidate();
+        assert_eq!(cache.get(dir.path()).unwrap().building.name, "Renamed");
+    }
 }
@@ -1,24 +1,64 @@
 use std::path::PathBuf;
 use std::sync::{Arc, Mutex};
+use std::time::Instant;
 
 use anyhow::Result;
 use serde_json::Value;
+use tracing::Instrument;
 
 use crate::agent::auth::{ensure_capability, TokenState};
 use crate::agent::protocol::{
-    JsonRpcRequest, JsonRpcResponse, AUTH_ERROR, INTERNAL_ERROR,
-    METHOD_NOT_FOUND,
+    JsonRpcNotification, JsonRpcRequest, JsonRpcResponse, PayloadOptions, AUTH_ERROR,
+    INTERNAL_ERROR, METHOD_NOT_FOUND,
 };
-use crate::agent::{building, collab, files, git, ifc};
+use crate::agent::{building, collab, files, git, ifc, subtree, sync};
+
+/// Channel for notifications a long-running call sends before its response.
+pub type ProgressSender = tokio::sync::mpsc::UnboundedSender<JsonRpcNotification>;
+
+/// Methods routed by [`dispatch_with_progress`]; each gets its own latency
+/// series on `/metrics`, anything else is counted as `other`.
+pub const RPC_METHODS: &[&str] = &[
+    "git.status",
+    "git.diff",
+    "git.entity_history",
+    "git.commit",
+    "files.read",
+    "building.get",
+    "building.subtree",
+    "building.delta",
+    "ifc.import",
+    "ifc.export",
+    "collab.sync",
+    "claim.list_pending",
+    "claim.review",
+    "claim.get_status",
+    "sync.apply_batch",
+    "metrics.report_cache",
+];
 
 pub struct AgentState {
     pub repo_root: PathBuf,
     pub token: Arc<Mutex<TokenState>>,
     pub metrics: Arc<crate::agent::observability::AgentMetrics>,
+    /// Parsed `building.yaml` shared by read RPCs (see `building::BuildingCache`).
+    pub building: Arc<building::BuildingCache>,
+    /// Delta-export cache shared by `ifc.export` and auto-export.
+    pub exports: Arc<ifc::ExportCache>,
     pub reload_handle: Option<tracing_subscriber::reload::Handle<tracing_subscriber::EnvFilter, tracing_subscriber::Registry>>,
 }
 
 pub async fn dispatch(state: Arc<AgentState>, request: JsonRpcRequest) -> JsonRpcResponse {
+    dispatch_with_progress(state, request, None).await
+}
+
+/// Like [`dispatch`], forwarding progress notifications (e.g. `sync.progress`)
+/// to `progress` when the transport can stream them.
+pub async fn dispatch_with_progress(
+    state: Arc<AgentState>,
+    request: JsonRpcRequest,
+    progress: Option<ProgressSender>,
+) -> JsonRpcResponse {
     let id = request.id.clone();
     let method = request.method.as_str();
     let params = request.params.unwrap_or(Value::Null);
@@ -34,20 +74,35 @@ pub async fn dispatch(state: Arc<AgentState>, request: JsonRpcRequest) -> JsonRp
     }
 
     // 2. Dispatch to handler
-    let result = match method {
-        "git.status" => handle_git_status(&state.repo_root),
-        "git.diff" => handle_git_diff(&state.repo_root, params),
-        "git.commit" => handle_git_commit(&state, params),
-        "files.read" => handle_files_read(&state.repo_root, params),
-        "building.get" => handle_building_get(&state.repo_root),
-        "ifc.import" => handle_ifc_import(&state.repo_root, params),
-        "ifc.export" => handle_ifc_export(&state.repo_root, params),
-        "collab.sync" => handle_collab_sync(params).await,
-        "claim.list_pending" => handle_claim_list_pending(&state.repo_root),
-        "claim.review" => handle_claim_review(&state.repo_root, params),
-        "claim.get_status" => handle_claim_get_status(&state.repo_root, params),
-        _ => Err(anyhow::anyhow!("Method not found")),
-    };
+    let started = Instant::now();
+    let result = async {
+        match method {
+            "git.status" => handle_git_status(&state.repo_root),
+            "git.diff" => handle_git_diff(&state, params),
+            "git.entity_history" => handle_git_entity_history(&state, params),
+            "git.commit" => handle_git_commit(&state, params),
+            "files.read" => handle_files_read(&state.repo_root, params),
+            "building.get" => handle_building_get(&state),
+            "building.subtree" => handle_building_subtree(&state, params),
+            "building.delta" => handle_building_delta(&state, params),
+            "ifc.import" => handle_ifc_import(&state, params),
+            "ifc.export" => handle_ifc_export(&state, params),
+            "collab.sync" => handle_collab_sync(params).await,
+            "claim.list_pending" => handle_claim_list_pending(&state.repo_root),
+            "claim.review" => handle_claim_review(&state, params),
+            "claim.get_status" => handle_claim_get_status(&state.repo_root, params),
+            "sync.apply_batch" => {
+                handle_sync_apply_batch(&state, params, id.clone(), progress).await
+            }
+            "metrics.report_cache" => handle_metrics_report_cache(&state, params),
+            _ => Err(anyhow::anyhow!("Method not found")),
+        }
+    }
+    .instrument(tracing::debug_span!("rpc", method))
+    .await;
+    state
+        .metrics
+        .record_rpc(method, started.elapsed(), result.is_ok());
 
     match result {
         Ok(value) => JsonRpcResponse::success(id, value),
@@ -67,14 +122,32 @@ fn handle_git_status(root: &std::path::Path) -> Result<Value> {
     Ok(serde_json::to_value(summary)?)
 }
 
-fn handle_git_diff(root: &std::path::Path, params: Value) -> Result<Value> {
+fn handle_git_diff(state: &AgentState, params: Value) -> Result<Value> {
     let commit = params.get("commit").and_then(|v| v.as_str());
     let file = params.get("file").and_then(|v| v.as_str());
+    let semantic = params
+        .get("semantic")
+        .and_then(|v| v.as_bool())
+        .unwrap_or(false);
 
-    let diff = git::diff(root, commit, file)?;
+    if semantic {
+        let diff = git::semantic_diff(&state.repo_root, &state.building.diffs, commit)?;
+        return Ok(serde_json::to_value(&*diff)?);
+    }
+    let diff = git::diff(&state.repo_root, commit, file)?;
     Ok(serde_json::to_value(diff)?)
 }
 
+fn handle_git_entity_history(state: &AgentState, params: Value) -> Result<Value> {
+    let entity = params
+        .get("entity")
+        .and_then(|v| v.as_str())
+        .ok_or_else(|| anyhow::anyhow!("Missing 'entity' parameter"))?;
+
+    let history = git::entity_history(&state.repo_root, &state.building.diffs, entity)?;
+    Ok(serde_json::to_value(history)?)
+}
+
 fn handle_git_commit(state: &AgentState, params: Value) -> Result<Value> {
     let message = params
         .get("message")
@@ -93,9 +166,65 @@ fn handle_git_commit(state: &AgentState, params: Value) -> Result<Value> {
     };
 
     let result = git::commit(&state.repo_root, message, stage_all, &did_key)?;
+    state.building.invalidate();
     Ok(serde_json::to_value(result)?)
 }
 
+async fn handle_sync_apply_batch(
+    state: &AgentState,
+    params: Value,
+    id: Option<Value>,
+    progress: Option<ProgressSender>,
+) -> Result<Value> {
+    let mutations_val = params
+        .get("mutations")
+        .ok_or_else(|| anyhow::anyhow!("Missing 'mutations' parameter"))?;
+    let mutations: Vec<crate::core::Mutation> = serde_json::from_value(mutations_val.clone())
+        .map_err(|e| anyhow::anyhow!("Invalid mutations format: {}", e))?;
+
+    let did_key = {
+        let token = state.token.lock().unwrap();
+        token.value().to_string()
+    };
+
+    // Loading, validating and saving a large building blocks; keep the
+    // socket free to forward progress meanwhile.
+    let repo_root = state.repo_root.clone();
+    let applied = tokio::task::spawn_blocking(move || {
+        sync::apply_batch(&repo_root, mutations, &did_key, |report| {
+            if let Some(tx) = &progress {
+                // The client may have disconnected; the batch still completes
+                let _ = tx.send(JsonRpcNotification::new(
+                    "sync.progress",
+                    serde_json::json!({ "id": id, "progress": report }),
+                ));
+            }
+        })
+    })
+    .await
+    .map_err(|e| anyhow::anyhow!("Batch task failed: {}", e))?;
+    // The commit can fail after building.yaml was already written.
+    state.building.invalidate();
+    Ok(serde_json::to_value(applied?)?)
+}
+
+fn handle_metrics_report_cache(state: &AgentState, params: Value) -> Result<Value> {
+    let cache = params
+        .get("cache")
+        .and_then(|v| v.as_str())
+        .ok_or_else(|| anyhow::anyhow!("Missing 'cache' parameter"))?;
+    let stats_val = params
+        .get("stats")
+        .ok_or_else(|| anyhow::anyhow!("Missing 'stats' parameter"))?;
+    let stats: crate::telemetry::CacheStats = serde_json::from_value(stats_val.clone())
+        .map_err(|e| anyhow::anyhow!("Invalid stats format: {}", e))?;
+
+    if !state.metrics.report_cache(cache, stats) {
+        return Err(anyhow::anyhow!("Unknown cache '{}'", cache));
+    }
+    Ok(serde_json::json!({ "recorded": true }))
+}
+
 fn handle_files_read(root: &std::path::Path, params: Value) -> Result<Value> {
     let path = params
         .get("path")
@@ -106,12 +235,38 @@ fn handle_files_read(root: &std::path::Path, params: Value) -> Result<Value> {
     Ok(serde_json::to_value(content)?)
 }
 
-fn handle_building_get(root: &std::path::Path) -> Result<Value> {
-    let result = building::get_building(root)?;
-    Ok(serde_json::to_value(result)?)
+fn handle_building_get(state: &AgentState) -> Result<Value> {
+    let result = state.building.get(&state.repo_root)?;
+    Ok(serde_json::to_value(&*result)?)
+}
+
+fn handle_building_subtree(state: &AgentState, params: Value) -> Result<Value> {
+    let address = params
+        .get("address")
+        .and_then(|v| v.as_str())
+        .ok_or_else(|| anyhow::anyhow!("Missing 'address' parameter"))?;
+    let options = PayloadOptions::from_params(&params)?;
+
+    let current = state.building.get(&state.repo_root)?;
+    let result = subtree::find_subtree(&current, address)
+        .ok_or_else(|| anyhow::anyhow!("No floor or room at '{}'", address))?;
+    options.encode(&result)
+}
+
+fn handle_building_delta(state: &AgentState, params: Value) -> Result<Value> {
+    let since = params
+        .get("since")
+        .and_then(|v| v.as_str())
+        .ok_or_else(|| anyhow::anyhow!("Missing 'since' parameter"))?;
+    let options = PayloadOptions::from_params(&params)?;
+
+    let current = state.building.get(&state.repo_root)?;
+    let (since, base) = state.building.revisions.digest_at(&state.repo_root, since)?;
+    let digest = current.digest()?;
+    options.encode(&subtree::building_delta(&current, &digest, &since, &base))
 }
 
-fn handle_ifc_import(root: &std::path::Path, params: Value) -> Result<Value> {
+fn handle_ifc_import(state: &AgentState, params: Value) -> Result<Value> {
     let filename = params
         .get("filename")
         .and_then(|v| v.as_str())
@@ -122,11 +277,14 @@ fn handle_ifc_import(root: &std::path::Path, params: Value) -> Result<Value> {
         .and_then(|v| v.as_str())
         .ok_or_else(|| anyhow::anyhow!("Missing 'data' parameter"))?;
 
-    let result = ifc::import_ifc(root, filename, data_base64)?;
+    let result = ifc::import_ifc(&state.repo_root, filename, data_base64);
+    // The import may have rewritten building.yaml even if it then failed.
+    state.building.invalidate();
+    let result = result?;
     Ok(serde_json::to_value(result)?)
 }
 
-fn handle_ifc_export(root: &std::path::Path, params: Value) -> Result<Value> {
+fn handle_ifc_export(state: &AgentState, params: Value) -> Result<Value> {
     let filename = params
         .get("filename")
         .and_then(|v| v.as_str())
@@ -140,8 +298,14 @@ fn handle_ifc_export(root: &std::path::Path, params: Value) -> Result<Value> {
         .and_then(|v| v.as_bool())
         .unwrap_or(false);
 
-    // Edge RPC only — same IFCExporter spine as CLI; delta rejected.
-    let result = ifc::export_ifc_with_options(root, filename, delta, approved_only)?;
+    // Edge RPC only — same IFCExporter spine as CLI; delta reuses unchanged storeys.
+    let result = ifc::export_ifc_with_options(
+        &state.repo_root,
+        &state.exports,
+        filename,
+        delta,
+        approved_only,
+    )?;
     Ok(serde_json::to_value(result)?)
 }
 
@@ -205,7 +369,7 @@ fn handle_claim_list_pending(root: &std::path::Path) -> Result<Value> {
     Ok(serde_json::to_value(list)?)
 }
 
-fn handle_claim_review(root: &std::path::Path, params: Value) -> Result<Value> {
+fn handle_claim_review(agent: &AgentState, params: Value) -> Result<Value> {
     use crate::agent::claim::GraceWindowManager;
     
     let building_id = params.get("building_id")
@@ -227,14 +391,16 @@ fn handle_claim_review(root: &std::path::Path, params: Value) -> Result<Value> {
     let mut manager = GraceWindowManager::new();
     manager.register_active_claim(building_id.to_string(), 14);
 
-    let (state, receipt) = manager.review_pending_contribution(
-        root.to_str().unwrap(),
+    let reviewed = manager.review_pending_contribution(
+        agent.repo_root.to_str().unwrap(),
         building_id,
         index,
         approve,
         owner_address,
         live,
-    ).map_err(map_grace_error)?;
+    );
+    agent.building.invalidate();
+    let (state, receipt) = reviewed.map_err(map_grace_error)?;
 
     Ok(serde_json::json!({
         "status": format!("{:?}", state),
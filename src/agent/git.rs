@@ -1,9 +1,13 @@
-use std::path::Path;
+use std::path::{Path, PathBuf};
+use std::sync::Arc;
 
 use crate::git::diff::DiffLineType;
-use crate::git::{BuildingGitManager, CommitMetadata, GitConfigManager};
+use crate::git::semantic::ChangeKind;
+use crate::git::{
+    BuildingGitManager, CommitMetadata, GitConfigManager, SemanticDiff, SemanticDiffCache,
+};
 use anyhow::{anyhow, Context, Result};
-use git2::{Repository, Status, StatusOptions};
+use git2::{ObjectType, Oid, Repository, Status, StatusOptions};
 use serde::{Deserialize, Serialize};
 
 #[derive(Debug, Clone, Serialize, Deserialize)]
@@ -90,6 +94,16 @@ pub struct GitFileDiff {
     pub content: String,
 }
 
+#[derive(Serialize)]
+pub struct GitEntityRevision {
+    pub commit_id: String,
+    pub message: String,
+    pub author: String,
+    pub time: i64,
+    pub change: ChangeKind,
+    pub fields: Vec<String>,
+}
+
 #[derive(Serialize)]
 pub struct GitCommitResult {
     pub commit_id: String,
@@ -133,14 +147,7 @@ pub fn status(repo_root: &Path) -> Result<GitStatusSummary> {
 }
 
 pub fn diff(repo_root: &Path, commit: Option<&str>, file: Option<&str>) -> Result<GitDiffPayload> {
-    let config = GitConfigManager::default_config();
-    let repo_root_str = repo_root
-        .to_str()
-        .ok_or_else(|| anyhow!("Repository path is not valid UTF-8"))?;
-
-    let manager = BuildingGitManager::new(repo_root_str, "Workspace", config)
-        .context("Failed to open Git repository")?;
-    let diff = manager
+    let diff = open_manager(repo_root)?
         .get_diff(commit, file)
         .context("Failed to generate diff")?;
 
@@ -165,12 +172,82 @@ pub fn diff(repo_root: &Path, commit: Option<&str>, file: Option<&str>) -> Resul
     })
 }
 
+/// Entity-level diff of `building.yaml` from `commit` (default `HEAD~1`) to `HEAD`.
+pub fn semantic_diff(
+    repo_root: &Path,
+    cache: &SemanticDiffCache,
+    commit: Option<&str>,
+) -> Result<Arc<SemanticDiff>> {
+    open_manager(repo_root)?
+        .get_semantic_diff(cache, commit)
+        .context("Failed to generate semantic diff")
+}
+
+/// Commits in which the `building.yaml` entity `key` changed, newest first.
+pub fn entity_history(
+    repo_root: &Path,
+    cache: &SemanticDiffCache,
+    key: &str,
+) -> Result<Vec<GitEntityRevision>> {
+    let history = open_manager(repo_root)?
+        .get_entity_history(cache, key)
+        .context("Failed to walk entity history")?;
+    Ok(history
+        .into_iter()
+        .map(|revision| GitEntityRevision {
+            commit_id: revision.commit.id,
+            message: revision.commit.message,
+            author: revision.commit.author,
+            time: revision.commit.time,
+            change: revision.change,
+            fields: revision.fields,
+        })
+        .collect())
+}
+
+fn open_manager(repo_root: &Path) -> Result<BuildingGitManager> {
+    let repo_root_str = repo_root
+        .to_str()
+        .ok_or_else(|| anyhow!("Repository path is not valid UTF-8"))?;
+    let config = GitConfigManager::default_config();
+    BuildingGitManager::new(repo_root_str, "Workspace", config)
+        .context("Failed to open Git repository")
+}
+
 pub fn commit(
     repo_root: &Path,
     message: &str,
     stage_all: bool,
     did_key: &str,
 ) -> Result<GitCommitResult> {
+    let mut manager = open_for_commit(repo_root, message)?;
+
+    let staged_files = if stage_all {
+        manager.stage_all().context("Failed to stage files")?
+    } else {
+        0
+    };
+
+    commit_staged_as(&mut manager, message, did_key, staged_files)
+}
+
+/// Stage `paths` (relative to `repo_root`) and commit them as `did_key`.
+pub fn commit_paths(
+    repo_root: &Path,
+    message: &str,
+    paths: &[&str],
+    did_key: &str,
+) -> Result<GitCommitResult> {
+    let mut manager = open_for_commit(repo_root, message)?;
+    for path in paths {
+        manager
+            .stage_file(path)
+            .with_context(|| format!("Failed to stage {}", path))?;
+    }
+    commit_staged_as(&mut manager, message, did_key, paths.len())
+}
+
+fn open_for_commit(repo_root: &Path, message: &str) -> Result<BuildingGitManager> {
     if message.trim().is_empty() {
         return Err(anyhow!("Commit message cannot be empty"));
     }
@@ -180,15 +257,16 @@ pub fn commit(
         .ok_or_else(|| anyhow!("Repository path is not valid UTF-8"))?;
 
     let config = GitConfigManager::load_from_arx_config_or_env();
-    let mut manager = BuildingGitManager::new(repo_root_str, "Workspace", config)
-        .context("Failed to open Git repository")?;
-
-    let staged_files = if stage_all {
-        manager.stage_all().context("Failed to stage files")?
-    } else {
-        0
-    };
+    BuildingGitManager::new(repo_root_str, "Workspace", config)
+        .context("Failed to open Git repository")
+}
 
+fn commit_staged_as(
+    manager: &mut BuildingGitManager,
+    message: &str,
+    did_key: &str,
+    staged_files: usize,
+) -> Result<GitCommitResult> {
     let metadata = CommitMetadata {
         message: message.to_string(),
         user_id: Some(did_key.to_string()),
@@ -207,6 +285,60 @@ pub fn commit(
     })
 }
 
+/// Commit id of `HEAD` when the working copy of `file` (relative to
+/// `repo_root`) is byte-identical to the blob `HEAD` committed for it.
+pub fn clean_head_revision(repo_root: &Path, file: &str) -> Option<String> {
+    let repo = Repository::discover(repo_root).ok()?;
+    let rel = repo_relative(&repo, &repo_root.join(file)).ok()?;
+    let head = repo.head().ok()?.peel_to_commit().ok()?;
+    let entry = head.tree().ok()?.get_path(&rel).ok()?;
+    let working = std::fs::read(repo_root.join(file)).ok()?;
+    let oid = Oid::hash_object(ObjectType::Blob, &working).ok()?;
+    (oid == entry.id()).then(|| head.id().to_string())
+}
+
+/// Resolve a revision (commit id, branch, `HEAD~1`, ...) to a full commit id.
+pub fn resolve_commit(repo_root: &Path, rev: &str) -> Result<String> {
+    let repo = Repository::discover(repo_root).context("Failed to open Git repository")?;
+    let commit = repo
+        .revparse_single(rev)
+        .and_then(|object| object.peel_to_commit())
+        .with_context(|| format!("Unknown revision '{}'", rev))?;
+    Ok(commit.id().to_string())
+}
+
+/// Contents of `file` (relative to `repo_root`) as committed in `commit`.
+pub fn file_at_commit(repo_root: &Path, commit: &str, file: &str) -> Result<Vec<u8>> {
+    let repo = Repository::discover(repo_root).context("Failed to open Git repository")?;
+    let rel = repo_relative(&repo, &repo_root.join(file))?;
+    let commit = repo
+        .find_commit(Oid::from_str(commit)?)
+        .with_context(|| format!("Unknown commit '{}'", commit))?;
+    let entry = commit
+        .tree()?
+        .get_path(&rel)
+        .with_context(|| format!("{} not found at {}", file, commit.id()))?;
+    let blob = entry.to_object(&repo)?.peel_to_blob()?;
+    Ok(blob.content().to_vec())
+}
+
+/// `path` relative to the repository's working directory (the file itself
+/// need not exist).
+fn repo_relative(repo: &Repository, path: &Path) -> Result<PathBuf> {
+    let workdir = repo
+        .workdir()
+        .ok_or_else(|| anyhow!("Repository has no working directory"))?
+        .canonicalize()?;
+    let name = path
+        .file_name()
+        .ok_or_else(|| anyhow!("Not a file path: {}", path.display()))?;
+    let dir = path.parent().unwrap_or(Path::new(".")).canonicalize()?;
+    let rel = dir
+        .strip_prefix(&workdir)
+        .map_err(|_| anyhow!("{} is outside the repository", path.display()))?;
+    Ok(rel.join(name))
+}
+
 fn summarize_status_entries(repo: &Repository) -> Result<(usize, usize, usize)> {
     let mut options = StatusOptions::new();
     options
@@ -251,6 +383,28 @@ fn diff_line_type_to_str(value: DiffLineType) -> &'static str {
     }
 }
 
+/// Git author identity for tests that commit (here and in `agent::sync`);
+/// unset again on drop.
+#[cfg(test)]
+pub(crate) struct EnvGuard;
+
+#[cfg(test)]
+impl EnvGuard {
+    pub(crate) fn new() -> Self {
+        std::env::set_var("GIT_AUTHOR_NAME", "Test User");
+        std::env::set_var("GIT_AUTHOR_EMAIL", "test@example.com");
+        Self
+    }
+}
+
+#[cfg(test)]
+impl Drop for EnvGuard {
+    fn drop(&mut self) {
+        std::env::remove_var("GIT_AUTHOR_NAME");
+        std::env::remove_var("GIT_AUTHOR_EMAIL");
+    }
+}
+
 #[cfg(test)]
 mod tests {
     use super::*;
@@ -259,22 +413,6 @@ mod tests {
 
     const DID_KEY: &str = "did:key:ztest";
 
-    struct EnvGuard;
-
-    impl EnvGuard {
-        fn new() -> Self {
-            std::env::set_var("GIT_AUTHOR_NAME", "Test User");
-            std::env::set_var("GIT_AUTHOR_EMAIL", "test@example.com");
-            Self
-        }
-    }
-    impl Drop for EnvGuard {
-        fn drop(&mut self) {
-            std::env::remove_var("GIT_AUTHOR_NAME");
-            std::env::remove_var("GIT_AUTHOR_EMAIL");
-        }
-    }
-
     fn setup_repo() -> (TempDir, std::path::PathBuf, EnvGuard) {
         let guard = EnvGuard::new();
         let tmp = TempDir::new().unwrap();
@@ -320,4 +458,27 @@ mod tests {
         let payload = diff(&root, None, None).unwrap();
         assert!(payload.files_changed >= 1);
     }
+
+    #[test]
+    fn revision_helpers_track_committed_file() {
+        let (_tmp, root, _guard) = setup_repo();
+        let file = root.join("building.yaml");
+        fs::write(&file, "first").unwrap();
+        let first = commit(&root, "Initial", true, DID_KEY).unwrap().commit_id;
+
+        assert_eq!(
+            clean_head_revision(&root, "building.yaml"),
+            Some(first.clone())
+        );
+        fs::write(&file, "edited").unwrap();
+        assert_eq!(clean_head_revision(&root, "building.yaml"), None);
+
+        commit(&root, "Update", true, DID_KEY).unwrap();
+        assert_eq!(resolve_commit(&root, "HEAD~1").unwrap(), first);
+        assert_eq!(
+            file_at_commit(&root, &first, "building.yaml").unwrap(),
+            b"first"
+        );
+        assert!(file_at_commit(&root, &first, "missing.yaml").is_err());
+    }
 }
@@ -1,12 +1,15 @@
 use std::fs;
-use std::path::Path;
+use std::io::{self, Write};
+use std::path::{Path, PathBuf};
+use std::sync::Mutex;
 
 use crate::agent::git::SyncState;
-use crate::export::ifc::IFCExporter;
+use crate::export::ifc::{IFCExporter, IfcExportCache};
 use crate::ingest::import_ifc_path;
 use crate::persistence::{load_building_at, save_building_at, BUILDING_YAML};
 use crate::utils::path_safety::PathSafety;
 use anyhow::{anyhow, bail, Result};
+use base64::write::EncoderStringWriter;
 use base64::{engine::general_purpose, Engine as _};
 
 #[derive(Debug, serde::Serialize)]
@@ -24,10 +27,38 @@ pub struct IfcImportResult {
 #[derive(Debug, serde::Serialize)]
 pub struct IfcExportResult {
     pub filename: String,
+    /// Base64 file contents; empty for [`export_ifc_file`].
     pub data: String,
     pub size_bytes: usize,
 }
 
+/// Delta-export state shared by `ifc.export` and auto-export
+/// (`AgentState::exports`).
+///
+/// Keeps the STEP blocks of one export path, the last one written: the repo
+/// holds one building, so another path (a renamed export) replaces it rather
+/// than growing the set. The cache is taken out for the duration of an
+/// export, so concurrent exports never wait on each other; one that finds it
+/// taken simply renders every storey.
+#[derive(Default)]
+pub struct ExportCache {
+    slot: Mutex<Option<(PathBuf, IfcExportCache)>>,
+}
+
+impl ExportCache {
+    fn take(&self, path: &Path) -> IfcExportCache {
+        let mut slot = self.slot.lock().unwrap_or_else(|p| p.into_inner());
+        match slot.take() {
+            Some((cached, cache)) if cached == path => cache,
+            _ => IfcExportCache::default(),
+        }
+    }
+
+    fn put(&self, path: PathBuf, cache: IfcExportCache) {
+        *self.slot.lock().unwrap_or_else(|p| p.into_inner()) = Some((path, cache));
+    }
+}
+
 pub fn import_ifc(repo_root: &Path, filename: &str, data_base64: &str) -> Result<IfcImportResult> {
     let bytes = decode_base64(data_base64)?;
     let max_ifc = crate::resource_limits::max_ifc_bytes() as usize;
@@ -106,33 +137,52 @@ fn finish_import(repo_root: &Path, ifc_path: &Path) -> Result<IfcImportResult> {
 /// Export IFC via the **same** compiler spine as `arx export --format ifc`
 /// (`export::ifc::IFCExporter`).
 ///
-/// Agent/daemon is edge bridging only: it must not invent alternate STEP writers
-/// or delta semantics. Official L1 pilot handoffs use the CLI.
+/// Agent/daemon is edge bridging only: it must not invent alternate STEP writers.
+/// Official L1 pilot handoffs use the CLI.
 ///
-/// * `delta` — always rejected (matches CLI: not implemented).
+/// * `delta` — reuse STEP blocks of storeys unchanged since this agent's last
+///   export to the same file ([`IFCExporter::export_incremental`]). The output
+///   is still a complete IFC file; only the work to produce it is incremental.
 /// * `approved_only` — same filter as CLI `--approved-only` (drop proposed/rejected LiDAR autos).
 pub fn export_ifc(
     repo_root: &Path,
+    exports: &ExportCache,
     filename: Option<String>,
     delta: bool,
 ) -> Result<IfcExportResult> {
-    export_ifc_with_options(repo_root, filename, delta, false)
+    export_ifc_with_options(repo_root, exports, filename, delta, false)
 }
 
 /// See [`export_ifc`]. Prefer this when the RPC client can pass review flags.
 pub fn export_ifc_with_options(
     repo_root: &Path,
+    exports: &ExportCache,
     filename: Option<String>,
     delta: bool,
     approved_only: bool,
 ) -> Result<IfcExportResult> {
-    if delta {
-        bail!(
-            "agent ifc.export delta is not supported (same as `arx export --delta`). \
-             Use full export via export::ifc. Official pilot handoffs: `arx export --format ifc`."
-        );
-    }
+    write_export(repo_root, exports, filename, delta, approved_only, true)
+}
 
+/// Like [`export_ifc`], but only writes the file: no base64 payload is
+/// encoded (`data` is empty). For auto-export, which never returns it.
+pub fn export_ifc_file(
+    repo_root: &Path,
+    exports: &ExportCache,
+    filename: Option<String>,
+    delta: bool,
+) -> Result<IfcExportResult> {
+    write_export(repo_root, exports, filename, delta, false, false)
+}
+
+fn write_export(
+    repo_root: &Path,
+    exports: &ExportCache,
+    filename: Option<String>,
+    delta: bool,
+    approved_only: bool,
+    with_payload: bool,
+) -> Result<IfcExportResult> {
     let mut building = load_building_at(repo_root)
         .map_err(|e| anyhow!("Failed to load {}: {}", BUILDING_YAML, e))?;
 
@@ -162,8 +212,37 @@ pub fn export_ifc_with_options(
     let ifc_path = exports_dir.join(&export_filename);
     PathSafety::validate_path_for_write(&ifc_path).map_err(|e| anyhow!(e))?;
 
-    // Full export only — single IFCExporter path (no delta theater).
-    exporter.export(&ifc_path)?;
+    // Stream once into both the file and the base64 payload instead of
+    // writing the file and reading it back into memory.
+    let tee = ExportTee {
+        file: fs::File::create(&ifc_path)?,
+        encoder: with_payload.then(|| EncoderStringWriter::new(&general_purpose::STANDARD)),
+        size_bytes: 0,
+    };
+    let tee = if delta {
+        let mut cache = exports.take(&ifc_path);
+        let (tee, stats) =
+            exporter.export_incremental_to_writer(tee, &export_filename, &mut cache)?;
+        exports.put(ifc_path.clone(), cache);
+        eprintln!(
+            "  delta: {} storey(s) reused, {} rewritten{}",
+            stats.floors_reused,
+            stats.floors_rewritten,
+            if stats.full_rewrite {
+                " (full rewrite)"
+            } else {
+                ""
+            }
+        );
+        tee
+    } else {
+        exporter.export_to_writer(tee, &export_filename)?
+    };
+    let size_bytes = tee.size_bytes;
+    let encoded = tee
+        .encoder
+        .map(EncoderStringWriter::into_inner)
+        .unwrap_or_default();
 
     let sync_state_path = repo_root.join(SyncState::default_path());
     let mut sync_state = SyncState::load(&sync_state_path).unwrap_or_else(|| {
@@ -185,16 +264,40 @@ pub fn export_ifc_with_options(
         .save(&sync_state_path)
         .map_err(|e| anyhow!("Failed to save IFC sync state: {}", e))?;
 
-    let bytes = fs::read(&ifc_path)?;
-    let encoded = general_purpose::STANDARD.encode(&bytes);
-
     Ok(IfcExportResult {
         filename: relative_display_path(repo_root, &ifc_path),
         data: encoded,
-        size_bytes: bytes.len(),
+        size_bytes,
     })
 }
 
+/// Export sink that writes the IFC file and, when requested, its base64 RPC
+/// payload in one pass.
+struct ExportTee {
+    file: fs::File,
+    encoder: Option<EncoderStringWriter<'static, general_purpose::GeneralPurpose, String>>,
+    size_bytes: usize,
+}
+
+impl Write for ExportTee {
+    fn write(&mut self, buf: &[u8]) -> io::Result<usize> {
+        self.file.write_all(buf)?;
+        if let Some(encoder) = &mut self.encoder {
+            encoder.write_all(buf)?;
+        }
+        self.size_bytes += buf.len();
+        Ok(buf.len())
+    }
+
+    fn flush(&mut self) -> io::Result<()> {
+        self.file.flush()?;
+        match &mut self.encoder {
+            Some(encoder) => encoder.flush(),
+            None => Ok(()),
+        }
+    }
+}
+
 fn decode_base64(data: &str) -> Result<Vec<u8>> {
     general_purpose::STANDARD
         .decode(data)
@@ -299,8 +402,18 @@ mod tests {
 
         save_building_at(repo_root, &building).unwrap();
 
-        let export = export_ifc(repo_root, None, false).unwrap();
+        let exports = ExportCache::default();
+        let export = export_ifc(repo_root, &exports, None, false).unwrap();
         assert!(export.size_bytes > 0);
         assert!(!export.data.is_empty());
+
+        // File-only delta export: same bytes on disk, no payload, cache kept
+        let written = fs::read(repo_root.join(&export.filename)).unwrap();
+        let file_only = export_ifc_file(repo_root, &exports, None, true).unwrap();
+        assert!(file_only.data.is_empty());
+        assert_eq!(file_only.size_bytes, written.len());
+        assert!(exports.slot.lock().unwrap().is_some());
+        let second = export_ifc_file(repo_root, &exports, None, true).unwrap();
+        assert_eq!(fs::read(repo_root.join(&second.filename)).unwrap(), written);
     }
 }
@@ -23,6 +23,10 @@ pub mod ifc;
 #[cfg(feature = "agent")]
 pub mod ssh_auth;
 #[cfg(feature = "agent")]
+pub mod subtree;
+#[cfg(feature = "agent")]
+pub mod sync;
+#[cfg(feature = "agent")]
 pub mod ssh_server;
 #[cfg(feature = "agent")]
 pub mod watcher;
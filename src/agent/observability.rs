@@ -1,23 +1,38 @@
 //! Observability and operational instrumentation helper for the ArxOS agent.
 
+use std::collections::BTreeMap;
 use std::fmt;
-use std::sync::atomic::{AtomicUsize, Ordering};
-use std::sync::Mutex;
-use std::time::Instant;
+use std::sync::atomic::{AtomicU64, AtomicUsize, Ordering};
+use std::sync::Arc;
+use std::time::{Duration, Instant};
 use std::path::PathBuf;
 use std::sync::OnceLock;
+use arc_swap::ArcSwap;
 use regex::Regex;
 use tracing_subscriber::{reload, EnvFilter, Registry};
 
+use crate::agent::dispatcher::RPC_METHODS;
+use crate::telemetry::{CacheStats, LatencyHistogram};
+
+/// Caches a client may report through `metrics.report_cache`.
+pub const REPORTED_CACHES: [&str; 1] = ["warm"];
+
 /// Thread-safe accumulator for agent operational metrics.
 pub struct AgentMetrics {
     pub start_time: Instant,
     pub claims_processed: AtomicUsize,
     pub claims_approved: AtomicUsize,
     pub claims_rejected: AtomicUsize,
-    pub rewards_distributed_axd: Mutex<f64>,
+    /// `f64` bits, so claim processing never waits on a lock.
+    rewards_distributed_axd: AtomicU64,
     pub errors_encountered: AtomicUsize,
     pub active_ws_clients: AtomicUsize,
+    /// Per-method RPC latency, indexed like [`RPC_METHODS`] plus a trailing
+    /// slot for unknown methods.
+    rpc_latency: Box<[LatencyHistogram]>,
+    rpc_errors: Box<[AtomicU64]>,
+    /// Latest counters each PWA cache reported, keyed by [`REPORTED_CACHES`] name.
+    cache_reports: ArcSwap<BTreeMap<&'static str, CacheStats>>,
 }
 
 impl Default for AgentMetrics {
@@ -33,9 +48,14 @@ impl AgentMetrics {
             claims_processed: AtomicUsize::new(0),
             claims_approved: AtomicUsize::new(0),
             claims_rejected: AtomicUsize::new(0),
-            rewards_distributed_axd: Mutex::new(0.0),
+            rewards_distributed_axd: AtomicU64::new(0f64.to_bits()),
             errors_encountered: AtomicUsize::new(0),
             active_ws_clients: AtomicUsize::new(0),
+            rpc_latency: (0..=RPC_METHODS.len())
+                .map(|_| LatencyHistogram::new())
+                .collect(),
+            rpc_errors: (0..=RPC_METHODS.len()).map(|_| AtomicU64::new(0)).collect(),
+            cache_reports: ArcSwap::from_pointee(BTreeMap::new()),
         }
     }
 
@@ -43,9 +63,11 @@ impl AgentMetrics {
         self.claims_processed.fetch_add(1, Ordering::SeqCst);
         if approved {
             self.claims_approved.fetch_add(1, Ordering::SeqCst);
-            if let Ok(mut val) = self.rewards_distributed_axd.lock() {
-                *val += reward;
-            }
+            let _ = self.rewards_distributed_axd.fetch_update(
+                Ordering::SeqCst,
+                Ordering::SeqCst,
+                |bits| Some((f64::from_bits(bits) + reward).to_bits()),
+            );
         } else {
             self.claims_rejected.fetch_add(1, Ordering::SeqCst);
         }
@@ -54,6 +76,48 @@ impl AgentMetrics {
     pub fn record_error(&self) {
         self.errors_encountered.fetch_add(1, Ordering::SeqCst);
     }
+
+    pub fn rewards_distributed_axd(&self) -> f64 {
+        f64::from_bits(self.rewards_distributed_axd.load(Ordering::SeqCst))
+    }
+
+    pub fn record_rpc(&self, method: &str, elapsed: Duration, ok: bool) {
+        let slot = RPC_METHODS
+            .iter()
+            .position(|m| *m == method)
+            .unwrap_or(RPC_METHODS.len());
+        self.rpc_latency[slot].observe(elapsed);
+        if !ok {
+            self.rpc_errors[slot].fetch_add(1, Ordering::Relaxed);
+        }
+    }
+
+    /// `(method, latency, errors)` for every known method, then `"other"`.
+    pub fn rpc_series(&self) -> impl Iterator<Item = (&'static str, &LatencyHistogram, u64)> + '_ {
+        RPC_METHODS
+            .iter()
+            .copied()
+            .chain(std::iter::once("other"))
+            .zip(self.rpc_latency.iter().zip(self.rpc_errors.iter()))
+            .map(|(method, (latency, errors))| (method, latency, errors.load(Ordering::Relaxed)))
+    }
+
+    /// Store the latest counters for `cache`; false if the name is not a known cache.
+    pub fn report_cache(&self, cache: &str, stats: CacheStats) -> bool {
+        let Some(name) = REPORTED_CACHES.iter().copied().find(|c| *c == cache) else {
+            return false;
+        };
+        self.cache_reports.rcu(|current| {
+            let mut next = BTreeMap::clone(current);
+            next.insert(name, stats);
+            next
+        });
+        true
+    }
+
+    pub fn cache_reports(&self) -> Arc<BTreeMap<&'static str, CacheStats>> {
+        self.cache_reports.load_full()
+    }
 }
 
 /// A wrapper that hides sensitive values (such as private keys or signatures) from formatting outputs.
@@ -1,3 +1,8 @@
+use std::io::Write;
+
+use anyhow::{anyhow, bail, Result};
+use base64::{engine::general_purpose, Engine as _};
+use flate2::{write::GzEncoder, Compression};
 use serde::{Deserialize, Serialize};
 use serde_json::Value;
 
@@ -48,6 +53,76 @@ impl JsonRpcResponse {
     }
 }
 
+/// Server-initiated message without an `id`, e.g. progress of a long call.
+#[derive(Debug, Clone, Serialize, Deserialize)]
+pub struct JsonRpcNotification {
+    pub jsonrpc: String,
+    pub method: String,
+    pub params: Value,
+}
+
+impl JsonRpcNotification {
+    pub fn new(method: &str, params: Value) -> Self {
+        Self {
+            jsonrpc: "2.0".to_string(),
+            method: method.to_string(),
+            params,
+        }
+    }
+}
+
+/// Result encoding requested through the `encoding` (`"json"` | `"cbor"`) and
+/// `compress` (bool) params of bulky RPCs.
+///
+/// Plain JSON is returned inline as before. Anything else comes back as
+/// `{ "encoding", "compression", "data" }` with base64 `data`, so the same
+/// result works over `/rpc` and as a WebSocket text frame.
+#[derive(Debug, Clone, Copy, Default, PartialEq, Eq)]
+pub struct PayloadOptions {
+    pub cbor: bool,
+    pub gzip: bool,
+}
+
+impl PayloadOptions {
+    pub fn from_params(params: &Value) -> Result<Self> {
+        let cbor = match params.get("encoding").and_then(|v| v.as_str()) {
+            None | Some("json") => false,
+            Some("cbor") => true,
+            Some(other) => bail!("Unsupported encoding '{}'", other),
+        };
+        let gzip = params
+            .get("compress")
+            .and_then(|v| v.as_bool())
+            .unwrap_or(false);
+        Ok(Self { cbor, gzip })
+    }
+
+    pub fn encode<T: Serialize>(&self, value: &T) -> Result<Value> {
+        if !self.cbor && !self.gzip {
+            return Ok(serde_json::to_value(value)?);
+        }
+
+        let mut bytes = Vec::new();
+        if self.cbor {
+            ciborium::into_writer(value, &mut bytes)
+                .map_err(|e| anyhow!("CBOR encoding failed: {}", e))?;
+        } else {
+            serde_json::to_writer(&mut bytes, value)?;
+        }
+        if self.gzip {
+            let mut encoder = GzEncoder::new(Vec::new(), Compression::default());
+            encoder.write_all(&bytes)?;
+            bytes = encoder.finish()?;
+        }
+
+        Ok(serde_json::json!({
+            "encoding": if self.cbor { "cbor" } else { "json" },
+            "compression": if self.gzip { "gzip" } else { "none" },
+            "data": general_purpose::STANDARD.encode(bytes),
+        }))
+    }
+}
+
 // Error codes
 pub const PARSE_ERROR: i32 = -32700;
 pub const INVALID_REQUEST: i32 = -32600;
@@ -55,3 +130,33 @@ pub const METHOD_NOT_FOUND: i32 = -32601;
 pub const INVALID_PARAMS: i32 = -32602;
 pub const INTERNAL_ERROR: i32 = -32603;
 pub const AUTH_ERROR: i32 = -32001;
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use flate2::read::GzDecoder;
+    use std::io::Read;
+
+    #[test]
+    fn payload_options_encode_compressed_json() {
+        let value = serde_json::json!({ "floors": [1, 2, 3] });
+        let plain = PayloadOptions::from_params(&Value::Null).unwrap();
+        assert_eq!(plain.encode(&value).unwrap(), value);
+
+        let params = serde_json::json!({ "compress": true });
+        let packed = PayloadOptions::from_params(&params)
+            .unwrap()
+            .encode(&value)
+            .unwrap();
+        assert_eq!(packed["encoding"], "json");
+        let data = general_purpose::STANDARD
+            .decode(packed["data"].as_str().unwrap())
+            .unwrap();
+        let mut json = String::new();
+        GzDecoder::new(&data[..]).read_to_string(&mut json).unwrap();
+        assert_eq!(serde_json::from_str::<Value>(&json).unwrap(), value);
+
+        let bad = serde_json::json!({ "encoding": "xml" });
+        assert!(PayloadOptions::from_params(&bad).is_err());
+    }
+}
@@ -10,7 +10,7 @@ use std::{
 #[cfg(feature = "agent")]
 use crate::agent::{
     auth::{generate_did_key, TokenState},
-    dispatcher::{dispatch, AgentState},
+    dispatcher::{dispatch, dispatch_with_progress, AgentState},
     protocol::{JsonRpcRequest, JsonRpcResponse, PARSE_ERROR},
     workspace::detect_repo_root,
 };
@@ -75,6 +75,7 @@ pub async fn start_agent() -> Result<(), Box<dyn std::error::Error>> {
         "ifc.import".to_string(),
         "ifc.export".to_string(),
         "collab.sync".to_string(),
+        "sync.apply".to_string(),
         "auth.manage".to_string(),
     ];
 
@@ -84,6 +85,8 @@ pub async fn start_agent() -> Result<(), Box<dyn std::error::Error>> {
         repo_root: repo_root.clone(),
         token: Arc::new(Mutex::new(token_state)),
         metrics: metrics.clone(),
+        building: Arc::new(crate::agent::building::BuildingCache::default()),
+        exports: Arc::new(crate::agent::ifc::ExportCache::default()),
         reload_handle: Some(reload_handle.clone()),
     });
 
@@ -121,6 +124,13 @@ pub async fn start_agent() -> Result<(), Box<dyn std::error::Error>> {
         }
     });
 
+    let cache_state = state.clone();
+    tokio::spawn(async move {
+        if let Err(e) = run_building_cache_watcher(cache_state).await {
+            eprintln!("❌ Building cache watcher error: {}", e);
+        }
+    });
+
     // 5. Start P2P Local Discovery
     crate::agent::discovery::start_discovery(root_token.clone(), 8787);
 
@@ -134,7 +144,7 @@ pub async fn start_agent() -> Result<(), Box<dyn std::error::Error>> {
          Official IFC export for pilots: `arx export --format ifc`."
     );
     println!(
-        "🔍 Auto-export convenience: watching for YAML changes (full export, not official)...\n"
+        "🔍 Auto-export convenience: watching for YAML changes (incremental export, not official)...\n"
     );
 
     let listener = tokio::net::TcpListener::bind(addr).await?;
@@ -312,27 +322,29 @@ pub async fn http_claim_approve(
             return (StatusCode::INTERNAL_SERVER_ERROR, "Invalid repo path").into_response();
         }
     };
-    let building = match crate::persistence::load_building_at(&state.repo_root) {
-        Ok(b) => b,
+    let building_id = match state.building.get(&state.repo_root) {
+        Ok(cached) => cached.building.id.clone(),
         Err(e) => {
             state.metrics.record_error();
             return (StatusCode::INTERNAL_SERVER_ERROR, format!("Failed to load building: {}", e)).into_response();
         }
     };
-    let building_id = building.id.clone();
 
     manager.register_active_claim(building_id.clone(), 14);
 
     let live_mode = body.live.unwrap_or(false);
 
-    match manager.review_pending_contribution(
+    let reviewed = manager.review_pending_contribution(
         repo_str,
         &building_id,
         id,
         true, // Approve
         &body.owner_address,
         live_mode,
-    ) {
+    );
+    // Reviewing may rewrite building.yaml (approval replaces it).
+    state.building.invalidate();
+    match reviewed {
         Ok((claim_state, receipt)) => {
             state.metrics.record_claim_processed(true, 500.0);
             Json(serde_json::json!({
@@ -369,25 +381,27 @@ pub async fn http_claim_reject(
             return (StatusCode::INTERNAL_SERVER_ERROR, "Invalid repo path").into_response();
         }
     };
-    let building = match crate::persistence::load_building_at(&state.repo_root) {
-        Ok(b) => b,
+    let building_id = match state.building.get(&state.repo_root) {
+        Ok(cached) => cached.building.id.clone(),
         Err(e) => {
             state.metrics.record_error();
             return (StatusCode::INTERNAL_SERVER_ERROR, format!("Failed to load building: {}", e)).into_response();
         }
     };
-    let building_id = building.id.clone();
 
     manager.register_active_claim(building_id.clone(), 14);
 
-    match manager.review_pending_contribution(
+    let reviewed = manager.review_pending_contribution(
         repo_str,
         &building_id,
         id,
         false, // Reject
         "0x0000000000000000000000000000000000000000",
         false,
-    ) {
+    );
+    // Reviewing may rewrite building.yaml (approval replaces it).
+    state.building.invalidate();
+    match reviewed {
         Ok((claim_state, receipt)) => {
             state.metrics.record_claim_processed(false, 0.0);
             Json(serde_json::json!({
@@ -465,7 +479,28 @@ async fn handle_socket(mut socket: WebSocket, state: Arc<AgentState>) {
             Message::Text(text) => {
                 // Parse JSON-RPC Request
                 let response = match serde_json::from_str::<JsonRpcRequest>(&text) {
-                    Ok(request) => dispatch(state.clone(), request).await,
+                    Ok(request) => {
+                        // Forward progress notifications while the call runs
+                        let (tx, mut rx) = tokio::sync::mpsc::unbounded_channel();
+                        let call = dispatch_with_progress(state.clone(), request, Some(tx));
+                        tokio::pin!(call);
+                        let response = loop {
+                            tokio::select! {
+                                response = &mut call => break response,
+                                Some(notification) = rx.recv() => {
+                                    if !send_json(&mut socket, &notification).await {
+                                        return;
+                                    }
+                                }
+                            }
+                        };
+                        while let Ok(notification) = rx.try_recv() {
+                            if !send_json(&mut socket, &notification).await {
+                                return;
+                            }
+                        }
+                        response
+                    }
                     Err(e) => JsonRpcResponse::error(
                         None,
                         PARSE_ERROR,
@@ -475,11 +510,8 @@ async fn handle_socket(mut socket: WebSocket, state: Arc<AgentState>) {
                 };
 
                 // Send Response
-                if let Ok(resp_text) = serde_json::to_string(&response) {
-                    if let Err(e) = socket.send(Message::Text(resp_text)).await {
-                        tracing::error!(error = %e, "Failed to send WebSocket response");
-                        return;
-                    }
+                if !send_json(&mut socket, &response).await {
+                    return;
                 }
             }
             Message::Close(_) => {
@@ -490,6 +522,18 @@ async fn handle_socket(mut socket: WebSocket, state: Arc<AgentState>) {
     }
 }
 
+/// Send `value` as a text frame; `false` once the socket is gone.
+#[cfg(feature = "agent")]
+async fn send_json<T: serde::Serialize>(socket: &mut WebSocket, value: &T) -> bool {
+    if let Ok(text) = serde_json::to_string(value) {
+        if let Err(e) = socket.send(Message::Text(text)).await {
+            tracing::error!(error = %e, "Failed to send WebSocket response");
+            return false;
+        }
+    }
+    true
+}
+
 #[cfg(feature = "agent")]
 #[derive(serde::Serialize)]
 struct AgentStatusDto {
@@ -517,7 +561,12 @@ pub async fn http_agent_status(
     }
 
     let uptime = state.metrics.start_time.elapsed().as_secs();
-    let cache_size = 0; // Static placeholder or simple count of active connections
+    // The warm cache lives in the PWA; this is its last `metrics.report_cache`
+    let cache_size = state
+        .metrics
+        .cache_reports()
+        .get("warm")
+        .map_or(0, |stats| stats.entries as usize);
 
     let status = AgentStatusDto {
         status: "healthy".to_string(),
@@ -551,11 +600,7 @@ pub async fn http_claims_status(
         return (StatusCode::UNAUTHORIZED, "Unauthorized").into_response();
     }
 
-    let axd = if let Ok(val) = state.metrics.rewards_distributed_axd.lock() {
-        *val
-    } else {
-        0.0
-    };
+    let axd = state.metrics.rewards_distributed_axd();
 
     let status = ClaimsStatusDto {
         claims_processed: state.metrics.claims_processed.load(Ordering::SeqCst),
@@ -578,15 +623,11 @@ pub async fn http_prometheus_metrics(
         return (StatusCode::UNAUTHORIZED, "Unauthorized").into_response();
     }
 
-    let axd = if let Ok(val) = state.metrics.rewards_distributed_axd.lock() {
-        *val
-    } else {
-        0.0
-    };
+    let axd = state.metrics.rewards_distributed_axd();
 
     let uptime = state.metrics.start_time.elapsed().as_secs();
 
-    let metrics_text = format!(
+    let mut metrics_text = format!(
         "# HELP arx_agent_uptime_seconds The uptime of the ArxOS agent in seconds.\n\
          # TYPE arx_agent_uptime_seconds gauge\n\
          arx_agent_uptime_seconds {}\n\
@@ -616,6 +657,7 @@ pub async fn http_prometheus_metrics(
         axd,
         state.metrics.errors_encountered.load(Ordering::SeqCst)
     );
+    write_latency_metrics(&mut metrics_text, &state.metrics);
 
     (
         [(axum::http::header::CONTENT_TYPE, "text/plain; version=0.0.4")],
@@ -623,62 +665,222 @@ pub async fn http_prometheus_metrics(
     ).into_response()
 }
 
+/// RPC and pipeline phase latency histograms, then the PWA cache counters.
+#[cfg(feature = "agent")]
+fn write_latency_metrics(out: &mut String, metrics: &crate::agent::observability::AgentMetrics) {
+    use crate::telemetry::{self, CacheStats, Phase};
+    use std::fmt::Write as _;
+
+    telemetry::write_histogram_family(
+        out,
+        "arx_agent_rpc_duration_seconds",
+        "Latency of JSON-RPC calls by method.",
+        metrics
+            .rpc_series()
+            .map(|(method, latency, _)| (format!("method=\"{}\"", method), latency)),
+    );
+    let _ = writeln!(
+        out,
+        "# HELP arx_agent_rpc_errors_total JSON-RPC calls that returned an error, by method."
+    );
+    let _ = writeln!(out, "# TYPE arx_agent_rpc_errors_total counter");
+    for (method, _, errors) in metrics.rpc_series().filter(|(_, _, errors)| *errors > 0) {
+        let _ = writeln!(
+            out,
+            "arx_agent_rpc_errors_total{{method=\"{}\"}} {}",
+            method, errors
+        );
+    }
+
+    telemetry::write_histogram_family(
+        out,
+        "arx_agent_phase_duration_seconds",
+        "Time spent in IFC, LiDAR, YAML and git phases.",
+        Phase::ALL.into_iter().map(|phase| {
+            (
+                format!("phase=\"{}\"", phase.as_str()),
+                telemetry::phase_latency(phase),
+            )
+        }),
+    );
+
+    // Gauges and counters as last reported by the PWA (`metrics.report_cache`)
+    let reports = metrics.cache_reports();
+    let mut cache_family = |name: &str, kind: &str, help: &str, value: fn(&CacheStats) -> u64| {
+        let _ = writeln!(out, "# HELP {} {}", name, help);
+        let _ = writeln!(out, "# TYPE {} {}", name, kind);
+        for (cache, stats) in reports.iter() {
+            let _ = writeln!(out, "{}{{cache=\"{}\"}} {}", name, cache, value(stats));
+        }
+    };
+    cache_family(
+        "arx_pwa_cache_hits_total",
+        "counter",
+        "PWA cache hits.",
+        |s| s.hits,
+    );
+    cache_family(
+        "arx_pwa_cache_misses_total",
+        "counter",
+        "PWA cache misses.",
+        |s| s.misses,
+    );
+    cache_family(
+        "arx_pwa_cache_evictions_total",
+        "counter",
+        "PWA cache evictions.",
+        |s| s.evictions,
+    );
+    cache_family(
+        "arx_pwa_cache_entries",
+        "gauge",
+        "Entries held by the PWA cache.",
+        |s| s.entries,
+    );
+    cache_family(
+        "arx_pwa_cache_bytes",
+        "gauge",
+        "Estimated bytes held by the PWA cache.",
+        |s| s.bytes,
+    );
+}
+
+/// Quiet period after the last YAML change before auto-export runs.
+#[cfg(feature = "agent")]
+const AUTO_EXPORT_QUIET_PERIOD: std::time::Duration = std::time::Duration::from_millis(750);
+
+/// Quiet period before auto-import, so a large IFC copy finishes first.
+#[cfg(feature = "agent")]
+const AUTO_IMPORT_QUIET_PERIOD: std::time::Duration = std::time::Duration::from_millis(1000);
+
 #[cfg(feature = "agent")]
 async fn run_auto_export_watcher(state: Arc<AgentState>) -> Result<(), Box<dyn std::error::Error>> {
-    use std::time::Duration;
+    use crate::agent::watcher::{FileWatcher, WatchOptions};
 
-    let watcher = crate::agent::watcher::FileWatcher::new(
+    // Debounce: editors and git checkouts touch files in bursts; export once
+    // for the whole burst after a quiet period. Root only, and only batches
+    // naming `building.yaml`: other YAML (CI, docs) must not cost an export.
+    let mut watcher = FileWatcher::with_options(
         &state.repo_root,
         vec!["yaml".to_string(), "yml".to_string()],
+        WatchOptions {
+            recursive: false,
+            debounce: AUTO_EXPORT_QUIET_PERIOD,
+            ..WatchOptions::default()
+        },
     )?;
     println!("👀 Watching {} for YAML changes", state.repo_root.display());
 
-    loop {
-        // Check for changes every 500ms
-        tokio::time::sleep(Duration::from_millis(500)).await;
+    while let Some(batch) = watcher.next_batch().await {
+        if !batch.contains_file_named(crate::persistence::BUILDING_YAML) {
+            continue;
+        }
+        let first = batch
+            .paths
+            .iter()
+            .next()
+            .map(|p| p.display().to_string())
+            .unwrap_or_default();
+        println!(
+            "📝 Detected change: {} ({} file(s), {} event(s) coalesced)",
+            first,
+            batch.paths.len(),
+            batch.events
+        );
+        println!(
+            "🔄 Auto-exporting IFC (incremental export via export::ifc; convenience only — \
+             official pilot handoffs use `arx export --format ifc`)..."
+        );
+
+        // delta=true: unchanged storeys are reused from the previous export.
+        // File only: nothing reads a base64 payload here.
+        let repo_root = state.repo_root.clone();
+        let exports = state.exports.clone();
+        let export = tokio::task::spawn_blocking(move || {
+            crate::agent::ifc::export_ifc_file(&repo_root, &exports, None, true)
+        })
+        .await?;
+        match export {
+            Ok(result) => {
+                println!(
+                    "✅ Auto-export complete: {} ({} bytes)",
+                    result.filename, result.size_bytes
+                );
+            }
+            Err(e) => {
+                eprintln!("❌ Auto-export failed: {}", e);
+            }
+        }
+    }
+    Ok(())
+}
 
-        if let Some(changed_path) = watcher.check_for_changes() {
-            println!("📝 Detected change: {}", changed_path.display());
-            println!(
-                "🔄 Auto-exporting IFC (full export via export::ifc; convenience only — \
-                 official pilot handoffs use `arx export --format ifc`)..."
-            );
+/// Keeps `AgentState::building` in step with `building.yaml` on disk: each
+/// batch of YAML changes drops the shared snapshot and re-parses it off the
+/// runtime, so `building.get` pollers keep reading from memory.
+#[cfg(feature = "agent")]
+async fn run_building_cache_watcher(state: Arc<AgentState>) -> Result<(), Box<dyn std::error::Error>> {
+    use crate::agent::watcher::{FileWatcher, WatchOptions};
 
-            // delta=false: same spine as CLI; no alternate delta semantics.
-            match crate::agent::ifc::export_ifc(&state.repo_root, None, false) {
-                Ok(result) => {
-                    println!(
-                        "✅ Auto-export complete: {} ({} bytes)",
-                        result.filename, result.size_bytes
-                    );
-                }
-                Err(e) => {
-                    eprintln!("❌ Auto-export failed: {}", e);
-                }
-            }
+    // Same scope as auto-export: only the root `building.yaml` is cached.
+    let mut watcher = FileWatcher::with_options(
+        &state.repo_root,
+        vec!["yaml".to_string(), "yml".to_string()],
+        WatchOptions {
+            recursive: false,
+            ..WatchOptions::default()
+        },
+    )?;
+
+    while let Some(batch) = watcher.next_batch().await {
+        if !batch.contains_file_named(crate::persistence::BUILDING_YAML) {
+            continue;
+        }
+        state.building.invalidate();
+
+        let refresh_state = state.clone();
+        let refreshed = tokio::task::spawn_blocking(move || {
+            refresh_state.building.refresh(&refresh_state.repo_root)
+        })
+        .await?;
+        if let Err(e) = refreshed {
+            // Usually a half-written file; the next change or request reloads.
+            tracing::debug!(error = %e, "Building cache refresh failed");
         }
     }
+    Ok(())
 }
 
 #[cfg(feature = "agent")]
 async fn run_auto_import_watcher(state: Arc<AgentState>) -> Result<(), Box<dyn std::error::Error>> {
-    use std::time::Duration;
+    use crate::agent::watcher::{FileWatcher, WatchOptions};
 
-    let watcher =
-        crate::agent::watcher::FileWatcher::new(&state.repo_root, vec!["ifc".to_string()])?;
+    // Root only: IFC files dropped into the repo, not our own `exports/`.
+    let mut watcher = FileWatcher::with_options(
+        &state.repo_root,
+        vec!["ifc".to_string()],
+        WatchOptions {
+            recursive: false,
+            debounce: AUTO_IMPORT_QUIET_PERIOD,
+            ..WatchOptions::default()
+        },
+    )?;
     println!(
         "👀 Watching {} for new IFC files",
         state.repo_root.display()
     );
 
-    loop {
-        tokio::time::sleep(Duration::from_millis(1000)).await;
-
-        if let Some(changed_path) = watcher.check_for_changes() {
+    while let Some(batch) = watcher.next_batch().await {
+        for changed_path in batch.paths {
             println!("🏗️  Detected new/modified IFC: {}", changed_path.display());
             println!("🔄 Auto-importing using native engine...");
 
-            match crate::agent::ifc::import_ifc_local(&state.repo_root, &changed_path) {
+            let repo_root = state.repo_root.clone();
+            let import = tokio::task::spawn_blocking(move || {
+                crate::agent::ifc::import_ifc_local(&repo_root, &changed_path)
+            })
+            .await?;
+            match import {
                 Ok(result) => {
                     println!(
                         "✅ Auto-import complete: {} ({} floors, {} equipment)",
@@ -691,4 +893,5 @@ async fn run_auto_import_watcher(state: Arc<AgentState>) -> Result<(), Box<dyn s
             }
         }
     }
+    Ok(())
 }
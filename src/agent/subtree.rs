@@ -0,0 +1,367 @@
+//! Partial building responses for the phone Review UI.
+//!
+//! `building.subtree` returns one floor or room by address (or id), and
+//! `building.delta` returns only the floors that changed since a committed
+//! revision. Both read the shared [`BuildingCache`](crate::agent::building::BuildingCache)
+//! snapshot.
+//!
+//! `Floor` and `Room` serialize their equipment and anchors as id lists (the
+//! YAML layout), so subtrees carry those items next to the node. A delta is
+//! relative to its `since` commit: clients apply it to the state they held at
+//! that commit and only move their base forward to the returned `revision`,
+//! which is set when the working `building.yaml` matches `HEAD`.
+
+use std::collections::HashMap;
+use std::path::Path;
+use std::sync::{Arc, Mutex};
+
+use anyhow::{anyhow, Result};
+use chrono::{DateTime, Utc};
+use serde::Serialize;
+use sha2::{Digest, Sha256};
+
+use crate::agent::building::BuildingGetResult;
+use crate::agent::git;
+use crate::core::domain::ArxAddress;
+use crate::core::{
+    Anchor, BoundingBox, Building, BuildingMetadata, CoordinateSystemInfo, Equipment, Floor, Room,
+};
+use crate::persistence::BUILDING_YAML;
+use crate::yaml::BuildingYamlSerializer;
+
+/// Committed revisions whose fingerprints are kept in memory.
+const MAX_CACHED_REVISIONS: usize = 16;
+
+type Fingerprint = [u8; 32];
+
+/// Header fields rewritten on every save (`add_floor` and the other mutators
+/// bump `updated_at`), left out of the header fingerprint so a save that only
+/// touched floors does not resend the header.
+const VOLATILE_HEADER_FIELDS: [&str; 1] = ["updated_at"];
+
+/// Building-level fields of `building.get`, without the floors.
+#[derive(Debug, Serialize)]
+pub struct BuildingHeader<'a> {
+    pub id: &'a str,
+    pub name: &'a str,
+    pub path: &'a str,
+    pub description: &'a Option<String>,
+    pub version: &'a str,
+    pub global_bounding_box: &'a Option<BoundingBox>,
+    pub created_at: DateTime<Utc>,
+    pub updated_at: DateTime<Utc>,
+    pub metadata: &'a Option<BuildingMetadata>,
+    pub coordinate_systems: &'a [CoordinateSystemInfo],
+    pub ifc_global_id: &'a Option<String>,
+    pub address: &'a Option<ArxAddress>,
+    pub anchors: &'a [Anchor],
+    pub claim_grace_period_days: Option<u32>,
+}
+
+impl<'a> BuildingHeader<'a> {
+    pub fn of(building: &'a Building) -> Self {
+        Self {
+            id: &building.id,
+            name: &building.name,
+            path: &building.path,
+            description: &building.description,
+            version: &building.version,
+            global_bounding_box: &building.global_bounding_box,
+            created_at: building.created_at,
+            updated_at: building.updated_at,
+            metadata: &building.metadata,
+            coordinate_systems: &building.coordinate_systems,
+            ifc_global_id: &building.ifc_global_id,
+            address: &building.address,
+            anchors: &building.anchors,
+            claim_grace_period_days: building.claim_grace_period_days,
+        }
+    }
+}
+
+/// One floor plus every equipment item and anchor below it.
+#[derive(Debug, Serialize)]
+pub struct FloorSubtree<'a> {
+    pub floor: &'a Floor,
+    pub equipment: Vec<&'a Equipment>,
+    pub anchors: Vec<&'a Anchor>,
+}
+
+impl<'a> FloorSubtree<'a> {
+    pub fn of(floor: &'a Floor) -> Self {
+        let mut equipment: Vec<&Equipment> = floor.equipment.iter().collect();
+        let mut anchors: Vec<&Anchor> = floor.anchors.iter().collect();
+        for wing in &floor.wings {
+            equipment.extend(&wing.equipment);
+            anchors.extend(&wing.anchors);
+            for room in &wing.rooms {
+                equipment.extend(&room.equipment);
+                anchors.extend(&room.anchors);
+            }
+        }
+        Self {
+            floor,
+            equipment,
+            anchors,
+        }
+    }
+}
+
+/// One room plus its equipment and anchors.
+#[derive(Debug, Serialize)]
+pub struct RoomSubtree<'a> {
+    pub floor_id: &'a str,
+    pub wing: &'a str,
+    pub room: &'a Room,
+    pub equipment: &'a [Equipment],
+    pub anchors: &'a [Anchor],
+}
+
+#[derive(Debug, Serialize)]
+#[serde(tag = "kind", rename_all = "snake_case")]
+pub enum SubtreeNode<'a> {
+    Floor(FloorSubtree<'a>),
+    Room(RoomSubtree<'a>),
+}
+
+/// JSON result for `building.subtree`.
+#[derive(Debug, Serialize)]
+pub struct SubtreeResult<'a> {
+    pub revision: Option<&'a str>,
+    pub address: &'a str,
+    pub node: SubtreeNode<'a>,
+}
+
+/// Find the floor or room whose `ArxAddress` path (or id) is `address`.
+pub fn find_subtree<'a>(
+    current: &'a BuildingGetResult,
+    address: &'a str,
+) -> Option<SubtreeResult<'a>> {
+    let matches = |id: &str, addr: &Option<ArxAddress>| {
+        id == address || addr.as_ref().is_some_and(|a| a.path == address)
+    };
+    let node = current.building.floors.iter().find_map(|floor| {
+        if matches(&floor.id, &floor.address) {
+            return Some(SubtreeNode::Floor(FloorSubtree::of(floor)));
+        }
+        floor.wings.iter().find_map(|wing| {
+            wing.rooms
+                .iter()
+                .find(|room| matches(&room.id, &room.address))
+                .map(|room| {
+                    SubtreeNode::Room(RoomSubtree {
+                        floor_id: &floor.id,
+                        wing: &wing.name,
+                        room,
+                        equipment: &room.equipment,
+                        anchors: &room.anchors,
+                    })
+                })
+        })
+    })?;
+    Some(SubtreeResult {
+        revision: current.revision.as_deref(),
+        address,
+        node,
+    })
+}
+
+/// Fingerprints of one building state: the header and each floor subtree.
+#[derive(Debug)]
+pub struct RevisionDigest {
+    header: Fingerprint,
+    floors: HashMap<String, Fingerprint>,
+}
+
+impl RevisionDigest {
+    pub fn of(building: &Building) -> Result<Self> {
+        let floors = building
+            .floors
+            .iter()
+            .map(|floor| Ok((floor.id.clone(), fingerprint(&FloorSubtree::of(floor))?)))
+            .collect::<Result<_>>()?;
+        Ok(Self {
+            header: header_fingerprint(&BuildingHeader::of(building))?,
+            floors,
+        })
+    }
+}
+
+/// Stable content hash. Going through `Value` sorts object keys, so maps
+/// without a fixed iteration order still hash the same.
+fn fingerprint<T: Serialize>(value: &T) -> Result<Fingerprint> {
+    let value = serde_json::to_value(value)?;
+    Ok(Sha256::digest(serde_json::to_vec(&value)?).into())
+}
+
+/// [`fingerprint`] of the header without [`VOLATILE_HEADER_FIELDS`].
+fn header_fingerprint(header: &BuildingHeader<'_>) -> Result<Fingerprint> {
+    let mut value = serde_json::to_value(header)?;
+    if let serde_json::Value::Object(fields) = &mut value {
+        for field in VOLATILE_HEADER_FIELDS {
+            fields.remove(field);
+        }
+    }
+    Ok(Sha256::digest(serde_json::to_vec(&value)?).into())
+}
+
+/// Fingerprints of committed revisions, keyed by commit id. Commits are
+/// immutable, so entries never go stale; the map is simply reset when full.
+#[derive(Debug, Default)]
+pub struct RevisionCache {
+    digests: Mutex<HashMap<String, Arc<RevisionDigest>>>,
+}
+
+impl RevisionCache {
+    /// Resolve `rev` to a commit and fingerprint `building.yaml` at it.
+    pub fn digest_at(&self, repo_root: &Path, rev: &str) -> Result<(String, Arc<RevisionDigest>)> {
+        let commit = git::resolve_commit(repo_root, rev)?;
+        if let Some(digest) = self.lock().get(&commit) {
+            return Ok((commit, digest.clone()));
+        }
+
+        let yaml = git::file_at_commit(repo_root, &commit, BUILDING_YAML)?;
+        let yaml = String::from_utf8(yaml)
+            .map_err(|_| anyhow!("{} at {} is not valid UTF-8", BUILDING_YAML, commit))?;
+        let building = BuildingYamlSerializer::deserialize_document(&yaml)
+            .map_err(|e| anyhow!("Failed to parse {} at {}: {}", BUILDING_YAML, commit, e))?
+            .into_building();
+        let digest = Arc::new(RevisionDigest::of(&building)?);
+
+        let mut digests = self.lock();
+        if digests.len() >= MAX_CACHED_REVISIONS {
+            digests.clear();
+        }
+        digests.insert(commit.clone(), digest.clone());
+        Ok((commit, digest))
+    }
+
+    fn lock(&self) -> std::sync::MutexGuard<'_, HashMap<String, Arc<RevisionDigest>>> {
+        self.digests
+            .lock()
+            .unwrap_or_else(|poisoned| poisoned.into_inner())
+    }
+}
+
+/// JSON result for `building.delta`.
+#[derive(Debug, Serialize)]
+pub struct BuildingDelta<'a> {
+    /// Commit the delta applies to.
+    pub since: &'a str,
+    /// `HEAD`, when the working `building.yaml` matches it: the next `since`.
+    pub revision: Option<&'a str>,
+    /// Building-level fields, present only when any of them changed.
+    pub header: Option<BuildingHeader<'a>>,
+    /// Floors added or changed since `since`, in building order.
+    pub floors: Vec<FloorSubtree<'a>>,
+    /// Ids of floors present at `since` that no longer exist.
+    pub removed_floors: Vec<&'a str>,
+    pub unchanged_floors: usize,
+}
+
+/// Diff the current snapshot against the fingerprints of commit `since`.
+pub fn building_delta<'a>(
+    current: &'a BuildingGetResult,
+    current_digest: &RevisionDigest,
+    since: &'a str,
+    base: &'a RevisionDigest,
+) -> BuildingDelta<'a> {
+    let building = &current.building;
+    let mut floors = Vec::new();
+    let mut unchanged_floors = 0;
+    for floor in &building.floors {
+        let now = current_digest.floors.get(&floor.id);
+        if now.is_some() && now == base.floors.get(&floor.id) {
+            unchanged_floors += 1;
+        } else {
+            floors.push(FloorSubtree::of(floor));
+        }
+    }
+    let mut removed_floors: Vec<&str> = base
+        .floors
+        .keys()
+        .filter(|id| !current_digest.floors.contains_key(*id))
+        .map(String::as_str)
+        .collect();
+    removed_floors.sort_unstable();
+
+    BuildingDelta {
+        since,
+        revision: current.revision.as_deref(),
+        header: (current_digest.header != base.header).then(|| BuildingHeader::of(building)),
+        floors,
+        removed_floors,
+        unchanged_floors,
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use crate::agent::building::get_building;
+    use crate::core::{Room, RoomType, Wing};
+    use crate::persistence::save_building_at;
+    use tempfile::tempdir;
+
+    fn two_floor_building() -> Building {
+        let mut building = Building::new("Delta HQ".into(), "/delta-hq".into());
+        for level in 0..2 {
+            let mut floor = Floor::new(format!("L{}", level), level);
+            let mut wing = Wing::new("A".into());
+            wing.add_room(Room::new(format!("Room {}", level), RoomType::Office));
+            floor.add_wing(wing);
+            building.add_floor(floor);
+        }
+        building
+    }
+
+    #[test]
+    fn subtree_finds_floors_and_rooms_by_id() {
+        let dir = tempdir().unwrap();
+        let building = two_floor_building();
+        let floor_id = building.floors[1].id.clone();
+        let room_id = building.floors[1].wings[0].rooms[0].id.clone();
+        save_building_at(dir.path(), &building).unwrap();
+        let current = get_building(dir.path()).unwrap();
+
+        let floor = find_subtree(&current, &floor_id).unwrap();
+        assert!(matches!(floor.node, SubtreeNode::Floor(ref f) if f.floor.level == 1));
+        let room = find_subtree(&current, &room_id).unwrap();
+        assert!(matches!(room.node, SubtreeNode::Room(ref r) if r.floor_id == floor_id));
+        assert!(find_subtree(&current, "/nowhere").is_none());
+    }
+
+    #[test]
+    fn delta_lists_only_changed_floors() {
+        let dir = tempdir().unwrap();
+        let mut building = two_floor_building();
+        save_building_at(dir.path(), &building).unwrap();
+        let base = RevisionDigest::of(&get_building(dir.path()).unwrap().building).unwrap();
+
+        building.floors[1].name = "Mezzanine".into();
+        let removed = building.floors.remove(0).id;
+        building.add_floor(Floor::new("Roof".into(), 2));
+        save_building_at(dir.path(), &building).unwrap();
+
+        let current = get_building(dir.path()).unwrap();
+        let digest = RevisionDigest::of(&current.building).unwrap();
+        let delta = building_delta(&current, &digest, "base", &base);
+        let names: Vec<&str> = delta.floors.iter().map(|f| f.floor.name.as_str()).collect();
+        assert_eq!(names, ["Mezzanine", "Roof"]);
+        assert_eq!(delta.removed_floors, [removed.as_str()]);
+        assert_eq!(delta.unchanged_floors, 0);
+        // `add_floor` bumped `updated_at`, which alone does not resend the header
+        assert!(delta.header.is_none());
+
+        building.name = "Delta Tower".into();
+        save_building_at(dir.path(), &building).unwrap();
+        let renamed = get_building(dir.path()).unwrap();
+        let renamed_digest = RevisionDigest::of(&renamed.building).unwrap();
+        let delta = building_delta(&renamed, &renamed_digest, "base", &digest);
+        assert_eq!(delta.header.map(|h| h.name), Some("Delta Tower"));
+
+        let same = building_delta(&current, &digest, "base", &digest);
+        assert!(same.floors.is_empty() && same.removed_floors.is_empty());
+        assert_eq!(same.unchanged_floors, 2);
+    }
+}
@@ -0,0 +1,229 @@
+//! Batched replay of PWA offline mutations (`sync.apply_batch`).
+//!
+//! The PWA's `SyncQueue` sends everything it captured while disconnected in
+//! one call. The batch is coalesced per entity, applied to a single
+//! in-memory load of `building.yaml`, validated and saved once, and recorded
+//! as one commit, instead of one load/validate/save/commit per edit.
+
+use std::path::Path;
+
+use anyhow::{anyhow, Result};
+use serde::Serialize;
+
+use crate::agent::git;
+use crate::core::mutation::{apply_mutation, coalesce, MutationOutcome};
+use crate::core::Mutation;
+use crate::persistence::{load_building_at, save_building_at, BUILDING_YAML};
+
+/// Batches larger than this report progress every this many mutations.
+pub const PROGRESS_INTERVAL: usize = 256;
+
+#[derive(Debug, Clone, Copy, PartialEq, Eq, Serialize)]
+#[serde(rename_all = "snake_case")]
+pub enum BatchStage {
+    Applying,
+    Saving,
+    Committing,
+}
+
+/// Progress of a large batch, streamed as `sync.progress` notifications.
+#[derive(Debug, Clone, Serialize)]
+pub struct BatchProgress {
+    pub stage: BatchStage,
+    /// Coalesced mutations applied so far.
+    pub done: usize,
+    pub total: usize,
+}
+
+#[derive(Debug, Clone, Serialize)]
+pub struct RejectedMutation {
+    pub target: String,
+    pub reason: String,
+}
+
+/// JSON result for `sync.apply_batch`.
+#[derive(Debug, Clone, Serialize)]
+pub struct BatchResult {
+    /// Mutations as sent.
+    pub received: usize,
+    /// Mutations left after coalescing per entity.
+    pub coalesced: usize,
+    pub applied: usize,
+    /// Older than what the building already holds (last write wins).
+    pub superseded: usize,
+    /// Mutations whose target does not exist; the rest of the batch still applies.
+    pub rejected: Vec<RejectedMutation>,
+    /// `None` when nothing changed and no commit was made.
+    pub commit_id: Option<String>,
+}
+
+/// Apply `mutations` to `{repo_root}/building.yaml` as one save and one commit.
+///
+/// A batch that fails validation is rejected as a whole and nothing is
+/// written. `progress` is only called for batches over [`PROGRESS_INTERVAL`].
+pub fn apply_batch(
+    repo_root: &Path,
+    mutations: Vec<Mutation>,
+    did_key: &str,
+    mut progress: impl FnMut(BatchProgress),
+) -> Result<BatchResult> {
+    let received = mutations.len();
+    let batch = coalesce(mutations);
+    let total = batch.len();
+    let report = total > PROGRESS_INTERVAL;
+
+    let mut building = load_building_at(repo_root)
+        .map_err(|e| anyhow!("Failed to load {}: {}", BUILDING_YAML, e))?;
+
+    let mut result = BatchResult {
+        received,
+        coalesced: total,
+        applied: 0,
+        superseded: 0,
+        rejected: Vec::new(),
+        commit_id: None,
+    };
+    for (done, mutation) in batch.iter().enumerate() {
+        match apply_mutation(&mut building, mutation) {
+            Ok(MutationOutcome::Applied) => result.applied += 1,
+            Ok(MutationOutcome::Superseded) => result.superseded += 1,
+            Err(reason) => result.rejected.push(RejectedMutation {
+                target: mutation.target().to_string(),
+                reason,
+            }),
+        }
+        if report && (done + 1) % PROGRESS_INTERVAL == 0 {
+            progress(BatchProgress {
+                stage: BatchStage::Applying,
+                done: done + 1,
+                total,
+            });
+        }
+    }
+    if result.applied == 0 {
+        return Ok(result);
+    }
+
+    let mut report_stage = |stage| {
+        if report {
+            progress(BatchProgress {
+                stage,
+                done: total,
+                total,
+            });
+        }
+    };
+    report_stage(BatchStage::Saving);
+    save_building_at(repo_root, &building)
+        .map_err(|e| anyhow!("Batch rejected, {} not written: {}", BUILDING_YAML, e))?;
+
+    report_stage(BatchStage::Committing);
+    let message = format!("Sync {} field change(s) from PWA", result.applied);
+    let commit = git::commit_paths(repo_root, &message, &[BUILDING_YAML], did_key)?;
+    result.commit_id = Some(commit.commit_id);
+    Ok(result)
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use crate::core::domain::ArxAddress;
+    use crate::core::{Anchor, Building, Position};
+    use std::collections::HashMap;
+    use tempfile::TempDir;
+
+    #[test]
+    fn batch_is_one_save_and_one_commit() {
+        let _guard = git::EnvGuard::new();
+        let tmp = TempDir::new().unwrap();
+        let repo = git2::Repository::init(tmp.path()).unwrap();
+        let root = tmp.path().canonicalize().unwrap();
+        save_building_at(&root, &Building::new("Pilot".into(), "/pilot".into())).unwrap();
+
+        let position = Position {
+            x: 1.0,
+            y: 2.0,
+            z: 0.0,
+            coordinate_system: "building_local".to_string(),
+        };
+        let address = ArxAddress::from_path("/usa/ny/nyc/pilot/lobby-anchor").unwrap();
+        let mut anchor = Anchor::new("Lobby".into(), position.clone(), 0.5);
+        anchor.id = "lobby".into();
+        let mut mutations = vec![Mutation::CreateAnchor {
+            address: address.clone(),
+            anchor,
+        }];
+        for i in 0..=PROGRESS_INTERVAL as u64 {
+            mutations.push(Mutation::UpdateProperties {
+                entity_address: address.clone(),
+                properties: HashMap::from([(format!("k{}", i % 3), i.to_string())]),
+                timestamp: i,
+            });
+        }
+        mutations.push(Mutation::RecalibrateAnchor {
+            anchor_id: "missing".into(),
+            new_position: position,
+            confidence: 0.9,
+            timestamp: 1,
+        });
+
+        let mut reports = 0;
+        let result = apply_batch(&root, mutations, "did:key:ztest", |_| reports += 1).unwrap();
+        assert_eq!(result.received, PROGRESS_INTERVAL + 3);
+        assert_eq!(result.coalesced, 3);
+        assert_eq!(result.applied, 2);
+        assert_eq!(result.rejected.len(), 1);
+        assert_eq!(reports, 0, "coalesced batch is small");
+
+        let head = repo.head().unwrap().peel_to_commit().unwrap();
+        assert_eq!(Some(head.id().to_string()), result.commit_id);
+        assert_eq!(head.parent_count(), 0);
+        let building = load_building_at(&root).unwrap();
+        let anchor = &building.anchors[0];
+        assert_eq!(anchor.properties.get("k0").map(String::as_str), Some("255"));
+        assert_eq!(anchor.properties.get("k1").map(String::as_str), Some("256"));
+    }
+
+    #[test]
+    fn large_batch_reports_progress() {
+        let _guard = git::EnvGuard::new();
+        let tmp = TempDir::new().unwrap();
+        git2::Repository::init(tmp.path()).unwrap();
+        let root = tmp.path().canonicalize().unwrap();
+        save_building_at(&root, &Building::new("Pilot".into(), "/pilot".into())).unwrap();
+
+        let total = PROGRESS_INTERVAL + 1;
+        let mutations = (0..total)
+            .map(|i| {
+                let position = Position {
+                    x: i as f64,
+                    y: 0.0,
+                    z: 0.0,
+                    coordinate_system: "building_local".to_string(),
+                };
+                let mut anchor = Anchor::new(format!("Pin {}", i), position, 0.5);
+                anchor.id = format!("pin-{}", i);
+                Mutation::CreateAnchor {
+                    address: ArxAddress::from_path(&format!("/usa/ny/nyc/pilot/pin-{}", i))
+                        .unwrap(),
+                    anchor,
+                }
+            })
+            .collect();
+
+        let mut reports = Vec::new();
+        let result = apply_batch(&root, mutations, "did:key:ztest", |report| {
+            reports.push((report.stage, report.done, report.total))
+        })
+        .unwrap();
+        assert_eq!(result.applied, total);
+        assert_eq!(
+            reports,
+            vec![
+                (BatchStage::Applying, PROGRESS_INTERVAL, total),
+                (BatchStage::Saving, total, total),
+                (BatchStage::Committing, total, total),
+            ]
+        );
+    }
+}
@@ -1,91 +1,249 @@
+//! Event-driven, debounced file watcher for the agent's background jobs.
+//!
+//! `notify` events are forwarded to a tokio channel. [`FileWatcher::next_batch`]
+//! waits for the first relevant change and keeps collecting until the
+//! debounce window passes without another one, so a burst of saves (editor
+//! temp files, a git checkout) becomes one [`ChangeBatch`] naming every path.
+
+use std::collections::BTreeSet;
+use std::ffi::OsStr;
 use std::path::{Path, PathBuf};
-use std::sync::mpsc::{channel, Receiver};
 use std::time::Duration;
 
 use anyhow::Result;
 use notify::{Config, Event, EventKind, RecommendedWatcher, RecursiveMode, Watcher};
+use tokio::sync::mpsc::{unbounded_channel, UnboundedReceiver};
+use tokio::time::Instant;
+
+/// Directories skipped in recursive mode, besides hidden ones (`.git`, `.arx`).
+const IGNORED_DIRS: [&str; 2] = ["target", "node_modules"];
 
-/// File watcher for YAML building data files
+/// How a [`FileWatcher`] watches and batches changes.
+#[derive(Debug, Clone)]
+pub struct WatchOptions {
+    /// Watch subdirectories as well as the root.
+    pub recursive: bool,
+    /// Quiet period after the last relevant event before a batch is released.
+    pub debounce: Duration,
+    /// Longest a steady stream of events can hold a batch back.
+    pub max_delay: Duration,
+}
+
+impl Default for WatchOptions {
+    fn default() -> Self {
+        Self {
+            recursive: true,
+            debounce: Duration::from_millis(250),
+            max_delay: Duration::from_secs(10),
+        }
+    }
+}
+
+/// Relevant changes coalesced over one debounce window.
+#[derive(Debug, Clone, Default, PartialEq, Eq)]
+pub struct ChangeBatch {
+    /// Every created or modified path with a watched extension.
+    pub paths: BTreeSet<PathBuf>,
+    /// Relevant filesystem events folded into this batch.
+    pub events: usize,
+}
+
+impl ChangeBatch {
+    pub fn is_empty(&self) -> bool {
+        self.paths.is_empty()
+    }
+
+    /// Whether any changed path has file name `name` (e.g. `building.yaml`).
+    pub fn contains_file_named(&self, name: &str) -> bool {
+        self.paths
+            .iter()
+            .any(|path| path.file_name() == Some(OsStr::new(name)))
+    }
+}
+
+/// File watcher for building data files (YAML, IFC) under a repository
 pub struct FileWatcher {
-    #[allow(dead_code)]
     watcher: RecommendedWatcher,
-    receiver: Receiver<Result<Event, notify::Error>>,
+    receiver: UnboundedReceiver<notify::Result<Event>>,
+    root: PathBuf,
     extensions: Vec<String>,
+    options: WatchOptions,
 }
 
 impl FileWatcher {
-    /// Create a new file watcher for the given repository root and extensions
+    /// Watch `repo_root` recursively for files with the given extensions
     pub fn new(repo_root: &Path, extensions: Vec<String>) -> Result<Self> {
-        let (tx, rx) = channel();
+        Self::with_options(repo_root, extensions, WatchOptions::default())
+    }
+
+    /// Watch `repo_root` for files with the given extensions
+    ///
+    /// In recursive mode hidden directories and build output are not
+    /// watched; top-level directories created later are picked up as their
+    /// creation events arrive.
+    pub fn with_options(
+        repo_root: &Path,
+        extensions: Vec<String>,
+        options: WatchOptions,
+    ) -> Result<Self> {
+        let (tx, rx) = unbounded_channel();
 
-        let mut watcher = RecommendedWatcher::new(
+        let watcher = RecommendedWatcher::new(
             move |res| {
                 let _ = tx.send(res);
             },
             Config::default().with_poll_interval(Duration::from_millis(500)),
         )?;
 
-        // Watch for relevant files in the repository root (non-recursive)
-        watcher.watch(repo_root, RecursiveMode::NonRecursive)?;
-
-        Ok(Self {
+        // Events carry paths under the watched path; canonical keeps them comparable
+        let root = repo_root
+            .canonicalize()
+            .unwrap_or_else(|_| repo_root.to_path_buf());
+        let mut this = Self {
             watcher,
             receiver: rx,
+            root,
             extensions,
-        })
+            options,
+        };
+
+        this.watcher
+            .watch(&this.root, RecursiveMode::NonRecursive)?;
+        if this.options.recursive {
+            for entry in std::fs::read_dir(&this.root)? {
+                let path = entry?.path();
+                if path.is_dir() {
+                    this.watch_subtree(&path)?;
+                }
+            }
+        }
+        Ok(this)
     }
 
-    /// Check for file changes (non-blocking)
-    /// Returns Some(path) if a relevant file was modified, None otherwise
-    pub fn check_for_changes(&self) -> Option<PathBuf> {
-        // Drain all pending events and check if any are relevant modifications
-        let mut file_changed = None;
+    /// Wait for the next batch of relevant changes
+    ///
+    /// Returns once `debounce` has passed without another relevant event,
+    /// or `max_delay` after the first one. `None` means the watcher stopped.
+    pub async fn next_batch(&mut self) -> Option<ChangeBatch> {
+        let mut batch = ChangeBatch::default();
+        while batch.is_empty() {
+            let event = self.receiver.recv().await?;
+            self.collect(event, &mut batch);
+        }
 
-        while let Ok(event_result) = self.receiver.try_recv() {
-            if let Ok(event) = event_result {
-                if self.is_relevant_modification(&event) {
-                    // Get the first modified path
-                    if let Some(path) = event.paths.first() {
-                        file_changed = Some(path.clone());
+        let deadline = Instant::now() + self.options.max_delay;
+        let mut quiet_until = Instant::now() + self.options.debounce;
+        loop {
+            match tokio::time::timeout_at(quiet_until.min(deadline), self.receiver.recv()).await {
+                Ok(Some(event)) => {
+                    if self.collect(event, &mut batch) {
+                        quiet_until = Instant::now() + self.options.debounce;
                     }
                 }
+                Ok(None) | Err(_) => return Some(batch),
             }
         }
+    }
 
-        file_changed
+    /// Drain pending events without waiting (non-blocking)
+    /// Returns the relevant changes seen so far, or None if there are none
+    pub fn check_for_changes(&mut self) -> Option<ChangeBatch> {
+        let mut batch = ChangeBatch::default();
+        while let Ok(event) = self.receiver.try_recv() {
+            self.collect(event, &mut batch);
+        }
+        (!batch.is_empty()).then_some(batch)
     }
 
-    /// Check if an event represents a relevant file modification
-    fn is_relevant_modification(&self, event: &Event) -> bool {
-        // Only care about modify/create events
-        let is_relevant_event = matches!(event.kind, EventKind::Modify(_) | EventKind::Create(_));
+    /// Fold one event into `batch`; true if it named a relevant path
+    fn collect(&mut self, event: notify::Result<Event>, batch: &mut ChangeBatch) -> bool {
+        let event = match event {
+            Ok(event) => event,
+            Err(e) => {
+                tracing::debug!(error = %e, "File watcher error");
+                return false;
+            }
+        };
 
-        if !is_relevant_event {
+        // Only care about modify/create events
+        if !matches!(event.kind, EventKind::Modify(_) | EventKind::Create(_)) {
             return false;
         }
+        if self.options.recursive && matches!(event.kind, EventKind::Create(_)) {
+            for dir in &event.paths {
+                if dir.parent() == Some(self.root.as_path()) && dir.is_dir() {
+                    if let Err(e) = self.watch_subtree(dir) {
+                        tracing::debug!(error = %e, path = %dir.display(), "Cannot watch directory");
+                    }
+                }
+            }
+        }
+
+        let mut relevant = false;
+        for path in event.paths {
+            if self.is_relevant_path(&path) {
+                batch.paths.insert(path);
+                relevant = true;
+            }
+        }
+        if relevant {
+            batch.events += 1;
+        }
+        relevant
+    }
 
-        // Check if any path matches one of the target extensions
-        event.paths.iter().any(|path| {
-            path.extension()
-                .and_then(|ext| ext.to_str())
-                .map(|ext| self.extensions.iter().any(|e| e.eq_ignore_ascii_case(ext)))
-                .unwrap_or(false)
-        })
+    fn watch_subtree(&mut self, dir: &Path) -> notify::Result<()> {
+        if dir.file_name().is_some_and(is_ignored_dir) {
+            return Ok(());
+        }
+        self.watcher.watch(dir, RecursiveMode::Recursive)
+    }
+
+    /// Check if a path has one of the target extensions outside ignored directories
+    fn is_relevant_path(&self, path: &Path) -> bool {
+        let watched_extension = path
+            .extension()
+            .and_then(|ext| ext.to_str())
+            .map(|ext| self.extensions.iter().any(|e| e.eq_ignore_ascii_case(ext)))
+            .unwrap_or(false);
+        if !watched_extension {
+            return false;
+        }
+        // Nested recursive watches still report e.g. `.git` below a subdirectory
+        let in_ignored_dir = path
+            .parent()
+            .and_then(|dir| dir.strip_prefix(&self.root).ok())
+            .is_some_and(|dir| dir.iter().any(is_ignored_dir));
+        !in_ignored_dir
     }
 }
 
+fn is_ignored_dir(name: &OsStr) -> bool {
+    let name = name.to_string_lossy();
+    name.starts_with('.') || IGNORED_DIRS.contains(&name.as_ref())
+}
+
 #[cfg(test)]
 mod tests {
     use super::*;
     use std::fs;
     use tempfile::TempDir;
 
+    fn yaml_watcher(repo_root: &Path, options: WatchOptions) -> FileWatcher {
+        FileWatcher::with_options(
+            repo_root,
+            vec!["yaml".to_string(), "yml".to_string()],
+            options,
+        )
+        .unwrap()
+    }
+
     #[test]
     fn detects_yaml_changes() {
         let temp = TempDir::new().unwrap();
         let repo_root = temp.path();
 
-        let watcher =
+        let mut watcher =
             FileWatcher::new(repo_root, vec!["yaml".to_string(), "yml".to_string()]).unwrap();
 
         // Create a YAML file
@@ -96,11 +254,10 @@ mod tests {
         std::thread::sleep(Duration::from_millis(600));
 
         // Check for changes
-        let changed = watcher.check_for_changes();
-        assert!(changed.is_some());
+        let changed = watcher.check_for_changes().expect("change detected");
         assert_eq!(
-            std::fs::canonicalize(changed.unwrap()).unwrap(),
-            std::fs::canonicalize(yaml_path).unwrap()
+            changed.paths.into_iter().collect::<Vec<_>>(),
+            vec![std::fs::canonicalize(yaml_path).unwrap()]
         );
     }
 
@@ -109,7 +266,7 @@ mod tests {
         let temp = TempDir::new().unwrap();
         let repo_root = temp.path();
 
-        let watcher =
+        let mut watcher =
             FileWatcher::new(repo_root, vec!["yaml".to_string(), "yml".to_string()]).unwrap();
 
         // Create a non-YAML file
@@ -122,4 +279,70 @@ mod tests {
         let changed = watcher.check_for_changes();
         assert!(changed.is_none());
     }
+
+    #[tokio::test]
+    async fn burst_of_saves_is_one_batch() {
+        let temp = TempDir::new().unwrap();
+        let root = temp.path().canonicalize().unwrap();
+        fs::create_dir_all(root.join("site/north")).unwrap();
+        fs::create_dir_all(root.join(".arx")).unwrap();
+
+        let mut watcher = yaml_watcher(
+            &root,
+            WatchOptions {
+                debounce: Duration::from_millis(300),
+                ..WatchOptions::default()
+            },
+        );
+
+        let nested = root.join("site/north/building.yaml");
+        for i in 0..5 {
+            fs::write(root.join("building.yaml"), format!("rev: {}", i)).unwrap();
+            fs::write(&nested, format!("rev: {}", i)).unwrap();
+            fs::write(root.join(".arx/state.yaml"), "hidden").unwrap();
+            tokio::time::sleep(Duration::from_millis(20)).await;
+        }
+
+        let batch = tokio::time::timeout(Duration::from_secs(5), watcher.next_batch())
+            .await
+            .expect("batch released")
+            .expect("watcher running");
+        assert_eq!(
+            batch.paths.into_iter().collect::<Vec<_>>(),
+            vec![root.join("building.yaml"), nested]
+        );
+        assert!(batch.events >= 2);
+
+        // The whole burst was consumed by that one batch
+        tokio::time::sleep(Duration::from_millis(400)).await;
+        assert!(watcher.check_for_changes().is_none());
+    }
+
+    #[tokio::test]
+    async fn non_recursive_ignores_subdirectories() {
+        let temp = TempDir::new().unwrap();
+        let root = temp.path().canonicalize().unwrap();
+        fs::create_dir_all(root.join("exports")).unwrap();
+
+        let mut watcher = yaml_watcher(
+            &root,
+            WatchOptions {
+                recursive: false,
+                ..WatchOptions::default()
+            },
+        );
+        fs::write(root.join("exports/building.yaml"), "nested").unwrap();
+        tokio::time::sleep(Duration::from_millis(400)).await;
+        assert!(watcher.check_for_changes().is_none());
+    }
+
+    #[test]
+    fn batch_matches_file_names() {
+        let batch = ChangeBatch {
+            paths: [PathBuf::from("/repo/.github/ci.yaml")].into(),
+            events: 1,
+        };
+        assert!(!batch.contains_file_named("building.yaml"));
+        assert!(batch.contains_file_named("ci.yaml"));
+    }
 }
@@ -62,6 +62,10 @@ pub struct SearchArgs {
 ///
 /// # Find all HVAC equipment in any city
 /// arx query "/usa/ny/*/ps-118/floor-*/hvac/*"
+///
+/// # Boilers exactly one segment below any Brooklyn building, or at any depth
+/// arx query --segments "/usa/ny/brooklyn/*/*/mech/boiler-*"
+/// arx query --segments "/usa/ny/**/boiler-*"
 /// ```
 #[derive(Debug, Clone, Args)]
 pub struct QueryArgs {
@@ -75,6 +79,10 @@ pub struct QueryArgs {
     /// Show detailed results
     #[arg(long)]
     pub verbose: bool,
+
+    /// Match segment by segment: `*` stops at `/`, `**` spans segments
+    #[arg(long)]
+    pub segments: bool,
 }
 
 /// Validate search limit is between 1 and 10000
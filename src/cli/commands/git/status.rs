@@ -20,6 +20,8 @@ impl Command for StatusCommand {
                     repo_root,
                     token: std::sync::Arc::new(std::sync::Mutex::new(token_state)),
                     metrics: std::sync::Arc::new(crate::agent::observability::AgentMetrics::new()),
+                    building: Default::default(),
+                    exports: Default::default(),
                     reload_handle: None,
                 });
 
@@ -2,6 +2,7 @@
 
 use super::Command;
 use crate::cli::args::{QueryArgs, SearchArgs};
+use crate::core::domain::AddressPattern;
 use crate::core::Equipment;
 use crate::persistence::load_building_data_from_dir;
 use std::error::Error;
@@ -32,7 +33,12 @@ pub struct QueryCommand {
 impl Command for QueryCommand {
     fn execute(&self) -> Result<(), Box<dyn Error>> {
         self.validate()?;
-        run_address_query(&self.args.pattern, &self.args.format, self.args.verbose)
+        run_address_query(
+            &self.args.pattern,
+            &self.args.format,
+            self.args.verbose,
+            self.args.segments,
+        )
     }
 
     fn name(&self) -> &'static str {
@@ -56,22 +62,34 @@ impl Command for QueryCommand {
 
 /// Load Building and return equipment whose durable `address` matches `pattern`.
 pub fn query_equipment_by_address(pattern: &str) -> Result<Vec<Equipment>, Box<dyn Error>> {
-    let building = load_building_data_from_dir()?;
-    let mut matches = Vec::new();
-
-    for item in building.get_all_equipment() {
-        if let Some(addr) = &item.address {
-            if addr.matches_glob(pattern) {
-                matches.push(item.clone());
-            }
-        }
-    }
+    let pattern =
+        AddressPattern::new(pattern).map_err(|_| format!("Invalid glob pattern: {}", pattern))?;
+    query_equipment_matching(&pattern)
+}
 
-    Ok(matches)
+/// Load Building and return equipment whose durable `address` matches a compiled pattern.
+pub fn query_equipment_matching(
+    pattern: &AddressPattern,
+) -> Result<Vec<Equipment>, Box<dyn Error>> {
+    let building = load_building_data_from_dir()?;
+    Ok(building
+        .find_equipment_by_address(pattern)
+        .into_iter()
+        .cloned()
+        .collect())
 }
 
 /// Run address query and print results.
-pub fn run_address_query(pattern: &str, format: &str, verbose: bool) -> Result<(), Box<dyn Error>> {
+///
+/// With `segments`, wildcards match segment by segment (see
+/// [`AddressPattern::segmented`]), which lets the address trie prune below
+/// every literal segment.
+pub fn run_address_query(
+    pattern: &str,
+    format: &str,
+    verbose: bool,
+    segments: bool,
+) -> Result<(), Box<dyn Error>> {
     println!("🔍 Query pattern: {}", pattern);
     println!();
 
@@ -81,12 +99,13 @@ pub fn run_address_query(pattern: &str, format: &str, verbose: bool) -> Result<(
         return Err("Invalid ArxAddress pattern. Must contain at least one segment".into());
     }
 
-    // Validate glob syntax
-    if glob::Pattern::new(pattern).is_err() {
-        return Err(format!("Invalid glob pattern: {}", pattern).into());
+    let compiled = if segments {
+        AddressPattern::segmented(pattern)
+    } else {
+        AddressPattern::new(pattern)
     }
-
-    let matches = query_equipment_by_address(pattern)?;
+    .map_err(|_| format!("Invalid glob pattern: {}", pattern))?;
+    let matches = query_equipment_matching(&compiled)?;
 
     if matches.is_empty() {
         println!("❌ No equipment found matching pattern");
@@ -292,7 +292,8 @@ impl Cli {
                 pattern,
                 format,
                 verbose,
-            } => commands::query::run_address_query(&pattern, &format, verbose),
+                segments,
+            } => commands::query::run_address_query(&pattern, &format, verbose, segments),
             Commands::Migrate { dry_run } => {
                 let cmd = MigrateCommand {
                     dry_run,
@@ -375,6 +376,8 @@ impl Cli {
                             vec![],
                         ))),
                         metrics: std::sync::Arc::new(crate::agent::observability::AgentMetrics::new()),
+                        building: Default::default(),
+                        exports: Default::default(),
                         reload_handle: None,
                     });
 
@@ -118,6 +118,9 @@ Use --path to select a project root without changing cwd.")]
         /// Show detailed results
         #[arg(long)]
         verbose: bool,
+        /// Match segment by segment: `*` stops at `/`, `**` spans segments
+        #[arg(long)]
+        segments: bool,
     },
     /// Backfill missing ArxAddress fields on equipment
     Migrate {
@@ -1,7 +1,9 @@
 //! Building data structure and implementation
 
 use super::{BoundingBox, Floor, Room, Anchor};
-use super::domain::ArxAddress;
+use super::domain::{AddressPattern, ArxAddress};
+use super::edits::EditLog;
+use super::spatial_index::{BuildingSpatialIndex, SpatialIndexCache};
 use chrono::{DateTime, Utc};
 use serde::{Deserialize, Serialize};
 use std::collections::HashMap;
@@ -55,6 +57,11 @@ pub struct Building {
     /// Last modification timestamp
     pub updated_at: DateTime<Utc>,
     /// Collection of floors in the building
+    ///
+    /// The spatial index notices edits made through this field, including
+    /// in-place position changes. Incremental saves do not: call
+    /// [`Self::mark_floor_dirty`] afterwards, or edit through the `_mut`
+    /// accessors, which record the edit themselves.
     pub floors: Vec<Floor>,
     // Equipment lives in floors -> wings -> rooms hierarchy
     /// Building metadata (YAML-only field)
@@ -74,6 +81,10 @@ pub struct Building {
     pub pending_anchor_ids: Vec<String>,
     /// Configurable staging grace window in days for in-flight claims (optional, defaults to 14 days)
     pub claim_grace_period_days: Option<u32>,
+    /// Lazily built R-tree index backing the spatial queries (never serialized)
+    pub(crate) spatial_index: SpatialIndexCache,
+    /// Floors edited since the last incremental save (never serialized)
+    pub(crate) edits: EditLog,
 }
 
 /// DTO for Building serialization to preserve YAML and Git layout
@@ -155,6 +166,8 @@ impl<'de> serde::Deserialize<'de> for Building {
             anchors: Vec::new(),
             pending_anchor_ids: dto.anchors,
             claim_grace_period_days: dto.claim_grace_period_days,
+            spatial_index: SpatialIndexCache::default(),
+            edits: EditLog::default(),
         })
     }
 }
@@ -206,6 +219,8 @@ impl Building {
             anchors: Vec::new(),
             pending_anchor_ids: Vec::new(),
             claim_grace_period_days: None,
+            spatial_index: SpatialIndexCache::default(),
+            edits: EditLog::default(),
         }
     }
 
@@ -237,8 +252,10 @@ impl Building {
             "Floor with level {} already exists in building",
             floor.level
         );
+        self.edits.mark_floor(&floor.id);
         self.floors.push(floor);
         self.updated_at = Utc::now();
+        self.spatial_index.clear();
     }
 
     /// Add a floor to the building with validation
@@ -270,8 +287,10 @@ impl Building {
         if self.floors.iter().any(|f| f.level == floor.level) {
             return Err(format!("Floor with level {} already exists", floor.level));
         }
+        self.edits.mark_floor(&floor.id);
         self.floors.push(floor);
         self.updated_at = Utc::now();
+        self.spatial_index.clear();
         Ok(())
     }
 
@@ -326,7 +345,10 @@ impl Building {
     /// assert_eq!(building.find_floor(0).unwrap().name, "Updated Ground Floor");
     /// ```
     pub fn find_floor_mut(&mut self, level: i32) -> Option<&mut Floor> {
-        self.floors.iter_mut().find(|f| f.level == level)
+        self.spatial_index.clear();
+        let floor = self.floors.iter_mut().find(|f| f.level == level)?;
+        self.edits.mark_floor(&floor.id);
+        Some(floor)
     }
 
     /// Get all rooms in the building across all floors and wings
@@ -398,6 +420,8 @@ impl Building {
 
     /// Get all rooms in the building (mutable references)
     pub fn get_all_rooms_mut(&mut self) -> Vec<&mut Room> {
+        self.spatial_index.clear();
+        self.edits.mark_all();
         self.floors
             .iter_mut()
             .flat_map(|floor| floor.wings.iter_mut())
@@ -407,9 +431,19 @@ impl Building {
 
     /// Find a room by its unique ID (mutable reference)
     pub fn find_room_mut(&mut self, room_id: &str) -> Option<&mut Room> {
-        self.get_all_rooms_mut()
-            .into_iter()
-            .find(|room| room.id == room_id)
+        self.spatial_index.clear();
+        for floor in &mut self.floors {
+            let found = floor
+                .wings
+                .iter_mut()
+                .flat_map(|wing| wing.rooms.iter_mut())
+                .find(|room| room.id == room_id);
+            if let Some(room) = found {
+                self.edits.mark_floor(&floor.id);
+                return Some(room);
+            }
+        }
+        None
     }
 
     /// Get all rooms of a specific type
@@ -451,6 +485,8 @@ impl Building {
 
     /// Get all equipment in the building (mutable references, non-duplicated)
     pub fn get_all_equipment_mut(&mut self) -> Vec<&mut super::Equipment> {
+        self.spatial_index.clear();
+        self.edits.mark_all();
         let mut equipment = Vec::new();
         for floor in &mut self.floors {
             for eq in &mut floor.equipment {
@@ -478,26 +514,76 @@ impl Building {
     }
 
     /// Find an equipment item by its unique ID or name (mutable reference)
+    ///
+    /// Only the owning floor (and this item) is marked as edited.
     pub fn find_equipment_mut(&mut self, id: &str) -> Option<&mut super::Equipment> {
-        self.get_all_equipment_mut()
-            .into_iter()
-            .find(|eq| eq.id.eq_ignore_ascii_case(id) || eq.name.eq_ignore_ascii_case(id))
+        self.spatial_index.clear();
+        for floor in &mut self.floors {
+            // Same order as `get_all_equipment_mut`
+            let found = floor
+                .equipment
+                .iter_mut()
+                .chain(floor.wings.iter_mut().flat_map(|wing| {
+                    wing.equipment
+                        .iter_mut()
+                        .chain(wing.rooms.iter_mut().flat_map(|room| room.equipment.iter_mut()))
+                }))
+                .find(|eq| eq.id.eq_ignore_ascii_case(id) || eq.name.eq_ignore_ascii_case(id));
+            if let Some(eq) = found {
+                self.edits.mark_equipment(&floor.id, &eq.id);
+                return Some(eq);
+            }
+        }
+        None
+    }
+
+    /// Spatial index over rooms, equipment and anchors
+    ///
+    /// Built on first use and cached until the building is mutated through
+    /// one of its `&mut` accessors, or until a container list, position or
+    /// equipment address differs from what the index was built from (direct
+    /// edits through the `pub` fields included).
+    /// The returned handle is a cheap snapshot that can outlive the borrow.
+    pub fn spatial_index(&self) -> std::sync::Arc<BuildingSpatialIndex> {
+        self.spatial_index.get_or_build(self)
+    }
+
+    /// Drop the cached spatial index after editing `floors` or `anchors` directly
+    ///
+    /// Also forgets the incremental-save baseline, so the next
+    /// `save_building_incremental` reserializes everything.
+    pub fn invalidate_spatial_index(&mut self) {
+        self.spatial_index.clear();
+        self.edits.mark_all();
+    }
+
+    /// Record a direct edit below one floor (rooms, wings, equipment, anchors)
+    ///
+    /// Cheaper than [`Self::invalidate_spatial_index`] for incremental saves:
+    /// only this floor is revalidated and reserialized.
+    pub fn mark_floor_dirty(&mut self, floor_id: &str) {
+        self.spatial_index.clear();
+        self.edits.mark_floor(floor_id);
     }
 
     /// Find equipment within a given radius of a 3D point
+    ///
+    /// Results are in [`get_all_equipment`](Self::get_all_equipment) order.
     pub fn find_equipment_within_radius(
         &self,
         center: super::spatial::Point3D,
         radius: f64,
     ) -> Vec<&super::Equipment> {
-        self.get_all_equipment()
-            .into_iter()
-            .filter(|eq| {
-                let eq_point =
-                    super::spatial::Point3D::new(eq.position.x, eq.position.y, eq.position.z);
-                center.distance_to(&eq_point) <= radius
-            })
-            .collect()
+        let within = |eq: &&super::Equipment| {
+            let eq_point =
+                super::spatial::Point3D::new(eq.position.x, eq.position.y, eq.position.z);
+            center.distance_to(&eq_point) <= radius
+        };
+        let slots = self.spatial_index().equipment_within(center, radius);
+        let found: Option<Vec<_>> = slots.iter().map(|slot| slot.equipment(self)).collect();
+        // Unresolvable slots mean an untracked edit: answer from the tree itself
+        let candidates = found.unwrap_or_else(|| self.get_all_equipment());
+        candidates.into_iter().filter(within).collect()
     }
 
     /// Find the nearest equipment item to a 3D point
@@ -505,6 +591,19 @@ impl Building {
         &self,
         center: super::spatial::Point3D,
     ) -> Option<(&super::Equipment, f64)> {
+        let indexed = self
+            .spatial_index()
+            .nearest_equipment(center)
+            .and_then(|(slot, distance)| Some((slot.equipment(self)?, distance)));
+        if let Some((eq, distance)) = indexed {
+            let eq_point =
+                super::spatial::Point3D::new(eq.position.x, eq.position.y, eq.position.z);
+            let live = center.distance_to(&eq_point);
+            // A mismatch means the item moved since indexing; rescan
+            if (live - distance).abs() <= 1e-9 * distance.max(1.0) {
+                return Some((eq, live));
+            }
+        }
         self.get_all_equipment()
             .into_iter()
             .map(|eq| {
@@ -520,6 +619,70 @@ impl Building {
             })
     }
 
+    /// Find rooms whose bounding box contains a 3D point
+    pub fn find_rooms_containing(&self, point: super::spatial::Point3D) -> Vec<&Room> {
+        self.spatial_index()
+            .rooms_containing(point)
+            .iter()
+            .filter_map(|slot| slot.room(self))
+            .filter(|room| {
+                let bbox = &room.spatial_properties.bounding_box;
+                (bbox.min.x..=bbox.max.x).contains(&point.x)
+                    && (bbox.min.y..=bbox.max.y).contains(&point.y)
+                    && (bbox.min.z..=bbox.max.z).contains(&point.z)
+            })
+            .collect()
+    }
+
+    /// Find rooms whose bounding box intersects `bbox`
+    pub fn find_rooms_in_bbox(&self, bbox: &BoundingBox) -> Vec<&Room> {
+        let (min, max) = bbox_corners(bbox);
+        self.spatial_index()
+            .rooms_intersecting(min, max)
+            .iter()
+            .filter_map(|slot| slot.room(self))
+            .filter(|room| {
+                let other = &room.spatial_properties.bounding_box;
+                other.min.x <= bbox.max.x
+                    && other.max.x >= bbox.min.x
+                    && other.min.y <= bbox.max.y
+                    && other.max.y >= bbox.min.y
+                    && other.min.z <= bbox.max.z
+                    && other.max.z >= bbox.min.z
+            })
+            .collect()
+    }
+
+    /// Find equipment positioned inside `bbox`
+    pub fn find_equipment_in_bbox(&self, bbox: &BoundingBox) -> Vec<&super::Equipment> {
+        let (min, max) = bbox_corners(bbox);
+        self.spatial_index()
+            .equipment_in_box(min, max)
+            .iter()
+            .filter_map(|slot| slot.equipment(self))
+            .filter(|eq| {
+                (bbox.min.x..=bbox.max.x).contains(&eq.position.x)
+                    && (bbox.min.y..=bbox.max.y).contains(&eq.position.y)
+                    && (bbox.min.z..=bbox.max.z).contains(&eq.position.z)
+            })
+            .collect()
+    }
+
+    /// Find equipment whose durable `address` matches `pattern`
+    ///
+    /// Answered from the address trie cached with the spatial index, so the
+    /// glob is compiled once by the caller and non-matching subtrees are
+    /// skipped. Results are in [`get_all_equipment`](Self::get_all_equipment) order.
+    pub fn find_equipment_by_address(&self, pattern: &AddressPattern) -> Vec<&super::Equipment> {
+        let matches =
+            |eq: &&super::Equipment| eq.address.as_ref().is_some_and(|a| pattern.matches(a));
+        let slots = self.spatial_index().equipment_matching(pattern);
+        let found: Option<Vec<_>> = slots.iter().map(|slot| slot.equipment(self)).collect();
+        // Unresolvable slots mean an untracked edit: answer from the tree itself
+        let candidates = found.unwrap_or_else(|| self.get_all_equipment());
+        candidates.into_iter().filter(matches).collect()
+    }
+
     /// Add a property to the building metadata
     pub fn add_metadata_property(&mut self, key: String, value: String) {
         if self.metadata.is_none() {
@@ -565,6 +728,8 @@ impl Building {
 
     /// Get all anchors in the building tree (mutable references).
     pub fn get_all_anchors_mut(&mut self) -> Vec<&mut super::Anchor> {
+        self.spatial_index.clear();
+        self.edits.mark_all();
         let mut anchors = Vec::new();
         for anchor in &mut self.anchors {
             anchors.push(anchor);
@@ -589,6 +754,7 @@ impl Building {
 
     /// Promote all addresses in the building hierarchy from one branch/prefix to another.
     pub fn promote_addresses(&mut self, from_branch: &str, to_branch: &str) {
+        self.edits.mark_all();
         if let Some(addr) = &mut self.address {
             *addr = addr.promote_to_branch(from_branch, to_branch);
         }
@@ -666,14 +832,14 @@ impl Building {
         center: super::spatial::Point3D,
         radius: f64,
     ) -> Vec<&super::Anchor> {
-        self.get_all_anchors()
-            .into_iter()
-            .filter(|a| {
-                let a_point =
-                    super::spatial::Point3D::new(a.position.x, a.position.y, a.position.z);
-                center.distance_to(&a_point) <= radius
-            })
-            .collect()
+        let within = |a: &&super::Anchor| {
+            let a_point = super::spatial::Point3D::new(a.position.x, a.position.y, a.position.z);
+            center.distance_to(&a_point) <= radius
+        };
+        let slots = self.spatial_index().anchors_within(center, radius);
+        let found: Option<Vec<_>> = slots.iter().map(|slot| slot.anchor(self)).collect();
+        let candidates = found.unwrap_or_else(|| self.get_all_anchors());
+        candidates.into_iter().filter(within).collect()
     }
 
     /// Find anchors whose confidence is below the specified threshold
@@ -685,6 +851,13 @@ impl Building {
     }
 }
 
+fn bbox_corners(bbox: &BoundingBox) -> (super::spatial::Point3D, super::spatial::Point3D) {
+    (
+        super::spatial::Point3D::new(bbox.min.x, bbox.min.y, bbox.min.z),
+        super::spatial::Point3D::new(bbox.max.x, bbox.max.y, bbox.max.z),
+    )
+}
+
 impl Default for Building {
     fn default() -> Self {
         let now = Utc::now();
@@ -705,6 +878,8 @@ impl Default for Building {
             anchors: Vec::new(),
             pending_anchor_ids: Vec::new(),
             claim_grace_period_days: None,
+            spatial_index: SpatialIndexCache::default(),
+            edits: EditLog::default(),
         }
     }
 }
@@ -5,6 +5,7 @@
 //!
 //! Supports both standardized engineering systems (14 reserved) and custom items.
 
+use super::AddressPattern;
 use crate::error::ArxError;
 use anyhow::Result;
 use serde::{Deserialize, Serialize};
@@ -342,17 +343,12 @@ impl ArxAddress {
     /// Whether this address matches a glob pattern against the full path.
     ///
     /// Patterns use standard glob wildcards (`*`, `?`) on the full path string,
-    /// e.g. `/usa/ny/*/floor-*/mech/boiler-*`.
+    /// e.g. `/usa/ny/*/floor-*/mech/boiler-*`, so `*` may span `/`. Compiles
+    /// the pattern on every call; compile an [`AddressPattern`] once (or
+    /// query an [`AddressTrie`](super::AddressTrie)) when matching many
+    /// addresses, and see [`AddressPattern::segmented`] for `*` that stops at `/`.
     pub fn matches_glob(&self, pattern: &str) -> bool {
-        let pat = if pattern.starts_with('/') {
-            pattern.to_string()
-        } else {
-            format!("/{}", pattern)
-        };
-        match glob::Pattern::new(&pat) {
-            Ok(p) => p.matches(&self.path),
-            Err(_) => false,
-        }
+        AddressPattern::new(pattern).is_ok_and(|p| p.matches(self))
     }
 
     /// Sanitize a path part for use in addresses
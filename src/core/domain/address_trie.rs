@@ -0,0 +1,576 @@
+//! Segment trie over [`ArxAddress`] paths and precompiled address globs
+//!
+//! [`AddressPattern`] compiles a glob such as `/usa/ny/*/floor-*/mech/boiler-*`
+//! once, in one of two modes:
+//!
+//! - [`AddressPattern::new`] keeps the semantics of [`ArxAddress::matches_glob`]:
+//!   the glob applies to the full path, so `*` and `?` may span `/`.
+//! - [`AddressPattern::segmented`] matches segment by segment, like `glob`'s
+//!   `require_literal_separator`: `*`, `?` and `[...]` stay within one
+//!   segment and only `**` crosses `/` (`/**/` also matches a single `/`).
+//!
+//! [`AddressTrie`] stores values under their address segments. A pattern
+//! query walks the trie carrying the set of pattern positions still alive
+//! after each segment and drops a subtree as soon as none survive: a literal
+//! prefix such as `/usa/ny/` never visits other states, and a fully literal
+//! pattern is a single root-to-leaf walk. A full-path `*` can absorb any
+//! number of segments, so past one every subtree stays alive; a segmented
+//! `*` ends at the next `/`, so each later literal segment prunes again.
+
+use super::ArxAddress;
+use std::collections::BTreeMap;
+
+#[derive(Debug, Clone)]
+enum Token {
+    Char(char),
+    /// `?`: any single character (but `/` when segmented).
+    AnyChar,
+    /// `*`: any run of characters; within one segment when segmented.
+    AnySeq,
+    /// Segmented `**` not followed by `/`: any run of characters, `/` included.
+    AnyPath,
+    /// Segmented `**/`: zero or more whole segments, each with its `/`.
+    /// Always followed by [`Token::SegmentBody`].
+    AnySegments,
+    /// Inside a segment consumed by the preceding [`Token::AnySegments`].
+    SegmentBody,
+    /// `[...]` / `[!...]`: inclusive character ranges.
+    Class {
+        negated: bool,
+        ranges: Vec<(char, char)>,
+    },
+}
+
+/// Address glob compiled once and reusable across any number of addresses.
+#[derive(Debug, Clone)]
+pub struct AddressPattern {
+    source: String,
+    tokens: Vec<Token>,
+    segmented: bool,
+}
+
+/// Pattern positions still able to match, sorted and deduplicated.
+type States = Vec<usize>;
+
+impl AddressPattern {
+    /// Compile `pattern` over the full path; a missing leading `/` is implied.
+    pub fn new(pattern: &str) -> Result<Self, glob::PatternError> {
+        Self::compile(pattern, false)
+    }
+
+    /// Compile `pattern` segment by segment: only `**` crosses `/`.
+    pub fn segmented(pattern: &str) -> Result<Self, glob::PatternError> {
+        Self::compile(pattern, true)
+    }
+
+    fn compile(pattern: &str, segmented: bool) -> Result<Self, glob::PatternError> {
+        let source = if pattern.starts_with('/') {
+            pattern.to_string()
+        } else {
+            format!("/{}", pattern)
+        };
+        // Same syntax errors as `glob`, which validated these patterns before
+        glob::Pattern::new(&source)?;
+        Ok(Self {
+            tokens: tokenize(&source, segmented),
+            source,
+            segmented,
+        })
+    }
+
+    /// Whether wildcards stop at `/` (see [`Self::segmented`]).
+    pub fn is_segmented(&self) -> bool {
+        self.segmented
+    }
+
+    /// The pattern with its leading `/`.
+    pub fn as_str(&self) -> &str {
+        &self.source
+    }
+
+    /// Whether `address` matches this pattern.
+    pub fn matches(&self, address: &ArxAddress) -> bool {
+        self.matches_path(&address.path)
+    }
+
+    /// Whether the address path `path` matches this pattern.
+    pub fn matches_path(&self, path: &str) -> bool {
+        let states = self.advance(&self.start(), path);
+        self.accepts(&states)
+    }
+
+    fn start(&self) -> States {
+        let mut states = vec![0];
+        self.close(&mut states);
+        states
+    }
+
+    /// States after consuming `text`; empty once no match is possible.
+    fn advance(&self, states: &[usize], text: &str) -> States {
+        let mut current = states.to_vec();
+        for c in text.chars() {
+            if current.is_empty() {
+                break;
+            }
+            let mut next = Vec::with_capacity(current.len() + 1);
+            let separator = self.segmented && c == '/';
+            for &i in &current {
+                match self.tokens.get(i) {
+                    Some(Token::AnySeq) if !separator => next.push(i),
+                    Some(Token::AnyPath) => next.push(i),
+                    Some(Token::AnySegments) if c != '/' => next.push(i + 1),
+                    Some(Token::SegmentBody) if c == '/' => next.push(i - 1),
+                    Some(Token::SegmentBody) => next.push(i),
+                    Some(Token::Char(expected)) if *expected == c => next.push(i + 1),
+                    Some(token @ (Token::AnyChar | Token::Class { .. }))
+                        if !separator && token_matches(token, c) =>
+                    {
+                        next.push(i + 1)
+                    }
+                    _ => {}
+                }
+            }
+            self.close(&mut next);
+            current = next;
+        }
+        current
+    }
+
+    /// Add the positions reachable by letting a wildcard match nothing.
+    fn close(&self, states: &mut States) {
+        let mut i = 0;
+        while i < states.len() {
+            let state = states[i];
+            match self.tokens.get(state) {
+                Some(Token::AnySeq | Token::AnyPath) => states.push(state + 1),
+                Some(Token::AnySegments) => states.push(state + 2),
+                _ => {}
+            }
+            i += 1;
+        }
+        states.sort_unstable();
+        states.dedup();
+    }
+
+    fn accepts(&self, states: &[usize]) -> bool {
+        states.last() == Some(&self.tokens.len())
+    }
+}
+
+fn tokenize(pattern: &str, segmented: bool) -> Vec<Token> {
+    let chars: Vec<char> = pattern.chars().collect();
+    let mut tokens = Vec::new();
+    let mut i = 0;
+    while i < chars.len() {
+        let token = match chars[i] {
+            '*' => {
+                let double = chars.get(i + 1) == Some(&'*');
+                while chars.get(i + 1) == Some(&'*') {
+                    i += 1;
+                }
+                if !segmented || !double {
+                    Token::AnySeq
+                } else if chars.get(i + 1) == Some(&'/') {
+                    i += 1;
+                    tokens.push(Token::AnySegments);
+                    Token::SegmentBody
+                } else {
+                    Token::AnyPath
+                }
+            }
+            '?' => Token::AnyChar,
+            '[' => {
+                // `glob` has accepted the pattern, so the class is closed
+                let negated = matches!(chars.get(i + 1), Some('!'));
+                let mut j = i + 1 + usize::from(negated);
+                let mut ranges = Vec::new();
+                // A leading `]` is a literal member
+                let mut first = true;
+                while j < chars.len() && (first || chars[j] != ']') {
+                    first = false;
+                    if chars.get(j + 1) == Some(&'-') && chars.get(j + 2).is_some_and(|&c| c != ']')
+                    {
+                        ranges.push((chars[j], chars[j + 2]));
+                        j += 3;
+                    } else {
+                        ranges.push((chars[j], chars[j]));
+                        j += 1;
+                    }
+                }
+                i = j;
+                Token::Class { negated, ranges }
+            }
+            c => Token::Char(c),
+        };
+        tokens.push(token);
+        i += 1;
+    }
+    tokens
+}
+
+fn token_matches(token: &Token, c: char) -> bool {
+    match token {
+        Token::Char(expected) => *expected == c,
+        Token::AnyChar | Token::AnySeq | Token::AnyPath => true,
+        Token::AnySegments | Token::SegmentBody => c != '/',
+        Token::Class { negated, ranges } => {
+            ranges.iter().any(|&(lo, hi)| (lo..=hi).contains(&c)) != *negated
+        }
+    }
+}
+
+fn path_segments(path: &str) -> impl Iterator<Item = &str> {
+    path.split('/').filter(|s| !s.is_empty())
+}
+
+fn normalize(path: &str) -> String {
+    format!("/{}", path_segments(path).collect::<Vec<_>>().join("/"))
+}
+
+/// Values keyed by address path, stored along the path's segments.
+///
+/// Results are returned in segment order (children sorted per level), with
+/// a parent before its descendants.
+#[derive(Debug, Clone)]
+pub struct AddressTrie<V> {
+    root: Node<V>,
+    len: usize,
+}
+
+#[derive(Debug, Clone)]
+struct Node<V> {
+    children: BTreeMap<String, Node<V>>,
+    /// Normalized full path and value, when an address ends here.
+    entry: Option<(String, V)>,
+}
+
+impl<V> Default for Node<V> {
+    fn default() -> Self {
+        Self {
+            children: BTreeMap::new(),
+            entry: None,
+        }
+    }
+}
+
+impl<V> Default for AddressTrie<V> {
+    fn default() -> Self {
+        Self::new()
+    }
+}
+
+impl<V> AddressTrie<V> {
+    pub fn new() -> Self {
+        Self {
+            root: Node::default(),
+            len: 0,
+        }
+    }
+
+    /// Number of addresses holding a value.
+    pub fn len(&self) -> usize {
+        self.len
+    }
+
+    pub fn is_empty(&self) -> bool {
+        self.len == 0
+    }
+
+    pub fn clear(&mut self) {
+        self.root = Node::default();
+        self.len = 0;
+    }
+
+    /// Store `value` at `path`, returning the value it replaces.
+    pub fn insert(&mut self, path: &str, value: V) -> Option<V> {
+        let node = descend_mut(&mut self.root, path);
+        let old = node.entry.replace((normalize(path), value));
+        if old.is_none() {
+            self.len += 1;
+        }
+        old.map(|(_, value)| value)
+    }
+
+    /// Value at `path`, inserting `default()` first if there is none.
+    pub fn get_or_insert_with(&mut self, path: &str, default: impl FnOnce() -> V) -> &mut V {
+        let node = descend_mut(&mut self.root, path);
+        if node.entry.is_none() {
+            self.len += 1;
+        }
+        &mut node
+            .entry
+            .get_or_insert_with(|| (normalize(path), default()))
+            .1
+    }
+
+    pub fn get(&self, path: &str) -> Option<&V> {
+        self.node(path)?.entry.as_ref().map(|(_, value)| value)
+    }
+
+    pub fn contains(&self, path: &str) -> bool {
+        self.get(path).is_some()
+    }
+
+    /// Remove the value at `path`, pruning nodes left without values.
+    pub fn remove(&mut self, path: &str) -> Option<V> {
+        let segments: Vec<&str> = path_segments(path).collect();
+        let removed = remove_from(&mut self.root, &segments);
+        if removed.is_some() {
+            self.len -= 1;
+        }
+        removed
+    }
+
+    /// Deepest stored address that is `path` itself or one of its ancestors.
+    pub fn longest_prefix(&self, path: &str) -> Option<(&str, &V)> {
+        let mut node = &self.root;
+        let mut best = entry_of(node);
+        for segment in path_segments(path) {
+            match node.children.get(segment) {
+                Some(child) => node = child,
+                None => break,
+            }
+            best = entry_of(node).or(best);
+        }
+        best
+    }
+
+    /// Every stored address at or below `prefix`.
+    pub fn descendants(&self, prefix: &str) -> Vec<(&str, &V)> {
+        let mut out = Vec::new();
+        if let Some(node) = self.node(prefix) {
+            collect_all(node, &mut out);
+        }
+        out
+    }
+
+    /// Every stored address matching `pattern`.
+    pub fn matching(&self, pattern: &AddressPattern) -> Vec<(&str, &V)> {
+        let mut out = Vec::new();
+        if let Some((path, value)) = entry_of(&self.root) {
+            if pattern.matches_path(path) {
+                out.push((path, value));
+            }
+        }
+        let start = pattern.start();
+        for (segment, child) in &self.root.children {
+            collect_matching(child, segment, &start, pattern, &mut out);
+        }
+        out
+    }
+
+    fn node(&self, path: &str) -> Option<&Node<V>> {
+        path_segments(path).try_fold(&self.root, |node, segment| node.children.get(segment))
+    }
+}
+
+fn entry_of<V>(node: &Node<V>) -> Option<(&str, &V)> {
+    node.entry
+        .as_ref()
+        .map(|(path, value)| (path.as_str(), value))
+}
+
+fn descend_mut<'a, V>(root: &'a mut Node<V>, path: &str) -> &'a mut Node<V> {
+    path_segments(path).fold(root, |node, segment| {
+        node.children.entry(segment.to_string()).or_default()
+    })
+}
+
+fn remove_from<V>(node: &mut Node<V>, segments: &[&str]) -> Option<V> {
+    let Some((segment, rest)) = segments.split_first() else {
+        return node.entry.take().map(|(_, value)| value);
+    };
+    let child = node.children.get_mut(*segment)?;
+    let removed = remove_from(child, rest);
+    if child.entry.is_none() && child.children.is_empty() {
+        node.children.remove(*segment);
+    }
+    removed
+}
+
+fn collect_all<'a, V>(node: &'a Node<V>, out: &mut Vec<(&'a str, &'a V)>) {
+    out.extend(entry_of(node));
+    for child in node.children.values() {
+        collect_all(child, out);
+    }
+}
+
+fn collect_matching<'a, V>(
+    node: &'a Node<V>,
+    segment: &str,
+    states: &[usize],
+    pattern: &AddressPattern,
+    out: &mut Vec<(&'a str, &'a V)>,
+) {
+    let mut states = pattern.advance(states, "/");
+    states = pattern.advance(&states, segment);
+    if states.is_empty() {
+        return;
+    }
+    if let Some((path, value)) = entry_of(node) {
+        if pattern.accepts(&states) {
+            out.push((path, value));
+        }
+    }
+    for (segment, child) in &node.children {
+        collect_matching(child, segment, &states, pattern, out);
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    fn trie(paths: &[&str]) -> AddressTrie<usize> {
+        let mut trie = AddressTrie::new();
+        for (i, path) in paths.iter().enumerate() {
+            trie.insert(path, i);
+        }
+        trie
+    }
+
+    fn keys<'a>(found: &[(&'a str, &usize)]) -> Vec<&'a str> {
+        found.iter().map(|(path, _)| *path).collect()
+    }
+
+    #[test]
+    fn pattern_matches_like_glob() {
+        let pattern = AddressPattern::new("/usa/ny/*/floor-*/mech/boiler-*").unwrap();
+        for (path, expected) in [
+            ("/usa/ny/brooklyn/ps-118/floor-02/mech/boiler-01", true),
+            ("/usa/ny/brooklyn/floor-02/mech/boiler-01", true),
+            ("/usa/ny/brooklyn/ps-118/floor-02/mech/pump-01", false),
+            ("/usa/ca/la/hq/floor-01/mech/boiler-01", false),
+        ] {
+            assert_eq!(pattern.matches_path(path), expected, "{}", path);
+            assert_eq!(
+                glob::Pattern::new(pattern.as_str()).unwrap().matches(path),
+                expected
+            );
+        }
+
+        let classes = AddressPattern::new("usa/n?/[a-c]*/[!x]*").unwrap();
+        assert_eq!(classes.as_str(), "/usa/n?/[a-c]*/[!x]*");
+        assert!(classes.matches_path("/usa/ny/brooklyn/ps-118"));
+        assert!(!classes.matches_path("/usa/ny/queens/ps-7"));
+        assert!(!classes.matches_path("/usa/ny/brooklyn/x"));
+        assert!(AddressPattern::new("/usa/[ny").is_err());
+    }
+
+    #[test]
+    fn trie_queries_prune_and_agree_with_pattern() {
+        let paths = [
+            "/usa/ny/brooklyn/ps-118/floor-01/mech/boiler-01",
+            "/usa/ny/brooklyn/ps-118/floor-02/mech/boiler-02",
+            "/usa/ny/brooklyn/ps-118/floor-02/mech/pump-01",
+            "/usa/ny/queens/ps-7/floor-01/mech/boiler-03",
+            "/usa/ca/la/hq/floor-01/mech/boiler-04",
+            "/usa/ny/brooklyn/ps-118",
+        ];
+        let trie = trie(&paths);
+        assert_eq!(trie.len(), paths.len());
+
+        for source in [
+            "/usa/ny/*/floor-*/mech/boiler-*",
+            "/usa/*boiler-0[2-4]",
+            "/*/floor-01/*",
+            "/usa/ny/brooklyn/ps-118",
+            "/usa/ca/*",
+        ] {
+            let pattern = AddressPattern::new(source).unwrap();
+            let glob = glob::Pattern::new(source).unwrap();
+            let mut expected: Vec<&str> = paths
+                .iter()
+                .copied()
+                .filter(|path| glob.matches(path))
+                .collect();
+            expected.sort_by(|a, b| path_segments(a).cmp(path_segments(b)));
+            assert_eq!(
+                keys(&trie.matching(&pattern)),
+                expected,
+                "{}",
+                pattern.as_str()
+            );
+        }
+
+        let separated = glob::MatchOptions {
+            require_literal_separator: true,
+            ..glob::MatchOptions::new()
+        };
+        for source in [
+            "/usa/ny/*/*/floor-*/mech/boiler-*",
+            "/usa/*/*/ps-*",
+            "/usa/*/*/*/floor-01/**",
+        ] {
+            let pattern = AddressPattern::segmented(source).unwrap();
+            let glob = glob::Pattern::new(source).unwrap();
+            let mut expected: Vec<&str> = paths
+                .iter()
+                .copied()
+                .filter(|path| glob.matches_with(path, separated))
+                .collect();
+            expected.sort_by(|a, b| path_segments(a).cmp(path_segments(b)));
+            assert_eq!(keys(&trie.matching(&pattern)), expected, "{}", source);
+        }
+
+        assert_eq!(trie.descendants("/usa/ny/brooklyn").len(), 4);
+        let (covering, _) = trie
+            .longest_prefix("/usa/ny/brooklyn/ps-118/floor-03/mech")
+            .unwrap();
+        assert_eq!(covering, "/usa/ny/brooklyn/ps-118");
+        assert!(trie.longest_prefix("/usa/tx").is_none());
+    }
+
+    #[test]
+    fn segmented_wildcards_stop_at_separators() {
+        let options = glob::MatchOptions {
+            require_literal_separator: true,
+            ..glob::MatchOptions::new()
+        };
+        let source = "/usa/ny/*/floor-*/mech/boiler-*";
+        let pattern = AddressPattern::segmented(source).unwrap();
+        assert!(pattern.is_segmented());
+        for (path, expected) in [
+            ("/usa/ny/brooklyn/floor-02/mech/boiler-01", true),
+            ("/usa/ny/brooklyn/ps-118/floor-02/mech/boiler-01", false),
+            ("/usa/ny/brooklyn/floor-02/mech/boiler-01/valve", false),
+        ] {
+            assert_eq!(pattern.matches_path(path), expected, "{}", path);
+            let glob = glob::Pattern::new(source).unwrap();
+            assert_eq!(glob.matches_with(path, options), expected, "{}", path);
+        }
+
+        let deep = AddressPattern::segmented("/usa/**/mech/boiler-?1").unwrap();
+        assert!(deep.matches_path("/usa/mech/boiler-01"));
+        assert!(deep.matches_path("/usa/ny/brooklyn/ps-118/floor-02/mech/boiler-01"));
+        assert!(!deep.matches_path("/usa/ny/xmech/boiler-01"));
+        assert!(!deep.matches_path("/usa/ny/mech/boiler-/1"));
+        let tail = AddressPattern::segmented("/usa/ny/**").unwrap();
+        assert!(tail.matches_path("/usa/ny/brooklyn/ps-118"));
+        assert!(!tail.matches_path("/usa/ca/la"));
+
+        // A literal segment after `*` prunes only when `*` cannot cross `/`
+        let segmented = AddressPattern::segmented("/usa/*/brooklyn/*").unwrap();
+        let full = AddressPattern::new("/usa/*/brooklyn/*").unwrap();
+        assert!(segmented
+            .advance(&segmented.start(), "/usa/ny/queens")
+            .is_empty());
+        assert!(!full.advance(&full.start(), "/usa/ny/queens").is_empty());
+    }
+
+    #[test]
+    fn remove_prunes_empty_branches() {
+        let mut trie = trie(&["/a/b/c", "/a/b"]);
+        assert_eq!(trie.remove("/a/b/c"), Some(0));
+        assert_eq!(trie.remove("/a/b/c"), None);
+        assert!(trie.root.children["a"].children["b"].children.is_empty());
+        assert_eq!(trie.remove("a/b"), Some(1));
+        assert!(trie.is_empty());
+        assert!(trie.root.children.is_empty());
+
+        *trie.get_or_insert_with("/x/y", || 5) += 1;
+        assert_eq!(trie.get("/x/y"), Some(&6));
+        assert_eq!(trie.insert("/x/y/", 7), Some(6));
+        assert_eq!(trie.len(), 1);
+    }
+}
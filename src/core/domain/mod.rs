@@ -4,7 +4,9 @@
 //! building-related entities.
 
 pub mod address;
+pub mod address_trie;
 pub mod economy;
 
 pub use address::{ArxAddress, RESERVED_SYSTEMS};
+pub use address_trie::{AddressPattern, AddressTrie};
 pub use economy::{BuildingValuation, ContributionRecord, EconomySnapshot, Money, RevenuePayout};
@@ -0,0 +1,186 @@
+//! Edit tracking for incremental saves.
+//!
+//! A `Building` that has been saved through
+//! `PersistenceManager::save_building_incremental` keeps the YAML it produced
+//! for every floor (its [`SaveBaseline`]). Each `&mut` accessor records which
+//! floor it handed out — and, for a single equipment item, which item — so the
+//! next incremental save only revalidates and reserializes those sections.
+//!
+//! Tracking only sees mutations that go through `Building` methods. Code that
+//! writes to `floors` (or anything below it) directly must call
+//! [`Building::mark_floor_dirty`](super::Building::mark_floor_dirty) or
+//! [`Building::invalidate_spatial_index`](super::Building::invalidate_spatial_index)
+//! afterwards; dropping the baseline just makes the next save a full one.
+
+use super::{Equipment, Floor};
+use std::collections::{HashMap, HashSet};
+use std::sync::Arc;
+
+/// Namespaces used by validation for duplicate / reference checks.
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub(crate) enum IdKind {
+    Room,
+    Equipment,
+    Anchor,
+    Address,
+}
+
+/// Ids and addresses declared on one floor (rooms, equipment, anchors and
+/// every `ArxAddress` path below the floor).
+#[derive(Debug, Default)]
+pub(crate) struct FloorIds {
+    rooms: HashSet<String>,
+    equipment: HashSet<String>,
+    anchors: HashSet<String>,
+    addresses: HashSet<String>,
+}
+
+impl FloorIds {
+    /// Collect ids in the same places `validate_building` registers them.
+    pub(crate) fn collect(floor: &Floor) -> Self {
+        let mut ids = Self::default();
+        ids.address(&floor.address);
+        for anchor in &floor.anchors {
+            ids.anchors.insert(anchor.id.clone());
+            ids.address(&anchor.address);
+        }
+        for eq in &floor.equipment {
+            ids.equipment(eq);
+        }
+        for wing in &floor.wings {
+            ids.address(&wing.address);
+            for anchor in &wing.anchors {
+                ids.anchors.insert(anchor.id.clone());
+                ids.address(&anchor.address);
+            }
+            for eq in &wing.equipment {
+                ids.equipment(eq);
+            }
+            for room in &wing.rooms {
+                ids.rooms.insert(room.id.clone());
+                ids.address(&room.address);
+                for anchor in &room.anchors {
+                    ids.anchors.insert(anchor.id.clone());
+                    ids.address(&anchor.address);
+                }
+                for eq in &room.equipment {
+                    ids.equipment(eq);
+                }
+            }
+        }
+        ids
+    }
+
+    pub(crate) fn contains(&self, kind: IdKind, id: &str) -> bool {
+        match kind {
+            IdKind::Room => self.rooms.contains(id),
+            IdKind::Equipment => self.equipment.contains(id),
+            IdKind::Anchor => self.anchors.contains(id),
+            IdKind::Address => self.addresses.contains(id),
+        }
+    }
+
+    fn equipment(&mut self, eq: &Equipment) {
+        self.equipment.insert(eq.id.clone());
+        self.address(&eq.address);
+    }
+
+    fn address(&mut self, address: &Option<super::domain::ArxAddress>) {
+        if let Some(addr) = address {
+            self.addresses.insert(addr.path.clone());
+        }
+    }
+}
+
+/// Serialized form of one floor as of the last incremental save.
+#[derive(Debug)]
+pub(crate) struct FloorSection {
+    /// The floor's item in `building.floors` (YAML, including the `- ` line).
+    pub(crate) yaml: String,
+    /// Equipment id → its item in the top-level `equipment:` list.
+    pub(crate) equipment: HashMap<String, Arc<str>>,
+    /// Ids used to validate other floors against this one.
+    pub(crate) ids: FloorIds,
+}
+
+/// Per-floor YAML sections of the last incremental save, keyed by floor id.
+#[derive(Debug)]
+pub(crate) struct SaveBaseline {
+    /// `STRICT_ADDRESSES` at the time the sections were validated.
+    pub(crate) strict_addresses: bool,
+    pub(crate) floors: HashMap<String, Arc<FloorSection>>,
+}
+
+/// What changed on a floor since the baseline.
+#[derive(Debug, Clone)]
+enum FloorEdit {
+    /// Anything on the floor may have changed.
+    Whole,
+    /// Only these equipment items (by id) were handed out.
+    Equipment(HashSet<String>),
+}
+
+/// Baseline plus the floors touched since it was taken.
+///
+/// Clones share the baseline (it is immutable) and copy the edit set, so a
+/// cloned building can still be saved incrementally.
+#[derive(Debug, Clone, Default)]
+pub(crate) struct EditLog {
+    baseline: Option<Arc<SaveBaseline>>,
+    floors: HashMap<String, FloorEdit>,
+}
+
+impl EditLog {
+    /// Baseline to splice against, if edits have been tracked since the last save.
+    pub(crate) fn baseline(&self) -> Option<&Arc<SaveBaseline>> {
+        self.baseline.as_ref()
+    }
+
+    /// Start tracking from `baseline` (after it has been written).
+    pub(crate) fn reset(&mut self, baseline: SaveBaseline) {
+        self.baseline = Some(Arc::new(baseline));
+        self.floors.clear();
+    }
+
+    pub(crate) fn mark_all(&mut self) {
+        self.baseline = None;
+        self.floors.clear();
+    }
+
+    pub(crate) fn mark_floor(&mut self, floor_id: &str) {
+        if self.baseline.is_some() {
+            self.floors.insert(floor_id.to_string(), FloorEdit::Whole);
+        }
+    }
+
+    pub(crate) fn mark_equipment(&mut self, floor_id: &str, equipment_id: &str) {
+        if self.baseline.is_none() {
+            return;
+        }
+        match self
+            .floors
+            .entry(floor_id.to_string())
+            .or_insert_with(|| FloorEdit::Equipment(HashSet::new()))
+        {
+            FloorEdit::Whole => {}
+            FloorEdit::Equipment(ids) => {
+                ids.insert(equipment_id.to_string());
+            }
+        }
+    }
+
+    /// No edits recorded for `floor_id` since the baseline.
+    pub(crate) fn is_floor_clean(&self, floor_id: &str) -> bool {
+        !self.floors.contains_key(floor_id)
+    }
+
+    /// The equipment item's baseline YAML is still valid (its floor was at
+    /// most partially edited and this item was not among the edits).
+    pub(crate) fn is_equipment_clean(&self, floor_id: &str, equipment_id: &str) -> bool {
+        match self.floors.get(floor_id) {
+            None => true,
+            Some(FloorEdit::Whole) => false,
+            Some(FloorEdit::Equipment(ids)) => !ids.contains(equipment_id),
+        }
+    }
+}
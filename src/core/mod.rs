@@ -7,14 +7,17 @@
 mod anchor;
 mod building;
 pub mod domain;
+pub(crate) mod edits;
 mod equipment;
 mod floor;
 pub mod identity;
+pub mod mutation;
 pub mod operations;
 pub mod review;
 mod room;
 mod serde_helpers;
 pub mod spatial;
+mod spatial_index;
 mod types;
 mod wing;
 
@@ -24,11 +27,13 @@ pub use building::{Building, BuildingMetadata, CoordinateSystemInfo};
 pub use equipment::{Equipment, EquipmentHealthStatus, EquipmentStatus, EquipmentType};
 pub use floor::Floor;
 pub use identity::ArxId;
+pub use mutation::Mutation;
 pub use review::{
     filter_building_for_export, mark_proposed, review_status_from_props, summarize_review,
     ReviewStatus, ReviewSummary, PROP_REVIEW_STATUS,
 };
 pub use room::{Room, RoomType};
+pub use spatial_index::{BuildingSpatialIndex, EntitySlot};
 pub use types::{BoundingBox, Dimensions, LidarEnrichment, Position, SpatialProperties};
 pub use wing::Wing;
 
@@ -0,0 +1,561 @@
+//! Field mutations captured offline and replayed against a building
+//!
+//! The PWA queues [`Mutation`]s while disconnected and hands them to the
+//! agent in one batch. [`coalesce`] folds every mutation targeting the same
+//! entity into one (last write wins by timestamp), and [`apply_mutation`]
+//! replays the result against an in-memory [`Building`], recording which
+//! floor each edit touched so the caller can validate and save once.
+
+use super::domain::ArxAddress;
+use super::{Anchor, Building, Floor, Position};
+use chrono::{DateTime, Utc};
+use serde::{Deserialize, Serialize};
+use std::collections::HashMap;
+
+/// Represents a pending spatial or semantic change captured offline.
+#[derive(Serialize, Deserialize, Clone, Debug, PartialEq)]
+pub enum Mutation {
+    /// Worker dropped a new spatial anchor.
+    CreateAnchor { address: ArxAddress, anchor: Anchor },
+    /// Worker recalibrated an existing anchor position.
+    RecalibrateAnchor {
+        anchor_id: String,
+        new_position: Position,
+        confidence: f64,
+        timestamp: u64,
+    },
+    /// Worker updated property values.
+    UpdateProperties {
+        entity_address: ArxAddress,
+        properties: HashMap<String, String>,
+        timestamp: u64,
+    },
+}
+
+/// Result of replaying one mutation.
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub enum MutationOutcome {
+    /// The building was changed.
+    Applied,
+    /// The building already holds a newer write for this entity.
+    Superseded,
+}
+
+impl Mutation {
+    /// Seconds since the epoch at which the mutation was captured, if recorded.
+    pub fn timestamp(&self) -> Option<u64> {
+        match self {
+            Mutation::CreateAnchor { .. } => None,
+            Mutation::RecalibrateAnchor { timestamp, .. }
+            | Mutation::UpdateProperties { timestamp, .. } => Some(*timestamp),
+        }
+    }
+
+    /// Human-readable target, for error reporting.
+    pub fn target(&self) -> &str {
+        match self {
+            Mutation::CreateAnchor { anchor, .. } => &anchor.id,
+            Mutation::RecalibrateAnchor { anchor_id, .. } => anchor_id,
+            Mutation::UpdateProperties { entity_address, .. } => &entity_address.path,
+        }
+    }
+}
+
+/// Property writes queued for one entity, with their timestamps.
+type PropertyWrites = Vec<(u64, HashMap<String, String>)>;
+
+/// Fold mutations targeting the same entity into one, last write wins.
+///
+/// - Anchor creations are keyed by anchor id; the last one queued wins.
+/// - Recalibrations are keyed by anchor id; the newest timestamp wins, ties
+///   going to the one queued last.
+/// - Property updates are keyed by entity address and merged key by key in
+///   timestamp order, so a later write to one property does not drop an
+///   earlier write to another. The merged update carries the newest timestamp.
+///
+/// Re-dropping an anchor replaces it outright, so recalibrations and property
+/// writes queued for it before its last creation are discarded. The result
+/// lists creations, then recalibrations, then property updates (each in order
+/// of first appearance), so a recalibration or property write queued for a
+/// freshly dropped anchor finds it.
+pub fn coalesce(mutations: impl IntoIterator<Item = Mutation>) -> Vec<Mutation> {
+    let mut creates: Vec<Mutation> = Vec::new();
+    let mut recalibrations: Vec<Option<Mutation>> = Vec::new();
+    let mut updates: Vec<Option<(ArxAddress, PropertyWrites)>> = Vec::new();
+    let mut create_slots: HashMap<String, usize> = HashMap::new();
+    let mut recalibration_slots: HashMap<String, usize> = HashMap::new();
+    let mut update_slots: HashMap<String, usize> = HashMap::new();
+
+    for mutation in mutations {
+        match mutation {
+            Mutation::CreateAnchor {
+                ref address,
+                ref anchor,
+            } => {
+                if let Some(slot) = recalibration_slots.remove(&anchor.id) {
+                    recalibrations[slot] = None;
+                }
+                if let Some(slot) = update_slots.remove(&address.path) {
+                    updates[slot] = None;
+                }
+                match create_slots.get(&anchor.id) {
+                    Some(&slot) => creates[slot] = mutation,
+                    None => {
+                        create_slots.insert(anchor.id.clone(), creates.len());
+                        creates.push(mutation);
+                    }
+                }
+            }
+            Mutation::RecalibrateAnchor {
+                ref anchor_id,
+                timestamp,
+                ..
+            } => match recalibration_slots.get(anchor_id) {
+                Some(&slot) => {
+                    let held = recalibrations[slot].as_ref().and_then(Mutation::timestamp);
+                    if held <= Some(timestamp) {
+                        recalibrations[slot] = Some(mutation);
+                    }
+                }
+                None => {
+                    recalibration_slots.insert(anchor_id.clone(), recalibrations.len());
+                    recalibrations.push(Some(mutation));
+                }
+            },
+            Mutation::UpdateProperties {
+                entity_address,
+                properties,
+                timestamp,
+            } => match update_slots.get(&entity_address.path) {
+                Some(&slot) => {
+                    if let Some((_, writes)) = &mut updates[slot] {
+                        writes.push((timestamp, properties));
+                    }
+                }
+                None => {
+                    update_slots.insert(entity_address.path.clone(), updates.len());
+                    updates.push(Some((entity_address, vec![(timestamp, properties)])));
+                }
+            },
+        }
+    }
+
+    let updates = updates
+        .into_iter()
+        .flatten()
+        .map(|(entity_address, mut writes)| {
+            // Stable: equal timestamps keep queue order
+            writes.sort_by_key(|(timestamp, _)| *timestamp);
+            let timestamp = writes.last().map_or(0, |(timestamp, _)| *timestamp);
+            let mut properties = HashMap::new();
+            for (_, write) in writes {
+                properties.extend(write);
+            }
+            Mutation::UpdateProperties {
+                entity_address,
+                properties,
+                timestamp,
+            }
+        });
+
+    creates
+        .into_iter()
+        .chain(recalibrations.into_iter().flatten())
+        .chain(updates)
+        .collect()
+}
+
+/// Replay one mutation against `building`.
+///
+/// Edits below a floor are recorded with [`Building::mark_floor_dirty`];
+/// building-level anchors drop the whole incremental-save baseline. Nothing
+/// is validated or saved here.
+pub fn apply_mutation(
+    building: &mut Building,
+    mutation: &Mutation,
+) -> Result<MutationOutcome, String> {
+    match mutation {
+        Mutation::CreateAnchor { address, anchor } => {
+            create_anchor(building, address, anchor);
+            Ok(MutationOutcome::Applied)
+        }
+        Mutation::RecalibrateAnchor {
+            anchor_id,
+            new_position,
+            confidence,
+            timestamp,
+        } => {
+            let at = DateTime::<Utc>::from_timestamp(*timestamp as i64, 0);
+            with_anchor_mut(building, anchor_id, |anchor| {
+                if at.is_some() && anchor.last_recalibrated_at > at {
+                    return MutationOutcome::Superseded;
+                }
+                anchor.recalibrate(new_position.clone(), *confidence);
+                if at.is_some() {
+                    anchor.last_recalibrated_at = at;
+                }
+                MutationOutcome::Applied
+            })
+            .ok_or_else(|| format!("Anchor '{}' not found", anchor_id))
+        }
+        Mutation::UpdateProperties {
+            entity_address,
+            properties,
+            ..
+        } => with_properties_mut(building, &entity_address.path, |target| {
+            target.extend(properties.iter().map(|(k, v)| (k.clone(), v.clone())));
+            MutationOutcome::Applied
+        })
+        .ok_or_else(|| format!("No entity at '{}'", entity_address.path)),
+    }
+}
+
+/// Attach `anchor` to the room, wing or floor whose address is the parent of
+/// `address`, or to the building itself. An anchor with the same id is replaced.
+fn create_anchor(building: &mut Building, address: &ArxAddress, anchor: &Anchor) {
+    let mut anchor = anchor.clone();
+    anchor.address = Some(address.clone());
+    // Re-dropping an anchor replaces it wherever it was
+    remove_anchor(building, &anchor.id);
+
+    let parent = address.parent();
+    let is_parent = |a: &Option<ArxAddress>| a.as_ref().is_some_and(|a| a.path == parent);
+    let mut placed = None;
+    for floor in &mut building.floors {
+        let anchors = if is_parent(&floor.address) {
+            Some(&mut floor.anchors)
+        } else {
+            floor.wings.iter_mut().find_map(|wing| {
+                if is_parent(&wing.address) {
+                    Some(&mut wing.anchors)
+                } else {
+                    wing.rooms
+                        .iter_mut()
+                        .find(|room| is_parent(&room.address))
+                        .map(|room| &mut room.anchors)
+                }
+            })
+        };
+        if let Some(anchors) = anchors {
+            anchors.push(anchor.clone());
+            placed = Some(floor.id.clone());
+            break;
+        }
+    }
+    match placed {
+        Some(floor_id) => building.mark_floor_dirty(&floor_id),
+        None => {
+            building.anchors.push(anchor);
+            building.invalidate_spatial_index();
+        }
+    }
+}
+
+fn remove_anchor(building: &mut Building, anchor_id: &str) {
+    if let Some(at) = building.anchors.iter().position(|a| a.id == anchor_id) {
+        building.anchors.remove(at);
+        building.invalidate_spatial_index();
+        return;
+    }
+    let mut touched = None;
+    for floor in &mut building.floors {
+        let lists =
+            std::iter::once(&mut floor.anchors).chain(floor.wings.iter_mut().flat_map(|wing| {
+                std::iter::once(&mut wing.anchors)
+                    .chain(wing.rooms.iter_mut().map(|room| &mut room.anchors))
+            }));
+        for anchors in lists {
+            if let Some(at) = anchors.iter().position(|a| a.id == anchor_id) {
+                anchors.remove(at);
+                touched = Some(floor.id.clone());
+                break;
+            }
+        }
+        if touched.is_some() {
+            break;
+        }
+    }
+    if let Some(floor_id) = touched {
+        building.mark_floor_dirty(&floor_id);
+    }
+}
+
+fn floor_anchor_mut<'a>(floor: &'a mut Floor, anchor_id: &str) -> Option<&'a mut Anchor> {
+    std::iter::once(&mut floor.anchors)
+        .chain(floor.wings.iter_mut().flat_map(|wing| {
+            std::iter::once(&mut wing.anchors)
+                .chain(wing.rooms.iter_mut().map(|room| &mut room.anchors))
+        }))
+        .flat_map(|anchors| anchors.iter_mut())
+        .find(|anchor| anchor.id == anchor_id)
+}
+
+fn with_anchor_mut<R>(
+    building: &mut Building,
+    anchor_id: &str,
+    f: impl FnOnce(&mut Anchor) -> R,
+) -> Option<R> {
+    if let Some(anchor) = building.anchors.iter_mut().find(|a| a.id == anchor_id) {
+        let result = f(anchor);
+        building.invalidate_spatial_index();
+        return Some(result);
+    }
+    let mut found = None;
+    for floor in &mut building.floors {
+        let floor_id = floor.id.clone();
+        if let Some(anchor) = floor_anchor_mut(floor, anchor_id) {
+            found = Some((floor_id, anchor));
+            break;
+        }
+    }
+    let (floor_id, anchor) = found?;
+    let result = f(anchor);
+    building.mark_floor_dirty(&floor_id);
+    Some(result)
+}
+
+/// Properties of the floor, wing, room, equipment item or anchor at `path`.
+fn floor_properties_mut<'a>(
+    floor: &'a mut Floor,
+    path: &str,
+) -> Option<&'a mut HashMap<String, String>> {
+    let at = |a: &Option<ArxAddress>| a.as_ref().is_some_and(|a| a.path == path);
+    if at(&floor.address) {
+        return Some(&mut floor.properties);
+    }
+    for anchor in &mut floor.anchors {
+        if at(&anchor.address) {
+            return Some(&mut anchor.properties);
+        }
+    }
+    for equipment in &mut floor.equipment {
+        if at(&equipment.address) {
+            return Some(&mut equipment.properties);
+        }
+    }
+    for wing in &mut floor.wings {
+        if at(&wing.address) {
+            return Some(&mut wing.properties);
+        }
+        let anchors = wing
+            .anchors
+            .iter_mut()
+            .map(|a| (&a.address, &mut a.properties));
+        let equipment = wing
+            .equipment
+            .iter_mut()
+            .map(|e| (&e.address, &mut e.properties));
+        for (address, properties) in anchors.chain(equipment) {
+            if at(address) {
+                return Some(properties);
+            }
+        }
+        for room in &mut wing.rooms {
+            if at(&room.address) {
+                return Some(&mut room.properties);
+            }
+            let anchors = room
+                .anchors
+                .iter_mut()
+                .map(|a| (&a.address, &mut a.properties));
+            let equipment = room
+                .equipment
+                .iter_mut()
+                .map(|e| (&e.address, &mut e.properties));
+            for (address, properties) in anchors.chain(equipment) {
+                if at(address) {
+                    return Some(properties);
+                }
+            }
+        }
+    }
+    None
+}
+
+fn with_properties_mut<R>(
+    building: &mut Building,
+    path: &str,
+    f: impl FnOnce(&mut HashMap<String, String>) -> R,
+) -> Option<R> {
+    if let Some(anchor) = building
+        .anchors
+        .iter_mut()
+        .find(|a| a.address.as_ref().is_some_and(|a| a.path == path))
+    {
+        let result = f(&mut anchor.properties);
+        building.invalidate_spatial_index();
+        return Some(result);
+    }
+    let mut found = None;
+    for floor in &mut building.floors {
+        let floor_id = floor.id.clone();
+        if let Some(properties) = floor_properties_mut(floor, path) {
+            found = Some((floor_id, properties));
+            break;
+        }
+    }
+    let (floor_id, properties) = found?;
+    let result = f(properties);
+    building.mark_floor_dirty(&floor_id);
+    Some(result)
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use crate::core::{Room, RoomType, Wing};
+
+    fn position(x: f64) -> Position {
+        Position {
+            x,
+            y: 0.0,
+            z: 0.0,
+            coordinate_system: "local".to_string(),
+        }
+    }
+
+    fn address(path: &str) -> ArxAddress {
+        ArxAddress::from_path(path).unwrap()
+    }
+
+    fn props(pairs: &[(&str, &str)]) -> HashMap<String, String> {
+        pairs
+            .iter()
+            .map(|(k, v)| (k.to_string(), v.to_string()))
+            .collect()
+    }
+
+    fn recalibration(id: &str, x: f64, timestamp: u64) -> Mutation {
+        Mutation::RecalibrateAnchor {
+            anchor_id: id.to_string(),
+            new_position: position(x),
+            confidence: 0.9,
+            timestamp,
+        }
+    }
+
+    #[test]
+    fn coalesce_keeps_last_write_per_entity() {
+        let room = address("/usa/ny/nyc/hq/floor-01/mech");
+        let mut anchor = Anchor::new("A".to_string(), position(0.0), 0.5);
+        anchor.id = "a1".to_string();
+        let merged = coalesce(vec![
+            Mutation::UpdateProperties {
+                entity_address: room.clone(),
+                properties: props(&[("status", "new"), ("owner", "ops")]),
+                timestamp: 20,
+            },
+            Mutation::CreateAnchor {
+                address: address("/usa/ny/nyc/hq/floor-01/mech/a1"),
+                anchor,
+            },
+            recalibration("a1", 2.0, 30),
+            recalibration("a1", 1.0, 10),
+            Mutation::UpdateProperties {
+                entity_address: room.clone(),
+                properties: props(&[("status", "old")]),
+                timestamp: 5,
+            },
+        ]);
+
+        assert_eq!(merged.len(), 3);
+        assert!(matches!(merged[0], Mutation::CreateAnchor { .. }));
+        assert_eq!(merged[1], recalibration("a1", 2.0, 30));
+        assert_eq!(
+            merged[2],
+            Mutation::UpdateProperties {
+                entity_address: room,
+                properties: props(&[("status", "new"), ("owner", "ops")]),
+                timestamp: 20,
+            }
+        );
+    }
+
+    #[test]
+    fn coalesce_drops_writes_queued_before_a_redrop() {
+        let pin = address("/usa/ny/nyc/hq/floor-01/mech/a1");
+        let mut anchor = Anchor::new("A".to_string(), position(5.0), 0.5);
+        anchor.id = "a1".to_string();
+        let redrop = Mutation::CreateAnchor {
+            address: pin.clone(),
+            anchor,
+        };
+        let merged = coalesce(vec![
+            recalibration("a1", 2.0, 30),
+            Mutation::UpdateProperties {
+                entity_address: pin.clone(),
+                properties: props(&[("tag", "old")]),
+                timestamp: 30,
+            },
+            redrop.clone(),
+            Mutation::UpdateProperties {
+                entity_address: pin.clone(),
+                properties: props(&[("status", "ok")]),
+                timestamp: 10,
+            },
+            recalibration("a1", 1.0, 10),
+        ]);
+
+        assert_eq!(
+            merged,
+            vec![
+                redrop,
+                recalibration("a1", 1.0, 10),
+                Mutation::UpdateProperties {
+                    entity_address: pin,
+                    properties: props(&[("status", "ok")]),
+                    timestamp: 10,
+                },
+            ]
+        );
+    }
+
+    #[test]
+    fn apply_places_anchor_and_rejects_stale_recalibration() {
+        let mut building = Building::new("HQ".to_string(), "/hq".to_string());
+        let mut floor = Floor::new("Floor 1".to_string(), 1);
+        let mut wing = Wing::new("Main".to_string());
+        let mut room = Room::new("Mech".to_string(), RoomType::Mechanical);
+        room.address = Some(address("/usa/ny/nyc/hq/floor-01/mech"));
+        wing.rooms.push(room);
+        floor.wings.push(wing);
+        building.floors.push(floor);
+
+        let mut anchor = Anchor::new("A".to_string(), position(0.0), 0.5);
+        anchor.id = "a1".to_string();
+        let create = Mutation::CreateAnchor {
+            address: address("/usa/ny/nyc/hq/floor-01/mech/a1"),
+            anchor,
+        };
+        let tag = Mutation::UpdateProperties {
+            entity_address: address("/usa/ny/nyc/hq/floor-01/mech/a1"),
+            properties: props(&[("tag", "door")]),
+            timestamp: 1,
+        };
+        assert_eq!(
+            apply_mutation(&mut building, &create),
+            Ok(MutationOutcome::Applied)
+        );
+        assert_eq!(
+            apply_mutation(&mut building, &tag),
+            Ok(MutationOutcome::Applied)
+        );
+        assert_eq!(
+            apply_mutation(&mut building, &recalibration("a1", 3.0, 200)),
+            Ok(MutationOutcome::Applied)
+        );
+        assert_eq!(
+            apply_mutation(&mut building, &recalibration("a1", 1.0, 100)),
+            Ok(MutationOutcome::Superseded)
+        );
+        assert!(apply_mutation(&mut building, &recalibration("missing", 1.0, 1)).is_err());
+
+        let anchor = &building.floors[0].wings[0].rooms[0].anchors[0];
+        assert_eq!(anchor.position.x, 3.0);
+        assert_eq!(
+            anchor.properties.get("tag").map(String::as_str),
+            Some("door")
+        );
+        assert!(building.anchors.is_empty());
+    }
+}
@@ -4,7 +4,7 @@
 //! for building entities.
 
 use crate::core::types::{Position, SpatialQueryResult};
-use crate::core::Building;
+use crate::core::{Building, EntitySlot};
 
 /// Result of spatial validation
 #[derive(Debug, Clone)]
@@ -88,46 +88,77 @@ pub fn spatial_query(
         (dx * dx + dy * dy + dz * dz).sqrt()
     };
 
-    // Collect all entities first
-    let mut all_entities: Vec<(String, String, Point3D, bool)> = Vec::new();
-    for floor in &building.floors {
-        // Filter by entity type if specified
-        let include_rooms = entity.is_empty() || entity.to_lowercase() == "room";
-        let include_equipment = entity.is_empty() || entity.to_lowercase() == "equipment";
-
-        if include_rooms {
-            // Collect rooms from wings (primary location)
-            for wing in &floor.wings {
-                for room in &wing.rooms {
+    let include_rooms = entity.is_empty() || entity.to_lowercase() == "room";
+    let include_equipment = entity.is_empty() || entity.to_lowercase() == "equipment";
+
+    // Rooms come from wings (primary location); equipment from floor level.
+    // `(floor, is_equipment, slot)` orders entities the way a floor-by-floor
+    // scan would, so results stay stable for equidistant entities.
+    let room_entity = |slot: EntitySlot| {
+        slot.room(building).map(|room| {
+            let p = &room.spatial_properties.position;
+            (
+                (slot.floor, false, slot),
+                room.name.clone(),
+                format!("Room ({:?})", room.room_type),
+                Point3D::new(p.x, p.y, p.z),
+            )
+        })
+    };
+    let equipment_entity = |slot: EntitySlot| {
+        slot.equipment(building).map(|equipment| {
+            (
+                (slot.floor, true, slot),
+                equipment.name.clone(),
+                format!("Equipment ({:?})", equipment.equipment_type),
+                Point3D::new(
+                    equipment.position.x,
+                    equipment.position.y,
+                    equipment.position.z,
+                ),
+            )
+        })
+    };
+    let floor_level = |slot: &EntitySlot| slot.wing.is_none();
+
+    // Full linear collection, only needed by the name lookup and "all" queries
+    let collect_entities = || {
+        let mut all_entities: Vec<(String, String, Point3D, bool)> = Vec::new();
+        for floor in &building.floors {
+            if include_rooms {
+                for wing in &floor.wings {
+                    for room in &wing.rooms {
+                        all_entities.push((
+                            room.name.clone(),
+                            format!("Room ({:?})", room.room_type),
+                            Point3D::new(
+                                room.spatial_properties.position.x,
+                                room.spatial_properties.position.y,
+                                room.spatial_properties.position.z,
+                            ),
+                            true,
+                        ));
+                    }
+                }
+            }
+
+            if include_equipment {
+                for equipment in &floor.equipment {
                     all_entities.push((
-                        room.name.clone(),
-                        format!("Room ({:?})", room.room_type),
-                        crate::core::spatial::Point3D::new(
-                            room.spatial_properties.position.x,
-                            room.spatial_properties.position.y,
-                            room.spatial_properties.position.z,
+                        equipment.name.clone(),
+                        format!("Equipment ({:?})", equipment.equipment_type),
+                        Point3D::new(
+                            equipment.position.x,
+                            equipment.position.y,
+                            equipment.position.z,
                         ),
-                        true,
+                        false,
                     ));
                 }
             }
         }
-
-        if include_equipment {
-            for equipment in &floor.equipment {
-                all_entities.push((
-                    equipment.name.clone(),
-                    format!("Equipment ({:?})", equipment.equipment_type),
-                    crate::core::spatial::Point3D::new(
-                        equipment.position.x,
-                        equipment.position.y,
-                        equipment.position.z,
-                    ),
-                    false,
-                ));
-            }
-        }
-    }
+        all_entities
+    };
 
     // Process query based on type
     match query_type.to_lowercase().as_str() {
@@ -139,6 +170,7 @@ pub fn spatial_query(
 
             let source_name = &params[0];
             let target_name = &params[1];
+            let all_entities = collect_entities();
 
             let source_entity = all_entities
                 .iter()
@@ -187,13 +219,34 @@ pub fn spatial_query(
                 .map_err(|e| format!("Invalid radius '{}': {}", params[3], e))?;
 
             let center = Point3D::new(center_x, center_y, center_z);
+            let index = building.spatial_index();
+
+            let mut hits = Vec::new();
+            if include_rooms {
+                hits.extend(
+                    index
+                        .rooms_within(center, radius)
+                        .into_iter()
+                        .filter_map(room_entity),
+                );
+            }
+            if include_equipment {
+                hits.extend(
+                    index
+                        .equipment_within(center, radius)
+                        .into_iter()
+                        .filter(floor_level)
+                        .filter_map(equipment_entity),
+                );
+            }
+            hits.sort_by(|a, b| a.0.cmp(&b.0));
 
-            for (name, entity_type, pos, _) in &all_entities {
-                let distance = distance_3d(&center, pos);
+            for (_, name, entity_type, pos) in hits {
+                let distance = distance_3d(&center, &pos);
                 if distance <= radius {
                     results.push(SpatialQueryResult {
-                        entity_name: name.clone(),
-                        entity_type: entity_type.clone(),
+                        entity_name: name,
+                        entity_type,
                         position: Position {
                             x: pos.x,
                             y: pos.y,
@@ -240,20 +293,40 @@ pub fn spatial_query(
                 None
             };
 
-            let mut candidates: Vec<SpatialQueryResult> = Vec::new();
-
-            for (name, entity_type, pos, _) in &all_entities {
-                let distance = distance_3d(&reference_point, pos);
+            let index = building.spatial_index();
+            let mut candidates = Vec::new();
+            if include_rooms {
+                candidates.extend(
+                    index
+                        .nearest_room(reference_point)
+                        .and_then(|(slot, _)| room_entity(slot)),
+                );
+            }
+            if include_equipment {
+                candidates.extend(
+                    index
+                        .nearest_equipment_matching(reference_point, floor_level)
+                        .and_then(|(slot, _)| equipment_entity(slot)),
+                );
+            }
 
-                if let Some(max_dist) = max_distance {
-                    if distance > max_dist {
-                        continue;
-                    }
-                }
+            let nearest = candidates
+                .into_iter()
+                .map(|(key, name, entity_type, pos)| {
+                    let distance = distance_3d(&reference_point, &pos);
+                    (distance, key, name, entity_type, pos)
+                })
+                .filter(|(distance, ..)| max_distance.is_none_or(|max| *distance <= max))
+                .min_by(|a, b| {
+                    a.0.partial_cmp(&b.0)
+                        .unwrap_or(std::cmp::Ordering::Equal)
+                        .then_with(|| a.1.cmp(&b.1))
+                });
 
-                candidates.push(SpatialQueryResult {
-                    entity_name: name.clone(),
-                    entity_type: entity_type.clone(),
+            if let Some((distance, _, name, entity_type, pos)) = nearest {
+                results.push(SpatialQueryResult {
+                    entity_name: name,
+                    entity_type,
                     position: Position {
                         x: pos.x,
                         y: pos.y,
@@ -263,24 +336,13 @@ pub fn spatial_query(
                     distance,
                 });
             }
-
-            // Sort by distance and return only the nearest
-            candidates.sort_by(|a, b| {
-                a.distance
-                    .partial_cmp(&b.distance)
-                    .unwrap_or(std::cmp::Ordering::Equal)
-            });
-
-            if let Some(nearest) = candidates.first() {
-                results.push(nearest.clone());
-            }
         }
 
         "all" | "" => {
             // Return all entities with distance from origin
             let origin = Point3D::new(0.0, 0.0, 0.0);
 
-            for (name, entity_type, pos, _) in &all_entities {
+            for (name, entity_type, pos, _) in &collect_entities() {
                 let distance = distance_3d(&origin, pos);
                 results.push(SpatialQueryResult {
                     entity_name: name.clone(),
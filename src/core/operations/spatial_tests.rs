@@ -112,4 +112,100 @@ mod tests {
         assert!(result.contains("Room A"));
         assert!(result.contains("local_offset"));
     }
+
+    #[test]
+    fn test_spatial_query_within_radius() {
+        let building = create_test_building();
+        let results = spatial_query(
+            &building,
+            "within_radius",
+            "",
+            vec![
+                "0.0".to_string(),
+                "0.0".to_string(),
+                "0.0".to_string(),
+                "8.0".to_string(),
+            ],
+        )
+        .unwrap();
+
+        let names: Vec<&str> = results.iter().map(|r| r.entity_name.as_str()).collect();
+        assert_eq!(names, vec!["Room A", "TestEq"]);
+        assert!((results[1].distance - 50.0_f64.sqrt()).abs() < 1e-12);
+    }
+
+    #[test]
+    fn test_building_spatial_index_queries() {
+        let mut building = create_test_building();
+        let origin = Point3D::new(0.0, 0.0, 0.0);
+
+        let inside = building.find_rooms_containing(Point3D::new(5.0, 5.0, 1.0));
+        assert_eq!(inside.len(), 1);
+        assert_eq!(inside[0].name, "Room A");
+
+        let (nearest, distance) = building.find_nearest_equipment(origin).unwrap();
+        assert_eq!(nearest.name, "TestEq");
+        assert!((distance - 50.0_f64.sqrt()).abs() < 1e-12);
+
+        // Mutable access drops the index; the next query sees the moved item
+        building.find_equipment_mut("TestEq").unwrap().position.x = 50.0;
+        assert!(building
+            .find_equipment_within_radius(origin, 10.0)
+            .is_empty());
+
+        // Direct edits are caught by the container census
+        let mut extra = Equipment::new(
+            "WingEq".to_string(),
+            "/eq2".to_string(),
+            EquipmentType::Other("Test".to_string()),
+        );
+        extra.position.x = 1.0;
+        building.floors[0].wings[0].equipment.push(extra);
+        let near: Vec<&str> = building
+            .find_equipment_within_radius(origin, 10.0)
+            .iter()
+            .map(|eq| eq.name.as_str())
+            .collect();
+        assert_eq!(near, vec!["WingEq"]);
+    }
+
+    #[test]
+    fn test_spatial_index_sees_in_place_moves() {
+        let mut building = create_test_building();
+        let far = Point3D::new(40.0, 40.0, 0.0);
+        assert!(building.find_equipment_within_radius(far, 5.0).is_empty());
+
+        // Same list sizes, new position written straight through the fields
+        building.floors[0].equipment[0].position.x = 41.0;
+        building.floors[0].equipment[0].position.y = 40.0;
+        let near: Vec<&str> = building
+            .find_equipment_within_radius(far, 5.0)
+            .iter()
+            .map(|eq| eq.name.as_str())
+            .collect();
+        assert_eq!(near, vec!["TestEq"]);
+
+        let (nearest, _) = building
+            .find_nearest_equipment(Point3D::new(0.0, 0.0, 0.0))
+            .unwrap();
+        assert_eq!(nearest.name, "TestEq");
+        assert!(building
+            .find_equipment_within_radius(Point3D::new(5.0, 5.0, 0.0), 1.0)
+            .is_empty());
+
+        building.anchors.push(crate::core::Anchor::new(
+            "Pin".to_string(),
+            Position {
+                x: 0.0,
+                y: 0.0,
+                z: 0.0,
+                coordinate_system: "building_local".to_string(),
+            },
+            0.9,
+        ));
+        assert!(building.find_anchors_near(far, 5.0).is_empty());
+        building.anchors[0].position.x = 40.0;
+        building.anchors[0].position.y = 40.0;
+        assert_eq!(building.find_anchors_near(far, 5.0).len(), 1);
+    }
 }
@@ -0,0 +1,466 @@
+//! R-tree spatial index over a [`Building`]
+//!
+//! Rooms are indexed by bounding box (and by their reference position),
+//! equipment and anchors by point, and equipment also by durable address in
+//! an [`AddressTrie`] for glob queries. The index stores only [`EntitySlot`]s —
+//! typed positions in the Building → Floor → Wing → Room tree — so it holds
+//! no borrows and can be cached on the building and shared across threads.
+//!
+//! `Building` builds the index lazily on the first spatial query and drops
+//! it whenever a mutable accessor hands out `&mut` access to its tree. Edits
+//! through the public fields are caught by a census taken at build time: the
+//! container list lengths plus a fingerprint of every indexed position and
+//! address, rechecked before each query. The check is one linear pass of
+//! hashing, far cheaper than the rebuild it guards.
+
+use super::domain::{AddressPattern, AddressTrie};
+use super::{Anchor, Building, Equipment, Position, Room};
+use crate::core::spatial::Point3D;
+use rstar::primitives::{GeomWithData, Rectangle};
+use rstar::{RTree, AABB};
+use std::collections::hash_map::DefaultHasher;
+use std::hash::{Hash, Hasher};
+use std::sync::{Arc, RwLock};
+
+type PointEntry = GeomWithData<[f64; 3], EntitySlot>;
+type BoxEntry = GeomWithData<Rectangle<[f64; 3]>, EntitySlot>;
+
+/// Location of a room, equipment item or anchor inside a [`Building`].
+///
+/// `None` means "held by the parent container": equipment with `wing: None`
+/// sits on the floor itself, an anchor with `floor: None` on the building.
+/// For rooms `room` is always set and `index` is unused. The derived
+/// ordering matches the traversal order of [`Building::get_all_equipment`]
+/// and [`Building::get_all_anchors`], so sorting slots reproduces the order
+/// of the equivalent linear scan.
+#[derive(Debug, Clone, Copy, PartialEq, Eq, PartialOrd, Ord, Hash)]
+pub struct EntitySlot {
+    pub floor: Option<u32>,
+    pub wing: Option<u32>,
+    pub room: Option<u32>,
+    pub index: u32,
+}
+
+impl EntitySlot {
+    /// Resolve an equipment slot against `building`.
+    pub fn equipment<'b>(&self, building: &'b Building) -> Option<&'b Equipment> {
+        let floor = building.floors.get(self.floor? as usize)?;
+        let list = match (self.wing, self.room) {
+            (None, _) => &floor.equipment,
+            (Some(w), None) => &floor.wings.get(w as usize)?.equipment,
+            (Some(w), Some(r)) => {
+                &floor
+                    .wings
+                    .get(w as usize)?
+                    .rooms
+                    .get(r as usize)?
+                    .equipment
+            }
+        };
+        list.get(self.index as usize)
+    }
+
+    /// Resolve an anchor slot against `building`.
+    pub fn anchor<'b>(&self, building: &'b Building) -> Option<&'b Anchor> {
+        let list = match (self.floor, self.wing, self.room) {
+            (None, _, _) => &building.anchors,
+            (Some(f), None, _) => &building.floors.get(f as usize)?.anchors,
+            (Some(f), Some(w), None) => {
+                &building
+                    .floors
+                    .get(f as usize)?
+                    .wings
+                    .get(w as usize)?
+                    .anchors
+            }
+            (Some(f), Some(w), Some(r)) => {
+                &building
+                    .floors
+                    .get(f as usize)?
+                    .wings
+                    .get(w as usize)?
+                    .rooms
+                    .get(r as usize)?
+                    .anchors
+            }
+        };
+        list.get(self.index as usize)
+    }
+
+    /// Resolve a room slot against `building`.
+    pub fn room<'b>(&self, building: &'b Building) -> Option<&'b Room> {
+        building
+            .floors
+            .get(self.floor? as usize)?
+            .wings
+            .get(self.wing? as usize)?
+            .rooms
+            .get(self.room? as usize)
+    }
+}
+
+/// Container list lengths and indexed geometry at build time, used to detect
+/// stale indexes.
+#[derive(Debug, Clone, Copy, PartialEq, Eq, Default)]
+struct IndexCensus {
+    floors: usize,
+    wings: usize,
+    rooms: usize,
+    equipment: usize,
+    anchors: usize,
+    /// Hash of every indexed position, room box and equipment address, so
+    /// in-place moves through the public fields invalidate the index too.
+    geometry: u64,
+}
+
+impl IndexCensus {
+    /// O(items): hashes everything [`BuildingSpatialIndex::build`] reads.
+    fn of(building: &Building) -> Self {
+        let mut census = IndexCensus {
+            floors: building.floors.len(),
+            anchors: building.anchors.len(),
+            ..Default::default()
+        };
+        let mut hasher = DefaultHasher::new();
+        let equipment = |items: &[Equipment], hasher: &mut DefaultHasher| {
+            for eq in items {
+                hash_position(hasher, &eq.position);
+                eq.address.as_ref().map(|a| a.path.as_str()).hash(hasher);
+            }
+            items.len()
+        };
+        let anchors = |items: &[Anchor], hasher: &mut DefaultHasher| {
+            for anchor in items {
+                hash_position(hasher, &anchor.position);
+            }
+            items.len()
+        };
+        anchors(&building.anchors, &mut hasher);
+        for floor in &building.floors {
+            census.wings += floor.wings.len();
+            census.equipment += equipment(&floor.equipment, &mut hasher);
+            census.anchors += anchors(&floor.anchors, &mut hasher);
+            for wing in &floor.wings {
+                census.rooms += wing.rooms.len();
+                census.equipment += equipment(&wing.equipment, &mut hasher);
+                census.anchors += anchors(&wing.anchors, &mut hasher);
+                for room in &wing.rooms {
+                    census.equipment += equipment(&room.equipment, &mut hasher);
+                    census.anchors += anchors(&room.anchors, &mut hasher);
+                    let spatial = &room.spatial_properties;
+                    hash_position(&mut hasher, &spatial.position);
+                    hash_position(&mut hasher, &spatial.bounding_box.min);
+                    hash_position(&mut hasher, &spatial.bounding_box.max);
+                }
+            }
+        }
+        census.geometry = hasher.finish();
+        census
+    }
+}
+
+fn hash_position(hasher: &mut DefaultHasher, position: &Position) {
+    for coordinate in [position.x, position.y, position.z] {
+        hasher.write_u64(coordinate.to_bits());
+    }
+}
+
+fn point_of(position: &Position) -> Option<[f64; 3]> {
+    let p = [position.x, position.y, position.z];
+    // Non-finite coordinates can never satisfy a distance query
+    p.iter().all(|v| v.is_finite()).then_some(p)
+}
+
+/// Bulk-loaded R-trees over one snapshot of a [`Building`].
+pub struct BuildingSpatialIndex {
+    census: IndexCensus,
+    room_boxes: RTree<BoxEntry>,
+    room_points: RTree<PointEntry>,
+    equipment: RTree<PointEntry>,
+    anchors: RTree<PointEntry>,
+    equipment_addresses: AddressTrie<Vec<EntitySlot>>,
+}
+
+impl BuildingSpatialIndex {
+    /// Index every room, equipment item and anchor of `building`.
+    pub fn build(building: &Building) -> Self {
+        let mut room_boxes = Vec::new();
+        let mut room_points = Vec::new();
+        let mut equipment = Vec::new();
+        let mut anchors = Vec::new();
+        let mut equipment_addresses = AddressTrie::new();
+
+        let mut push_addresses = |items: &[Equipment], slot: EntitySlot| {
+            for (i, eq) in items.iter().enumerate() {
+                if let Some(address) = &eq.address {
+                    let slots = equipment_addresses.get_or_insert_with(&address.path, Vec::new);
+                    slots.push(EntitySlot {
+                        index: i as u32,
+                        ..slot
+                    });
+                }
+            }
+        };
+        let push_points = |out: &mut Vec<PointEntry>,
+                           positions: &mut dyn Iterator<Item = &Position>,
+                           slot: EntitySlot| {
+            for (i, position) in positions.enumerate() {
+                if let Some(p) = point_of(position) {
+                    out.push(GeomWithData::new(
+                        p,
+                        EntitySlot {
+                            index: i as u32,
+                            ..slot
+                        },
+                    ));
+                }
+            }
+        };
+
+        let top = EntitySlot {
+            floor: None,
+            wing: None,
+            room: None,
+            index: 0,
+        };
+        push_points(
+            &mut anchors,
+            &mut building.anchors.iter().map(|a| &a.position),
+            top,
+        );
+
+        for (f, floor) in building.floors.iter().enumerate() {
+            let on_floor = EntitySlot {
+                floor: Some(f as u32),
+                ..top
+            };
+            push_addresses(&floor.equipment, on_floor);
+            push_points(
+                &mut equipment,
+                &mut floor.equipment.iter().map(|e| &e.position),
+                on_floor,
+            );
+            push_points(
+                &mut anchors,
+                &mut floor.anchors.iter().map(|a| &a.position),
+                on_floor,
+            );
+
+            for (w, wing) in floor.wings.iter().enumerate() {
+                let on_wing = EntitySlot {
+                    wing: Some(w as u32),
+                    ..on_floor
+                };
+                push_addresses(&wing.equipment, on_wing);
+                push_points(
+                    &mut equipment,
+                    &mut wing.equipment.iter().map(|e| &e.position),
+                    on_wing,
+                );
+                push_points(
+                    &mut anchors,
+                    &mut wing.anchors.iter().map(|a| &a.position),
+                    on_wing,
+                );
+
+                for (r, room) in wing.rooms.iter().enumerate() {
+                    let in_room = EntitySlot {
+                        room: Some(r as u32),
+                        ..on_wing
+                    };
+                    push_addresses(&room.equipment, in_room);
+                    push_points(
+                        &mut equipment,
+                        &mut room.equipment.iter().map(|e| &e.position),
+                        in_room,
+                    );
+                    push_points(
+                        &mut anchors,
+                        &mut room.anchors.iter().map(|a| &a.position),
+                        in_room,
+                    );
+
+                    let spatial = &room.spatial_properties;
+                    if let Some(p) = point_of(&spatial.position) {
+                        room_points.push(GeomWithData::new(p, in_room));
+                    }
+                    let bbox = &spatial.bounding_box;
+                    if let (Some(min), Some(max)) = (point_of(&bbox.min), point_of(&bbox.max)) {
+                        room_boxes.push(GeomWithData::new(
+                            Rectangle::from_corners(min, max),
+                            in_room,
+                        ));
+                    }
+                }
+            }
+        }
+
+        Self {
+            census: IndexCensus::of(building),
+            room_boxes: RTree::bulk_load(room_boxes),
+            room_points: RTree::bulk_load(room_points),
+            equipment: RTree::bulk_load(equipment),
+            anchors: RTree::bulk_load(anchors),
+            equipment_addresses,
+        }
+    }
+
+    /// True when the containers and geometry of `building` still match this index.
+    pub fn matches(&self, building: &Building) -> bool {
+        self.census == IndexCensus::of(building)
+    }
+
+    /// Equipment slots within `radius` of `center`, in traversal order.
+    pub fn equipment_within(&self, center: Point3D, radius: f64) -> Vec<EntitySlot> {
+        within(&self.equipment, center, radius)
+    }
+
+    /// Anchor slots within `radius` of `center`, in traversal order.
+    pub fn anchors_within(&self, center: Point3D, radius: f64) -> Vec<EntitySlot> {
+        within(&self.anchors, center, radius)
+    }
+
+    /// Room slots whose reference position is within `radius` of `center`.
+    pub fn rooms_within(&self, center: Point3D, radius: f64) -> Vec<EntitySlot> {
+        within(&self.room_points, center, radius)
+    }
+
+    /// Nearest equipment item to `center` (ties broken by traversal order).
+    pub fn nearest_equipment(&self, center: Point3D) -> Option<(EntitySlot, f64)> {
+        nearest(&self.equipment, center, |_| true)
+    }
+
+    /// Nearest equipment item whose slot satisfies `keep`.
+    pub fn nearest_equipment_matching(
+        &self,
+        center: Point3D,
+        keep: impl Fn(&EntitySlot) -> bool,
+    ) -> Option<(EntitySlot, f64)> {
+        nearest(&self.equipment, center, keep)
+    }
+
+    /// Room whose reference position is nearest to `center`.
+    pub fn nearest_room(&self, center: Point3D) -> Option<(EntitySlot, f64)> {
+        nearest(&self.room_points, center, |_| true)
+    }
+
+    /// Rooms whose bounding box contains `point`, in traversal order.
+    pub fn rooms_containing(&self, point: Point3D) -> Vec<EntitySlot> {
+        let mut slots: Vec<EntitySlot> = self
+            .room_boxes
+            .locate_all_at_point(&[point.x, point.y, point.z])
+            .map(|entry| entry.data)
+            .collect();
+        slots.sort_unstable();
+        slots
+    }
+
+    /// Rooms whose bounding box intersects the box `[min, max]`.
+    pub fn rooms_intersecting(&self, min: Point3D, max: Point3D) -> Vec<EntitySlot> {
+        let envelope = AABB::from_corners([min.x, min.y, min.z], [max.x, max.y, max.z]);
+        let mut slots: Vec<EntitySlot> = self
+            .room_boxes
+            .locate_in_envelope_intersecting(&envelope)
+            .map(|entry| entry.data)
+            .collect();
+        slots.sort_unstable();
+        slots
+    }
+
+    /// Equipment slots whose durable address matches `pattern`, in traversal order.
+    pub fn equipment_matching(&self, pattern: &AddressPattern) -> Vec<EntitySlot> {
+        let mut slots: Vec<EntitySlot> = self
+            .equipment_addresses
+            .matching(pattern)
+            .into_iter()
+            .flat_map(|(_, slots)| slots.iter().copied())
+            .collect();
+        slots.sort_unstable();
+        slots
+    }
+
+    /// Equipment positioned inside the box `[min, max]`.
+    pub fn equipment_in_box(&self, min: Point3D, max: Point3D) -> Vec<EntitySlot> {
+        let envelope = AABB::from_corners([min.x, min.y, min.z], [max.x, max.y, max.z]);
+        let mut slots: Vec<EntitySlot> = self
+            .equipment
+            .locate_in_envelope(&envelope)
+            .map(|entry| entry.data)
+            .collect();
+        slots.sort_unstable();
+        slots
+    }
+}
+
+fn within(tree: &RTree<PointEntry>, center: Point3D, radius: f64) -> Vec<EntitySlot> {
+    if radius.is_nan() || radius < 0.0 {
+        return Vec::new();
+    }
+    // Slightly generous squared radius; callers re-check the exact distance
+    let max_squared = radius * radius * (1.0 + 1e-9) + f64::MIN_POSITIVE;
+    let mut slots: Vec<EntitySlot> = tree
+        .locate_within_distance([center.x, center.y, center.z], max_squared)
+        .map(|entry| entry.data)
+        .collect();
+    slots.sort_unstable();
+    slots
+}
+
+fn nearest(
+    tree: &RTree<PointEntry>,
+    center: Point3D,
+    keep: impl Fn(&EntitySlot) -> bool,
+) -> Option<(EntitySlot, f64)> {
+    let query = [center.x, center.y, center.z];
+    let mut candidates = tree
+        .nearest_neighbor_iter_with_distance_2(&query)
+        .filter(|(entry, _)| keep(&entry.data));
+    let (first, best) = candidates.next()?;
+    let slot = candidates
+        .take_while(|(_, d2)| *d2 <= best)
+        .fold(first.data, |slot, (entry, _)| slot.min(entry.data));
+    Some((slot, best.sqrt()))
+}
+
+/// Lazily built, shareable index slot held by [`Building`].
+#[derive(Default)]
+pub(crate) struct SpatialIndexCache(RwLock<Option<Arc<BuildingSpatialIndex>>>);
+
+impl SpatialIndexCache {
+    /// Current index for `building`, rebuilding it when missing or stale.
+    pub(crate) fn get_or_build(&self, building: &Building) -> Arc<BuildingSpatialIndex> {
+        if let Ok(guard) = self.0.read() {
+            if let Some(index) = guard.as_ref().filter(|index| index.matches(building)) {
+                return Arc::clone(index);
+            }
+        }
+        let index = Arc::new(BuildingSpatialIndex::build(building));
+        if let Ok(mut guard) = self.0.write() {
+            *guard = Some(Arc::clone(&index));
+        }
+        index
+    }
+
+    pub(crate) fn clear(&mut self) {
+        if let Ok(slot) = self.0.get_mut() {
+            *slot = None;
+        }
+    }
+}
+
+impl Clone for SpatialIndexCache {
+    fn clone(&self) -> Self {
+        // Clones are usually edited through the public fields right away,
+        // which the census cannot always see; let them index themselves.
+        Self::default()
+    }
+}
+
+impl std::fmt::Debug for SpatialIndexCache {
+    fn fmt(&self, f: &mut std::fmt::Formatter<'_>) -> std::fmt::Result {
+        let built = self.0.read().map(|guard| guard.is_some()).unwrap_or(false);
+        f.debug_struct("SpatialIndexCache")
+            .field("built", &built)
+            .finish()
+    }
+}
@@ -1,4 +1,5 @@
 use crate::core::spatial::mesh::Mesh;
+use crate::core::spatial::types::Point3D;
 use crate::core::{Building, Equipment, Floor, Room};
 use crate::ifc::mapping::{
     entity_kind, identity_property_map, lidar_enrichment_to_pset, properties_for_export,
@@ -8,13 +9,68 @@ use crate::ifc::mapping::{
 use anyhow::Result;
 use chrono::Utc;
 
+use flate2::write::GzEncoder;
+use flate2::Compression;
+use std::collections::hash_map::DefaultHasher;
 use std::collections::HashMap;
+use std::fmt;
 use std::fs::File;
+use std::hash::Hasher;
 use std::io::{BufWriter, Write};
 use std::path::Path;
 use uuid::Uuid;
 
+/// Output buffer size. Large blocks keep syscalls (and compressor or socket
+/// writes) off the per-entity path.
+const WRITE_BUFFER_BYTES: usize = 1 << 20;
+
+/// STEP REAL formatted shortest-roundtrip via `ryu`.
+///
+/// STEP requires a decimal point and an upper-case exponent marker, so
+/// `1e-7` is written as `1.0E-7`. Non-finite values have no STEP spelling
+/// and are written as `0.0`.
+struct Real(f64);
+
+impl fmt::Display for Real {
+    fn fmt(&self, f: &mut fmt::Formatter<'_>) -> fmt::Result {
+        if !self.0.is_finite() {
+            return f.write_str("0.0");
+        }
+        let mut buffer = ryu::Buffer::new();
+        let text = buffer.format_finite(self.0);
+        match text.split_once('e') {
+            None => f.write_str(text),
+            Some((mantissa, exponent)) => {
+                f.write_str(mantissa)?;
+                if !mantissa.contains('.') {
+                    f.write_str(".0")?;
+                }
+                f.write_str("E")?;
+                f.write_str(exponent)
+            }
+        }
+    }
+}
+
+/// Comma-separated STEP references (`#1,#2,#3`) without an intermediate `String`.
+struct Refs<'a>(&'a [usize]);
+
+impl fmt::Display for Refs<'_> {
+    fn fmt(&self, f: &mut fmt::Formatter<'_>) -> fmt::Result {
+        for (i, id) in self.0.iter().enumerate() {
+            if i > 0 {
+                f.write_str(",")?;
+            }
+            write!(f, "#{}", id)?;
+        }
+        Ok(())
+    }
+}
+
 /// Helper struct to handle STEP file formatting and ID generation
+///
+/// Entities are formatted straight into a large `BufWriter`, so nothing is
+/// allocated per entity and `W` can be a file, a compressor or a socket.
 struct StepWriter<W: Write> {
     writer: BufWriter<W>,
     next_id: usize,
@@ -22,12 +78,32 @@ struct StepWriter<W: Write> {
 
 impl<W: Write> StepWriter<W> {
     fn new(inner: W) -> Self {
+        Self::starting_at(inner, 1)
+    }
+
+    /// Writer whose first entity gets `#next_id` (incremental export blocks).
+    fn starting_at(inner: W, next_id: usize) -> Self {
+        Self {
+            writer: BufWriter::with_capacity(WRITE_BUFFER_BYTES, inner),
+            next_id,
+        }
+    }
+
+    /// Writer for an in-memory sink (e.g. a `Vec`), which needs no buffer:
+    /// with zero capacity every write goes straight through to `inner`.
+    fn unbuffered_at(inner: W, next_id: usize) -> Self {
         Self {
-            writer: BufWriter::new(inner),
-            next_id: 1,
+            writer: BufWriter::with_capacity(0, inner),
+            next_id,
         }
     }
 
+    /// Copy an already formatted block of entity lines.
+    fn write_raw(&mut self, block: &[u8]) -> Result<()> {
+        self.writer.write_all(block)?;
+        Ok(())
+    }
+
     /// Write the standard IFC header
     fn write_header(&mut self, filename: &str) -> Result<()> {
         writeln!(self.writer, "ISO-10303-21;")?;
@@ -55,6 +131,13 @@ impl<W: Write> StepWriter<W> {
         Ok(())
     }
 
+    /// Flush buffered output and hand back the sink (e.g. to finish a compressor).
+    fn finish(self) -> Result<W> {
+        self.writer
+            .into_inner()
+            .map_err(|e| anyhow::Error::new(e.into_error()))
+    }
+
     /// Generate a new STEP ID (e.g., #1)
     fn next_id(&mut self) -> usize {
         let id = self.next_id;
@@ -62,31 +145,24 @@ impl<W: Write> StepWriter<W> {
         id
     }
 
-    /// Write a raw STEP line
-    #[allow(dead_code)]
-    fn write_line(&mut self, _id: usize, content: &str) -> Result<()> {
-        writeln!(self.writer, "#{};", content)?;
-        // writeln!(self.writer, "#{}= {};", id, content)?; // Correct format is #1= IFCTYPE(...);
-        Ok(())
-    }
-
-    fn write_cartesian_point_list_3d(&mut self, points: &[[f64; 3]]) -> Result<usize> {
+    fn write_cartesian_point_list_3d(&mut self, points: &[Point3D]) -> Result<usize> {
         let id = self.next_id();
         write!(self.writer, "#{}= IFCCARTESIANPOINTLIST3D((", id)?;
         for (i, p) in points.iter().enumerate() {
             if i > 0 {
-                write!(self.writer, ",")?;
+                self.writer.write_all(b",")?;
             }
-            write!(self.writer, "({:.4},{:.4},{:.4})", p[0], p[1], p[2])?;
+            write!(self.writer, "({},{},{})", Real(p.x), Real(p.y), Real(p.z))?;
         }
-        writeln!(self.writer, "));")?;
+        self.writer.write_all(b"));\n")?;
         Ok(id)
     }
 
+    /// Write a face set from flat triangle indices (incomplete trailing triples are skipped).
     fn write_triangulated_face_set(
         &mut self,
         coordinates_id: usize,
-        indices: &[[u32; 3]],
+        indices: &[u32],
     ) -> Result<usize> {
         let id = self.next_id();
         write!(
@@ -94,9 +170,9 @@ impl<W: Write> StepWriter<W> {
             "#{}= IFCTRIANGULATEDFACESET(#{},(),.T.,(",
             id, coordinates_id
         )?;
-        for (i, tri) in indices.iter().enumerate() {
+        for (i, tri) in indices.chunks_exact(3).enumerate() {
             if i > 0 {
-                write!(self.writer, ",")?;
+                self.writer.write_all(b",")?;
             }
             // IFC indices are 1-based
             write!(
@@ -107,18 +183,133 @@ impl<W: Write> StepWriter<W> {
                 tri[2] + 1
             )?;
         }
-        writeln!(self.writer, "));")?;
+        self.writer.write_all(b"));\n")?;
         Ok(id)
     }
 
     /// Write an entity and return its ID
-    fn write_entity(&mut self, content: String) -> Result<usize> {
+    fn write_entity(&mut self, content: fmt::Arguments<'_>) -> Result<usize> {
         let id = self.next_id();
         writeln!(self.writer, "#{}= {};", id, content)?;
         Ok(id)
     }
 }
 
+/// Entity lines emitted for one subtree, keyed by a fingerprint of its source.
+struct CachedBlock {
+    fingerprint: u64,
+    bytes: Vec<u8>,
+    /// Id of the block's root entity (owner history, building or storey).
+    root_id: usize,
+    /// Number of STEP ids the block occupies.
+    id_count: usize,
+}
+
+/// Previously emitted STEP blocks, retained between exports of one building.
+///
+/// Each block keeps the ids it was first written with. Changed subtrees are
+/// re-emitted with fresh ids above every id in use; STEP allows gaps, so
+/// unchanged blocks are copied verbatim. When gaps outgrow the live ids,
+/// the next export starts over from `#1`.
+#[derive(Default)]
+pub struct IfcExportCache {
+    owner_history: Option<CachedBlock>,
+    prelude: Option<CachedBlock>,
+    floors: HashMap<String, CachedBlock>,
+    floor_links: Option<CachedBlock>,
+    next_id: usize,
+}
+
+/// What an incremental export reused and what it rewrote.
+#[derive(Debug, Clone, Copy, Default, PartialEq, Eq)]
+pub struct IncrementalExportStats {
+    pub floors_reused: usize,
+    pub floors_rewritten: usize,
+    /// True when the cache was empty or compacted and everything was re-emitted.
+    pub full_rewrite: bool,
+}
+
+impl IfcExportCache {
+    pub fn new() -> Self {
+        Self::default()
+    }
+
+    fn live_ids(&self) -> usize {
+        self.owner_history.iter().map(|b| b.id_count).sum::<usize>()
+            + self.prelude.iter().map(|b| b.id_count).sum::<usize>()
+            + self.floors.values().map(|b| b.id_count).sum::<usize>()
+            + self.floor_links.iter().map(|b| b.id_count).sum::<usize>()
+    }
+
+    /// Renumbering threshold: restart once dead ids dominate the id space.
+    fn needs_compaction(&self) -> bool {
+        self.next_id > 2 * self.live_ids() + 4096
+    }
+
+    /// Reuse `slot` if its fingerprint matches, else render a fresh block.
+    fn block<F>(
+        slot: &mut Option<CachedBlock>,
+        next_id: &mut usize,
+        fingerprint: u64,
+        render: F,
+    ) -> Result<(usize, bool)>
+    where
+        F: FnOnce(&mut StepWriter<Vec<u8>>) -> Result<usize>,
+    {
+        if let Some(block) = slot.as_ref().filter(|b| b.fingerprint == fingerprint) {
+            return Ok((block.root_id, true));
+        }
+        let first_id = *next_id;
+        let mut writer = StepWriter::unbuffered_at(Vec::new(), first_id);
+        let root_id = render(&mut writer)?;
+        *next_id = writer.next_id;
+        *slot = Some(CachedBlock {
+            fingerprint,
+            bytes: writer.finish()?,
+            root_id,
+            id_count: *next_id - first_id,
+        });
+        Ok((root_id, false))
+    }
+}
+
+/// `io::Write` adapter feeding a hasher, so fingerprints need no buffer.
+struct HashWriter(DefaultHasher);
+
+impl Write for HashWriter {
+    fn write(&mut self, buf: &[u8]) -> std::io::Result<usize> {
+        self.0.write(buf);
+        Ok(buf.len())
+    }
+
+    fn flush(&mut self) -> std::io::Result<()> {
+        Ok(())
+    }
+}
+
+/// Stable fingerprint of a serializable value (maps serialize sorted).
+fn fingerprint<T: serde::Serialize + ?Sized>(hasher: &mut HashWriter, value: &T) -> Result<()> {
+    serde_json::to_writer(hasher, value)?;
+    Ok(())
+}
+
+/// Fingerprint of everything `export_floor` reads.
+///
+/// YAML serialization of floors, wings and rooms lists equipment by id
+/// only, so equipment bodies are hashed separately.
+fn floor_fingerprint(floor: &Floor) -> Result<u64> {
+    let mut hasher = HashWriter(DefaultHasher::new());
+    fingerprint(&mut hasher, floor)?;
+    for wing in &floor.wings {
+        for room in &wing.rooms {
+            fingerprint(&mut hasher, &room.equipment)?;
+        }
+        fingerprint(&mut hasher, &wing.equipment)?;
+    }
+    fingerprint(&mut hasher, &floor.equipment)?;
+    Ok(hasher.0.finish())
+}
+
 pub struct IFCExporter {
     building: Building,
 }
@@ -128,23 +319,167 @@ impl IFCExporter {
         Self { building }
     }
 
+    /// Export to `output_path`; a `.gz` extension writes a gzip-compressed file.
     pub fn export(&self, output_path: &Path) -> Result<()> {
+        let _timer = crate::telemetry::time(crate::telemetry::Phase::IfcExport);
         let file = File::create(output_path)?;
-        let mut writer = StepWriter::new(file);
-
-        writer.write_header(
-            output_path
-                .file_name()
-                .unwrap_or_default()
-                .to_string_lossy()
-                .as_ref(),
-        )?;
+        let filename = output_path
+            .file_name()
+            .unwrap_or_default()
+            .to_string_lossy()
+            .into_owned();
+
+        let is_gzip = output_path
+            .extension()
+            .is_some_and(|ext| ext.eq_ignore_ascii_case("gz"));
+        if is_gzip {
+            let encoder =
+                self.export_to_writer(GzEncoder::new(file, Compression::default()), &filename)?;
+            encoder.finish()?;
+        } else {
+            self.export_to_writer(file, &filename)?;
+        }
+        Ok(())
+    }
+
+    /// Stream the STEP file into any sink (file, compressor, socket, …).
+    ///
+    /// Output is buffered in large blocks and never held in memory as a
+    /// whole. Returns the sink once everything is flushed so callers can
+    /// finalize it.
+    pub fn export_to_writer<W: Write>(&self, sink: W, filename: &str) -> Result<W> {
+        let mut writer = StepWriter::new(sink);
+        writer.write_header(filename)?;
 
         // 1. Create Owner History (required for most entities)
         let owner_history_id = self.create_owner_history(&mut writer)?;
 
-        // ... (rest of export logic) ...
-        self.export_content(&mut writer, owner_history_id)
+        self.export_content(&mut writer, owner_history_id)?;
+        writer.finish()
+    }
+
+    /// Export to `output_path`, rewriting only subtrees changed since the
+    /// export that filled `cache`.
+    ///
+    /// Storeys are compared by fingerprint under their `Floor::id`;
+    /// unchanged storeys are copied from the cache byte-for-byte, including
+    /// their STEP ids and relationship GUIDs.
+    pub fn export_incremental(
+        &self,
+        output_path: &Path,
+        cache: &mut IfcExportCache,
+    ) -> Result<IncrementalExportStats> {
+        let filename = output_path
+            .file_name()
+            .unwrap_or_default()
+            .to_string_lossy()
+            .into_owned();
+        let file = File::create(output_path)?;
+        let (_, stats) = self.export_incremental_to_writer(file, &filename, cache)?;
+        Ok(stats)
+    }
+
+    /// [`Self::export_incremental`] into any sink; returns it once flushed.
+    pub fn export_incremental_to_writer<W: Write>(
+        &self,
+        sink: W,
+        filename: &str,
+        cache: &mut IfcExportCache,
+    ) -> Result<(W, IncrementalExportStats)> {
+        let mut stats = IncrementalExportStats::default();
+        if cache.next_id == 0 || cache.needs_compaction() {
+            *cache = IfcExportCache {
+                next_id: 1,
+                ..IfcExportCache::default()
+            };
+            stats.full_rewrite = true;
+        }
+
+        let building = &self.building;
+        let mut prelude_hasher = HashWriter(DefaultHasher::new());
+        fingerprint(
+            &mut prelude_hasher,
+            &(
+                &building.name,
+                &building.id,
+                &building.ifc_global_id,
+                &building.metadata,
+            ),
+        )?;
+        let prelude_fingerprint = prelude_hasher.0.finish();
+
+        // Owner history content is constant; every block refers to its id.
+        let (owner_history_id, _) =
+            IfcExportCache::block(&mut cache.owner_history, &mut cache.next_id, 0, |w| {
+                self.create_owner_history(w)
+            })?;
+        let (building_id, _) = IfcExportCache::block(
+            &mut cache.prelude,
+            &mut cache.next_id,
+            prelude_fingerprint,
+            |w| self.export_prelude(w, owner_history_id),
+        )?;
+
+        let mut previous = std::mem::take(&mut cache.floors);
+        let mut floor_ids = Vec::with_capacity(building.floors.len());
+        let mut order = Vec::with_capacity(building.floors.len());
+        for floor in &building.floors {
+            if cache.floors.contains_key(&floor.id) {
+                // Duplicate floor id: emit uncached rather than alias a block.
+                let mut writer = StepWriter::unbuffered_at(Vec::new(), cache.next_id);
+                floor_ids.push(self.export_floor(&mut writer, floor, owner_history_id)?);
+                cache.next_id = writer.next_id;
+                order.push(Err(writer.finish()?));
+                stats.floors_rewritten += 1;
+                continue;
+            }
+            let mut slot = previous.remove(&floor.id);
+            let (floor_id, reused) = IfcExportCache::block(
+                &mut slot,
+                &mut cache.next_id,
+                floor_fingerprint(floor)?,
+                |w| self.export_floor(w, floor, owner_history_id),
+            )?;
+            if reused {
+                stats.floors_reused += 1;
+            } else {
+                stats.floors_rewritten += 1;
+            }
+            floor_ids.push(floor_id);
+            if let Some(block) = slot {
+                cache.floors.insert(floor.id.clone(), block);
+            }
+            order.push(Ok(floor.id.as_str()));
+        }
+
+        let mut links_hasher = HashWriter(DefaultHasher::new());
+        fingerprint(&mut links_hasher, &(building_id, &floor_ids))?;
+        IfcExportCache::block(
+            &mut cache.floor_links,
+            &mut cache.next_id,
+            links_hasher.0.finish(),
+            |w| {
+                self.export_floor_links(w, building_id, floor_ids, owner_history_id)?;
+                Ok(building_id)
+            },
+        )?;
+
+        let mut writer = StepWriter::new(sink);
+        writer.write_header(filename)?;
+        for block in [&cache.owner_history, &cache.prelude].into_iter().flatten() {
+            writer.write_raw(&block.bytes)?;
+        }
+        for entry in &order {
+            match entry {
+                Ok(floor_key) => writer.write_raw(&cache.floors[*floor_key].bytes)?,
+                Err(uncached) => writer.write_raw(uncached)?,
+            }
+        }
+        if let Some(block) = &cache.floor_links {
+            writer.write_raw(&block.bytes)?;
+        }
+        writer.write_footer()?;
+        Ok((writer.finish()?, stats))
     }
 
     /// Collect universal paths for tracked entities (Equipment and Rooms).
@@ -177,6 +512,26 @@ impl IFCExporter {
         writer: &mut StepWriter<W>,
         owner_history_id: usize,
     ) -> Result<()> {
+        let building_id = self.export_prelude(writer, owner_history_id)?;
+
+        // 6. Process Floors (BuildingStoreys)
+        let mut floor_ids = Vec::new();
+        for floor in &self.building.floors {
+            floor_ids.push(self.export_floor(writer, floor, owner_history_id)?);
+        }
+
+        self.export_floor_links(writer, building_id, floor_ids, owner_history_id)?;
+
+        writer.write_footer()?;
+        Ok(())
+    }
+
+    /// Project, site and building plus their aggregations; returns the building id.
+    fn export_prelude<W: Write>(
+        &self,
+        writer: &mut StepWriter<W>,
+        owner_history_id: usize,
+    ) -> Result<usize> {
         // 2. Create Project
         let project_id = self.create_project(writer, &self.building, owner_history_id)?;
 
@@ -202,111 +557,72 @@ impl IFCExporter {
             owner_history_id,
         )?;
 
-        // 6. Process Floors (BuildingStoreys)
-        let mut floor_ids = Vec::new();
-        for floor in &self.building.floors {
-            let floor_id = self.create_building_storey(writer, floor, owner_history_id)?;
-            floor_ids.push(floor_id);
+        Ok(building_id)
+    }
 
-            // 7. Process Wings and Rooms
-            let mut room_ids = Vec::new();
+    /// One storey with its wings, rooms, equipment and relationships.
+    ///
+    /// Only `owner_history_id` is referenced from outside the block, which is
+    /// what lets incremental export reuse the emitted bytes verbatim.
+    fn export_floor<W: Write>(
+        &self,
+        writer: &mut StepWriter<W>,
+        floor: &Floor,
+        owner_history_id: usize,
+    ) -> Result<usize> {
+        let floor_id = self.create_building_storey(writer, floor, owner_history_id)?;
 
-            for wing in &floor.wings {
-                let mut zone_entity_ids = Vec::new();
+        // 7. Process Wings and Rooms
+        let mut room_ids = Vec::new();
 
-                for room in &wing.rooms {
-                    let room_id = self.create_space(
-                        writer,
-                        room,
-                        floor.elevation.unwrap_or(0.0),
-                        owner_history_id,
-                    )?;
-                    room_ids.push(room_id);
-                    zone_entity_ids.push(room_id);
+        for wing in &floor.wings {
+            let mut zone_entity_ids = Vec::new();
 
-                    // --- ADD PSETS FOR ROOM ---
-                    let identity = identity_property_map(&room.id, entity_kind::ROOM);
-                    self.create_property_set(
-                        writer,
-                        owner_history_id,
-                        room_id,
-                        PSET_ARX_IDENTITY,
-                        &identity,
-                    )?;
-                    if let Some(ref enrichment) = room.lidar_enrichment {
-                        let lidar_props = lidar_enrichment_to_pset(enrichment);
-                        self.create_property_set(
-                            writer,
-                            owner_history_id,
-                            room_id,
-                            PSET_ARX_LIDAR,
-                            &lidar_props,
-                        )?;
-                    }
-                    let mut room_props = properties_for_export(&room.properties, PSET_ARX_ROOM);
-                    room_props.insert(PROP_ARX_WING.to_string(), wing.name.clone());
+            for room in &wing.rooms {
+                let room_id = self.create_space(
+                    writer,
+                    room,
+                    floor.elevation.unwrap_or(0.0),
+                    owner_history_id,
+                )?;
+                room_ids.push(room_id);
+                zone_entity_ids.push(room_id);
+
+                // --- ADD PSETS FOR ROOM ---
+                let identity = identity_property_map(&room.id, entity_kind::ROOM);
+                self.create_property_set(
+                    writer,
+                    owner_history_id,
+                    room_id,
+                    PSET_ARX_IDENTITY,
+                    &identity,
+                )?;
+                if let Some(ref enrichment) = room.lidar_enrichment {
+                    let lidar_props = lidar_enrichment_to_pset(enrichment);
                     self.create_property_set(
                         writer,
                         owner_history_id,
                         room_id,
-                        PSET_ARX_ROOM,
-                        &room_props,
+                        PSET_ARX_LIDAR,
+                        &lidar_props,
                     )?;
-
-                    // Process Equipment in Room
-                    if !room.equipment.is_empty() {
-                        let mut equipment_ids = Vec::new();
-                        for equipment in &room.equipment {
-                            let eq_id =
-                                self.create_equipment(writer, equipment, owner_history_id)?;
-                            equipment_ids.push(eq_id);
-
-                            let identity =
-                                identity_property_map(&equipment.id, entity_kind::EQUIPMENT);
-                            self.create_property_set(
-                                writer,
-                                owner_history_id,
-                                eq_id,
-                                PSET_ARX_IDENTITY,
-                                &identity,
-                            )?;
-                            if let Some(ref enrichment) = equipment.lidar_enrichment {
-                                let lidar_props = lidar_enrichment_to_pset(enrichment);
-                                self.create_property_set(
-                                    writer,
-                                    owner_history_id,
-                                    eq_id,
-                                    PSET_ARX_LIDAR,
-                                    &lidar_props,
-                                )?;
-                            }
-                            let eq_props =
-                                properties_for_export(&equipment.properties, PSET_ARX_EQUIPMENT);
-                            self.create_property_set(
-                                writer,
-                                owner_history_id,
-                                eq_id,
-                                PSET_ARX_EQUIPMENT,
-                                &eq_props,
-                            )?;
-                        }
-                        self.create_containment(
-                            writer,
-                            room_id,
-                            equipment_ids,
-                            "RoomToEquipment",
-                            owner_history_id,
-                        )?;
-                    }
                 }
+                let mut room_props = properties_for_export(&room.properties, PSET_ARX_ROOM);
+                room_props.insert(PROP_ARX_WING.to_string(), wing.name.clone());
+                self.create_property_set(
+                    writer,
+                    owner_history_id,
+                    room_id,
+                    PSET_ARX_ROOM,
+                    &room_props,
+                )?;
 
-                // Process Wing-level Equipment
-                if !wing.equipment.is_empty() {
-                    let mut wing_equipment_ids = Vec::new();
-                    for equipment in &wing.equipment {
+                // Process Equipment in Room
+                if !room.equipment.is_empty() {
+                    let mut equipment_ids = Vec::new();
+                    for equipment in &room.equipment {
                         let eq_id = self.create_equipment(writer, equipment, owner_history_id)?;
-                        wing_equipment_ids.push(eq_id);
-                        zone_entity_ids.push(eq_id);
+                        equipment_ids.push(eq_id);
 
                         let identity = identity_property_map(&equipment.id, entity_kind::EQUIPMENT);
                         self.create_property_set(
@@ -326,9 +642,8 @@ impl IFCExporter {
                                 &lidar_props,
                             )?;
                         }
-                        let mut eq_props =
+                        let eq_props =
                             properties_for_export(&equipment.properties, PSET_ARX_EQUIPMENT);
-                        eq_props.insert(PROP_ARX_WING.to_string(), wing.name.clone());
                         self.create_property_set(
                             writer,
                             owner_history_id,
@@ -339,43 +654,21 @@ impl IFCExporter {
                     }
                     self.create_containment(
                         writer,
-                        floor_id,
-                        wing_equipment_ids,
-                        "FloorToWingEquipment",
+                        room_id,
+                        equipment_ids,
+                        "RoomToEquipment",
                         owner_history_id,
                     )?;
                 }
-
-                // Create standard IFCZONE for Wing grouping
-                if !zone_entity_ids.is_empty() {
-                    let zone_id = writer.write_entity(format!(
-                        "IFCZONE('{}',#{},'{}',$,$)",
-                        self.generate_guid(),
-                        owner_history_id,
-                        wing.name
-                    ))?;
-
-                    let related_refs = zone_entity_ids
-                        .iter()
-                        .map(|id| format!("#{}", id))
-                        .collect::<Vec<_>>()
-                        .join(",");
-                    writer.write_entity(format!(
-                        "IFCRELASSIGNSTOGROUP('{}',#{},'WingAssignment',$,({}),$,#{})",
-                        self.generate_guid(),
-                        owner_history_id,
-                        related_refs,
-                        zone_id
-                    ))?;
-                }
             }
 
-            // Process Floor-level Equipment
-            if !floor.equipment.is_empty() {
-                let mut floor_equipment_ids = Vec::new();
-                for equipment in &floor.equipment {
+            // Process Wing-level Equipment
+            if !wing.equipment.is_empty() {
+                let mut wing_equipment_ids = Vec::new();
+                for equipment in &wing.equipment {
                     let eq_id = self.create_equipment(writer, equipment, owner_history_id)?;
-                    floor_equipment_ids.push(eq_id);
+                    wing_equipment_ids.push(eq_id);
+                    zone_entity_ids.push(eq_id);
 
                     let identity = identity_property_map(&equipment.id, entity_kind::EQUIPMENT);
                     self.create_property_set(
@@ -395,7 +688,9 @@ impl IFCExporter {
                             &lidar_props,
                         )?;
                     }
-                    let eq_props = properties_for_export(&equipment.properties, PSET_ARX_EQUIPMENT);
+                    let mut eq_props =
+                        properties_for_export(&equipment.properties, PSET_ARX_EQUIPMENT);
+                    eq_props.insert(PROP_ARX_WING.to_string(), wing.name.clone());
                     self.create_property_set(
                         writer,
                         owner_history_id,
@@ -407,25 +702,90 @@ impl IFCExporter {
                 self.create_containment(
                     writer,
                     floor_id,
-                    floor_equipment_ids,
-                    "FloorToEquipment",
+                    wing_equipment_ids,
+                    "FloorToWingEquipment",
                     owner_history_id,
                 )?;
             }
 
-            // Link Floor -> Rooms (Aggregation)
-            if !room_ids.is_empty() {
-                self.create_aggregation(
+            // Create standard IFCZONE for Wing grouping
+            if !zone_entity_ids.is_empty() {
+                let zone_id = writer.write_entity(format_args!(
+                    "IFCZONE('{}',#{},'{}',$,$)",
+                    self.generate_guid(),
+                    owner_history_id,
+                    wing.name
+                ))?;
+
+                writer.write_entity(format_args!(
+                    "IFCRELASSIGNSTOGROUP('{}',#{},'WingAssignment',$,({}),$,#{})",
+                    self.generate_guid(),
+                    owner_history_id,
+                    Refs(&zone_entity_ids),
+                    zone_id
+                ))?;
+            }
+        }
+
+        // Process Floor-level Equipment
+        if !floor.equipment.is_empty() {
+            let mut floor_equipment_ids = Vec::new();
+            for equipment in &floor.equipment {
+                let eq_id = self.create_equipment(writer, equipment, owner_history_id)?;
+                floor_equipment_ids.push(eq_id);
+
+                let identity = identity_property_map(&equipment.id, entity_kind::EQUIPMENT);
+                self.create_property_set(
+                    writer,
+                    owner_history_id,
+                    eq_id,
+                    PSET_ARX_IDENTITY,
+                    &identity,
+                )?;
+                if let Some(ref enrichment) = equipment.lidar_enrichment {
+                    let lidar_props = lidar_enrichment_to_pset(enrichment);
+                    self.create_property_set(
+                        writer,
+                        owner_history_id,
+                        eq_id,
+                        PSET_ARX_LIDAR,
+                        &lidar_props,
+                    )?;
+                }
+                let eq_props = properties_for_export(&equipment.properties, PSET_ARX_EQUIPMENT);
+                self.create_property_set(
                     writer,
-                    floor_id,
-                    room_ids,
-                    "FloorToRooms",
                     owner_history_id,
+                    eq_id,
+                    PSET_ARX_EQUIPMENT,
+                    &eq_props,
                 )?;
             }
+            self.create_containment(
+                writer,
+                floor_id,
+                floor_equipment_ids,
+                "FloorToEquipment",
+                owner_history_id,
+            )?;
         }
 
-        // Link Building -> Floors
+        // Link Floor -> Rooms (Aggregation)
+        if !room_ids.is_empty() {
+            self.create_aggregation(writer, floor_id, room_ids, "FloorToRooms", owner_history_id)?;
+        }
+
+        Ok(floor_id)
+    }
+
+    /// Link Building -> Floors
+    fn export_floor_links<W: Write>(
+        &self,
+        writer: &mut StepWriter<W>,
+        building_id: usize,
+        floor_ids: Vec<usize>,
+        owner_history_id: usize,
+    ) -> Result<()> {
         if !floor_ids.is_empty() {
             self.create_aggregation(
                 writer,
@@ -435,8 +795,6 @@ impl IFCExporter {
                 owner_history_id,
             )?;
         }
-
-        writer.write_footer()?;
         Ok(())
     }
 
@@ -444,23 +802,25 @@ impl IFCExporter {
 
     fn create_owner_history<W: Write>(&self, writer: &mut StepWriter<W>) -> Result<usize> {
         // Minimal OwnerHistory setup
-        let person_id = writer.write_entity("IFCPERSON($,'ArxOS','User',$,$,$,$,$)".to_string())?;
-        let org_id = writer.write_entity("IFCORGANIZATION($,'ArxOS',$,$,$)".to_string())?;
-        let person_and_org_id = writer.write_entity(format!(
+        let person_id =
+            writer.write_entity(format_args!("IFCPERSON($,'ArxOS','User',$,$,$,$,$)"))?;
+        let org_id = writer.write_entity(format_args!("IFCORGANIZATION($,'ArxOS',$,$,$)"))?;
+        let person_and_org_id = writer.write_entity(format_args!(
             "IFCPERSONANDORGANIZATION(#{},#{},$)",
             person_id, org_id
         ))?;
-        let _app_id = writer.write_entity(
-            "IFCAPPLICATION(#{},'1.0','ArxOS','ArxOS')"
-                .to_string()
-                .replace("#{}", &format!("#{}", org_id)),
-        )?; // Fix: org_id ref
+        let _app_id = writer.write_entity(format_args!(
+            "IFCAPPLICATION(#{},'1.0','ArxOS','ArxOS')",
+            org_id
+        ))?; // Fix: org_id ref
 
         // Correct Application ref
-        let app_id =
-            writer.write_entity(format!("IFCAPPLICATION(#{},'1.0','ArxOS','ArxOS')", org_id))?;
+        let app_id = writer.write_entity(format_args!(
+            "IFCAPPLICATION(#{},'1.0','ArxOS','ArxOS')",
+            org_id
+        ))?;
 
-        writer.write_entity(format!(
+        writer.write_entity(format_args!(
             "IFCOWNERHISTORY(#{},#{},.READWRITE.,.NOCHANGE.,$,$,$,$)",
             person_and_org_id, app_id
         ))
@@ -473,26 +833,27 @@ impl IFCExporter {
         owner_hist: usize,
     ) -> Result<usize> {
         // Units
-        let length_unit = writer.write_entity("IFCSIUNIT(*,.LENGTHUNIT.,$,.METRE.)".to_string())?;
+        let length_unit =
+            writer.write_entity(format_args!("IFCSIUNIT(*,.LENGTHUNIT.,$,.METRE.)"))?;
         let area_unit =
-            writer.write_entity("IFCSIUNIT(*,.AREAUNIT.,$,.SQUARE_METRE.)".to_string())?;
+            writer.write_entity(format_args!("IFCSIUNIT(*,.AREAUNIT.,$,.SQUARE_METRE.)"))?;
         let volume_unit =
-            writer.write_entity("IFCSIUNIT(*,.VOLUMEUNIT.,$,.CUBIC_METRE.)".to_string())?;
-        let unit_assignment = writer.write_entity(format!(
+            writer.write_entity(format_args!("IFCSIUNIT(*,.VOLUMEUNIT.,$,.CUBIC_METRE.)"))?;
+        let unit_assignment = writer.write_entity(format_args!(
             "IFCUNITASSIGNMENT((#{},#{},#{}))",
             length_unit, area_unit, volume_unit
         ))?;
 
         // Context
         let origin = self.create_cartesian_point(writer, 0.0, 0.0, 0.0)?;
-        let world_cs = writer.write_entity(format!("IFCAXIS2PLACEMENT3D(#{},$,$)", origin))?;
+        let world_cs = writer.write_entity(format_args!("IFCAXIS2PLACEMENT3D(#{},$,$)", origin))?;
         let _context_type = "'Model'";
-        let context = writer.write_entity(format!(
+        let context = writer.write_entity(format_args!(
             "IFCGEOMETRICREPRESENTATIONCONTEXT($,'Model',3,1.0E-5,#{},$)",
             world_cs
         ))?;
 
-        writer.write_entity(format!(
+        writer.write_entity(format_args!(
             "IFCPROJECT('{}',#{},'{}',$,$,$,$,(#{}),#{})",
             self.generate_guid(),
             owner_hist,
@@ -510,7 +871,7 @@ impl IFCExporter {
     ) -> Result<usize> {
         let placement = self.create_local_placement(writer, None, 0.0, 0.0, 0.0)?;
 
-        writer.write_entity(format!(
+        writer.write_entity(format_args!(
             "IFCSITE('{}',#{},'Default Site',$,$,#{},$,$,.ELEMENT.,(0,0,0),(0,0,0),0.,$,$)",
             self.generate_guid(),
             owner_hist,
@@ -527,7 +888,7 @@ impl IFCExporter {
         let placement = self.create_local_placement(writer, None, 0.0, 0.0, 0.0)?;
         let global_id = resolve_product_global_id(&building.ifc_global_id, &building.id);
 
-        let building_id = writer.write_entity(format!(
+        let building_id = writer.write_entity(format_args!(
             "IFCBUILDING('{}',#{},'{}',$,$,#{},$,$,.ELEMENT.,$,$,$)",
             global_id, owner_hist, building.name, placement
         ))?;
@@ -566,9 +927,13 @@ impl IFCExporter {
         let placement = self.create_local_placement(writer, None, 0.0, 0.0, elevation)?;
         let global_id = resolve_product_global_id(&floor.ifc_global_id, &floor.id);
 
-        let floor_id = writer.write_entity(format!(
+        let floor_id = writer.write_entity(format_args!(
             "IFCBUILDINGSTOREY('{}',#{},'{}',$,$,#{},$,$,.ELEMENT.,{})",
-            global_id, owner_hist, floor.name, placement, elevation
+            global_id,
+            owner_hist,
+            floor.name,
+            placement,
+            Real(elevation)
         ))?;
 
         let identity = identity_property_map(&floor.id, entity_kind::FLOOR);
@@ -622,15 +987,15 @@ impl IFCExporter {
         };
 
         let representation = if let Some(rep_id) = shape_rep_id {
-            let product_def_shape =
-                writer.write_entity(format!("IFCPRODUCTDEFINITIONSHAPE($,$,(#{}))", rep_id))?;
+            let product_def_shape = writer
+                .write_entity(format_args!("IFCPRODUCTDEFINITIONSHAPE($,$,(#{}))", rep_id))?;
             format!("#{}", product_def_shape)
         } else {
             "$".to_string()
         };
 
         let global_id = resolve_product_global_id(&room.ifc_global_id, &room.id);
-        writer.write_entity(format!(
+        writer.write_entity(format_args!(
             "IFCSPACE('{}',#{},'{}',$,$,#{},{},$,.ELEMENT.,.INTERNAL.,$)",
             global_id, owner_hist, room.name, placement, representation
         ))
@@ -663,8 +1028,8 @@ impl IFCExporter {
         let representation = if let Some(mesh) = &equipment.mesh {
             if !mesh.vertices.is_empty() {
                 let rep_id = self.create_mesh_shape(writer, mesh)?;
-                let product_def_shape =
-                    writer.write_entity(format!("IFCPRODUCTDEFINITIONSHAPE($,$,(#{}))", rep_id))?;
+                let product_def_shape = writer
+                    .write_entity(format_args!("IFCPRODUCTDEFINITIONSHAPE($,$,(#{}))", rep_id))?;
                 format!("#{}", product_def_shape)
             } else {
                 "$".to_string()
@@ -674,7 +1039,7 @@ impl IFCExporter {
         };
 
         let global_id = resolve_product_global_id(&equipment.ifc_global_id, &equipment.id);
-        writer.write_entity(format!(
+        writer.write_entity(format_args!(
             "{}('{}',#{},'{}',$,$,#{},{},$,$)",
             ifc_entity_type, global_id, owner_hist, equipment.name, placement, representation
         ))
@@ -690,18 +1055,13 @@ impl IFCExporter {
         name: &str,
         owner_hist: usize,
     ) -> Result<usize> {
-        let children_refs = child_ids
-            .iter()
-            .map(|id| format!("#{}", id))
-            .collect::<Vec<_>>()
-            .join(",");
-        writer.write_entity(format!(
+        writer.write_entity(format_args!(
             "IFCRELAGGREGATES('{}',#{},'{}',$,#{},({}))",
             self.generate_guid(),
             owner_hist,
             name,
             parent_id,
-            children_refs
+            Refs(&child_ids)
         ))
     }
 
@@ -713,17 +1073,12 @@ impl IFCExporter {
         name: &str,
         owner_hist: usize,
     ) -> Result<usize> {
-        let contained_refs = contained_ids
-            .iter()
-            .map(|id| format!("#{}", id))
-            .collect::<Vec<_>>()
-            .join(",");
-        writer.write_entity(format!(
+        writer.write_entity(format_args!(
             "IFCRELCONTAINEDINSPATIALSTRUCTURE('{}',#{},'{}',$,({}),#{})",
             self.generate_guid(),
             owner_hist,
             name,
-            contained_refs,
+            Refs(&contained_ids),
             container_id
         ))
     }
@@ -744,27 +1099,22 @@ impl IFCExporter {
         let mut prop_ids = Vec::new();
         for (key, value) in properties {
             // IfcPropertySingleValue
-            let p_id = writer.write_entity(format!(
+            let p_id = writer.write_entity(format_args!(
                 "IFCPROPERTYSINGLEVALUE('{}',$,IFCLABEL('{}'),$)",
                 key, value
             ))?;
             prop_ids.push(p_id);
         }
 
-        let prop_refs = prop_ids
-            .iter()
-            .map(|id| format!("#{}", id))
-            .collect::<Vec<_>>()
-            .join(",");
-        let pset_id = writer.write_entity(format!(
+        let pset_id = writer.write_entity(format_args!(
             "IFCPROPERTYSET('{}',#{},'{}',$,({}))",
             self.generate_guid(),
             owner_hist,
             name,
-            prop_refs
+            Refs(&prop_ids),
         ))?;
 
-        writer.write_entity(format!(
+        writer.write_entity(format_args!(
             "IFCRELDEFINESBYPROPERTIES('{}',#{},$,$,(#{}),#{})",
             self.generate_guid(),
             owner_hist,
@@ -784,7 +1134,12 @@ impl IFCExporter {
         y: f64,
         z: f64,
     ) -> Result<usize> {
-        writer.write_entity(format!("IFCCARTESIANPOINT(({:.4},{:.4},{:.4}))", x, y, z))
+        writer.write_entity(format_args!(
+            "IFCCARTESIANPOINT(({},{},{}))",
+            Real(x),
+            Real(y),
+            Real(z)
+        ))
     }
 
     fn create_local_placement<W: Write>(
@@ -797,14 +1152,14 @@ impl IFCExporter {
     ) -> Result<usize> {
         let location = self.create_cartesian_point(writer, x, y, z)?;
         let axis_placement =
-            writer.write_entity(format!("IFCAXIS2PLACEMENT3D(#{},$,$)", location))?;
+            writer.write_entity(format_args!("IFCAXIS2PLACEMENT3D(#{},$,$)", location))?;
 
         let relative_to_str = match relative_to {
             Some(id) => format!("#{}", id),
             None => "$".to_string(),
         };
 
-        writer.write_entity(format!(
+        writer.write_entity(format_args!(
             "IFCLOCALPLACEMENT({},#{})",
             relative_to_str, axis_placement
         ))
@@ -815,25 +1170,14 @@ impl IFCExporter {
         writer: &mut StepWriter<impl std::io::Write>,
         mesh: &Mesh,
     ) -> Result<usize> {
-        // 1. Convert vertices to array of arrays
-        let points: Vec<[f64; 3]> = mesh.vertices.iter().map(|v| [v.x, v.y, v.z]).collect();
+        // 1. Write CartesianPointList3D straight from the mesh vertices
+        let coords_id = writer.write_cartesian_point_list_3d(&mesh.vertices)?;
 
-        // 2. Write CartesianPointList3D
-        let coords_id = writer.write_cartesian_point_list_3d(&points)?;
-
-        // 3. Convert indices to triplets
-        let mut triangles = Vec::new();
-        for chunk in mesh.indices.chunks(3) {
-            if chunk.len() == 3 {
-                triangles.push([chunk[0], chunk[1], chunk[2]]);
-            }
-        }
+        // 2. Write TriangulatedFaceSet from the flat index triplets
+        let face_set_id = writer.write_triangulated_face_set(coords_id, &mesh.indices)?;
 
-        // 4. Write TriangulatedFaceSet
-        let face_set_id = writer.write_triangulated_face_set(coords_id, &triangles)?;
-
-        // 5. Wrap in ShapeRepresentation
-        let shape_rep = writer.write_entity(format!(
+        // 3. Wrap in ShapeRepresentation
+        let shape_rep = writer.write_entity(format_args!(
             "IFCSHAPEREPRESENTATION($,'Body','Tessellation',(#{}))",
             face_set_id
         ))?;
@@ -854,23 +1198,29 @@ impl IFCExporter {
 
         // Profile
         let position = self.create_cartesian_point(writer, 0.0, 0.0, 0.0)?; // Local to profile
-        let axis2d = writer.write_entity(format!("IFCAXIS2PLACEMENT2D(#{},$)", position))?;
-        let profile = writer.write_entity(format!(
-            "IFCRECTANGLEPROFILEDEF(.AREA.,'RoomProfile',#{},{:.4},{:.4})",
-            axis2d, width, depth
+        let axis2d = writer.write_entity(format_args!("IFCAXIS2PLACEMENT2D(#{},$)", position))?;
+        let profile = writer.write_entity(format_args!(
+            "IFCRECTANGLEPROFILEDEF(.AREA.,'RoomProfile',#{},{},{})",
+            axis2d,
+            Real(width),
+            Real(depth)
         ))?;
 
         // Extrusion
         let position_3d = self.create_cartesian_point(writer, 0.0, 0.0, 0.0)?;
-        let axis3d = writer.write_entity(format!("IFCAXIS2PLACEMENT3D(#{},$,$)", position_3d))?;
-        let direction = writer.write_entity("IFCDIRECTION((0.,0.,1.))".to_string())?;
-
-        let solid = writer.write_entity(format!(
-            "IFCEXTRUDEDAREASOLID(#{},#{},#{},{:.4})",
-            profile, axis3d, direction, height
+        let axis3d =
+            writer.write_entity(format_args!("IFCAXIS2PLACEMENT3D(#{},$,$)", position_3d))?;
+        let direction = writer.write_entity(format_args!("IFCDIRECTION((0.,0.,1.))"))?;
+
+        let solid = writer.write_entity(format_args!(
+            "IFCEXTRUDEDAREASOLID(#{},#{},#{},{})",
+            profile,
+            axis3d,
+            direction,
+            Real(height)
         ))?;
 
-        writer.write_entity(format!(
+        writer.write_entity(format_args!(
             "IFCSHAPEREPRESENTATION($,'Body','SweptSolid',(#{}))",
             solid
         ))
@@ -968,3 +1318,79 @@ impl IFCExporter {
         result
     }
 }
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    #[test]
+    fn real_uses_step_spelling() {
+        assert_eq!(Real(0.0).to_string(), "0.0");
+        assert_eq!(Real(2.5).to_string(), "2.5");
+        assert_eq!(Real(-0.125).to_string(), "-0.125");
+        assert_eq!(Real(1e-7).to_string(), "1.0E-7");
+        assert_eq!(Real(1.5e20).to_string(), "1.5E20");
+        assert_eq!(Real(f64::NAN).to_string(), "0.0");
+    }
+
+    #[test]
+    fn export_to_writer_streams_into_sink() {
+        let building = Building::new("Tower".to_string(), "".to_string());
+        let bytes = IFCExporter::new(building)
+            .export_to_writer(Vec::new(), "tower.ifc")
+            .unwrap();
+        let text = String::from_utf8(bytes).unwrap();
+        assert!(text.starts_with("ISO-10303-21;"));
+        assert!(text.contains("IFCPROJECT("));
+        assert!(text.trim_end().ends_with("END-ISO-10303-21;"));
+    }
+
+    fn entity_ids(text: &str) -> Vec<usize> {
+        text.lines()
+            .filter_map(|line| line.strip_prefix('#')?.split_once('=')?.0.parse().ok())
+            .collect()
+    }
+
+    #[test]
+    fn incremental_export_reuses_unchanged_storeys() {
+        let mut building = Building::new("Tower".to_string(), "".to_string());
+        building.add_floor(Floor::new("Ground".to_string(), 0));
+        building.add_floor(Floor::new("Roof".to_string(), 1));
+
+        let mut cache = IfcExportCache::new();
+        let (first, stats) = IFCExporter::new(building.clone())
+            .export_incremental_to_writer(Vec::new(), "tower.ifc", &mut cache)
+            .unwrap();
+        assert!(stats.full_rewrite);
+        assert_eq!(stats.floors_rewritten, 2);
+
+        building.floors[1].name = "Penthouse".to_string();
+        let (second, stats) = IFCExporter::new(building)
+            .export_incremental_to_writer(Vec::new(), "tower.ifc", &mut cache)
+            .unwrap();
+        assert_eq!(
+            stats,
+            IncrementalExportStats {
+                floors_reused: 1,
+                floors_rewritten: 1,
+                full_rewrite: false,
+            }
+        );
+
+        let first = String::from_utf8(first).unwrap();
+        let second = String::from_utf8(second).unwrap();
+        let ground = |text: &str| {
+            text.lines()
+                .find(|l| l.contains("IFCBUILDINGSTOREY(") && l.contains("'Ground'"))
+                .map(str::to_string)
+        };
+        assert_eq!(ground(&first), ground(&second));
+        assert!(second.contains("'Penthouse'") && !second.contains("'Roof'"));
+
+        let mut ids = entity_ids(&second);
+        let total = ids.len();
+        ids.sort_unstable();
+        ids.dedup();
+        assert_eq!(ids.len(), total, "STEP ids must stay unique");
+    }
+}
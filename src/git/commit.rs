@@ -1,6 +1,7 @@
 //! Commit operations for Git repository
 
 use super::{CommitMetadata, GitConfig, GitError};
+use crate::telemetry::{self, Phase};
 use git2::{Repository, Signature};
 use std::path::Path;
 
@@ -11,6 +12,7 @@ pub fn commit_changes_with_metadata(
     metadata: &CommitMetadata,
     file_paths: &[String],
 ) -> Result<String, GitError> {
+    let _timer = telemetry::time(Phase::GitCommit);
     let mut index = repo
         .index()
         .map_err(|e| GitError::GitError(e.message().to_string()))?;
@@ -91,6 +93,7 @@ pub fn commit_staged_with_user(
     config: &GitConfig,
     metadata: &CommitMetadata,
 ) -> Result<String, GitError> {
+    let _timer = telemetry::time(Phase::GitCommit);
     let mut index = repo
         .index()
         .map_err(|e| GitError::GitError(e.message().to_string()))?;
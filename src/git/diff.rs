@@ -16,7 +16,7 @@ pub struct GitStatus {
 }
 
 /// Commit information
-#[derive(Debug)]
+#[derive(Debug, Clone)]
 pub struct CommitInfo {
     pub id: String,
     pub message: String,
@@ -143,7 +143,33 @@ pub fn list_commits(repo: &Repository, limit: usize) -> Result<Vec<CommitInfo>,
 }
 
 /// Get commit history for a specific file
+///
+/// Lists the commits (newest first) that added or changed `file_path`, found
+/// by comparing the file's blob id with the first parent's: no diff is
+/// computed and no content is read.
 pub fn get_file_history(repo: &Repository, file_path: &str) -> Result<Vec<CommitInfo>, GitError> {
+    Ok(file_revisions(repo, file_path)?
+        .into_iter()
+        .map(|(commit, _)| commit)
+        .collect())
+}
+
+/// Commits (newest first) that added or changed `file_path`, with the blob
+/// id of the file at each.
+pub fn file_revisions(
+    repo: &Repository,
+    file_path: &str,
+) -> Result<Vec<(CommitInfo, git2::Oid)>, GitError> {
+    let path = Path::new(file_path);
+    let blob_at = |commit: &git2::Commit| -> Option<git2::Oid> {
+        commit
+            .tree()
+            .ok()?
+            .get_path(path)
+            .ok()
+            .map(|entry| entry.id())
+    };
+
     let mut revwalk = repo
         .revwalk()
         .map_err(|e| GitError::GitError(e.message().to_string()))?;
@@ -151,27 +177,32 @@ pub fn get_file_history(repo: &Repository, file_path: &str) -> Result<Vec<Commit
         .push_head()
         .map_err(|e| GitError::GitError(e.message().to_string()))?;
 
-    let mut commits = Vec::new();
+    let mut revisions = Vec::new();
     for oid in revwalk {
         let oid = oid.map_err(|e| GitError::GitError(e.message().to_string()))?;
         let commit = repo
             .find_commit(oid)
             .map_err(|e| GitError::GitError(e.message().to_string()))?;
 
-        // Check if file was modified in this commit
-        if let Ok(tree) = commit.tree() {
-            if tree.get_path(Path::new(file_path)).is_ok() {
-                commits.push(CommitInfo {
+        // Modified in this commit: present, and not the parent's blob
+        let Some(blob) = blob_at(&commit) else {
+            continue;
+        };
+        let parent_blob = commit.parent(0).ok().and_then(|parent| blob_at(&parent));
+        if parent_blob != Some(blob) {
+            revisions.push((
+                CommitInfo {
                     id: oid.to_string(),
                     message: commit.message().unwrap_or("").to_string(),
                     author: commit.author().name().unwrap_or("").to_string(),
                     time: commit.time().seconds(),
-                });
-            }
+                },
+                blob,
+            ));
         }
     }
 
-    Ok(commits)
+    Ok(revisions)
 }
 
 /// Get diff between commits
@@ -119,6 +119,31 @@ impl BuildingGitManager {
         get_diff(&self.repo, commit_hash, file_path)
     }
 
+    /// Entity-level diff of the building file from `commit_hash` (default:
+    /// `HEAD`'s parent) to `HEAD`, served from `cache` when already computed
+    pub fn get_semantic_diff(
+        &self,
+        cache: &super::SemanticDiffCache,
+        commit_hash: Option<&str>,
+    ) -> Result<std::sync::Arc<super::SemanticDiff>, GitError> {
+        let head = self.repo.head()?.peel_to_commit()?;
+        let from = match commit_hash {
+            Some(rev) => self.repo.revparse_single(rev)?.peel_to_commit()?.id(),
+            None => head.parent(0).map_or(head.id(), |parent| parent.id()),
+        };
+        cache.diff(&self.repo, from, head.id())
+    }
+
+    /// Commits in which one building entity (by `ArxAddress` path, `ifc:`
+    /// GlobalId or `kind:id`) changed
+    pub fn get_entity_history(
+        &self,
+        cache: &super::SemanticDiffCache,
+        key: &str,
+    ) -> Result<Vec<super::semantic::EntityRevision>, GitError> {
+        cache.entity_history(&self.repo, key)
+    }
+
     /// Get diff statistics between commits
     pub fn get_diff_stats(&self, commit_hash: Option<&str>) -> Result<super::DiffStats, GitError> {
         get_diff_stats(&self.repo, commit_hash)
@@ -357,6 +382,8 @@ mod tests {
             anchors: vec![],
             pending_anchor_ids: vec![],
             claim_grace_period_days: None,
+            spatial_index: Default::default(),
+            edits: Default::default(),
         };
 
         // Export building (this will create a commit)
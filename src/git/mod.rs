@@ -9,9 +9,11 @@ pub mod diff;
 pub mod export;
 pub mod manager;
 pub mod repository;
+pub mod semantic;
 pub mod staging;
 
 // Re-export types and main manager
 pub use diff::{CommitInfo, DiffResult, DiffStats, GitStatus};
 pub use manager::CommitMetadata;
+pub use semantic::{SemanticDiff, SemanticDiffCache};
 pub use manager::*;
@@ -0,0 +1,778 @@
+//! Structural diffs of `building.yaml` between commits
+//!
+//! Line diffs of the monolithic YAML are slow to produce for large buildings
+//! and say little about what actually changed. This module compares two
+//! `Building` snapshots entity by entity instead: every floor, wing, room,
+//! equipment item and anchor is keyed by its `ArxAddress` path, else its IFC
+//! GlobalId, else `kind:id`, and reported as added, removed, or modified with
+//! the names of the fields that differ.
+//!
+//! [`SemanticDiffCache`] keeps the parsed entity index of each `building.yaml`
+//! blob (commits that did not touch the file share one) and each diff by
+//! (commit, commit) pair. Commits are immutable, so entries never go stale;
+//! each map is simply reset when full. A blob that matches the working copy's
+//! binary snapshot is decoded from it instead of parsing YAML.
+//!
+//! Entity history still parses a blob, but only when the entity's own text
+//! differs from the previous revision's (see [`entity_fragment`]). Those
+//! parses bypass the index cache, so one history query cannot flush it.
+
+use std::collections::HashMap;
+use std::path::PathBuf;
+use std::sync::{Arc, Mutex};
+
+use git2::{Oid, Repository};
+use serde::Serialize;
+use serde_json::{Map, Value};
+
+use super::diff::{file_revisions, CommitInfo};
+use super::GitError;
+use crate::core::Building;
+use crate::persistence::{snapshot, BUILDING_YAML};
+use crate::yaml::BuildingYamlSerializer;
+
+/// Parsed `building.yaml` blobs kept in memory.
+const MAX_CACHED_INDEXES: usize = 16;
+/// Computed diffs kept in memory.
+const MAX_CACHED_DIFFS: usize = 64;
+
+/// Fields that are rewritten on every save and do not by themselves make an
+/// entity modified.
+const VOLATILE_FIELDS: [&str; 1] = ["updated_at"];
+
+/// Child lists: nested in the serialized tree, reported as entities of their own.
+const CHILD_FIELDS: [&str; 5] = ["floors", "wings", "rooms", "equipment", "anchors"];
+
+#[derive(Debug, Clone, Copy, PartialEq, Eq, Hash, Serialize)]
+#[serde(rename_all = "snake_case")]
+pub enum EntityKind {
+    Building,
+    Floor,
+    Wing,
+    Room,
+    Equipment,
+    Anchor,
+}
+
+impl EntityKind {
+    pub fn as_str(self) -> &'static str {
+        match self {
+            EntityKind::Building => "building",
+            EntityKind::Floor => "floor",
+            EntityKind::Wing => "wing",
+            EntityKind::Room => "room",
+            EntityKind::Equipment => "equipment",
+            EntityKind::Anchor => "anchor",
+        }
+    }
+}
+
+#[derive(Debug, Clone, Copy, PartialEq, Eq, Serialize)]
+#[serde(rename_all = "snake_case")]
+pub enum ChangeKind {
+    Added,
+    Removed,
+    Modified,
+}
+
+/// One entity that differs between two snapshots.
+#[derive(Debug, Clone, Serialize)]
+pub struct EntityChange {
+    pub kind: EntityKind,
+    /// Identity the snapshots were matched on (see the module docs).
+    pub key: String,
+    pub name: String,
+    pub change: ChangeKind,
+    /// Own fields that differ, sorted; `parent` when the entity moved.
+    /// Empty for additions and removals.
+    pub fields: Vec<String>,
+}
+
+/// Entity-level changes of `building.yaml` from commit `from` to `to`.
+#[derive(Debug, Clone, Serialize)]
+pub struct SemanticDiff {
+    pub from: String,
+    pub to: String,
+    /// Additions and modifications in `to` order, then removals in `from` order.
+    pub changes: Vec<EntityChange>,
+}
+
+/// Commit in which one entity changed.
+#[derive(Debug, Clone)]
+pub struct EntityRevision {
+    pub commit: CommitInfo,
+    pub change: ChangeKind,
+    pub fields: Vec<String>,
+}
+
+#[derive(Debug, Clone, PartialEq)]
+struct Entity {
+    kind: EntityKind,
+    name: String,
+    parent: Option<String>,
+    /// Serialized own fields, without child lists.
+    fields: Map<String, Value>,
+}
+
+/// Every entity of one building snapshot, by identity key.
+#[derive(Debug, Default)]
+pub struct EntityIndex {
+    order: Vec<String>,
+    entities: HashMap<String, Entity>,
+}
+
+impl EntityIndex {
+    pub fn of(building: &Building) -> Result<Self, GitError> {
+        let mut index = Self::default();
+        let mut owners = HashMap::new();
+        let root = to_object(building)?;
+        index.visit(EntityKind::Building, root, None, &mut owners);
+
+        // Containers list equipment and anchors by id only
+        for equipment in building.get_all_equipment() {
+            let parent = owners.get(&(EntityKind::Equipment, equipment.id.clone()));
+            let fields = to_object(equipment)?;
+            index.insert(EntityKind::Equipment, fields, parent.cloned());
+        }
+        for anchor in building.get_all_anchors() {
+            let parent = owners.get(&(EntityKind::Anchor, anchor.id.clone()));
+            let fields = to_object(anchor)?;
+            index.insert(EntityKind::Anchor, fields, parent.cloned());
+        }
+        Ok(index)
+    }
+
+    pub fn len(&self) -> usize {
+        self.order.len()
+    }
+
+    pub fn is_empty(&self) -> bool {
+        self.order.is_empty()
+    }
+
+    fn visit(
+        &mut self,
+        kind: EntityKind,
+        mut fields: Map<String, Value>,
+        parent: Option<String>,
+        owners: &mut HashMap<(EntityKind, String), String>,
+    ) {
+        let children: Vec<(&str, Value)> = CHILD_FIELDS
+            .iter()
+            .filter_map(|&field| Some((field, fields.remove(field)?)))
+            .collect();
+        let key = self.insert(kind, fields, parent);
+
+        for (field, value) in children {
+            let Value::Array(items) = value else {
+                continue;
+            };
+            let child_kind = match field {
+                "floors" => EntityKind::Floor,
+                "wings" => EntityKind::Wing,
+                "rooms" => EntityKind::Room,
+                "equipment" => EntityKind::Equipment,
+                _ => EntityKind::Anchor,
+            };
+            for item in items {
+                match item {
+                    Value::Object(child) => {
+                        self.visit(child_kind, child, Some(key.clone()), owners);
+                    }
+                    Value::String(id) => {
+                        owners.insert((child_kind, id), key.clone());
+                    }
+                    _ => {}
+                }
+            }
+        }
+    }
+
+    fn insert(
+        &mut self,
+        kind: EntityKind,
+        fields: Map<String, Value>,
+        parent: Option<String>,
+    ) -> String {
+        let mut key = identity(kind, &fields);
+        if self.entities.contains_key(&key) {
+            // Duplicate address or GlobalId: keep both, told apart by id
+            key = format!(
+                "{}#{}",
+                key,
+                fields.get("id").and_then(Value::as_str).unwrap_or("")
+            );
+        }
+        let name = fields
+            .get("name")
+            .and_then(Value::as_str)
+            .unwrap_or_default()
+            .to_string();
+        self.order.push(key.clone());
+        self.entities.insert(
+            key.clone(),
+            Entity {
+                kind,
+                name,
+                parent,
+                fields,
+            },
+        );
+        key
+    }
+}
+
+fn to_object<T: Serialize>(value: &T) -> Result<Map<String, Value>, GitError> {
+    match serde_json::to_value(value) {
+        Ok(Value::Object(map)) => Ok(map),
+        Ok(_) => Err(GitError::SerializationError(
+            "expected an object".to_string(),
+        )),
+        Err(e) => Err(GitError::SerializationError(e.to_string())),
+    }
+}
+
+fn identity(kind: EntityKind, fields: &Map<String, Value>) -> String {
+    if kind == EntityKind::Building {
+        return EntityKind::Building.as_str().to_string();
+    }
+    if let Some(Value::String(path)) = fields.get("address") {
+        return path.clone();
+    }
+    if let Some(Value::String(guid)) = fields.get("ifc_global_id") {
+        return format!("ifc:{}", guid);
+    }
+    let id = fields.get("id").and_then(Value::as_str).unwrap_or_default();
+    format!("{}:{}", kind.as_str(), id)
+}
+
+/// Text that must occur in the YAML of any snapshot holding entity `key`.
+fn needle(key: &str) -> &str {
+    let key = key.split('#').next().unwrap_or(key);
+    if key.starts_with('/') {
+        key
+    } else {
+        key.rsplit(':').next().unwrap_or(key)
+    }
+}
+
+/// Lines of a `building.yaml` blob that mention any of `needles` and the
+/// entity state around them, or empty when none occurs. Empty needles are
+/// ignored.
+///
+/// For every matching line this keeps the list item around it (the entity,
+/// with its nested lists) in full, or the whole top-level block when no item
+/// encloses it, plus the first line and scalar fields of each enclosing item
+/// and key, which give its parent's identity. History passes the entity's
+/// key text and its `id`: containers list equipment and anchors by id, so
+/// the id lines are what change when an item moves between rooms. With both,
+/// equal fragments mean the entity's fields and parent are unchanged, and
+/// history only parses revisions where the fragment changed. The inverse
+/// does not hold: edits to children or siblings sharing the text (e.g. an
+/// address prefix) change the fragment and just cost a parse.
+fn entity_fragment(yaml: &[u8], needles: &[&[u8]]) -> Vec<u8> {
+    let lines: Vec<&[u8]> = yaml.split(|&c| c == b'\n').collect();
+    // Nesting depth: list items sit between their key and their fields, so
+    // `- id: r1` at indent n is deeper than `rooms:` at n and shallower than
+    // its own `name:` at n + 2. Blank lines have none.
+    let depth = |line: &[u8]| {
+        let indent = line.iter().position(|&c| c != b' ')?;
+        Some(2 * indent + usize::from(is_item(&line[indent..])))
+    };
+    let depths: Vec<Option<usize>> = lines.iter().map(|line| depth(line)).collect();
+
+    // Enclosing line of each line and the end of each line's block, in one pass.
+    let mut parent = vec![None; lines.len()];
+    let mut end = vec![lines.len(); lines.len()];
+    let mut open: Vec<usize> = Vec::new();
+    for (i, d) in depths.iter().enumerate() {
+        let Some(d) = *d else { continue };
+        while let Some(&top) = open.last() {
+            if depths[top] < Some(d) {
+                break;
+            }
+            end[top] = i;
+            open.pop();
+        }
+        parent[i] = open.last().copied();
+        open.push(i);
+    }
+
+    let item = |i: usize| {
+        let line = lines[i];
+        is_item(&line[line.iter().position(|&c| c != b' ').unwrap_or(0)..])
+    };
+    let mut keep = vec![false; lines.len()];
+    let mut whole = vec![false; lines.len()];
+    let matches = |line: &[u8]| {
+        needles
+            .iter()
+            .any(|needle| !needle.is_empty() && contains(line, needle))
+    };
+    for i in (0..lines.len()).filter(|&i| matches(lines[i])) {
+        keep[i] = true;
+        let mut at = Some(i);
+        let mut root = i;
+        let mut entity_found = false;
+        while let Some(j) = at {
+            root = j;
+            if item(j) && !entity_found {
+                entity_found = true;
+                if !whole[j] {
+                    whole[j] = true;
+                    keep[j..end[j]].iter_mut().for_each(|k| *k = true);
+                }
+            } else {
+                keep[j] = true;
+                for k in j + 1..end[j] {
+                    if parent[k] == Some(j) && !item(k) {
+                        keep[k] = true;
+                    }
+                }
+            }
+            at = parent[j];
+        }
+        if !entity_found && !whole[root] {
+            whole[root] = true;
+            keep[root..end[root]].iter_mut().for_each(|k| *k = true);
+        }
+    }
+
+    let mut fragment = Vec::new();
+    for (line, _) in lines.iter().zip(&keep).filter(|(_, &kept)| kept) {
+        fragment.extend_from_slice(line);
+        fragment.push(b'\n');
+    }
+    fragment
+}
+
+fn is_item(trimmed: &[u8]) -> bool {
+    trimmed.starts_with(b"- ") || trimmed == b"-"
+}
+
+fn contains(haystack: &[u8], needle: &[u8]) -> bool {
+    needle.is_empty()
+        || haystack
+            .windows(needle.len())
+            .any(|window| window == needle)
+}
+
+/// Fields that differ between two states of one entity, or `None` if only
+/// volatile fields changed.
+fn changed_fields(old: &Entity, new: &Entity) -> Option<Vec<String>> {
+    let mut fields: Vec<String> = old
+        .fields
+        .iter()
+        .filter(|(field, value)| new.fields.get(*field) != Some(value))
+        .map(|(field, _)| field.clone())
+        .chain(
+            new.fields
+                .keys()
+                .filter(|field| !old.fields.contains_key(*field))
+                .cloned(),
+        )
+        .filter(|field| !VOLATILE_FIELDS.contains(&field.as_str()))
+        .collect();
+    if old.parent != new.parent {
+        fields.push("parent".to_string());
+    }
+    fields.sort_unstable();
+    (!fields.is_empty()).then_some(fields)
+}
+
+/// Entity-level changes from `old` to `new`.
+pub fn diff_indexes(old: &EntityIndex, new: &EntityIndex) -> Vec<EntityChange> {
+    let change = |key: &str, entity: &Entity, change, fields| EntityChange {
+        kind: entity.kind,
+        key: key.to_string(),
+        name: entity.name.clone(),
+        change,
+        fields,
+    };
+    let mut changes = Vec::new();
+    for key in &new.order {
+        let entity = &new.entities[key];
+        match old.entities.get(key) {
+            None => changes.push(change(key, entity, ChangeKind::Added, Vec::new())),
+            Some(before) => {
+                if let Some(fields) = changed_fields(before, entity) {
+                    changes.push(change(key, entity, ChangeKind::Modified, fields));
+                }
+            }
+        }
+    }
+    for key in &old.order {
+        if !new.entities.contains_key(key) {
+            changes.push(change(
+                key,
+                &old.entities[key],
+                ChangeKind::Removed,
+                Vec::new(),
+            ));
+        }
+    }
+    changes
+}
+
+/// Entity-level changes from building `old` to `new`.
+pub fn diff_buildings(old: &Building, new: &Building) -> Result<Vec<EntityChange>, GitError> {
+    Ok(diff_indexes(&EntityIndex::of(old)?, &EntityIndex::of(new)?))
+}
+
+#[derive(Debug, Default)]
+struct CacheState {
+    /// By blob id of the file.
+    indexes: HashMap<Oid, Arc<EntityIndex>>,
+    /// By (from, to) commit id.
+    diffs: HashMap<(Oid, Oid), Arc<SemanticDiff>>,
+}
+
+/// Parsed snapshots and diffs of one building file across commits.
+#[derive(Debug)]
+pub struct SemanticDiffCache {
+    file_path: PathBuf,
+    state: Mutex<CacheState>,
+}
+
+impl Default for SemanticDiffCache {
+    fn default() -> Self {
+        Self::new(BUILDING_YAML)
+    }
+}
+
+impl SemanticDiffCache {
+    /// Cache for `file_path`, relative to the repository root.
+    pub fn new(file_path: impl Into<PathBuf>) -> Self {
+        Self {
+            file_path: file_path.into(),
+            state: Mutex::new(CacheState::default()),
+        }
+    }
+
+    fn lock(&self) -> std::sync::MutexGuard<'_, CacheState> {
+        self.state
+            .lock()
+            .unwrap_or_else(|poisoned| poisoned.into_inner())
+    }
+
+    /// Entity-level diff of the file from commit `from` to commit `to`.
+    pub fn diff(
+        &self,
+        repo: &Repository,
+        from: Oid,
+        to: Oid,
+    ) -> Result<Arc<SemanticDiff>, GitError> {
+        if let Some(diff) = self.lock().diffs.get(&(from, to)) {
+            return Ok(diff.clone());
+        }
+
+        let old_blob = self.blob_at(repo, from)?;
+        let new_blob = self.blob_at(repo, to)?;
+        let changes = if old_blob == new_blob {
+            Vec::new()
+        } else {
+            let old = self.index_of(repo, old_blob)?;
+            let new = self.index_of(repo, new_blob)?;
+            diff_indexes(&old, &new)
+        };
+        let diff = Arc::new(SemanticDiff {
+            from: from.to_string(),
+            to: to.to_string(),
+            changes,
+        });
+
+        let mut state = self.lock();
+        if state.diffs.len() >= MAX_CACHED_DIFFS {
+            state.diffs.clear();
+        }
+        state.diffs.insert((from, to), diff.clone());
+        Ok(diff)
+    }
+
+    /// Commits (newest first) in which entity `key` was added, changed or
+    /// removed.
+    ///
+    /// Only commits that changed the file's blob are considered. Each is
+    /// parsed only if the entity's text (see [`entity_fragment`]) differs
+    /// from the previous revision's; a blob that does not mention it, or
+    /// leaves it untouched, is not parsed.
+    pub fn entity_history(
+        &self,
+        repo: &Repository,
+        key: &str,
+    ) -> Result<Vec<EntityRevision>, GitError> {
+        let file_path = self.file_path.to_string_lossy();
+        let mut revisions = file_revisions(repo, &file_path)?;
+        revisions.reverse();
+
+        let needle = needle(key).as_bytes();
+        // Learnt from the first parse that finds the entity
+        let mut id = String::new();
+        let mut history = Vec::new();
+        let mut previous: Option<Entity> = None;
+        let mut previous_fragment = Vec::new();
+        for (commit, blob) in revisions {
+            let content = repo.find_blob(blob)?;
+            let mut fragment = entity_fragment(content.content(), &[needle, id.as_bytes()]);
+            let current = if fragment.is_empty() {
+                None
+            } else if fragment == previous_fragment {
+                previous.clone()
+            } else {
+                let cached = self.lock().indexes.get(&blob).cloned();
+                let index = match cached {
+                    Some(index) => index,
+                    None => Arc::new(self.parse_index(repo, blob)?),
+                };
+                let entity = index.entities.get(key).cloned();
+                let entity_id = entity
+                    .as_ref()
+                    .and_then(|e| e.fields.get("id"))
+                    .and_then(Value::as_str);
+                if let Some(entity_id) = entity_id.filter(|entity_id| *entity_id != id) {
+                    // Compare the next revision against the same needles
+                    id = entity_id.to_string();
+                    fragment = entity_fragment(content.content(), &[needle, id.as_bytes()]);
+                }
+                entity
+            };
+            previous_fragment = fragment;
+            let change = match (&previous, &current) {
+                (None, Some(_)) => Some((ChangeKind::Added, Vec::new())),
+                (Some(_), None) => Some((ChangeKind::Removed, Vec::new())),
+                (Some(old), Some(new)) => {
+                    changed_fields(old, new).map(|fields| (ChangeKind::Modified, fields))
+                }
+                (None, None) => None,
+            };
+            if let Some((change, fields)) = change {
+                history.push(EntityRevision {
+                    commit,
+                    change,
+                    fields,
+                });
+            }
+            previous = current;
+        }
+        history.reverse();
+        Ok(history)
+    }
+
+    fn blob_at(&self, repo: &Repository, commit: Oid) -> Result<Option<Oid>, GitError> {
+        let tree = repo.find_commit(commit)?.tree()?;
+        Ok(tree.get_path(&self.file_path).ok().map(|entry| entry.id()))
+    }
+
+    /// Entity index of a blob; a missing file is an empty building.
+    fn index_of(&self, repo: &Repository, blob: Option<Oid>) -> Result<Arc<EntityIndex>, GitError> {
+        let Some(blob) = blob else {
+            return Ok(Arc::new(EntityIndex::default()));
+        };
+        if let Some(index) = self.lock().indexes.get(&blob) {
+            return Ok(index.clone());
+        }
+        let index = Arc::new(self.parse_index(repo, blob)?);
+
+        let mut state = self.lock();
+        if state.indexes.len() >= MAX_CACHED_INDEXES {
+            state.indexes.clear();
+        }
+        state.indexes.insert(blob, index.clone());
+        Ok(index)
+    }
+
+    fn parse_index(&self, repo: &Repository, blob: Oid) -> Result<EntityIndex, GitError> {
+        let content = repo.find_blob(blob)?;
+        let content = content.content();
+        let document = match repo
+            .workdir()
+            .and_then(|workdir| snapshot::load_fresh(workdir, content))
+        {
+            Some(document) => document,
+            None => {
+                let yaml = std::str::from_utf8(content)
+                    .map_err(|e| GitError::SerializationError(e.to_string()))?;
+                BuildingYamlSerializer::deserialize_document(yaml)
+                    .map_err(|e| GitError::SerializationError(e.to_string()))?
+            }
+        };
+        EntityIndex::of(&document.into_building())
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use crate::core::{Equipment, EquipmentType, Floor, Room, RoomType, Wing};
+
+    fn building() -> Building {
+        let mut building = Building::new("Semantic HQ".into(), "/semantic-hq".into());
+        let mut floor = Floor::new("L1".into(), 1);
+        let mut wing = Wing::new("A".into());
+        let mut room = Room::new("Plant".into(), RoomType::Mechanical);
+        room.equipment.push(Equipment::new(
+            "AHU-1".into(),
+            "/semantic-hq/l1/plant/ahu-1".into(),
+            EquipmentType::HVAC,
+        ));
+        wing.add_room(room);
+        wing.add_room(Room::new("Office".into(), RoomType::Office));
+        floor.add_wing(wing);
+        building.add_floor(floor);
+        building
+    }
+
+    #[test]
+    fn diff_reports_entities_not_lines() {
+        let old = building();
+        let mut new = old.clone();
+        let rooms = &mut new.floors[0].wings[0].rooms;
+        rooms[0].equipment[0]
+            .properties
+            .insert("rpm".into(), "1200".into());
+        let moved = rooms[0].equipment.remove(0);
+        rooms[1].equipment.push(moved);
+        rooms[1].name = "Open Office".into();
+        let removed = rooms.remove(0).id;
+        new.updated_at = old.updated_at + chrono::Duration::seconds(5);
+
+        let changes = diff_buildings(&old, &new).unwrap();
+        let summary: Vec<(EntityKind, ChangeKind, Vec<&str>)> = changes
+            .iter()
+            .map(|c| {
+                (
+                    c.kind,
+                    c.change,
+                    c.fields.iter().map(String::as_str).collect(),
+                )
+            })
+            .collect();
+        assert_eq!(
+            summary,
+            [
+                (EntityKind::Room, ChangeKind::Modified, vec!["name"]),
+                (
+                    EntityKind::Equipment,
+                    ChangeKind::Modified,
+                    vec!["parent", "properties"]
+                ),
+                (EntityKind::Room, ChangeKind::Removed, vec![]),
+            ]
+        );
+        assert_eq!(changes[2].key, format!("room:{}", removed));
+        assert!(diff_buildings(&old, &old).unwrap().is_empty());
+    }
+
+    #[test]
+    fn needle_finds_the_identifying_text() {
+        assert_eq!(needle("/usa/ny/hq/l1/plant"), "/usa/ny/hq/l1/plant");
+        assert_eq!(needle("room:1234"), "1234");
+        assert_eq!(needle("ifc:3vB2$Qk#9"), "3vB2$Qk");
+    }
+
+    #[test]
+    fn fragment_covers_the_entity_and_its_parents() {
+        let yaml = "\
+floors:
+- id: l1
+  name: Level 1
+  wings:
+  - id: w1
+    rooms:
+    - id: r1
+      name: Plant
+      equipment:
+      - ahu-1
+    - id: r2
+      name: Office
+      equipment: []
+  equipment:
+  - id: ahu-1
+    name: AHU
+    properties:
+      rpm: '1200'
+  - id: fcu-1
+    name: FCU
+";
+        let fragment = |yaml: &str| entity_fragment(yaml.as_bytes(), &[b"ahu-1".as_slice()]);
+        let base = fragment(yaml);
+        let text = String::from_utf8(base.clone()).unwrap();
+        assert!(text.contains("      rpm: '1200'\n"));
+        assert!(text.contains("    - id: r1\n"));
+        assert!(!text.contains("Office") && !text.contains("FCU"));
+        assert!(fragment("floors: []\n").is_empty());
+        assert!(entity_fragment(yaml.as_bytes(), &[b"".as_slice()]).is_empty());
+        // Outside any list item the whole top-level block is the entity
+        let root = "building:\n  name: HQ\n  box:\n    min: 1\nfloors: []\n";
+        let root_fragment = entity_fragment(root.as_bytes(), &[b"building".as_slice()]);
+        assert_eq!(
+            root_fragment,
+            b"building:\n  name: HQ\n  box:\n    min: 1\n"
+        );
+
+        // Unrelated edits keep the fragment; own fields and moves change it
+        assert_eq!(fragment(&yaml.replace("Office", "Open Office")), base);
+        assert_eq!(fragment(&yaml.replace("name: FCU", "name: FCU-2")), base);
+        assert_ne!(fragment(&yaml.replace("'1200'", "'900'")), base);
+        let moved = yaml
+            .replace("      - ahu-1\n", "")
+            .replace("equipment: []", "equipment:\n      - ahu-1");
+        assert_ne!(fragment(&moved), base);
+        assert_ne!(fragment(&yaml.replace("id: r1", "id: r9")), base);
+    }
+
+    fn commit_building(repo: &Repository, building: &Building, message: &str) {
+        let document = BuildingYamlSerializer::document(building);
+        let yaml = BuildingYamlSerializer::serialize_document(&document).unwrap();
+        std::fs::write(repo.workdir().unwrap().join(BUILDING_YAML), yaml).unwrap();
+        let mut index = repo.index().unwrap();
+        index.add_path(std::path::Path::new(BUILDING_YAML)).unwrap();
+        index.write().unwrap();
+        let tree = repo.find_tree(index.write_tree().unwrap()).unwrap();
+        let signature = git2::Signature::now("Test User", "test@example.com").unwrap();
+        let parent = repo.head().ok().and_then(|head| head.peel_to_commit().ok());
+        let parents: Vec<&git2::Commit> = parent.iter().collect();
+        repo.commit(
+            Some("HEAD"),
+            &signature,
+            &signature,
+            message,
+            &tree,
+            &parents,
+        )
+        .unwrap();
+    }
+
+    #[test]
+    fn history_sees_address_keyed_item_moving_rooms() {
+        let temp = tempfile::TempDir::new().unwrap();
+        let repo = Repository::init(temp.path()).unwrap();
+        let mut old = building();
+        old.floors[0].wings[0].rooms[0].equipment[0].address = Some(
+            crate::core::domain::ArxAddress::from_path("/semantic-hq/l1/plant/ahu-1").unwrap(),
+        );
+        commit_building(&repo, &old, "add AHU");
+
+        // Same address and fields; only the room listing its id changes
+        let mut new = old.clone();
+        let rooms = &mut new.floors[0].wings[0].rooms;
+        let moved = rooms[0].equipment.remove(0);
+        rooms[1].equipment.push(moved);
+        commit_building(&repo, &new, "move AHU");
+
+        let key = "/semantic-hq/l1/plant/ahu-1";
+        let cache = SemanticDiffCache::default();
+        let history = cache.entity_history(&repo, key).unwrap();
+        let summary: Vec<(ChangeKind, Vec<&str>)> = history
+            .iter()
+            .map(|r| (r.change, r.fields.iter().map(String::as_str).collect()))
+            .collect();
+        assert_eq!(
+            summary,
+            [
+                (ChangeKind::Modified, vec!["parent"]),
+                (ChangeKind::Added, vec![]),
+            ]
+        );
+    }
+}
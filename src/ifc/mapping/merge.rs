@@ -12,8 +12,22 @@
 //!   existing entities are omitted (counted in stats).
 //! - **Existing** (LiDAR): result starts from existing; unmatched existing kept;
 //!   new entities from the scan are added.
+//!
+//! # Indexing
+//!
+//! Identity lookups use typed keys borrowed from the existing model, and the
+//! proximity fallback queries R-trees built per floor (or per edited list).
+//! Floors do not share state, so they merge in parallel; the result is the
+//! same as a sequential floor-by-floor merge.
+
+use std::collections::hash_map::RandomState;
+use std::collections::{BTreeSet, HashMap, HashSet};
+use std::hash::BuildHasher;
 
-use std::collections::{HashMap, HashSet};
+use chrono::Utc;
+use rayon::prelude::*;
+use rstar::primitives::GeomWithData;
+use rstar::RTree;
 
 use crate::core::{Building, Equipment, EquipmentType, Floor, Position, Room};
 
@@ -149,124 +163,141 @@ fn merge_incoming_base(
 
     merge_building_metadata(&mut building, existing);
 
-    let (existing_floors, existing_rooms, existing_equipment) = index_existing(existing);
-    let mut matched_room_keys: HashSet<String> = HashSet::new();
-    let mut matched_eq_keys: HashSet<String> = HashSet::new();
+    let index = ExistingIndex::build(existing, policy);
+
+    // Floors only read the shared index, so they merge independently; the
+    // matched key sets are unions, making the totals order-independent.
+    let outcomes: Vec<FloorOutcome> = building
+        .floors
+        .par_iter_mut()
+        .map(|floor| merge_incoming_floor(floor, existing, &index, policy))
+        .collect();
+
+    let mut matched_room_keys: HashSet<KeySlot> = HashSet::new();
+    let mut matched_eq_keys: HashSet<KeySlot> = HashSet::new();
+    for outcome in outcomes {
+        accumulate_stats(&mut stats, &outcome.stats);
+        matched_room_keys.extend(outcome.matched_rooms);
+        matched_eq_keys.extend(outcome.matched_equipment);
+    }
+    building.invalidate_spatial_index();
 
-    for floor in &mut building.floors {
-        let floor_path = floor.name.clone();
-        if let Some(old_floor) = find_floor(&existing_floors, floor) {
-            stats.floors_matched += 1;
-            apply_floor_identity(floor, old_floor);
-        } else {
-            stats.floors_added += 1;
-        }
+    finish_orphan_stats(
+        &mut stats,
+        &mut warnings,
+        index.rooms.key_count(),
+        matched_room_keys.len(),
+        index.equipment.key_count(),
+        matched_eq_keys.len(),
+        policy,
+    );
 
-        // Spatial room candidates from existing floor (clone positions for matching)
-        let spatial_room_candidates: Vec<(String, Position)> = existing
-            .floors
-            .iter()
-            .filter(|f| f.level == floor.level || f.name == floor.name || f.id == floor.id)
-            .flat_map(|f| {
-                f.wings.iter().flat_map(|w| {
-                    w.rooms
-                        .iter()
-                        .map(|r| (r.id.clone(), r.spatial_properties.position.clone()))
-                })
-            })
-            .collect();
+    MergeResult {
+        building,
+        stats,
+        warnings,
+    }
+}
+
+/// Per-floor result of an incoming-base merge.
+#[derive(Default)]
+struct FloorOutcome {
+    stats: MergeStats,
+    matched_rooms: Vec<KeySlot>,
+    matched_equipment: Vec<KeySlot>,
+}
+
+fn merge_incoming_floor(
+    floor: &mut Floor,
+    existing: &Building,
+    index: &ExistingIndex<'_>,
+    policy: &MergePolicy,
+) -> FloorOutcome {
+    let mut out = FloorOutcome::default();
+    if let Some(old_floor) = find_floor(&existing.floors, floor) {
+        out.stats.floors_matched += 1;
+        apply_floor_identity(floor, old_floor);
+    } else {
+        out.stats.floors_added += 1;
+    }
+
+    // Existing floors whose rooms are spatial candidates for this floor
+    let candidate_floors: Vec<usize> = existing
+        .floors
+        .iter()
+        .enumerate()
+        .filter(|(_, f)| f.level == floor.level || f.name == floor.name || f.id == floor.id)
+        .map(|(i, _)| i)
+        .collect();
+
+    let floor_name = floor.name.as_str();
+    for eq in &mut floor.equipment {
+        let path = EntityPath::new(floor_name, None, None, &eq.name);
+        match find_equipment(index, eq, path, policy, None) {
+            Some((key, old_eq)) => {
+                out.stats.equipment_matched += 1;
+                out.matched_equipment.push(key);
+                merge_equipment_fields(eq, old_eq, policy);
+            }
+            None => out.stats.equipment_added += 1,
+        }
+    }
 
-        for eq in &mut floor.equipment {
-            let path = format!("{}/{}", floor_path, eq.name);
-            match find_equipment(&existing_equipment, eq, &path, policy, &[]) {
+    for wing in &mut floor.wings {
+        let wing_name = wing.name.as_str();
+        for eq in &mut wing.equipment {
+            let path = EntityPath::new(floor_name, Some(wing_name), None, &eq.name);
+            match find_equipment(index, eq, path, policy, None) {
                 Some((key, old_eq)) => {
-                    stats.equipment_matched += 1;
-                    matched_eq_keys.insert(key);
+                    out.stats.equipment_matched += 1;
+                    out.matched_equipment.push(key);
                     merge_equipment_fields(eq, old_eq, policy);
                 }
-                None => stats.equipment_added += 1,
+                None => out.stats.equipment_added += 1,
             }
         }
 
-        for wing in &mut floor.wings {
-            let wing_path = format!("{}/{}", floor_path, wing.name);
-            for eq in &mut wing.equipment {
-                let path = format!("{}/{}", wing_path, eq.name);
-                match find_equipment(&existing_equipment, eq, &path, policy, &[]) {
-                    Some((key, old_eq)) => {
-                        stats.equipment_matched += 1;
-                        matched_eq_keys.insert(key);
-                        merge_equipment_fields(eq, old_eq, policy);
-                    }
-                    None => stats.equipment_added += 1,
+        for room in &mut wing.rooms {
+            let path = EntityPath::new(floor_name, None, None, &room.name);
+            let path_wing = EntityPath::new(floor_name, Some(wing_name), None, &room.name);
+            match find_room(index, room, path, path_wing, policy, &candidate_floors) {
+                Some((key, old_room)) => {
+                    out.stats.rooms_matched += 1;
+                    out.matched_rooms.push(key);
+                    merge_room_fields(room, old_room, policy);
                 }
+                None => out.stats.rooms_added += 1,
             }
 
-            for room in &mut wing.rooms {
-                let room_path = format!("{}/{}", floor_path, room.name);
-                let room_path_wing = format!("{}/{}/{}", floor_path, wing.name, room.name);
-                match find_room(
-                    &existing_rooms,
-                    room,
-                    &room_path,
-                    &room_path_wing,
-                    policy,
-                    &spatial_room_candidates,
-                ) {
-                    Some((key, old_room)) => {
-                        stats.rooms_matched += 1;
-                        matched_room_keys.insert(key);
-                        merge_room_fields(room, old_room, policy);
-                    }
-                    None => stats.rooms_added += 1,
-                }
+            // Equipment spatial candidates from matched old room (by id)
+            let old_room = index.rooms.get(MatchKey::Id(&room.id)).map(|(_, r)| r);
+            let candidates = match (old_room, policy.equipment_match_radius_m) {
+                (Some(old), Some(_)) => Some((
+                    old.equipment.as_slice(),
+                    PointIndex::new(old.equipment.iter().map(|e| &e.position)),
+                )),
+                _ => None,
+            };
 
-                // Equipment spatial candidates from matched old room (by id)
-                let room_id_for_eq = room.id.clone();
-                let spatial_eq: Vec<(String, Position, EquipmentType)> = existing_rooms
-                    .get(&format!("id:{}", room_id_for_eq))
-                    .map(|r| {
-                        r.equipment
-                            .iter()
-                            .map(|e| (e.id.clone(), e.position.clone(), e.equipment_type.clone()))
-                            .collect()
-                    })
-                    .unwrap_or_default();
-
-                for eq in &mut room.equipment {
-                    let path = format!("{}/{}/{}", wing_path, room.name, eq.name);
-                    match find_equipment(&existing_equipment, eq, &path, policy, &spatial_eq) {
-                        Some((key, old_eq)) => {
-                            stats.equipment_matched += 1;
-                            matched_eq_keys.insert(key);
-                            merge_equipment_fields(eq, old_eq, policy);
-                            eq.room_id = Some(room.id.clone());
-                        }
-                        None => {
-                            stats.equipment_added += 1;
-                            eq.room_id = Some(room.id.clone());
-                        }
+            for eq in &mut room.equipment {
+                let path = EntityPath::new(floor_name, Some(wing_name), Some(&room.name), &eq.name);
+                let spatial = candidates.as_ref().map(|(list, points)| (*list, points));
+                match find_equipment(index, eq, path, policy, spatial) {
+                    Some((key, old_eq)) => {
+                        out.stats.equipment_matched += 1;
+                        out.matched_equipment.push(key);
+                        merge_equipment_fields(eq, old_eq, policy);
+                        eq.room_id = Some(room.id.clone());
+                    }
+                    None => {
+                        out.stats.equipment_added += 1;
+                        eq.room_id = Some(room.id.clone());
                     }
                 }
             }
         }
     }
-
-    finish_orphan_stats(
-        &mut stats,
-        &mut warnings,
-        existing_rooms.len(),
-        matched_room_keys.len(),
-        existing_equipment.len(),
-        matched_eq_keys.len(),
-        policy,
-    );
-
-    MergeResult {
-        building,
-        stats,
-        warnings,
-    }
+    out
 }
 
 // ---------------------------------------------------------------------------
@@ -288,183 +319,206 @@ fn merge_existing_base(
         building.name = incoming.name.clone();
     }
 
+    // Route every incoming floor to the floor it merges into, in input
+    // order: an unmatched floor is appended and later floors may match it.
+    let mut floors = std::mem::take(&mut building.floors);
+    let base_floors = floors.len();
+    let mut groups: Vec<Vec<Floor>> = vec![Vec::new(); base_floors];
     for incoming_floor in incoming.floors {
-        let floor_idx = building
-            .floors
+        let target = floors
             .iter()
             .position(|f| f.level == incoming_floor.level || f.name == incoming_floor.name);
-
-        let floor_idx = match floor_idx {
+        match target {
             Some(i) => {
                 stats.floors_matched += 1;
-                if building.floors[i].elevation.is_none() {
-                    building.floors[i].elevation = incoming_floor.elevation;
-                }
-                for (k, v) in &incoming_floor.properties {
-                    building.floors[i]
-                        .properties
-                        .entry(k.clone())
-                        .or_insert_with(|| v.clone());
-                }
-                i
+                groups[i].push(incoming_floor);
             }
             None => {
                 stats.floors_added += 1;
-                building.add_floor(incoming_floor);
-                continue;
+                floors.push(incoming_floor);
+                groups.push(Vec::new());
             }
-        };
+        }
+    }
 
-        // Work on a clone of wings to avoid borrow issues, then write back
-        let floor_name = building.floors[floor_idx].name.clone();
-        let mut wings = building.floors[floor_idx].wings.clone();
+    // Each target floor receives its incoming floors in order; distinct
+    // targets share nothing and merge in parallel.
+    let floor_stats: Vec<MergeStats> = floors
+        .par_iter_mut()
+        .zip(groups.into_par_iter())
+        .map(|(floor, group)| {
+            let mut stats = MergeStats::default();
+            for incoming_floor in group {
+                merge_existing_floor(floor, incoming_floor, policy, &mut stats);
+            }
+            stats
+        })
+        .collect();
+    for part in &floor_stats {
+        accumulate_stats(&mut stats, part);
+    }
 
-        for incoming_wing in incoming_floor.wings {
-            let wing_idx = wings.iter().position(|w| w.name == incoming_wing.name);
-            let wing_idx = match wing_idx {
-                Some(i) => i,
-                None => {
-                    wings.push(incoming_wing);
-                    // count rooms/equipment as added
-                    let w = wings.last().unwrap();
-                    stats.rooms_added += w.rooms.len();
-                    stats.equipment_added +=
-                        w.rooms.iter().map(|r| r.equipment.len()).sum::<usize>()
-                            + w.equipment.len();
-                    continue;
-                }
-            };
+    if floors.len() > base_floors {
+        building.updated_at = Utc::now();
+    }
+    building.floors = floors;
+    building.invalidate_spatial_index();
 
-            for mut incoming_room in incoming_wing.rooms {
-                let room_path = format!("{}/{}", floor_name, incoming_room.name);
-                let room_path_wing = format!(
-                    "{}/{}/{}",
-                    floor_name, wings[wing_idx].name, incoming_room.name
-                );
+    // Existing base keeps unmatched existing; zero orphan counts
+    stats.existing_rooms_not_in_incoming = 0;
+    stats.existing_equipment_not_in_incoming = 0;
 
-                // Build temporary index of current wing rooms for matching
-                let room_match = {
-                    let rooms_ref: Vec<&Room> = wings[wing_idx].rooms.iter().collect();
-                    find_room_in_list(
-                        &rooms_ref,
-                        &incoming_room,
-                        &room_path,
-                        &room_path_wing,
-                        policy,
-                    )
-                };
-
-                match room_match {
-                    Some(ri) => {
-                        stats.rooms_matched += 1;
-                        let old_room = wings[wing_idx].rooms[ri].clone();
-                        merge_room_fields(&mut incoming_room, &old_room, policy);
-                        // Keep name from existing when spatial match used different names? Prefer incoming name for scan labels
-                        // Preserve id from old (done in merge_room_fields)
-
-                        // Merge equipment into the matched room
-                        let mut merged_eq = old_room.equipment.clone();
-                        for mut inc_eq in incoming_room.equipment.drain(..) {
-                            let eq_path = format!(
-                                "{}/{}/{}/{}",
-                                floor_name, wings[wing_idx].name, old_room.name, inc_eq.name
-                            );
-                            let eq_match = find_equipment_in_list(
-                                &merged_eq.iter().collect::<Vec<_>>(),
-                                &inc_eq,
-                                &eq_path,
-                                policy,
-                            );
-                            match eq_match {
-                                Some(ei) => {
-                                    stats.equipment_matched += 1;
-                                    let old_eq = merged_eq[ei].clone();
-                                    merge_equipment_fields(&mut inc_eq, &old_eq, policy);
-                                    inc_eq.room_id = Some(incoming_room.id.clone());
-                                    merged_eq[ei] = inc_eq;
-                                }
-                                None => {
-                                    stats.equipment_added += 1;
-                                    inc_eq.room_id = Some(incoming_room.id.clone());
-                                    merged_eq.push(inc_eq);
-                                }
-                            }
-                        }
-                        incoming_room.equipment = merged_eq;
-                        wings[wing_idx].rooms[ri] = incoming_room;
-                    }
-                    None => {
-                        stats.rooms_added += 1;
-                        stats.equipment_added += incoming_room.equipment.len();
-                        for eq in &mut incoming_room.equipment {
-                            eq.room_id = Some(incoming_room.id.clone());
-                        }
-                        wings[wing_idx].rooms.push(incoming_room);
-                    }
-                }
-            }
+    MergeResult {
+        building,
+        stats,
+        warnings,
+    }
+}
 
-            // Wing-level equipment
-            for mut inc_eq in incoming_wing.equipment {
-                let eq_path = format!("{}/{}/{}", floor_name, wings[wing_idx].name, inc_eq.name);
-                let eq_match = find_equipment_in_list(
-                    &wings[wing_idx].equipment.iter().collect::<Vec<_>>(),
-                    &inc_eq,
-                    &eq_path,
-                    policy,
-                );
-                match eq_match {
-                    Some(ei) => {
-                        stats.equipment_matched += 1;
-                        let old_eq = wings[wing_idx].equipment[ei].clone();
-                        merge_equipment_fields(&mut inc_eq, &old_eq, policy);
-                        wings[wing_idx].equipment[ei] = inc_eq;
-                    }
-                    None => {
-                        stats.equipment_added += 1;
-                        wings[wing_idx].equipment.push(inc_eq);
-                    }
-                }
-            }
-        }
+fn merge_existing_floor(
+    floor: &mut Floor,
+    incoming_floor: Floor,
+    policy: &MergePolicy,
+    stats: &mut MergeStats,
+) {
+    if floor.elevation.is_none() {
+        floor.elevation = incoming_floor.elevation;
+    }
+    for (k, v) in &incoming_floor.properties {
+        floor
+            .properties
+            .entry(k.clone())
+            .or_insert_with(|| v.clone());
+    }
 
-        // Floor-level equipment from incoming
-        for mut inc_eq in incoming_floor.equipment {
-            let eq_path = format!("{}/{}", floor_name, inc_eq.name);
-            let eq_match = find_equipment_in_list(
-                &building.floors[floor_idx]
-                    .equipment
+    let wings = &mut floor.wings;
+    // Built on first use per wing, then kept in step with list edits
+    let mut room_indexes: Vec<Option<ListIndex>> = vec![None; wings.len()];
+    let mut equipment_indexes: Vec<Option<ListIndex>> = vec![None; wings.len()];
+
+    for incoming_wing in incoming_floor.wings {
+        let wing_idx = wings.iter().position(|w| w.name == incoming_wing.name);
+        let wing_idx = match wing_idx {
+            Some(i) => i,
+            None => {
+                // count rooms/equipment as added
+                stats.rooms_added += incoming_wing.rooms.len();
+                stats.equipment_added += incoming_wing
+                    .rooms
                     .iter()
-                    .collect::<Vec<_>>(),
-                &inc_eq,
-                &eq_path,
-                policy,
+                    .map(|r| r.equipment.len())
+                    .sum::<usize>()
+                    + incoming_wing.equipment.len();
+                wings.push(incoming_wing);
+                room_indexes.push(None);
+                equipment_indexes.push(None);
+                continue;
+            }
+        };
+        let wing = &mut wings[wing_idx];
+        let rooms_index = room_indexes[wing_idx].get_or_insert_with(|| ListIndex::new(&wing.rooms));
+
+        for mut incoming_room in incoming_wing.rooms {
+            let room_match = find_in_list(
+                rooms_index,
+                &wing.rooms,
+                &incoming_room,
+                policy.room_match_radius_m,
+                |_| true,
             );
-            match eq_match {
-                Some(ei) => {
-                    stats.equipment_matched += 1;
-                    let old_eq = building.floors[floor_idx].equipment[ei].clone();
-                    merge_equipment_fields(&mut inc_eq, &old_eq, policy);
-                    building.floors[floor_idx].equipment[ei] = inc_eq;
+
+            match room_match {
+                Some(ri) => {
+                    stats.rooms_matched += 1;
+                    let old_room = &wing.rooms[ri];
+                    merge_room_fields(&mut incoming_room, old_room, policy);
+                    // Keep name from existing when spatial match used different names? Prefer incoming name for scan labels
+                    // Preserve id from old (done in merge_room_fields)
+
+                    // Merge equipment into the matched room
+                    let mut merged_eq = old_room.equipment.clone();
+                    let mut eq_index = ListIndex::new(&merged_eq);
+                    for mut inc_eq in incoming_room.equipment.drain(..) {
+                        let eq_match = find_in_list(
+                            &eq_index,
+                            &merged_eq,
+                            &inc_eq,
+                            policy.equipment_match_radius_m,
+                            |e| {
+                                equipment_types_compatible(
+                                    &e.equipment_type,
+                                    &inc_eq.equipment_type,
+                                )
+                            },
+                        );
+                        inc_eq.room_id = Some(incoming_room.id.clone());
+                        match eq_match {
+                            Some(ei) => {
+                                stats.equipment_matched += 1;
+                                merge_equipment_fields(&mut inc_eq, &merged_eq[ei], policy);
+                                eq_index.replace(ei, &merged_eq[ei], &inc_eq);
+                                merged_eq[ei] = inc_eq;
+                            }
+                            None => {
+                                stats.equipment_added += 1;
+                                eq_index.insert(merged_eq.len(), &inc_eq);
+                                merged_eq.push(inc_eq);
+                            }
+                        }
+                    }
+                    incoming_room.equipment = merged_eq;
+                    rooms_index.replace(ri, &wing.rooms[ri], &incoming_room);
+                    wing.rooms[ri] = incoming_room;
                 }
                 None => {
-                    stats.equipment_added += 1;
-                    building.floors[floor_idx].equipment.push(inc_eq);
+                    stats.rooms_added += 1;
+                    stats.equipment_added += incoming_room.equipment.len();
+                    for eq in &mut incoming_room.equipment {
+                        eq.room_id = Some(incoming_room.id.clone());
+                    }
+                    rooms_index.insert(wing.rooms.len(), &incoming_room);
+                    wing.rooms.push(incoming_room);
                 }
             }
         }
 
-        building.floors[floor_idx].wings = wings;
+        // Wing-level equipment
+        let eq_index =
+            equipment_indexes[wing_idx].get_or_insert_with(|| ListIndex::new(&wing.equipment));
+        for inc_eq in incoming_wing.equipment {
+            merge_equipment_into_list(eq_index, &mut wing.equipment, inc_eq, policy, stats);
+        }
     }
 
-    // Existing base keeps unmatched existing; zero orphan counts
-    stats.existing_rooms_not_in_incoming = 0;
-    stats.existing_equipment_not_in_incoming = 0;
+    // Floor-level equipment from incoming
+    let mut eq_index = ListIndex::new(&floor.equipment);
+    for inc_eq in incoming_floor.equipment {
+        merge_equipment_into_list(&mut eq_index, &mut floor.equipment, inc_eq, policy, stats);
+    }
+}
 
-    MergeResult {
-        building,
-        stats,
-        warnings,
+fn merge_equipment_into_list(
+    index: &mut ListIndex,
+    list: &mut Vec<Equipment>,
+    mut inc_eq: Equipment,
+    policy: &MergePolicy,
+    stats: &mut MergeStats,
+) {
+    let eq_match = find_in_list(index, list, &inc_eq, policy.equipment_match_radius_m, |e| {
+        equipment_types_compatible(&e.equipment_type, &inc_eq.equipment_type)
+    });
+    match eq_match {
+        Some(ei) => {
+            stats.equipment_matched += 1;
+            merge_equipment_fields(&mut inc_eq, &list[ei], policy);
+            index.replace(ei, &list[ei], &inc_eq);
+            list[ei] = inc_eq;
+        }
+        None => {
+            stats.equipment_added += 1;
+            index.insert(list.len(), &inc_eq);
+            list.push(inc_eq);
+        }
     }
 }
 
@@ -624,250 +678,488 @@ fn distance(p1: &Position, p2: &Position) -> f64 {
     ((p1.x - p2.x).powi(2) + (p1.y - p2.y).powi(2) + (p1.z - p2.z).powi(2)).sqrt()
 }
 
-type FloorIndex<'a> = Vec<&'a Floor>;
-type RoomIndex<'a> = HashMap<String, &'a Room>;
-type EquipmentIndex<'a> = HashMap<String, &'a Equipment>;
+fn accumulate_stats(total: &mut MergeStats, part: &MergeStats) {
+    total.floors_matched += part.floors_matched;
+    total.floors_added += part.floors_added;
+    total.rooms_matched += part.rooms_matched;
+    total.rooms_added += part.rooms_added;
+    total.equipment_matched += part.equipment_matched;
+    total.equipment_added += part.equipment_added;
+}
 
-fn index_existing(existing: &Building) -> (FloorIndex<'_>, RoomIndex<'_>, EquipmentIndex<'_>) {
-    let mut floors = Vec::new();
-    let mut rooms = HashMap::new();
-    let mut equipment = HashMap::new();
+/// Hierarchical name path of a room or equipment item below its floor.
+#[derive(Debug, Clone, Copy, PartialEq, Eq, Hash)]
+struct EntityPath<'s> {
+    floor: &'s str,
+    wing: Option<&'s str>,
+    room: Option<&'s str>,
+    name: &'s str,
+}
 
-    for floor in &existing.floors {
-        floors.push(floor);
-        for eq in &floor.equipment {
-            insert_equipment_keys(&mut equipment, eq, &format!("{}/{}", floor.name, eq.name));
+impl<'s> EntityPath<'s> {
+    fn new(floor: &'s str, wing: Option<&'s str>, room: Option<&'s str>, name: &'s str) -> Self {
+        Self {
+            floor,
+            wing,
+            room,
+            name,
         }
-        for wing in &floor.wings {
-            for eq in &wing.equipment {
-                insert_equipment_keys(
-                    &mut equipment,
+    }
+}
+
+/// Identity key of an existing entity, borrowing its strings.
+#[derive(Debug, Clone, Copy, PartialEq, Eq, Hash)]
+enum MatchKey<'s> {
+    GlobalId(&'s str),
+    Id(&'s str),
+    Path(EntityPath<'s>),
+}
+
+/// Insertion number of a key in a [`KeyIndex`]; stands in for the key
+/// itself when recording which existing keys were matched.
+type KeySlot = usize;
+
+/// Existing entities by identity key; the first entity to claim a key wins.
+struct KeyIndex<'a, T> {
+    entries: Vec<&'a T>,
+    keys: HashMap<MatchKey<'a>, (KeySlot, usize)>,
+}
+
+impl<'a, T> KeyIndex<'a, T> {
+    fn new() -> Self {
+        Self {
+            entries: Vec::new(),
+            keys: HashMap::new(),
+        }
+    }
+
+    fn push(&mut self, entity: &'a T, keys: impl IntoIterator<Item = MatchKey<'a>>) {
+        let entry = self.entries.len();
+        self.entries.push(entity);
+        for key in keys {
+            let slot = self.keys.len();
+            self.keys.entry(key).or_insert((slot, entry));
+        }
+    }
+
+    /// Number of distinct keys (what the orphan statistics count).
+    fn key_count(&self) -> usize {
+        self.keys.len()
+    }
+
+    fn get(&self, key: MatchKey<'_>) -> Option<(KeySlot, &'a T)> {
+        // Probe keys borrow the incoming model; shorten the map's key lifetime
+        let keys: &HashMap<MatchKey<'_>, (KeySlot, usize)> = &self.keys;
+        keys.get(&key)
+            .map(|&(slot, entry)| (slot, self.entries[entry]))
+    }
+}
+
+fn identity_keys<'a>(
+    global_id: Option<&'a str>,
+    id: &'a str,
+    paths: impl IntoIterator<Item = EntityPath<'a>>,
+) -> impl Iterator<Item = MatchKey<'a>> {
+    global_id
+        .filter(|gid| !gid.is_empty())
+        .map(MatchKey::GlobalId)
+        .into_iter()
+        .chain(std::iter::once(MatchKey::Id(id)))
+        .chain(paths.into_iter().map(MatchKey::Path))
+}
+
+/// Read-only lookup structures over the existing building (incoming base).
+struct ExistingIndex<'a> {
+    rooms: KeyIndex<'a, Room>,
+    equipment: KeyIndex<'a, Equipment>,
+    /// Per existing floor: its rooms in wing order and their positions.
+    /// Only built when the policy enables spatial room matching.
+    floor_rooms: Vec<(Vec<&'a Room>, PointIndex)>,
+}
+
+impl<'a> ExistingIndex<'a> {
+    fn build(existing: &'a Building, policy: &MergePolicy) -> Self {
+        let mut rooms = KeyIndex::new();
+        let mut equipment = KeyIndex::new();
+
+        for floor in &existing.floors {
+            let f = floor.name.as_str();
+            for eq in &floor.equipment {
+                let path = EntityPath::new(f, None, None, &eq.name);
+                equipment.push(
                     eq,
-                    &format!("{}/{}/{}", floor.name, wing.name, eq.name),
+                    identity_keys(eq.ifc_global_id.as_deref(), &eq.id, [path]),
                 );
             }
-            for room in &wing.rooms {
-                let path = format!("{}/{}", floor.name, room.name);
-                let path_wing = format!("{}/{}/{}", floor.name, wing.name, room.name);
-                insert_room_keys(&mut rooms, room, &path);
-                insert_room_keys(&mut rooms, room, &path_wing);
-                for eq in &room.equipment {
-                    insert_equipment_keys(
-                        &mut equipment,
+            for wing in &floor.wings {
+                let w = Some(wing.name.as_str());
+                for eq in &wing.equipment {
+                    let path = EntityPath::new(f, w, None, &eq.name);
+                    equipment.push(
                         eq,
-                        &format!("{}/{}/{}/{}", floor.name, wing.name, room.name, eq.name),
+                        identity_keys(eq.ifc_global_id.as_deref(), &eq.id, [path]),
+                    );
+                }
+                for room in &wing.rooms {
+                    let paths = [
+                        EntityPath::new(f, None, None, &room.name),
+                        EntityPath::new(f, w, None, &room.name),
+                    ];
+                    rooms.push(
+                        room,
+                        identity_keys(room.ifc_global_id.as_deref(), &room.id, paths),
                     );
+                    for eq in &room.equipment {
+                        let path = EntityPath::new(f, w, Some(&room.name), &eq.name);
+                        equipment.push(
+                            eq,
+                            identity_keys(eq.ifc_global_id.as_deref(), &eq.id, [path]),
+                        );
+                    }
                 }
             }
         }
-    }
-
-    (floors, rooms, equipment)
-}
 
-fn insert_room_keys<'a>(index: &mut RoomIndex<'a>, room: &'a Room, path: &str) {
-    if let Some(ref gid) = room.ifc_global_id {
-        if !gid.is_empty() {
-            index.entry(format!("gid:{}", gid)).or_insert(room);
-        }
-    }
-    index.entry(format!("id:{}", room.id)).or_insert(room);
-    index.entry(format!("path:{}", path)).or_insert(room);
-}
+        let floor_rooms = if policy.room_match_radius_m.is_some() {
+            existing
+                .floors
+                .par_iter()
+                .map(|floor| {
+                    let list: Vec<&Room> =
+                        floor.wings.iter().flat_map(|w| w.rooms.iter()).collect();
+                    let points =
+                        PointIndex::new(list.iter().map(|r| &r.spatial_properties.position));
+                    (list, points)
+                })
+                .collect()
+        } else {
+            Vec::new()
+        };
 
-fn insert_equipment_keys<'a>(index: &mut EquipmentIndex<'a>, eq: &'a Equipment, path: &str) {
-    if let Some(ref gid) = eq.ifc_global_id {
-        if !gid.is_empty() {
-            index.entry(format!("gid:{}", gid)).or_insert(eq);
+        Self {
+            rooms,
+            equipment,
+            floor_rooms,
         }
     }
-    index.entry(format!("id:{}", eq.id)).or_insert(eq);
-    index.entry(format!("path:{}", path)).or_insert(eq);
 }
 
-fn find_floor<'a>(floors: &FloorIndex<'a>, floor: &Floor) -> Option<&'a Floor> {
+fn find_floor<'a>(floors: &'a [Floor], floor: &Floor) -> Option<&'a Floor> {
     if let Some(ref gid) = floor.ifc_global_id {
         if !gid.is_empty() {
             if let Some(f) = floors
                 .iter()
                 .find(|f| f.ifc_global_id.as_deref() == Some(gid.as_str()))
             {
-                return Some(*f);
+                return Some(f);
             }
         }
     }
     if let Some(f) = floors.iter().find(|f| f.id == floor.id) {
-        return Some(*f);
+        return Some(f);
     }
     if let Some(f) = floors.iter().find(|f| f.level == floor.level) {
-        return Some(*f);
+        return Some(f);
     }
-    floors.iter().find(|f| f.name == floor.name).copied()
+    floors.iter().find(|f| f.name == floor.name)
 }
 
 fn find_room<'a>(
-    index: &RoomIndex<'a>,
+    index: &ExistingIndex<'a>,
     room: &Room,
-    path: &str,
-    path_wing: &str,
+    path: EntityPath<'_>,
+    path_wing: EntityPath<'_>,
     policy: &MergePolicy,
-    spatial_candidates: &[(String, Position)],
-) -> Option<(String, &'a Room)> {
+    candidate_floors: &[usize],
+) -> Option<(KeySlot, &'a Room)> {
     if let Some(ref gid) = room.ifc_global_id {
-        let key = format!("gid:{}", gid);
-        if let Some(r) = index.get(&key) {
-            return Some((key, *r));
+        if let Some(hit) = index.rooms.get(MatchKey::GlobalId(gid)) {
+            return Some(hit);
         }
     }
-    let id_key = format!("id:{}", room.id);
-    if let Some(r) = index.get(&id_key) {
-        return Some((id_key, *r));
+    if let Some(hit) = index.rooms.get(MatchKey::Id(&room.id)) {
+        return Some(hit);
     }
-    let p1 = format!("path:{}", path);
-    if let Some(r) = index.get(&p1) {
-        return Some((p1, *r));
+    if let Some(hit) = index.rooms.get(MatchKey::Path(path)) {
+        return Some(hit);
     }
-    let p2 = format!("path:{}", path_wing);
-    if let Some(r) = index.get(&p2) {
-        return Some((p2, *r));
+    if let Some(hit) = index.rooms.get(MatchKey::Path(path_wing)) {
+        return Some(hit);
     }
 
-    // Spatial fallback (LiDAR) — candidates are (room_id, position)
+    // Spatial fallback (LiDAR): closest room on the candidate floors, ties
+    // going to the earliest floor and room
     if let Some(radius) = policy.room_match_radius_m {
-        let mut best: Option<(&str, f64)> = None;
-        for (id, pos) in spatial_candidates {
-            let d = distance(&room.spatial_properties.position, pos);
-            if d < radius && best.map(|(_, bd)| d < bd).unwrap_or(true) {
-                best = Some((id.as_str(), d));
-            }
-        }
-        if let Some((id, _)) = best {
-            let key = format!("id:{}", id);
-            if let Some(r) = index.get(&key) {
-                return Some((key, *r));
-            }
+        let position = &room.spatial_properties.position;
+        let best = candidate_floors
+            .iter()
+            .filter_map(|&f| {
+                let (rooms, points) = &index.floor_rooms[f];
+                points
+                    .closest_within(position, radius, |_| true)
+                    .map(|(i, d)| (d, rooms[i]))
+            })
+            .fold(None, |best: Option<(f64, &Room)>, (d, r)| match best {
+                Some((bd, _)) if d >= bd => best,
+                _ => Some((d, r)),
+            });
+        if let Some((_, candidate)) = best {
+            return index.rooms.get(MatchKey::Id(&candidate.id));
         }
     }
     None
 }
 
-fn find_room_in_list(
-    rooms: &[&Room],
-    room: &Room,
-    path: &str,
-    path_wing: &str,
+fn find_equipment<'a>(
+    index: &ExistingIndex<'a>,
+    eq: &Equipment,
+    path: EntityPath<'_>,
     policy: &MergePolicy,
-) -> Option<usize> {
-    if let Some(ref gid) = room.ifc_global_id {
-        if let Some(i) = rooms
-            .iter()
-            .position(|r| r.ifc_global_id.as_deref() == Some(gid.as_str()))
-        {
-            return Some(i);
+    spatial_candidates: Option<(&[Equipment], &PointIndex)>,
+) -> Option<(KeySlot, &'a Equipment)> {
+    if let Some(ref gid) = eq.ifc_global_id {
+        if let Some(hit) = index.equipment.get(MatchKey::GlobalId(gid)) {
+            return Some(hit);
         }
     }
-    if let Some(i) = rooms.iter().position(|r| r.id == room.id) {
-        return Some(i);
+    if let Some(hit) = index.equipment.get(MatchKey::Id(&eq.id)) {
+        return Some(hit);
     }
-    if let Some(i) = rooms.iter().position(|r| r.name == room.name) {
-        // path-ish match by name
-        let _ = (path, path_wing);
-        return Some(i);
+    if let Some(hit) = index.equipment.get(MatchKey::Path(path)) {
+        return Some(hit);
     }
-    if let Some(radius) = policy.room_match_radius_m {
-        let mut best: Option<(usize, f64)> = None;
-        for (i, r) in rooms.iter().enumerate() {
-            let d = distance(
-                &room.spatial_properties.position,
-                &r.spatial_properties.position,
-            );
-            if d < radius && best.map(|(_, bd)| d < bd).unwrap_or(true) {
-                best = Some((i, d));
-            }
+
+    if let (Some(radius), Some((list, points))) =
+        (policy.equipment_match_radius_m, spatial_candidates)
+    {
+        let best = points.closest_within(&eq.position, radius, |i| {
+            equipment_types_compatible(&list[i].equipment_type, &eq.equipment_type)
+        });
+        if let Some((i, _)) = best {
+            return index.equipment.get(MatchKey::Id(&list[i].id));
         }
-        return best.map(|(i, _)| i);
     }
     None
 }
 
-fn find_equipment<'a>(
-    index: &EquipmentIndex<'a>,
-    eq: &Equipment,
-    path: &str,
-    policy: &MergePolicy,
-    spatial_candidates: &[(String, Position, EquipmentType)],
-) -> Option<(String, &'a Equipment)> {
-    if let Some(ref gid) = eq.ifc_global_id {
-        let key = format!("gid:{}", gid);
-        if let Some(e) = index.get(&key) {
-            return Some((key, *e));
+type PointEntry = GeomWithData<[f64; 3], usize>;
+
+/// R-tree over the positions of one candidate list, keyed by list index.
+#[derive(Clone)]
+struct PointIndex {
+    tree: RTree<PointEntry>,
+}
+
+impl PointIndex {
+    fn new<'p>(positions: impl Iterator<Item = &'p Position>) -> Self {
+        let entries = positions
+            .enumerate()
+            .filter_map(|(i, p)| Self::entry(i, p))
+            .collect();
+        Self {
+            tree: RTree::bulk_load(entries),
         }
     }
-    let id_key = format!("id:{}", eq.id);
-    if let Some(e) = index.get(&id_key) {
-        return Some((id_key, *e));
+
+    /// Non-finite positions are left out: their distance never compares
+    /// below a radius, so they could not match anyway.
+    fn entry(i: usize, p: &Position) -> Option<PointEntry> {
+        let point = [p.x, p.y, p.z];
+        point
+            .iter()
+            .all(|v| v.is_finite())
+            .then(|| GeomWithData::new(point, i))
     }
-    let p = format!("path:{}", path);
-    if let Some(e) = index.get(&p) {
-        return Some((p, *e));
+
+    fn insert(&mut self, i: usize, p: &Position) {
+        if let Some(entry) = Self::entry(i, p) {
+            self.tree.insert(entry);
+        }
     }
 
-    if let Some(radius) = policy.equipment_match_radius_m {
-        let mut best: Option<(&str, f64)> = None;
-        for (id, pos, ty) in spatial_candidates {
-            if !equipment_types_compatible(ty, &eq.equipment_type) {
-                continue;
-            }
-            let d = distance(&eq.position, pos);
-            if d < radius && best.map(|(_, bd)| d < bd).unwrap_or(true) {
-                best = Some((id.as_str(), d));
+    fn remove(&mut self, i: usize, p: &Position) {
+        if let Some(entry) = Self::entry(i, p) {
+            self.tree.remove(&entry);
+        }
+    }
+
+    /// Closest accepted entry strictly closer than `radius`, ties going to
+    /// the lowest list index — the same answer as a linear scan that keeps
+    /// the first strictly better candidate.
+    fn closest_within(
+        &self,
+        position: &Position,
+        radius: f64,
+        accept: impl Fn(usize) -> bool,
+    ) -> Option<(usize, f64)> {
+        let query = [position.x, position.y, position.z];
+        if !query.iter().all(|v| v.is_finite()) || radius.is_nan() || radius <= 0.0 {
+            return None;
+        }
+        // Generous search radius; the exact test below decides membership
+        let max_squared = radius * radius * (1.0 + 1e-9);
+        self.tree
+            .locate_within_distance(query, max_squared)
+            .filter(|entry| accept(entry.data))
+            .filter_map(|entry| {
+                let [x, y, z] = *entry.geom();
+                let d = ((position.x - x).powi(2)
+                    + (position.y - y).powi(2)
+                    + (position.z - z).powi(2))
+                .sqrt();
+                (d < radius).then_some((entry.data, d))
+            })
+            .min_by(|a, b| a.1.total_cmp(&b.1).then(a.0.cmp(&b.0)))
+    }
+}
+
+/// Identity fields shared by rooms and equipment for in-list matching.
+trait Matchable {
+    fn global_id(&self) -> Option<&str>;
+    fn arx_id(&self) -> &str;
+    fn label(&self) -> &str;
+    fn match_position(&self) -> &Position;
+}
+
+impl Matchable for Room {
+    fn global_id(&self) -> Option<&str> {
+        self.ifc_global_id.as_deref()
+    }
+    fn arx_id(&self) -> &str {
+        &self.id
+    }
+    fn label(&self) -> &str {
+        &self.name
+    }
+    fn match_position(&self) -> &Position {
+        &self.spatial_properties.position
+    }
+}
+
+impl Matchable for Equipment {
+    fn global_id(&self) -> Option<&str> {
+        self.ifc_global_id.as_deref()
+    }
+    fn arx_id(&self) -> &str {
+        &self.id
+    }
+    fn label(&self) -> &str {
+        &self.name
+    }
+    fn match_position(&self) -> &Position {
+        &self.position
+    }
+}
+
+#[derive(Debug, Clone, Copy, PartialEq, Eq, Hash)]
+enum ListField {
+    GlobalId,
+    Id,
+    Name,
+}
+
+impl ListField {
+    fn of<T: Matchable>(self, item: &T) -> Option<&str> {
+        match self {
+            ListField::GlobalId => item.global_id(),
+            ListField::Id => Some(item.arx_id()),
+            ListField::Name => Some(item.label()),
+        }
+    }
+}
+
+const LIST_FIELDS: [ListField; 3] = [ListField::GlobalId, ListField::Id, ListField::Name];
+
+/// Index over a room or equipment list that the existing-base merge edits
+/// in place. Field values are keyed by hash (collisions are resolved
+/// against the list itself), each bucket keeping list positions sorted so
+/// "first position with this value" matches a linear `position()` scan.
+#[derive(Clone)]
+struct ListIndex {
+    hasher: RandomState,
+    fields: HashMap<(ListField, u64), BTreeSet<usize>>,
+    points: PointIndex,
+}
+
+impl ListIndex {
+    fn new<T: Matchable>(list: &[T]) -> Self {
+        let mut index = Self {
+            hasher: RandomState::new(),
+            fields: HashMap::new(),
+            points: PointIndex::new(list.iter().map(|item| item.match_position())),
+        };
+        for (i, item) in list.iter().enumerate() {
+            index.insert_fields(i, item);
+        }
+        index
+    }
+
+    fn hash(&self, field: ListField, value: &str) -> (ListField, u64) {
+        (field, self.hasher.hash_one(value))
+    }
+
+    fn insert_fields<T: Matchable>(&mut self, i: usize, item: &T) {
+        for field in LIST_FIELDS {
+            if let Some(value) = field.of(item) {
+                let key = self.hash(field, value);
+                self.fields.entry(key).or_default().insert(i);
             }
         }
-        if let Some((id, _)) = best {
-            let key = format!("id:{}", id);
-            if let Some(e) = index.get(&key) {
-                return Some((key, *e));
+    }
+
+    /// Record `item` at list position `i` (a push).
+    fn insert<T: Matchable>(&mut self, i: usize, item: &T) {
+        self.insert_fields(i, item);
+        self.points.insert(i, item.match_position());
+    }
+
+    /// Record that position `i` changed from `old` to `new`.
+    fn replace<T: Matchable>(&mut self, i: usize, old: &T, new: &T) {
+        for field in LIST_FIELDS {
+            if let Some(value) = field.of(old) {
+                let key = self.hash(field, value);
+                if let Some(bucket) = self.fields.get_mut(&key) {
+                    bucket.remove(&i);
+                }
             }
         }
+        self.points.remove(i, old.match_position());
+        self.insert(i, new);
+    }
+
+    fn first<T: Matchable>(&self, list: &[T], field: ListField, value: &str) -> Option<usize> {
+        self.fields
+            .get(&self.hash(field, value))?
+            .iter()
+            .copied()
+            .find(|&i| field.of(&list[i]) == Some(value))
     }
-    None
 }
 
-fn find_equipment_in_list(
-    list: &[&Equipment],
-    eq: &Equipment,
-    path: &str,
-    policy: &MergePolicy,
+/// In-list match: global id, then Arx id, then name, then proximity.
+fn find_in_list<T: Matchable>(
+    index: &ListIndex,
+    list: &[T],
+    item: &T,
+    radius: Option<f64>,
+    accept: impl Fn(&T) -> bool,
 ) -> Option<usize> {
-    let _ = path;
-    if let Some(ref gid) = eq.ifc_global_id {
-        if let Some(i) = list
-            .iter()
-            .position(|e| e.ifc_global_id.as_deref() == Some(gid.as_str()))
-        {
+    if let Some(gid) = item.global_id() {
+        if let Some(i) = index.first(list, ListField::GlobalId, gid) {
             return Some(i);
         }
     }
-    if let Some(i) = list.iter().position(|e| e.id == eq.id) {
+    if let Some(i) = index.first(list, ListField::Id, item.arx_id()) {
         return Some(i);
     }
-    if let Some(i) = list.iter().position(|e| e.name == eq.name) {
+    if let Some(i) = index.first(list, ListField::Name, item.label()) {
         return Some(i);
     }
-    if let Some(radius) = policy.equipment_match_radius_m {
-        let mut best: Option<(usize, f64)> = None;
-        for (i, e) in list.iter().enumerate() {
-            if !equipment_types_compatible(&e.equipment_type, &eq.equipment_type) {
-                continue;
-            }
-            let d = distance(&eq.position, &e.position);
-            if d < radius && best.map(|(_, bd)| d < bd).unwrap_or(true) {
-                best = Some((i, d));
-            }
-        }
-        return best.map(|(i, _)| i);
-    }
-    None
+    let radius = radius?;
+    index
+        .points
+        .closest_within(item.match_position(), radius, |i| accept(&list[i]))
+        .map(|(i, _)| i)
 }
 
 fn equipment_types_compatible(a: &EquipmentType, b: &EquipmentType) -> bool {
@@ -1066,4 +1358,127 @@ mod tests {
         assert_eq!(e.lidar_enrichment.as_ref().map(|e| e.point_count), Some(80));
         assert!((e.position.x - 2.25).abs() < 1e-9);
     }
+
+    #[test]
+    fn lidar_merge_routes_floors_in_input_order() {
+        let mut existing = Building::new("Scan".into(), "/s".into());
+        existing.add_floor(Floor::new("Floor 0".into(), 0));
+
+        // Floor 1 is new; the second "Floor 1" must merge into it, and its
+        // room must match the first one spatially rather than be added.
+        let scan_floor = |x: f64| {
+            let mut floor = Floor::new("Floor 1".into(), 1);
+            let mut wing = Wing::new("Main".into());
+            let mut room = Room::new(format!("Room at {}", x), RoomType::Office);
+            room.spatial_properties.position.x = x;
+            wing.add_room(room);
+            floor.add_wing(wing);
+            floor
+        };
+        let mut incoming = Building::new("Scan".into(), "/s".into());
+        incoming.floors.push(scan_floor(1.0));
+        incoming.floors.push(scan_floor(1.5));
+
+        let result = merge_building_with_policy(&existing, incoming, &MergePolicy::lidar());
+        assert_eq!(result.stats.floors_added, 1);
+        assert_eq!(result.stats.floors_matched, 1);
+        assert_eq!(result.stats.rooms_matched, 1);
+        assert_eq!(result.building.floors.len(), 2);
+        let rooms = &result.building.floors[1].wings[0].rooms;
+        assert_eq!(rooms.len(), 1);
+        assert_eq!(rooms[0].name, "Room at 1.5");
+    }
+
+    /// (gid, id, name, x, y, hvac) drawn from small pools so fields collide.
+    type Seed = (Option<u8>, u8, u8, u8, u8, bool);
+
+    fn seeded_equipment((gid, id, name, x, y, hvac): Seed) -> Equipment {
+        let kind = if hvac {
+            EquipmentType::HVAC
+        } else {
+            EquipmentType::Electrical
+        };
+        let mut eq = Equipment::new(format!("eq{}", name), "".into(), kind);
+        eq.id = format!("id{}", id);
+        eq.ifc_global_id = gid.map(|gid| format!("gid{}", gid));
+        eq.position = Position {
+            x: x as f64,
+            y: y as f64,
+            z: 0.0,
+            coordinate_system: "building_local".into(),
+        };
+        eq
+    }
+
+    /// The linear scan `find_in_list` replaced.
+    fn find_in_list_linear(
+        list: &[Equipment],
+        item: &Equipment,
+        radius: Option<f64>,
+    ) -> Option<usize> {
+        if let Some(gid) = item.global_id() {
+            if let Some(i) = list.iter().position(|c| c.global_id() == Some(gid)) {
+                return Some(i);
+            }
+        }
+        if let Some(i) = list.iter().position(|c| c.arx_id() == item.arx_id()) {
+            return Some(i);
+        }
+        if let Some(i) = list.iter().position(|c| c.label() == item.label()) {
+            return Some(i);
+        }
+        let radius = radius?;
+        let mut best: Option<(usize, f64)> = None;
+        for (i, candidate) in list.iter().enumerate() {
+            if !equipment_types_compatible(&candidate.equipment_type, &item.equipment_type) {
+                continue;
+            }
+            let d = distance(&candidate.position, &item.position);
+            if d < radius && best.map_or(true, |(_, best_d)| d < best_d) {
+                best = Some((i, d));
+            }
+        }
+        best.map(|(i, _)| i)
+    }
+
+    fn seed() -> impl proptest::strategy::Strategy<Value = Seed> {
+        (
+            proptest::option::of(0u8..4),
+            0u8..6,
+            0u8..6,
+            0u8..5,
+            0u8..5,
+            proptest::bool::ANY,
+        )
+    }
+
+    proptest::proptest! {
+        #[test]
+        fn list_index_matches_linear_scan(
+            list in proptest::collection::vec(seed(), 0..24),
+            edits in proptest::collection::vec((0usize..32, seed()), 0..8),
+            probes in proptest::collection::vec(seed(), 1..16),
+            radius in proptest::sample::select(vec![None, Some(0.5), Some(2.5), Some(9.0)]),
+        ) {
+            let mut list: Vec<Equipment> = list.into_iter().map(seeded_equipment).collect();
+            let mut index = ListIndex::new(&list);
+            // Keep the index in step with replace and push edits, as the merge does
+            for (at, seed) in edits {
+                let next = seeded_equipment(seed);
+                if at < list.len() {
+                    index.replace(at, &list[at], &next);
+                    list[at] = next;
+                } else {
+                    index.insert(list.len(), &next);
+                    list.push(next);
+                }
+            }
+            for probe in probes.into_iter().map(seeded_equipment) {
+                let indexed = find_in_list(&index, &list, &probe, radius, |c: &Equipment| {
+                    equipment_types_compatible(&c.equipment_type, &probe.equipment_type)
+                });
+                proptest::prop_assert_eq!(indexed, find_in_list_linear(&list, &probe, radius));
+            }
+        }
+    }
 }
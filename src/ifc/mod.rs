@@ -1,7 +1,7 @@
 //! IFC processing for ArxOS (native STEP parser only).
 //!
 //! External IFC bytes become a `core::Building` via `parse_native` /
-//! `parse_native_content`. Production imports must continue through
+//! `parse_native_content` / `parse_native_bytes`. Production imports must continue through
 //! `ingest::import_ifc_path` so merge + validation finalize the model.
 
 use log::info;
@@ -72,8 +72,9 @@ impl IFCProcessor {
         if !Path::new(file_path).exists() {
             return Err(anyhow::anyhow!("IFC file not found: {}", file_path));
         }
-        let content = std::fs::read_to_string(file_path)?;
-        self.parse_native_content(&content, validate_strict)
+        // Lex straight from the page cache; no owned copy of the file.
+        let source = parser::StepSource::open(Path::new(file_path))?;
+        self.parse_native_bytes(source.as_bytes(), validate_strict)
     }
 
     /// Parse IFC from an in-memory STEP string (CLI / WASM / ingest shared path).
@@ -82,10 +83,50 @@ impl IFCProcessor {
         content: &str,
         validate_strict: bool,
     ) -> anyhow::Result<ParsingResult> {
-        let lexer = parser::StepLexer::new(content);
+        self.parse_native_bytes(content.as_bytes(), validate_strict)
+    }
+
+    /// Parse IFC from raw STEP bytes (e.g., a memory-mapped file).
+    pub fn parse_native_bytes(
+        &self,
+        content: &[u8],
+        validate_strict: bool,
+    ) -> anyhow::Result<ParsingResult> {
         let mut registry = parser::EntityRegistry::new();
-        registry.populate_from_lexer(lexer);
+        registry.populate_parallel(content);
+        self.resolve_registry(registry, validate_strict, false)
+    }
 
+    /// Parse IFC lazily: header pre-scan, then entities are lexed on first use.
+    ///
+    /// With `hierarchy_only`, room/equipment bodies are not meshed, so the bulk
+    /// of geometry entities (`IFCCARTESIANPOINT`, `IFCPOLYLOOP`, …) is never
+    /// parsed; placements and properties still resolve.
+    pub fn parse_native_lazy(
+        &self,
+        file_path: &str,
+        validate_strict: bool,
+        hierarchy_only: bool,
+    ) -> anyhow::Result<ParsingResult> {
+        info!(
+            "Processing IFC file (Native lazy, strict={}, hierarchy_only={}): {}",
+            validate_strict, hierarchy_only, file_path
+        );
+        if !Path::new(file_path).exists() {
+            return Err(anyhow::anyhow!("IFC file not found: {}", file_path));
+        }
+        let source = std::sync::Arc::new(parser::StepSource::open(Path::new(file_path))?);
+        let mut registry = parser::EntityRegistry::new();
+        registry.populate_lazy(source);
+        self.resolve_registry(registry, validate_strict, hierarchy_only)
+    }
+
+    fn resolve_registry(
+        &self,
+        mut registry: parser::EntityRegistry,
+        validate_strict: bool,
+        hierarchy_only: bool,
+    ) -> anyhow::Result<ParsingResult> {
         let stats = registry.get_stats();
 
         if validate_strict && stats.spatial_entities == 0 {
@@ -95,7 +136,13 @@ impl IFCProcessor {
         }
 
         let mut resolver = parser::IfcResolver::new(&mut registry);
-        let (building, report) = resolver.resolve_all()?;
+        if hierarchy_only {
+            resolver = resolver.hierarchy_only();
+        }
+        let (building, report) = {
+            let _resolve = crate::telemetry::time(crate::telemetry::Phase::IfcResolve);
+            resolver.resolve_all()?
+        };
         let warnings = report
             .warnings
             .iter()
@@ -117,8 +164,10 @@ impl IFCProcessor {
     }
 
     /// Extract hierarchical building data from an IFC file.
+    ///
+    /// Uses the lazy, hierarchy-only path: no meshes are extracted.
     pub fn extract_hierarchy(&self, file_path: &str) -> anyhow::Result<crate::core::Building> {
-        Ok(self.parse_native(file_path, false)?.building)
+        Ok(self.parse_native_lazy(file_path, false, true)?.building)
     }
 
     pub fn validate_ifc_file(&self, file_path: &str) -> IFCResult<bool> {
@@ -144,31 +193,36 @@ impl IFCProcessor {
         }
 
         use crate::utils::path_safety::PathSafety;
-        let base_dir = std::env::current_dir().map_err(|e| IFCError::FileNotFound {
-            path: format!("Failed to get current directory: {}", e),
+        PathSafety::validate_path(Path::new(file_path)).map_err(|e| IFCError::FileNotFound {
+            path: format!("Failed to read IFC file '{}': {}", file_path, e),
         })?;
 
-        let content = PathSafety::read_file_safely(std::path::Path::new(file_path), &base_dir)
-            .map_err(|e| IFCError::FileNotFound {
+        // Structure checks only need section markers and entity headers, so
+        // scan the mapped bytes instead of reading the file into a String.
+        let source =
+            parser::StepSource::open(Path::new(file_path)).map_err(|e| IFCError::FileNotFound {
                 path: format!("Failed to read IFC file '{}': {}", file_path, e),
             })?;
 
-        self.validate_ifc_structure(&content)?;
+        self.validate_ifc_structure(source.as_bytes())?;
 
         info!("IFC file validation passed");
         Ok(true)
     }
 
-    fn validate_ifc_structure(&self, content: &str) -> IFCResult<()> {
-        let lines: Vec<&str> = content.lines().collect();
+    fn validate_ifc_structure(&self, content: &[u8]) -> IFCResult<()> {
+        let mut lines = content.split(|&b| b == b'\n').map(|line| line.trim_ascii());
 
-        if lines.is_empty() {
+        if content.is_empty() {
             return Err(IFCError::InvalidFormat {
                 reason: "File contains no content".to_string(),
             });
         }
 
-        if !lines[0].starts_with("ISO-10303-21;") {
+        if !lines
+            .next()
+            .is_some_and(|first| first.starts_with(b"ISO-10303-21;"))
+        {
             return Err(IFCError::InvalidFormat {
                 reason: "Missing ISO-10303-21 header".to_string(),
             });
@@ -178,14 +232,12 @@ impl IFCProcessor {
         let mut has_data = false;
         let mut has_endsec = false;
 
-        for line in lines.iter() {
-            let line = line.trim();
-            if line == "HEADER;" {
-                has_header = true;
-            } else if line == "DATA;" {
-                has_data = true;
-            } else if line == "ENDSEC;" {
-                has_endsec = true;
+        for line in lines {
+            match line {
+                b"HEADER;" => has_header = true,
+                b"DATA;" => has_data = true,
+                b"ENDSEC;" => has_endsec = true,
+                _ => {}
             }
         }
 
@@ -207,16 +259,17 @@ impl IFCProcessor {
             });
         }
 
-        if !content.trim_end().ends_with("END-ISO-10303-21;") {
+        if !content.trim_ascii_end().ends_with(b"END-ISO-10303-21;") {
             return Err(IFCError::InvalidFormat {
                 reason: "Missing END-ISO-10303-21 footer".to_string(),
             });
         }
 
-        let has_entities = lines
-            .iter()
-            .any(|line| line.starts_with("#") && line.contains("="));
-        if !has_entities {
+        // Header-only pre-scan: no parameters are parsed.
+        if parser::StepLexer::from_bytes(content)
+            .next_entity_header()
+            .is_none()
+        {
             return Err(IFCError::InvalidFormat {
                 reason: "No entity definitions found".to_string(),
             });
@@ -0,0 +1,490 @@
+//! Interned IFC class names.
+//!
+//! Every entity carries its class; storing it as an owned `String` costs an
+//! allocation per entity plus a clone per class-index insert, and every class
+//! check is a string compare. [`IfcClass`] is a small handle: well-known IFC4
+//! classes resolve by binary search in a static table, anything else goes
+//! through a process-wide fallback interner. Its names are leaked, so it holds
+//! at most [`MAX_DYNAMIC_CLASSES`]; past that, unknown names are kept as a
+//! shared string on the handle, freed with the entities that carry it.
+
+use std::collections::HashMap;
+use std::fmt;
+use std::sync::{Arc, OnceLock, RwLock};
+
+/// Known IFC4 entity classes (upper case, sorted for binary search).
+const KNOWN_CLASSES: &[&str] = &[
+    "IFCACTIONREQUEST",
+    "IFCACTOR",
+    "IFCACTORROLE",
+    "IFCACTUATOR",
+    "IFCAIRTERMINAL",
+    "IFCAIRTERMINALBOX",
+    "IFCAIRTERMINALTYPE",
+    "IFCAIRTOAIRHEATRECOVERY",
+    "IFCALARM",
+    "IFCANNOTATION",
+    "IFCAPPLICATION",
+    "IFCAPPROVAL",
+    "IFCARBITRARYCLOSEDPROFILEDEF",
+    "IFCARBITRARYOPENPROFILEDEF",
+    "IFCARBITRARYPROFILEDEFWITHVOIDS",
+    "IFCAUDIOVISUALAPPLIANCE",
+    "IFCAXIS1PLACEMENT",
+    "IFCAXIS2PLACEMENT2D",
+    "IFCAXIS2PLACEMENT3D",
+    "IFCBEAM",
+    "IFCBEAMTYPE",
+    "IFCBLOCK",
+    "IFCBOILER",
+    "IFCBOOLEANCLIPPINGRESULT",
+    "IFCBOOLEANRESULT",
+    "IFCBOUNDINGBOX",
+    "IFCBUILDING",
+    "IFCBUILDINGELEMENTPART",
+    "IFCBUILDINGELEMENTPROXY",
+    "IFCBUILDINGELEMENTPROXYTYPE",
+    "IFCBUILDINGSTOREY",
+    "IFCBURNER",
+    "IFCCABLECARRIERFITTING",
+    "IFCCABLECARRIERSEGMENT",
+    "IFCCABLEFITTING",
+    "IFCCABLESEGMENT",
+    "IFCCARTESIANPOINT",
+    "IFCCARTESIANPOINTLIST2D",
+    "IFCCARTESIANPOINTLIST3D",
+    "IFCCARTESIANTRANSFORMATIONOPERATOR3D",
+    "IFCCARTESIANTRANSFORMATIONOPERATOR3DNONUNIFORM",
+    "IFCCHILLER",
+    "IFCCIRCLE",
+    "IFCCIRCLEPROFILEDEF",
+    "IFCCLASSIFICATION",
+    "IFCCLASSIFICATIONREFERENCE",
+    "IFCCLOSEDSHELL",
+    "IFCCOIL",
+    "IFCCOLOURRGB",
+    "IFCCOLOURRGBLIST",
+    "IFCCOLUMN",
+    "IFCCOLUMNTYPE",
+    "IFCCOMMUNICATIONSAPPLIANCE",
+    "IFCCOMPLEXPROPERTY",
+    "IFCCOMPOSITECURVE",
+    "IFCCOMPOSITECURVESEGMENT",
+    "IFCCOMPRESSOR",
+    "IFCCONDENSER",
+    "IFCCONTROLLER",
+    "IFCCONVERSIONBASEDUNIT",
+    "IFCCOOLEDBEAM",
+    "IFCCOOLINGTOWER",
+    "IFCCOVERING",
+    "IFCCOVERINGTYPE",
+    "IFCCURTAINWALL",
+    "IFCCYLINDRICALPOINT",
+    "IFCDAMPER",
+    "IFCDERIVEDUNIT",
+    "IFCDERIVEDUNITELEMENT",
+    "IFCDIMENSIONALEXPONENTS",
+    "IFCDIRECTION",
+    "IFCDISCRETEACCESSORY",
+    "IFCDISTRIBUTIONCHAMBERELEMENT",
+    "IFCDISTRIBUTIONCONTROLELEMENT",
+    "IFCDISTRIBUTIONELEMENT",
+    "IFCDISTRIBUTIONFLOWELEMENT",
+    "IFCDISTRIBUTIONPORT",
+    "IFCDISTRIBUTIONSYSTEM",
+    "IFCDOOR",
+    "IFCDOORTYPE",
+    "IFCDUCTFITTING",
+    "IFCDUCTSEGMENT",
+    "IFCDUCTSILENCER",
+    "IFCELECTRICAPPLIANCE",
+    "IFCELECTRICDISTRIBUTIONBOARD",
+    "IFCELECTRICFLOWSTORAGEDEVICE",
+    "IFCELECTRICGENERATOR",
+    "IFCELECTRICMOTOR",
+    "IFCELECTRICTIMECONTROL",
+    "IFCELEMENTASSEMBLY",
+    "IFCELEMENTQUANTITY",
+    "IFCELLIPSE",
+    "IFCENERGYCONVERSIONDEVICE",
+    "IFCENGINE",
+    "IFCEVAPORATIVECOOLER",
+    "IFCEVAPORATOR",
+    "IFCEXTRUDEDAREASOLID",
+    "IFCFACE",
+    "IFCFACEBASEDSURFACEMODEL",
+    "IFCFACEBOUND",
+    "IFCFACEOUTERBOUND",
+    "IFCFACETEDBREP",
+    "IFCFAN",
+    "IFCFANTYPE",
+    "IFCFASTENER",
+    "IFCFILTER",
+    "IFCFIREALARM",
+    "IFCFIREDETECTOR",
+    "IFCFIRESUPPRESSIONTERMINAL",
+    "IFCFIRESUPRESSION",
+    "IFCFLOWCONTROLLER",
+    "IFCFLOWFITTING",
+    "IFCFLOWINSTRUMENT",
+    "IFCFLOWMETER",
+    "IFCFLOWMOVINGDEVICE",
+    "IFCFLOWSEGMENT",
+    "IFCFLOWSTORAGEDEVICE",
+    "IFCFLOWTERMINAL",
+    "IFCFLOWTREATMENTDEVICE",
+    "IFCFOOTING",
+    "IFCFURNISHINGELEMENT",
+    "IFCFURNITURE",
+    "IFCFURNITURETYPE",
+    "IFCGEOGRAPHICELEMENT",
+    "IFCGEOMETRICCURVESET",
+    "IFCGEOMETRICREPRESENTATIONCONTEXT",
+    "IFCGEOMETRICREPRESENTATIONSUBCONTEXT",
+    "IFCGEOMETRICSET",
+    "IFCGRID",
+    "IFCGRIDAXIS",
+    "IFCGRIDPLACEMENT",
+    "IFCGROUP",
+    "IFCHALFSPACESOLID",
+    "IFCHEATEXCHANGER",
+    "IFCHUMIDIFIER",
+    "IFCIDENTIFIER",
+    "IFCINDEXEDPOLYCURVE",
+    "IFCINDEXEDPOLYGONALFACE",
+    "IFCINTERCEPTOR",
+    "IFCJUNCTIONBOX",
+    "IFCLABEL",
+    "IFCLAMP",
+    "IFCLIGHTFIXTURE",
+    "IFCLINE",
+    "IFCLOCALPLACEMENT",
+    "IFCMAPCONVERSION",
+    "IFCMAPPEDITEM",
+    "IFCMATERIAL",
+    "IFCMATERIALCONSTITUENT",
+    "IFCMATERIALCONSTITUENTSET",
+    "IFCMATERIALLAYER",
+    "IFCMATERIALLAYERSET",
+    "IFCMATERIALLAYERSETUSAGE",
+    "IFCMATERIALLIST",
+    "IFCMATERIALPROFILE",
+    "IFCMATERIALPROFILESET",
+    "IFCMATERIALPROFILESETUSAGE",
+    "IFCMEASUREWITHUNIT",
+    "IFCMECHANICALFASTENER",
+    "IFCMEDICALDEVICE",
+    "IFCMEMBER",
+    "IFCMEMBERTYPE",
+    "IFCMONETARYUNIT",
+    "IFCMOTORCONNECTION",
+    "IFCOPENINGELEMENT",
+    "IFCOPENSHELL",
+    "IFCORGANIZATION",
+    "IFCOUTLET",
+    "IFCOWNERHISTORY",
+    "IFCPERSON",
+    "IFCPERSONANDORGANIZATION",
+    "IFCPILE",
+    "IFCPIPEFITTING",
+    "IFCPIPESEGMENT",
+    "IFCPLANARBOX",
+    "IFCPLANE",
+    "IFCPLATE",
+    "IFCPLATETYPE",
+    "IFCPOLYGONALBOUNDEDHALFSPACE",
+    "IFCPOLYGONALFACESET",
+    "IFCPOLYLINE",
+    "IFCPOLYLOOP",
+    "IFCPORT",
+    "IFCPOSTALADDRESS",
+    "IFCPRESENTATIONLAYERASSIGNMENT",
+    "IFCPRESENTATIONSTYLEASSIGNMENT",
+    "IFCPRODUCTDEFINITIONSHAPE",
+    "IFCPROJECT",
+    "IFCPROJECTEDCRS",
+    "IFCPROJECTIONELEMENT",
+    "IFCPROJECTLIBRARY",
+    "IFCPROPERTYENUMERATEDVALUE",
+    "IFCPROPERTYENUMERATION",
+    "IFCPROPERTYLISTVALUE",
+    "IFCPROPERTYSET",
+    "IFCPROPERTYSINGLEVALUE",
+    "IFCPROTECTIVEDEVICE",
+    "IFCPUMP",
+    "IFCQUANTITYAREA",
+    "IFCQUANTITYCOUNT",
+    "IFCQUANTITYLENGTH",
+    "IFCQUANTITYVOLUME",
+    "IFCQUANTITYWEIGHT",
+    "IFCRAILING",
+    "IFCRAMP",
+    "IFCRAMPFLIGHT",
+    "IFCRECTANGLEHOLLOWPROFILEDEF",
+    "IFCRECTANGLEPROFILEDEF",
+    "IFCREINFORCINGBAR",
+    "IFCRELAGGREGATES",
+    "IFCRELASSIGNSTOGROUP",
+    "IFCRELASSOCIATESCLASSIFICATION",
+    "IFCRELASSOCIATESMATERIAL",
+    "IFCRELCONNECTSELEMENTS",
+    "IFCRELCONNECTSPATHELEMENTS",
+    "IFCRELCONNECTSPORTS",
+    "IFCRELCONNECTSPORTTOELEMENT",
+    "IFCRELCONTAINEDINSPATIALSTRUCTURE",
+    "IFCRELDECLARES",
+    "IFCRELDEFINESBYPROPERTIES",
+    "IFCRELDEFINESBYTYPE",
+    "IFCRELFILLSELEMENT",
+    "IFCRELNESTS",
+    "IFCRELSERVICESBUILDINGS",
+    "IFCRELSPACEBOUNDARY",
+    "IFCRELVOIDSELEMENT",
+    "IFCREPRESENTATIONMAP",
+    "IFCROOF",
+    "IFCSANITARYTERMINAL",
+    "IFCSANITARYTERMINALTYPE",
+    "IFCSENSOR",
+    "IFCSHADINGDEVICE",
+    "IFCSHAPEASPECT",
+    "IFCSHAPEREPRESENTATION",
+    "IFCSHELLBASEDSURFACEMODEL",
+    "IFCSITE",
+    "IFCSIUNIT",
+    "IFCSLAB",
+    "IFCSLABTYPE",
+    "IFCSOLARDEVICE",
+    "IFCSPACE",
+    "IFCSPACEHEATER",
+    "IFCSPACETYPE",
+    "IFCSPHERICALPOINT",
+    "IFCSTACKTERMINAL",
+    "IFCSTAIR",
+    "IFCSTAIRFLIGHT",
+    "IFCSTYLEDITEM",
+    "IFCSURFACESTYLE",
+    "IFCSURFACESTYLERENDERING",
+    "IFCSURFACESTYLESHADING",
+    "IFCSWITCHINGDEVICE",
+    "IFCSYSTEM",
+    "IFCTANK",
+    "IFCTELECOMADDRESS",
+    "IFCTRANSFORMER",
+    "IFCTRIANGULATEDFACESET",
+    "IFCTRIMMEDCURVE",
+    "IFCTUBEBUNDLE",
+    "IFCUNITARYCONTROLELEMENT",
+    "IFCUNITARYEQUIPMENT",
+    "IFCUNITASSIGNMENT",
+    "IFCVALVE",
+    "IFCVECTOR",
+    "IFCVIBRATIONISOLATOR",
+    "IFCVIRTUALELEMENT",
+    "IFCWALL",
+    "IFCWALLSTANDARDCASE",
+    "IFCWALLTYPE",
+    "IFCWASTETERMINAL",
+    "IFCWINDOW",
+    "IFCWINDOWTYPE",
+    "IFCZONE",
+];
+
+/// Cap on unknown class names kept by the fallback interner. Vendor schemas
+/// add a few dozen; a long-lived agent importing arbitrary files must not leak
+/// one name per distinct typo.
+pub const MAX_DYNAMIC_CLASSES: usize = 1024;
+
+/// Interned IFC class name.
+#[derive(Clone, PartialEq, Eq, Hash, PartialOrd, Ord)]
+pub struct IfcClass(Repr);
+
+#[derive(Clone, PartialEq, Eq, Hash, PartialOrd, Ord)]
+enum Repr {
+    /// Index into `KNOWN_CLASSES`, then into the fallback interner
+    Interned(u32),
+    /// Unknown name that arrived after the fallback interner filled up
+    Owned(Arc<str>),
+}
+
+#[derive(Default)]
+struct DynamicClasses {
+    names: Vec<&'static str>,
+    ids: HashMap<&'static str, u32>,
+}
+
+impl DynamicClasses {
+    /// Register `name`, or `None` once `cap` names are held.
+    fn insert(&mut self, name: &str, cap: usize) -> Option<u32> {
+        if let Some(&id) = self.ids.get(name) {
+            return Some(id);
+        }
+        if self.names.len() >= cap {
+            return None;
+        }
+        let leaked: &'static str = Box::leak(name.to_owned().into_boxed_str());
+        let id = (KNOWN_CLASSES.len() + self.names.len()) as u32;
+        self.names.push(leaked);
+        self.ids.insert(leaked, id);
+        Some(id)
+    }
+}
+
+fn dynamic_classes() -> &'static RwLock<DynamicClasses> {
+    static DYNAMIC: OnceLock<RwLock<DynamicClasses>> = OnceLock::new();
+    DYNAMIC.get_or_init(Default::default)
+}
+
+impl IfcClass {
+    /// Intern a class name, registering it with the fallback interner if
+    /// unknown. Once that holds [`MAX_DYNAMIC_CLASSES`] names, new ones are
+    /// carried by the handle itself, so distinct classes never merge.
+    pub fn intern(name: &str) -> Self {
+        if let Some(class) = Self::lookup(name) {
+            return class;
+        }
+        let mut dynamic = dynamic_classes()
+            .write()
+            .unwrap_or_else(|poisoned| poisoned.into_inner());
+        match dynamic.insert(name, MAX_DYNAMIC_CLASSES) {
+            Some(id) => Self(Repr::Interned(id)),
+            None => Self::unregistered(name),
+        }
+    }
+
+    /// Look up an already-interned class without registering a new one.
+    ///
+    /// Names past the interner cap are never registered, so this is `None`
+    /// for them; compare against [`IfcClass::unregistered`] instead.
+    pub fn lookup(name: &str) -> Option<Self> {
+        if let Ok(idx) = KNOWN_CLASSES.binary_search(&name) {
+            return Some(Self(Repr::Interned(idx as u32)));
+        }
+        let dynamic = dynamic_classes()
+            .read()
+            .unwrap_or_else(|poisoned| poisoned.into_inner());
+        dynamic.ids.get(name).map(|&id| Self(Repr::Interned(id)))
+    }
+
+    /// The handle [`IfcClass::intern`] gives `name` once the interner is full.
+    pub(super) fn unregistered(name: &str) -> Self {
+        Self(Repr::Owned(Arc::from(name)))
+    }
+
+    /// The class name (e.g., "IFCSPACE").
+    pub fn as_str(&self) -> &str {
+        let idx = match &self.0 {
+            Repr::Interned(idx) => *idx as usize,
+            Repr::Owned(name) => return name,
+        };
+        if let Some(name) = KNOWN_CLASSES.get(idx) {
+            return name;
+        }
+        let dynamic = dynamic_classes()
+            .read()
+            .unwrap_or_else(|poisoned| poisoned.into_inner());
+        dynamic
+            .names
+            .get(idx - KNOWN_CLASSES.len())
+            .copied()
+            .unwrap_or("")
+    }
+
+    /// True for classes in the static IFC4 table.
+    pub fn is_known(&self) -> bool {
+        matches!(self.0, Repr::Interned(idx) if (idx as usize) < KNOWN_CLASSES.len())
+    }
+}
+
+impl From<&str> for IfcClass {
+    fn from(name: &str) -> Self {
+        Self::intern(name)
+    }
+}
+
+impl From<String> for IfcClass {
+    fn from(name: String) -> Self {
+        Self::intern(&name)
+    }
+}
+
+impl PartialEq<str> for IfcClass {
+    fn eq(&self, other: &str) -> bool {
+        self.as_str() == other
+    }
+}
+
+impl PartialEq<&str> for IfcClass {
+    fn eq(&self, other: &&str) -> bool {
+        self.as_str() == *other
+    }
+}
+
+impl fmt::Debug for IfcClass {
+    fn fmt(&self, f: &mut fmt::Formatter<'_>) -> fmt::Result {
+        write!(f, "{:?}", self.as_str())
+    }
+}
+
+impl fmt::Display for IfcClass {
+    fn fmt(&self, f: &mut fmt::Formatter<'_>) -> fmt::Result {
+        f.write_str(self.as_str())
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    #[test]
+    fn known_table_is_sorted_and_unique() {
+        assert!(KNOWN_CLASSES.windows(2).all(|w| w[0] < w[1]));
+    }
+
+    #[test]
+    fn known_classes_round_trip() {
+        let space = IfcClass::intern("IFCSPACE");
+        assert!(space.is_known());
+        assert_eq!(space, "IFCSPACE");
+        assert_eq!(space.as_str(), "IFCSPACE");
+        assert_eq!(IfcClass::lookup("IFCSPACE"), Some(space));
+    }
+
+    #[test]
+    fn unknown_classes_intern_once() {
+        let a = IfcClass::intern("IFCVENDORTHING");
+        let b = IfcClass::intern("IFCVENDORTHING");
+        assert_eq!(a, b);
+        assert!(!a.is_known());
+        assert_eq!(a.to_string(), "IFCVENDORTHING");
+        assert_eq!(IfcClass::lookup("IFCNEVERSEEN"), None);
+    }
+
+    #[test]
+    fn fallback_interner_is_capped() {
+        let mut dynamic = DynamicClasses::default();
+        let a = dynamic.insert("IFCVENDORA", 2).unwrap();
+        let b = dynamic.insert("IFCVENDORB", 2).unwrap();
+        assert_ne!(a, b);
+        assert_eq!(dynamic.insert("IFCVENDORC", 2), None);
+        // Already-held names still resolve at the cap
+        assert_eq!(dynamic.insert("IFCVENDORA", 2), Some(a));
+        assert_eq!(dynamic.names.len(), 2);
+    }
+
+    #[test]
+    fn classes_past_the_cap_stay_distinct() {
+        let c = IfcClass::unregistered("IFCVENDORC");
+        let d = IfcClass::unregistered("IFCVENDORD");
+        assert_ne!(c, d);
+        assert_eq!(c, IfcClass::unregistered("IFCVENDORC"));
+        assert_eq!(c, "IFCVENDORC");
+        assert_eq!(d.to_string(), "IFCVENDORD");
+        assert!(!c.is_known());
+
+        let mut counts = HashMap::new();
+        for class in [c.clone(), d, c] {
+            *counts.entry(class).or_insert(0) += 1;
+        }
+        assert_eq!(counts.len(), 2);
+    }
+}
@@ -5,7 +5,10 @@
 
 use super::lexer::{Param, RawEntity};
 use super::registry::EntityRegistry;
+use crate::core::spatial::mesh::Mesh;
 use nalgebra::{Matrix3, Matrix4, Vector3};
+use std::collections::{HashMap, HashSet};
+use std::sync::{Arc, RwLock};
 
 #[derive(Debug, Clone)]
 pub struct Transform3D {
@@ -38,19 +41,133 @@ impl Transform3D {
     }
 }
 
+/// Per-import memo of resolved placements and untransformed meshes.
+///
+/// Storeys share parent placements and products share representations
+/// (notably through `IFCMAPPEDITEM`), so each placement chain and each shared
+/// representation is resolved once; instances only pay for the final
+/// transform. Representations used by a single product are not kept (see
+/// [`GeometryCache::is_shared`]). Locks make one cache usable from parallel
+/// resolvers.
+#[derive(Default)]
+pub struct GeometryCache {
+    placements: RwLock<HashMap<u64, Transform3D>>,
+    meshes: RwLock<HashMap<u64, Option<Arc<Mesh>>>>,
+    /// Representations requested at least once outside a mapped item.
+    seen: RwLock<HashSet<u64>>,
+}
+
+impl GeometryCache {
+    pub fn new() -> Self {
+        Self::default()
+    }
+
+    fn placement(&self, id: u64) -> Option<Transform3D> {
+        self.placements
+            .read()
+            .unwrap_or_else(|poisoned| poisoned.into_inner())
+            .get(&id)
+            .cloned()
+    }
+
+    fn insert_placement(&self, id: u64, transform: &Transform3D) {
+        self.placements
+            .write()
+            .unwrap_or_else(|poisoned| poisoned.into_inner())
+            .insert(id, transform.clone());
+    }
+
+    /// Untransformed mesh for representation `id`, resolving it on first use.
+    pub fn mesh_or_insert_with<F>(&self, id: u64, resolve: F) -> Option<Arc<Mesh>>
+    where
+        F: FnOnce() -> Option<Mesh>,
+    {
+        if let Some(cached) = self
+            .meshes
+            .read()
+            .unwrap_or_else(|poisoned| poisoned.into_inner())
+            .get(&id)
+        {
+            return cached.clone();
+        }
+        let mesh = resolve().map(Arc::new);
+        self.meshes
+            .write()
+            .unwrap_or_else(|poisoned| poisoned.into_inner())
+            .entry(id)
+            .or_insert(mesh)
+            .clone()
+    }
+
+    /// Record a use of representation `id` and report whether it is shared:
+    /// already cached, or referenced before. The first reference of a
+    /// representation is meshed in place; only later ones go through
+    /// [`GeometryCache::mesh_or_insert_with`].
+    pub fn is_shared(&self, id: u64) -> bool {
+        if self
+            .meshes
+            .read()
+            .unwrap_or_else(|poisoned| poisoned.into_inner())
+            .contains_key(&id)
+        {
+            return true;
+        }
+        !self
+            .seen
+            .write()
+            .unwrap_or_else(|poisoned| poisoned.into_inner())
+            .insert(id)
+    }
+
+    /// Number of memoized placements and representation meshes.
+    pub fn entry_counts(&self) -> (usize, usize) {
+        let placements = self
+            .placements
+            .read()
+            .unwrap_or_else(|poisoned| poisoned.into_inner())
+            .len();
+        let meshes = self
+            .meshes
+            .read()
+            .unwrap_or_else(|poisoned| poisoned.into_inner())
+            .len();
+        (placements, meshes)
+    }
+}
+
 /// Resolves geometric placements for IFC entities.
 pub struct GeometryResolver<'a> {
     registry: &'a EntityRegistry,
+    cache: Option<&'a GeometryCache>,
 }
 
 impl<'a> GeometryResolver<'a> {
     pub fn new(registry: &'a EntityRegistry) -> Self {
-        Self { registry }
+        Self {
+            registry,
+            cache: None,
+        }
+    }
+
+    /// Resolver that memoizes placements (and, via `MeshResolver`, meshes) in `cache`.
+    pub fn with_cache(registry: &'a EntityRegistry, cache: &'a GeometryCache) -> Self {
+        Self {
+            registry,
+            cache: Some(cache),
+        }
+    }
+
+    /// Shared memo cache, if any.
+    pub fn cache(&self) -> Option<&'a GeometryCache> {
+        self.cache
     }
 
     /// Resolve the global transform for a given entity's placement.
     pub fn resolve_placement(&self, placement_id: u64) -> Transform3D {
-        if let Some(entity) = self.registry.get_raw(placement_id) {
+        if let Some(cached) = self.cache.and_then(|c| c.placement(placement_id)) {
+            return cached;
+        }
+        let transform = if let Some(entity) = self.registry.get_raw(placement_id) {
             match entity.class.as_str() {
                 "IFCLOCALPLACEMENT" => self.resolve_local_placement(entity),
                 "IFCAXIS2PLACEMENT3D" => self.resolve_axis2placement3d(entity),
@@ -58,7 +175,50 @@ impl<'a> GeometryResolver<'a> {
             }
         } else {
             Transform3D::identity()
+        };
+        if let Some(cache) = self.cache {
+            cache.insert_placement(placement_id, &transform);
+        }
+        transform
+    }
+
+    /// Resolve an `IfcCartesianTransformationOperator3D` (mapped item target).
+    ///
+    /// Param 0: Axis1 (X), Param 1: Axis2 (Y), Param 2: LocalOrigin,
+    /// Param 3: Scale, Param 4: Axis3 (Z); the non-uniform subtype adds
+    /// Param 5: Scale2 and Param 6: Scale3.
+    pub fn resolve_transformation_operator(&self, operator_id: u64) -> Transform3D {
+        let Some(entity) = self.registry.get_raw(operator_id) else {
+            return Transform3D::identity();
+        };
+        if !entity
+            .class
+            .as_str()
+            .starts_with("IFCCARTESIANTRANSFORMATIONOPERATOR3D")
+        {
+            return Transform3D::identity();
         }
+
+        let direction = |index: usize, default: Vector3<f64>| match entity.params.get(index) {
+            Some(Param::Reference(id)) => self.resolve_direction(*id).unwrap_or(default),
+            _ => default,
+        };
+        let x_axis_raw = direction(0, Vector3::new(1.0, 0.0, 0.0));
+        let z_axis = direction(4, Vector3::new(0.0, 0.0, 1.0));
+        let origin = match entity.params.get(2) {
+            Some(Param::Reference(id)) => self.resolve_cartesian_point(*id),
+            _ => Vector3::new(0.0, 0.0, 0.0),
+        };
+        let scale = self.extract_float(&entity.params, 3).unwrap_or(1.0);
+        let scale2 = self.extract_float(&entity.params, 5).unwrap_or(scale);
+        let scale3 = self.extract_float(&entity.params, 6).unwrap_or(scale);
+
+        let z = z_axis.normalize();
+        let x = (x_axis_raw - x_axis_raw.dot(&z) * z).normalize();
+        let y = z.cross(&x);
+
+        let rotation = Matrix3::from_columns(&[x * scale, y * scale2, z * scale3]);
+        Transform3D::from_translation_rotation(origin, rotation)
     }
 
     fn resolve_local_placement(&self, entity: &RawEntity) -> Transform3D {
@@ -244,14 +404,14 @@ mod tests {
         // Spherical: R=1.0, Theta=0, Phi=90 (Should be X=1, Y=0, Z=0)
         registry.register(RawEntity {
             id: 1,
-            class: "IFCSPHERICALPOINT".to_string(),
+            class: "IFCSPHERICALPOINT".into(),
             params: vec![Param::Float(1.0), Param::Float(0.0), Param::Float(90.0)],
         });
 
         // Cylindrical: Rho=1.0, Phi=90, Z=5.0 (Should be X=0, Y=1, Z=5)
         registry.register(RawEntity {
             id: 2,
-            class: "IFCCYLINDRICALPOINT".to_string(),
+            class: "IFCCYLINDRICALPOINT".into(),
             params: vec![Param::Float(1.0), Param::Float(90.0), Param::Float(5.0)],
         });
 
@@ -267,4 +427,65 @@ mod tests {
         assert!((cylinder.y - 1.0).abs() < 1e-6);
         assert_eq!(cylinder.z, 5.0);
     }
+
+    #[test]
+    fn test_cached_placement_and_transformation_operator() {
+        let mut registry = EntityRegistry::new();
+        let point = |id, coords: [f64; 3]| RawEntity {
+            id,
+            class: "IFCCARTESIANPOINT".into(),
+            params: vec![Param::List(
+                coords.iter().map(|c| Param::Float(*c)).collect(),
+            )],
+        };
+        registry.register(point(1, [1.0, 2.0, 3.0]));
+        registry.register(RawEntity {
+            id: 2,
+            class: "IFCAXIS2PLACEMENT3D".into(),
+            params: vec![Param::Reference(1), Param::Null, Param::Null],
+        });
+        registry.register(RawEntity {
+            id: 3,
+            class: "IFCLOCALPLACEMENT".into(),
+            params: vec![Param::Null, Param::Reference(2)],
+        });
+        registry.register(point(4, [10.0, 0.0, 0.0]));
+        registry.register(RawEntity {
+            id: 5,
+            class: "IFCCARTESIANTRANSFORMATIONOPERATOR3D".into(),
+            params: vec![
+                Param::Null,
+                Param::Null,
+                Param::Reference(4),
+                Param::Float(2.0),
+                Param::Null,
+            ],
+        });
+
+        let cache = GeometryCache::new();
+        let resolver = GeometryResolver::with_cache(&registry, &cache);
+
+        let placed = resolver.resolve_placement(3);
+        let again = resolver.resolve_placement(3);
+        assert_eq!(placed.matrix, again.matrix);
+        assert_eq!(cache.entry_counts(), (2, 0));
+        let origin = placed.transform_point(&Vector3::new(0.0, 0.0, 0.0));
+        assert_eq!(origin, Vector3::new(1.0, 2.0, 3.0));
+
+        let target = resolver.resolve_transformation_operator(5);
+        let p = target.transform_point(&Vector3::new(1.0, 1.0, 1.0));
+        assert!((p - Vector3::new(12.0, 2.0, 2.0)).norm() < 1e-9);
+    }
+
+    #[test]
+    fn representations_are_shared_from_their_second_use() {
+        let cache = GeometryCache::new();
+        assert!(!cache.is_shared(7));
+        assert!(cache.is_shared(7));
+
+        // Mapped sources are cached on first use and count as shared from then on
+        cache.mesh_or_insert_with(8, || None);
+        assert!(cache.is_shared(8));
+        assert_eq!(cache.entry_counts(), (0, 1));
+    }
 }
@@ -3,7 +3,16 @@
 //! This module implements a streamlined ISO-10303-21 lexer optimized for
 //! large BIM datasets. It avoids complex parser combinators for maximum
 //! throughput and memory efficiency.
-
+//!
+//! The lexer scans raw bytes (`&[u8]`), so it can run directly over a
+//! memory-mapped file (see [`super::source::StepSource`]). [`StepLexer::next_entity_ref`]
+//! yields [`RawEntityRef`] values that borrow class names, enums and strings
+//! from the input; only strings containing STEP escapes (`''`) or invalid
+//! UTF-8 allocate. [`StepLexer::next_entity`] converts to the owned
+//! [`RawEntity`] stored by the registry.
+
+use super::class::IfcClass;
+use std::borrow::Cow;
 use std::str::FromStr;
 
 /// A raw entity extracted from a STEP-21 DATA section.
@@ -11,8 +20,8 @@ use std::str::FromStr;
 pub struct RawEntity {
     /// The STEP ID (e.g., 123 from #123)
     pub id: u64,
-    /// The IFC class name (e.g., "IFCSPACE")
-    pub class: String,
+    /// The interned IFC class name (e.g., IFCSPACE)
+    pub class: IfcClass,
     /// The raw parameters associated with the entity
     pub params: Vec<Param>,
 }
@@ -40,54 +49,125 @@ pub enum Param {
     Typed(String, Box<Param>),
 }
 
+/// A raw entity borrowing its class name and string data from the lexer input.
+#[derive(Debug, Clone, PartialEq)]
+pub struct RawEntityRef<'a> {
+    /// The STEP ID (e.g., 123 from #123)
+    pub id: u64,
+    /// The IFC class name, borrowed from the input
+    pub class: &'a str,
+    /// The raw parameters associated with the entity
+    pub params: Vec<ParamRef<'a>>,
+}
+
+/// Borrowed counterpart of [`Param`].
+#[derive(Debug, Clone, PartialEq)]
+pub enum ParamRef<'a> {
+    Integer(i64),
+    Float(f64),
+    /// Borrowed unless the literal contained escapes or invalid UTF-8
+    String(Cow<'a, str>),
+    Reference(u64),
+    List(Vec<ParamRef<'a>>),
+    Null,
+    Enum(&'a str),
+    Boolean(bool),
+    Typed(&'a str, Box<ParamRef<'a>>),
+}
+
+impl RawEntityRef<'_> {
+    /// Copy borrowed data into an owned [`RawEntity`].
+    pub fn into_owned(self) -> RawEntity {
+        RawEntity {
+            id: self.id,
+            class: IfcClass::intern(self.class),
+            params: self.params.into_iter().map(ParamRef::into_owned).collect(),
+        }
+    }
+}
+
+impl ParamRef<'_> {
+    /// Copy borrowed data into an owned [`Param`].
+    pub fn into_owned(self) -> Param {
+        match self {
+            ParamRef::Integer(i) => Param::Integer(i),
+            ParamRef::Float(f) => Param::Float(f),
+            ParamRef::String(s) => Param::String(s.into_owned()),
+            ParamRef::Reference(id) => Param::Reference(id),
+            ParamRef::List(items) => {
+                Param::List(items.into_iter().map(ParamRef::into_owned).collect())
+            }
+            ParamRef::Null => Param::Null,
+            ParamRef::Enum(e) => Param::Enum(e.to_string()),
+            ParamRef::Boolean(b) => Param::Boolean(b),
+            ParamRef::Typed(class, val) => {
+                Param::Typed(class.to_string(), Box::new(val.into_owned()))
+            }
+        }
+    }
+}
+
 /// Lexer for STEP-21 files.
-pub struct StepLexer {
-    /// The full input content of the IFC file
-    input: Vec<char>,
-    /// Current position in the input
+pub struct StepLexer<'a> {
+    /// The full input content of the IFC file (UTF-8 / ASCII bytes)
+    input: &'a [u8],
+    /// Current byte position in the input
     pos: usize,
 }
 
-impl StepLexer {
+impl<'a> StepLexer<'a> {
     /// Create a new lexer from a string slice.
-    pub fn new(input: &str) -> Self {
-        Self {
-            input: input.chars().collect(),
-            pos: 0,
-        }
+    pub fn new(input: &'a str) -> Self {
+        Self::from_bytes(input.as_bytes())
     }
 
-    /// Reset the lexer to a specific position (useful for lazy loading).
+    /// Create a new lexer over raw bytes (e.g., a memory-mapped file).
+    pub fn from_bytes(input: &'a [u8]) -> Self {
+        Self { input, pos: 0 }
+    }
+
+    /// Reset the lexer to a specific byte position (useful for lazy loading).
     pub fn seek(&mut self, offset: usize) {
         self.pos = offset;
     }
 
+    /// Current byte position in the input.
+    pub fn position(&self) -> usize {
+        self.pos
+    }
+
     /// Parse the next entity from the current position.
     ///
     /// Returns None if no more entities are found.
     pub fn next_entity(&mut self) -> Option<RawEntity> {
+        self.next_entity_ref().map(RawEntityRef::into_owned)
+    }
+
+    /// Parse the next entity without copying class names or strings.
+    ///
+    /// Returns None if no more entities are found.
+    pub fn next_entity_ref(&mut self) -> Option<RawEntityRef<'a>> {
         // Skip until we find the start of an entity (#)
         self.skip_to_entity_start()?;
 
         // 1. Read the ID (#123)
         self.pos += 1; // skip #
-        let id_str = self.read_while(|c| c.is_ascii_digit());
-        let id = u64::from_str(&id_str).ok()?;
+        let id = parse_ascii::<u64>(self.read_while(|c| c.is_ascii_digit()))?;
 
         // 2. Skip to '='
         self.skip_whitespace();
-        if self.peek() != Some('=') {
+        if self.peek() != Some(b'=') {
             return None;
         }
         self.pos += 1; // skip =
         self.skip_whitespace();
 
         // 3. Read Class Name (e.g., IFCSPACE)
-        let class = self.read_while(|c| c.is_ascii_alphanumeric() || c == '_');
+        let class = self.read_ident();
 
         // 4. Read Parameters (...)
         self.skip_whitespace();
-        let params = if self.peek() == Some('(') {
+        let params = if self.peek() == Some(b'(') {
             self.parse_param_list().unwrap_or_default()
         } else {
             Vec::new()
@@ -95,55 +175,103 @@ impl StepLexer {
 
         // 5. Skip semicolon
         self.skip_whitespace();
-        if self.peek() == Some(';') {
+        if self.peek() == Some(b';') {
             self.pos += 1;
         }
 
-        Some(RawEntity { id, class, params })
+        Some(RawEntityRef { id, class, params })
+    }
+
+    /// Scan the next entity header without parsing its parameters.
+    ///
+    /// Returns `(id, class, offset)` where `offset` is the byte position of the
+    /// entity's `#`; [`Self::seek`] to it and call [`Self::next_entity`] to
+    /// materialize the entity later. The body is skipped up to the terminating
+    /// `;` outside string literals and `/* ... */` comments.
+    pub fn next_entity_header(&mut self) -> Option<(u64, &'a str, usize)> {
+        self.skip_to_entity_start()?;
+        let offset = self.pos;
+
+        self.pos += 1; // skip #
+        let id = parse_ascii::<u64>(self.read_while(|c| c.is_ascii_digit()))?;
+        self.skip_whitespace();
+        if self.peek() != Some(b'=') {
+            return None;
+        }
+        self.pos += 1; // skip =
+        self.skip_whitespace();
+        let class = self.read_ident();
+
+        let mut in_string = false;
+        while let Some(c) = self.peek() {
+            if !in_string && starts_comment(self.input, self.pos) {
+                self.pos = comment_end(self.input, self.pos);
+                continue;
+            }
+            self.pos += 1;
+            match c {
+                b'\'' => in_string = !in_string,
+                b';' if !in_string => break,
+                _ => {}
+            }
+        }
+
+        Some((id, class, offset))
     }
 
     // --- Helper Methods ---
 
+    /// Advance to the next `#` outside `/* ... */` comments.
     fn skip_to_entity_start(&mut self) -> Option<()> {
-        while self.pos < self.input.len() {
-            if self.input[self.pos] == '#' {
+        while let Some(c) = self.peek() {
+            if c == b'#' {
                 return Some(());
             }
-            self.pos += 1;
+            if starts_comment(self.input, self.pos) {
+                self.pos = comment_end(self.input, self.pos);
+            } else {
+                self.pos += 1;
+            }
         }
         None
     }
 
     fn skip_whitespace(&mut self) {
-        while self.pos < self.input.len() && self.input[self.pos].is_whitespace() {
+        while self.pos < self.input.len() && self.input[self.pos].is_ascii_whitespace() {
             self.pos += 1;
         }
     }
 
-    fn peek(&self) -> Option<char> {
+    fn peek(&self) -> Option<u8> {
         self.input.get(self.pos).copied()
     }
 
-    fn read_while<F>(&mut self, f: F) -> String
+    fn read_while<F>(&mut self, f: F) -> &'a [u8]
     where
-        F: Fn(char) -> bool,
+        F: Fn(u8) -> bool,
     {
-        let mut result = String::new();
-        while self.pos < self.input.len() && f(self.input[self.pos]) {
-            result.push(self.input[self.pos]);
+        let input = self.input;
+        let start = self.pos;
+        while self.pos < input.len() && f(input[self.pos]) {
             self.pos += 1;
         }
-        result
+        &input[start..self.pos]
+    }
+
+    /// Read an identifier (`[A-Za-z0-9_]*`); always ASCII, so always valid UTF-8.
+    fn read_ident(&mut self) -> &'a str {
+        let bytes = self.read_while(|c| c.is_ascii_alphanumeric() || c == b'_');
+        std::str::from_utf8(bytes).unwrap_or_default()
     }
 
-    fn parse_param_list(&mut self) -> Option<Vec<Param>> {
+    fn parse_param_list(&mut self) -> Option<Vec<ParamRef<'a>>> {
         self.pos += 1; // skip (
         let mut params = Vec::new();
 
         while self.pos < self.input.len() {
             self.skip_whitespace();
 
-            if self.peek() == Some(')') {
+            if self.peek() == Some(b')') {
                 self.pos += 1;
                 return Some(params);
             }
@@ -154,7 +282,7 @@ impl StepLexer {
             }
 
             self.skip_whitespace();
-            if self.peek() == Some(',') {
+            if self.peek() == Some(b',') {
                 self.pos += 1;
             } else if self.pos == start_pos {
                 // Prevent infinite loop if no progress was made
@@ -164,80 +292,94 @@ impl StepLexer {
         None
     }
 
-    fn parse_single_param(&mut self) -> Option<Param> {
+    fn parse_string_literal(&mut self) -> Cow<'a, str> {
+        let input = self.input;
+        self.pos += 1; // skip opening '
+        let start = self.pos;
+        let mut escaped = false;
+        while self.pos < input.len() {
+            if input[self.pos] == b'\'' {
+                // Check for escaped quote ''
+                if input.get(self.pos + 1) == Some(&b'\'') {
+                    escaped = true;
+                    self.pos += 2;
+                    continue;
+                }
+                break;
+            }
+            self.pos += 1;
+        }
+        let raw = &input[start..self.pos.min(input.len())];
+        if self.pos < input.len() {
+            self.pos += 1; // skip closing '
+        }
+
+        let text = String::from_utf8_lossy(raw);
+        if escaped {
+            Cow::Owned(text.replace("''", "'"))
+        } else {
+            text
+        }
+    }
+
+    fn parse_single_param(&mut self) -> Option<ParamRef<'a>> {
         self.skip_whitespace();
         let c = self.peek()?;
 
         match c {
-            '$' | '*' => {
+            b'$' | b'*' => {
                 self.pos += 1;
-                Some(Param::Null)
+                Some(ParamRef::Null)
             }
-            '#' => {
+            b'#' => {
                 self.pos += 1;
-                let id_str = self.read_while(|c| c.is_ascii_digit());
-                u64::from_str(&id_str).ok().map(Param::Reference)
+                parse_ascii::<u64>(self.read_while(|c| c.is_ascii_digit())).map(ParamRef::Reference)
             }
-            '\'' => {
+            b'\'' => Some(ParamRef::String(self.parse_string_literal())),
+            b'(' => self.parse_param_list().map(ParamRef::List),
+            b'.' => {
                 self.pos += 1;
-                let mut s = String::new();
-                while self.pos < self.input.len() {
-                    let next = self.input[self.pos];
-                    if next == '\'' {
-                        // Check for escaped quote ''
-                        if self.input.get(self.pos + 1) == Some(&'\'') {
-                            s.push('\'');
-                            self.pos += 2;
-                            continue;
-                        } else {
-                            self.pos += 1;
-                            break;
-                        }
-                    }
-                    s.push(next);
+                let e = self.read_ident();
+                if self.peek() == Some(b'.') {
                     self.pos += 1;
                 }
-                Some(Param::String(s))
-            }
-            '(' => self.parse_param_list().map(Param::List),
-            '.' => {
-                self.pos += 1;
-                let e = self.read_while(|c| c.is_ascii_alphanumeric() || c == '_');
-                if self.peek() == Some('.') {
-                    self.pos += 1;
-                }
-                match e.as_str() {
-                    "T" => Some(Param::Boolean(true)),
-                    "F" => Some(Param::Boolean(false)),
-                    "U" => Some(Param::Null), // Unknown as Null
-                    _ => Some(Param::Enum(e)),
+                match e {
+                    "T" => Some(ParamRef::Boolean(true)),
+                    "F" => Some(ParamRef::Boolean(false)),
+                    "U" => Some(ParamRef::Null), // Unknown as Null
+                    _ => Some(ParamRef::Enum(e)),
                 }
             }
             _ if c.is_ascii_uppercase() => {
                 // Typed parameter: CLASS_NAME(Value)
-                let class = self.read_while(|c| c.is_ascii_alphanumeric() || c == '_');
+                let class = self.read_ident();
                 self.skip_whitespace();
-                if self.peek() == Some('(') {
+                if self.peek() == Some(b'(') {
                     self.pos += 1;
                     let val = self.parse_single_param()?;
                     self.skip_whitespace();
-                    if self.peek() == Some(')') {
+                    if self.peek() == Some(b')') {
                         self.pos += 1;
                     }
-                    Some(Param::Typed(class, Box::new(val)))
+                    Some(ParamRef::Typed(class, Box::new(val)))
                 } else {
-                    Some(Param::Enum(class)) // Fallback to enum if no parens
+                    Some(ParamRef::Enum(class)) // Fallback to enum if no parens
                 }
             }
-            _ if c.is_ascii_digit() || c == '-' || c == '.' => {
+            _ if c.is_ascii_digit() || c == b'-' || c == b'.' => {
                 let s = self.read_while(|c| {
-                    c.is_ascii_digit() || c == '-' || c == '.' || c == 'e' || c == 'E' || c == '+'
+                    c.is_ascii_digit()
+                        || c == b'-'
+                        || c == b'.'
+                        || c == b'e'
+                        || c == b'E'
+                        || c == b'+'
                 });
 
-                if s.contains('.') || s.to_lowercase().contains('e') {
-                    f64::from_str(&s).ok().map(Param::Float)
+                if s.iter().any(|&c| c == b'.' || c == b'e' || c == b'E') {
+                    parse_ascii::<f64>(s).map(ParamRef::Float)
                 } else {
-                    i64::from_str(&s).ok().map(Param::Integer)
+                    parse_ascii::<i64>(s).map(ParamRef::Integer)
                 }
             }
             _ => None,
@@ -245,6 +387,67 @@ impl StepLexer {
     }
 }
 
+/// Split STEP input into byte ranges that each end on an entity terminator.
+///
+/// Entities end at `;` outside string literals, so every range can be lexed
+/// independently (e.g., one [`StepLexer`] per range on a thread pool). Quote
+/// state is tracked with a single toggle per `'`, which also handles the
+/// doubled `''` escape; `/* ... */` comments are skipped. Ranges are returned in input order, cover the whole
+/// input, and are never smaller than `min_chunk_bytes` (except the last).
+pub fn split_entity_chunks(
+    input: &[u8],
+    max_chunks: usize,
+    min_chunk_bytes: usize,
+) -> Vec<std::ops::Range<usize>> {
+    let max_chunks = max_chunks.max(1);
+    let target = (input.len() / max_chunks).max(min_chunk_bytes).max(1);
+    let mut ranges = Vec::with_capacity(max_chunks);
+    let mut start = 0;
+    let mut next_cut = target;
+    let mut in_string = false;
+
+    let mut i = 0;
+    while i < input.len() {
+        match input[i] {
+            b'\'' => in_string = !in_string,
+            // Comments may contain apostrophes; skip them wholesale.
+            b'/' if !in_string && starts_comment(input, i) => {
+                i = comment_end(input, i);
+                continue;
+            }
+            b';' if !in_string && i + 1 >= next_cut => {
+                ranges.push(start..i + 1);
+                start = i + 1;
+                next_cut = start + target;
+            }
+            _ => {}
+        }
+        i += 1;
+    }
+    if start < input.len() || ranges.is_empty() {
+        ranges.push(start..input.len());
+    }
+    ranges
+}
+
+fn starts_comment(input: &[u8], i: usize) -> bool {
+    input.get(i..i + 2) == Some(b"/*")
+}
+
+/// Byte offset just past the `/* ... */` comment opening at `start`, or the
+/// end of input when it is unterminated.
+fn comment_end(input: &[u8], start: usize) -> usize {
+    input[start + 2..]
+        .windows(2)
+        .position(|w| w == b"*/")
+        .map_or(input.len(), |p| start + 2 + p + 2)
+}
+
+/// Parse a numeric token scanned from ASCII bytes.
+fn parse_ascii<T: FromStr>(bytes: &[u8]) -> Option<T> {
+    std::str::from_utf8(bytes).ok()?.parse().ok()
+}
+
 #[cfg(test)]
 mod tests {
     use super::*;
@@ -294,4 +497,87 @@ mod tests {
         assert_eq!(e2.id, 2);
         assert_eq!(e2.params[1], Param::Reference(1));
     }
+
+    #[test]
+    fn test_lex_borrowed_strings() {
+        let input = b"#5= IFCWALL('plain', 'it''s', IFCLABEL('x'), .AREA.);";
+        let mut lexer = StepLexer::from_bytes(input);
+        let entity = lexer.next_entity_ref().unwrap();
+
+        assert_eq!(entity.class, "IFCWALL");
+        match &entity.params[0] {
+            ParamRef::String(Cow::Borrowed(s)) => assert_eq!(*s, "plain"),
+            other => panic!("Expected borrowed string, got {:?}", other),
+        }
+        match &entity.params[1] {
+            ParamRef::String(Cow::Owned(s)) => assert_eq!(s, "it's"),
+            other => panic!("Expected owned (unescaped) string, got {:?}", other),
+        }
+        assert_eq!(entity.params[3], ParamRef::Enum("AREA"));
+
+        let owned = entity.into_owned();
+        assert_eq!(
+            owned.params[2],
+            Param::Typed(
+                "IFCLABEL".to_string(),
+                Box::new(Param::String("x".to_string()))
+            )
+        );
+    }
+
+    #[test]
+    fn test_split_entity_chunks_respects_strings() {
+        let input = b"#1= IFCLABEL('a;b');/* don't; */#2= IFCLABEL('it''s;');#3= IFCWALL($);";
+        let ranges = split_entity_chunks(input, 8, 1);
+
+        assert_eq!(ranges.len(), 3);
+        assert_eq!(ranges.first().unwrap().start, 0);
+        assert_eq!(ranges.last().unwrap().end, input.len());
+
+        let mut ids = Vec::new();
+        for range in ranges {
+            let mut lexer = StepLexer::from_bytes(&input[range]);
+            while let Some(e) = lexer.next_entity_ref() {
+                ids.push(e.id);
+            }
+        }
+        assert_eq!(ids, vec![1, 2, 3]);
+    }
+
+    #[test]
+    fn test_header_scan_and_seek() {
+        let input = "#1= IFCLABEL('a;#9= X;');\n#2= IFCWALL('w', (1, 2));";
+        let mut lexer = StepLexer::new(input);
+        let (id1, class1, _) = lexer.next_entity_header().unwrap();
+        let (id2, class2, offset2) = lexer.next_entity_header().unwrap();
+        assert!(lexer.next_entity_header().is_none());
+        assert_eq!((id1, class1), (1, "IFCLABEL"));
+        assert_eq!((id2, class2), (2, "IFCWALL"));
+
+        lexer.seek(offset2);
+        let wall = lexer.next_entity().unwrap();
+        assert_eq!(wall.id, 2);
+        assert_eq!(wall.params.len(), 2);
+    }
+
+    #[test]
+    fn test_header_scan_skips_comments() {
+        // Same input as the chunker test: the comment's apostrophe must not
+        // open a string, and a `#` inside a comment is not an entity
+        let input = "#1= IFCLABEL('a;b');/* don't; */#2= IFCLABEL('it''s;');#3= IFCWALL($);";
+        let mut lexer = StepLexer::new(input);
+        let mut ids = Vec::new();
+        while let Some((id, _, _)) = lexer.next_entity_header() {
+            ids.push(id);
+        }
+        assert_eq!(ids, vec![1, 2, 3]);
+
+        let input = "/* see #9 */#1= IFCWALL($/* 'x; */);\n#2= IFCDOOR($);";
+        let mut lexer = StepLexer::new(input);
+        let (id1, class1, _) = lexer.next_entity_header().unwrap();
+        let (id2, class2, _) = lexer.next_entity_header().unwrap();
+        assert!(lexer.next_entity_header().is_none());
+        assert_eq!((id1, class1), (1, "IFCWALL"));
+        assert_eq!((id2, class2), (2, "IFCDOOR"));
+    }
 }
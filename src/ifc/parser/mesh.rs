@@ -30,8 +30,7 @@ impl<'a> MeshResolver<'a> {
                 if let Some(Param::List(reps)) = shape_entity.params.get(2) {
                     for rep_id_param in reps {
                         if let Param::Reference(rep_id) = rep_id_param {
-                            if let Some(mesh) =
-                                self.extract_mesh_from_representation(*rep_id, transform)
+                            if let Some(mesh) = self.representation_mesh(*rep_id, transform, false)
                             {
                                 return Some(mesh);
                             }
@@ -40,11 +39,36 @@ impl<'a> MeshResolver<'a> {
                 }
                 None
             }
-            "IFCSHAPEREPRESENTATION" => self.extract_mesh_from_representation(shape_id, transform),
+            "IFCSHAPEREPRESENTATION" => self.representation_mesh(shape_id, transform, false),
             _ => self.resolve_mesh_item(shape_id, transform),
         }
     }
 
+    /// Mesh for a shape representation placed by `transform`.
+    ///
+    /// With a `GeometryCache`, a shared representation (an `IFCMAPPEDITEM`
+    /// source, or one referenced before) is resolved once in its local frame
+    /// and each placement only transforms the cached vertices. Anything else
+    /// is meshed straight into place, without a cached copy to clone.
+    fn representation_mesh(
+        &self,
+        rep_id: u64,
+        transform: &Transform3D,
+        mapped: bool,
+    ) -> Option<Mesh> {
+        let cache = self
+            .geometry
+            .cache()
+            .filter(|cache| mapped || cache.is_shared(rep_id));
+        let Some(cache) = cache else {
+            return self.extract_mesh_from_representation(rep_id, transform);
+        };
+        let local = cache.mesh_or_insert_with(rep_id, || {
+            self.extract_mesh_from_representation(rep_id, &Transform3D::identity())
+        })?;
+        Some(instance_mesh(&local, transform))
+    }
+
     /// Extract width/depth/height from an extruded rectangle body when present.
     ///
     /// Returns `(width=XDim, depth=YDim, height=extrusion depth)` for
@@ -158,10 +182,44 @@ impl<'a> MeshResolver<'a> {
             "IFCFACETEDBREP" => self.resolve_faceted_brep(item_entity, transform),
             "IFCCLOSEDSHELL" | "IFCOPENSHELL" => self.resolve_shell(item_id, transform),
             "IFCBOOLEANRESULT" => self.resolve_boolean_result(item_entity, transform),
+            "IFCMAPPEDITEM" => self.resolve_mapped_item(item_entity, transform),
             _ => None,
         }
     }
 
+    fn resolve_mapped_item(&self, entity: &RawEntity, transform: &Transform3D) -> Option<Mesh> {
+        // IfcMappedItem
+        // Param 0: MappingSource (IfcRepresentationMap)
+        // Param 1: MappingTarget (IfcCartesianTransformationOperator)
+        let map_id = match entity.params.first()? {
+            Param::Reference(id) => *id,
+            _ => return None,
+        };
+        let map = self.registry.get_raw(map_id)?;
+        if map.class != "IFCREPRESENTATIONMAP" {
+            return None;
+        }
+
+        // IfcRepresentationMap
+        // Param 0: MappingOrigin (IfcAxis2Placement)
+        // Param 1: MappedRepresentation (IfcShapeRepresentation)
+        let origin = match map.params.first() {
+            Some(Param::Reference(id)) => self.geometry.resolve_placement(*id),
+            _ => Transform3D::identity(),
+        };
+        let rep_id = match map.params.get(1)? {
+            Param::Reference(id) => *id,
+            _ => return None,
+        };
+        let target = match entity.params.get(1) {
+            Some(Param::Reference(id)) => self.geometry.resolve_transformation_operator(*id),
+            _ => Transform3D::identity(),
+        };
+
+        let placed = transform.compose(&target).compose(&origin);
+        self.representation_mesh(rep_id, &placed, true)
+    }
+
     fn resolve_boolean_result(&self, entity: &RawEntity, transform: &Transform3D) -> Option<Mesh> {
         // IfcBooleanResult
         // Param 0: Operator (.UNION., .INTERSECTION., .DIFFERENCE.)
@@ -513,6 +571,22 @@ impl<'a> MeshResolver<'a> {
     }
 }
 
+/// Copy of a local-frame mesh with every vertex moved by `transform`.
+fn instance_mesh(local: &Mesh, transform: &Transform3D) -> Mesh {
+    let vertices = local
+        .vertices
+        .iter()
+        .map(|v| {
+            let p = transform.transform_point(&Vector3::new(v.x, v.y, v.z));
+            Point3D::new(p.x, p.y, p.z)
+        })
+        .collect();
+    Mesh {
+        vertices,
+        indices: local.indices.clone(),
+    }
+}
+
 pub fn calculate_normal(points: &[Point3D]) -> Vector3<f64> {
     if points.len() < 3 {
         return Vector3::new(0.0, 0.0, 1.0);
@@ -3,12 +3,18 @@
 //! This module provides a high-performance, lossless, and Git-friendly
 //! implementation of the ISO-10303-21 (STEP) format for IFC data.
 
+pub mod class;
 pub mod geometry;
 pub mod lexer;
 pub mod mesh;
 pub mod registry;
+pub mod relations;
 pub mod resolver;
+pub mod source;
 
+pub use class::IfcClass;
 pub use lexer::StepLexer;
 pub use registry::EntityRegistry;
+pub use relations::RelationIndex;
 pub use resolver::IfcResolver;
+pub use source::StepSource;
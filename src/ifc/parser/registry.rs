@@ -3,19 +3,141 @@
 //! This module manages the graph of STEP entities and their mapping
 //! to the ArxOS domain (ArxAddress).
 
-use super::lexer::{Param, RawEntity};
-use crate::core::domain::ArxAddress;
+use super::class::IfcClass;
+use super::lexer::{split_entity_chunks, RawEntity, StepLexer};
+use super::relations::RelationIndex;
+use crate::core::domain::{AddressPattern, AddressTrie, ArxAddress};
+use crate::telemetry::{self, Phase};
+use rayon::prelude::*;
 use std::collections::HashMap;
+use std::sync::{Arc, OnceLock};
+
+/// Inputs below this size are lexed on the calling thread.
+const PARALLEL_MIN_CHUNK_BYTES: usize = 1024 * 1024;
+
+/// Chunks per worker thread; a few extra smooth out uneven entity density.
+const CHUNKS_PER_THREAD: usize = 4;
+
+/// Slack allowed above `2 × len` before an ID is stored sparsely.
+const DENSE_ID_SLACK: usize = 4096;
+
+/// Entity storage indexed by STEP ID.
+///
+/// STEP IDs are nearly contiguous, so entities live in a `Vec` indexed by
+/// `id - base`, where `base` is the first ID stored (chunk registries start
+/// mid-file). IDs below `base` or far beyond the populated range (e.g., a lone
+/// `#900000000`) go to a sparse side map so one outlier cannot force a huge
+/// allocation.
+#[derive(Default)]
+struct EntityStore {
+    base: u64,
+    dense: Vec<Option<RawEntity>>,
+    sparse: HashMap<u64, RawEntity>,
+    len: usize,
+}
+
+impl EntityStore {
+    fn dense_index(&self, id: u64) -> Option<usize> {
+        usize::try_from(id.checked_sub(self.base)?).ok()
+    }
+
+    fn insert(&mut self, entity: RawEntity) {
+        let id = entity.id;
+        if self.len == 0 && self.dense.is_empty() {
+            self.base = id;
+        }
+        let slot = self
+            .dense_index(id)
+            .filter(|&idx| idx < self.dense.len() || idx < 2 * self.len + DENSE_ID_SLACK);
+        match slot {
+            Some(idx) => {
+                if idx >= self.dense.len() {
+                    self.dense.resize_with(idx + 1, || None);
+                }
+                let previous = self.dense[idx].replace(entity);
+                let moved = !self.sparse.is_empty() && self.sparse.remove(&id).is_some();
+                if previous.is_none() && !moved {
+                    self.len += 1;
+                }
+            }
+            None => {
+                if self.sparse.insert(id, entity).is_none() {
+                    self.len += 1;
+                }
+            }
+        }
+    }
+
+    fn get(&self, id: u64) -> Option<&RawEntity> {
+        let dense = self
+            .dense_index(id)
+            .and_then(|idx| self.dense.get(idx))
+            .and_then(Option::as_ref);
+        dense.or_else(|| self.sparse.get(&id))
+    }
+
+    fn reserve(&mut self, additional: usize) {
+        self.dense.reserve(additional);
+    }
+
+    fn clear(&mut self) {
+        self.base = 0;
+        self.dense.clear();
+        self.sparse.clear();
+        self.len = 0;
+    }
+
+    fn into_entities(self) -> impl Iterator<Item = RawEntity> {
+        self.dense
+            .into_iter()
+            .flatten()
+            .chain(self.sparse.into_values())
+    }
+}
+
+/// Entities known by byte offset only, lexed on first access.
+///
+/// Used by [`EntityRegistry::populate_lazy`]: a header pre-scan records where
+/// each `#id=` starts, and `get_raw` seeks there the first time the id is
+/// dereferenced. Geometry that nothing references is never parsed.
+struct LazyEntities {
+    input: Arc<dyn AsRef<[u8]> + Send + Sync>,
+    slots: HashMap<u64, LazySlot>,
+}
+
+struct LazySlot {
+    offset: usize,
+    entity: OnceLock<Option<Box<RawEntity>>>,
+}
+
+impl LazyEntities {
+    fn get(&self, id: u64) -> Option<&RawEntity> {
+        let slot = self.slots.get(&id)?;
+        slot.entity
+            .get_or_init(|| {
+                let mut lexer = StepLexer::from_bytes((*self.input).as_ref());
+                lexer.seek(slot.offset);
+                lexer.next_entity().filter(|e| e.id == id).map(Box::new)
+            })
+            .as_deref()
+    }
+}
 
 /// A graph-aware cache for STEP entities and their ArxOS counterparts.
 #[derive(Default)]
 pub struct EntityRegistry {
     /// Mapping from STEP ID (#123) to raw entity data.
-    entities: HashMap<u64, RawEntity>,
-    /// Mapping from Class Name (e.g., "IFCSPACE") to list of IDs.
-    class_map: HashMap<String, Vec<u64>>,
+    entities: EntityStore,
+    /// Mapping from interned class (e.g., IFCSPACE) to list of IDs.
+    class_map: HashMap<IfcClass, Vec<u64>>,
     /// Mapping from STEP ID to resolved ArxAddress.
     address_map: HashMap<u64, ArxAddress>,
+    /// Reverse of `address_map`: STEP IDs by address segment.
+    address_index: AddressTrie<Vec<u64>>,
+    /// Relationship adjacency, built on first use and reset on `register`.
+    relations: OnceLock<RelationIndex>,
+    /// Offset-indexed entities from `populate_lazy`, materialized on demand.
+    lazy: Option<LazyEntities>,
 }
 
 impl EntityRegistry {
@@ -28,17 +150,28 @@ impl EntityRegistry {
     pub fn register(&mut self, entity: RawEntity) {
         let id = entity.id;
         let class = entity.class.clone();
-        self.entities.insert(id, entity);
+        self.entities.insert(entity);
         self.class_map.entry(class).or_default().push(id);
+        self.relations.take();
     }
 
     /// Look up a raw entity by its STEP ID.
     pub fn get_raw(&self, id: u64) -> Option<&RawEntity> {
-        self.entities.get(&id)
+        self.entities
+            .get(id)
+            .or_else(|| self.lazy.as_ref()?.get(id))
     }
 
     /// Get all entity IDs for a specific class.
     pub fn get_by_class(&self, class: &str) -> &[u64] {
+        match IfcClass::lookup(class) {
+            Some(class) => self.get_by_class_id(&class),
+            None => self.get_by_class_id(&IfcClass::unregistered(class)),
+        }
+    }
+
+    /// Get all entity IDs for an interned class.
+    pub fn get_by_class_id(&self, class: &IfcClass) -> &[u64] {
         self.class_map
             .get(class)
             .map(|v| v.as_slice())
@@ -47,7 +180,26 @@ impl EntityRegistry {
 
     /// Map a STEP ID to an ArxAddress.
     pub fn set_address(&mut self, id: u64, address: ArxAddress) {
-        self.address_map.insert(id, address);
+        let ids = self
+            .address_index
+            .get_or_insert_with(&address.path, Vec::new);
+        if !ids.contains(&id) {
+            ids.push(id);
+        }
+        if let Some(old) = self.address_map.insert(id, address) {
+            if self.address_map.get(&id) != Some(&old) {
+                self.unindex_address(id, &old);
+            }
+        }
+    }
+
+    fn unindex_address(&mut self, id: u64, address: &ArxAddress) {
+        if let Some(ids) = self.address_index.remove(&address.path) {
+            let rest: Vec<u64> = ids.into_iter().filter(|&other| other != id).collect();
+            if !rest.is_empty() {
+                self.address_index.insert(&address.path, rest);
+            }
+        }
     }
 
     /// Get the resolved ArxAddress for a STEP ID.
@@ -55,54 +207,149 @@ impl EntityRegistry {
         self.address_map.get(&id)
     }
 
+    /// STEP IDs mapped to exactly `address`, in mapping order.
+    pub fn ids_at_address(&self, address: &ArxAddress) -> &[u64] {
+        self.address_index
+            .get(&address.path)
+            .map(|ids| ids.as_slice())
+            .unwrap_or(&[])
+    }
+
+    /// STEP IDs whose address matches `pattern`, grouped by address.
+    pub fn ids_matching(&self, pattern: &AddressPattern) -> Vec<u64> {
+        self.address_index
+            .matching(pattern)
+            .into_iter()
+            .flat_map(|(_, ids)| ids.iter().copied())
+            .collect()
+    }
+
     /// Clear all data in the registry.
     pub fn clear(&mut self) {
         self.entities.clear();
+        self.class_map.clear();
         self.address_map.clear();
+        self.address_index.clear();
+        self.relations.take();
+        self.lazy = None;
     }
 
     /// Get the count of registered entities.
     pub fn entity_count(&self) -> usize {
-        self.entities.len()
+        self.entities.len + self.lazy.as_ref().map_or(0, |lazy| lazy.slots.len())
+    }
+
+    /// True when entities are materialized on demand (see [`Self::populate_lazy`]).
+    pub fn is_lazy(&self) -> bool {
+        self.lazy.is_some()
     }
 
     /// Populate the registry from a lexer.
-    pub fn populate_from_lexer(&mut self, mut lexer: crate::ifc::parser::lexer::StepLexer) {
+    pub fn populate_from_lexer(&mut self, mut lexer: StepLexer<'_>) {
         while let Some(entity) = lexer.next_entity() {
             self.register(entity);
         }
     }
 
-    /// Get all entity IDs that are contained within or aggregated by a specific entity.
-    pub fn get_contained(&self, container_id: u64) -> Vec<u64> {
-        let mut kids = Vec::new();
-        // Look through IfcRelAggregates and IfcRelContainedInSpatialStructure
-        for &rel_id in self.get_by_class("IFCRELAGGREGATES") {
-            if let Some(rel) = self.get_raw(rel_id) {
-                if matches!(rel.params.get(4), Some(Param::Reference(id)) if *id == container_id) {
-                    if let Some(Param::List(related)) = rel.params.get(5) {
-                        for p in related {
-                            if let Param::Reference(id) = p {
-                                kids.push(*id);
-                            }
-                        }
-                    }
-                }
-            }
+    /// Populate the registry from raw STEP bytes, lexing chunks in parallel.
+    ///
+    /// The input is split at entity terminators (`;` outside strings), each
+    /// chunk is lexed into its own registry on the rayon pool, and the chunk
+    /// registries are merged in file order so `get_by_class` ordering matches
+    /// a sequential [`Self::populate_from_lexer`] pass.
+    pub fn populate_parallel(&mut self, input: &[u8]) {
+        let max_chunks = rayon::current_num_threads() * CHUNKS_PER_THREAD;
+        self.populate_chunked(input, max_chunks, PARALLEL_MIN_CHUNK_BYTES);
+    }
+
+    fn populate_chunked(&mut self, input: &[u8], max_chunks: usize, min_chunk_bytes: usize) {
+        let lex = telemetry::time(Phase::IfcLex);
+        let ranges = split_entity_chunks(input, max_chunks, min_chunk_bytes);
+        if ranges.len() <= 1 {
+            // Lexing and registering interleave; count the pass as registering.
+            drop(lex);
+            let _register = telemetry::time(Phase::IfcRegister);
+            self.populate_from_lexer(StepLexer::from_bytes(input));
+            return;
         }
-        for &rel_id in self.get_by_class("IFCRELCONTAINEDINSPATIALSTRUCTURE") {
-            if let Some(rel) = self.get_raw(rel_id) {
-                if matches!(rel.params.get(5), Some(Param::Reference(id)) if *id == container_id) {
-                    if let Some(Param::List(related)) = rel.params.get(4) {
-                        for p in related {
-                            if let Param::Reference(id) = p {
-                                kids.push(*id);
-                            }
-                        }
-                    }
-                }
-            }
+
+        let chunks: Vec<EntityRegistry> = ranges
+            .into_par_iter()
+            .map(|range| {
+                let mut chunk = EntityRegistry::new();
+                chunk.populate_from_lexer(StepLexer::from_bytes(&input[range]));
+                chunk
+            })
+            .collect();
+        drop(lex);
+
+        let _register = telemetry::time(Phase::IfcRegister);
+        self.entities
+            .reserve(chunks.iter().map(|c| c.entities.len).sum());
+        for chunk in chunks {
+            self.merge(chunk);
+        }
+    }
+
+    /// Populate the registry with a header-only pre-scan and lex entities lazily.
+    ///
+    /// Records `#id → byte offset` and the class of every entity, so
+    /// `get_by_class` / `get_stats` work immediately, while parameters are
+    /// parsed only when `get_raw` first dereferences an id. Intended for a
+    /// fresh registry over a memory-mapped [`super::StepSource`]; commands that
+    /// only need the spatial tree skip parsing the bulk of geometry entities.
+    pub fn populate_lazy<S>(&mut self, input: Arc<S>)
+    where
+        S: AsRef<[u8]> + Send + Sync + 'static,
+    {
+        let _lex = telemetry::time(Phase::IfcLex);
+        let mut slots = HashMap::new();
+        let mut lexer = StepLexer::from_bytes((*input).as_ref());
+        while let Some((id, class, offset)) = lexer.next_entity_header() {
+            let slot = LazySlot {
+                offset,
+                entity: OnceLock::new(),
+            };
+            slots.insert(id, slot);
+            self.class_map
+                .entry(IfcClass::intern(class))
+                .or_default()
+                .push(id);
         }
+        self.lazy = Some(LazyEntities { input, slots });
+        self.relations.take();
+    }
+
+    /// Merge another registry into this one (entities, class index and addresses).
+    ///
+    /// Entries of `other` win on duplicate STEP IDs, matching `register` order.
+    /// Meant for eagerly populated registries; a lazy index on `other` is dropped.
+    pub fn merge(&mut self, other: EntityRegistry) {
+        for entity in other.entities.into_entities() {
+            self.entities.insert(entity);
+        }
+        for (class, ids) in other.class_map {
+            self.class_map.entry(class).or_default().extend(ids);
+        }
+        for (id, address) in other.address_map {
+            self.set_address(id, address);
+        }
+        self.relations.take();
+    }
+
+    /// Containment / aggregation / group / property adjacency for all entities.
+    ///
+    /// Built once on first call after the registry is populated.
+    pub fn relations(&self) -> &RelationIndex {
+        self.relations.get_or_init(|| RelationIndex::build(self))
+    }
+
+    /// Get all entity IDs that are contained within or aggregated by a specific entity.
+    pub fn get_contained(&self, container_id: u64) -> Vec<u64> {
+        // IfcRelAggregates first, then IfcRelContainedInSpatialStructure
+        let relations = self.relations();
+        let mut kids = relations.aggregated_children(container_id).to_vec();
+        kids.extend_from_slice(relations.contained_elements(container_id));
         kids
     }
 
@@ -117,17 +364,17 @@ impl EntityRegistry {
     pub fn get_stats(&self) -> crate::ifc::EntityStats {
         let mut class_counts = HashMap::new();
         for (class, ids) in &self.class_map {
-            class_counts.insert(class.clone(), ids.len());
+            class_counts.insert(class.to_string(), ids.len());
         }
 
         let spatial_classes = ["IFCSITE", "IFCBUILDING", "IFCBUILDINGSTOREY", "IFCSPACE"];
         let spatial_entities = spatial_classes
             .iter()
-            .map(|&c| self.class_map.get(c).map(|v| v.len()).unwrap_or(0))
+            .map(|&c| self.get_by_class(c).len())
             .sum();
 
         crate::ifc::EntityStats {
-            total_entities: self.entities.len(),
+            total_entities: self.entity_count(),
             class_counts,
             spatial_entities,
         }
@@ -143,12 +390,12 @@ mod tests {
         let mut registry = EntityRegistry::new();
         registry.register(RawEntity {
             id: 1,
-            class: "IFCSPACE".to_string(),
+            class: "IFCSPACE".into(),
             params: vec![],
         });
         registry.register(RawEntity {
             id: 2,
-            class: "IFCSPACE".to_string(),
+            class: "IFCSPACE".into(),
             params: vec![],
         });
 
@@ -162,12 +409,12 @@ mod tests {
         let mut registry = EntityRegistry::new();
         registry.register(RawEntity {
             id: 1,
-            class: "IFCBUILDING".to_string(),
+            class: "IFCBUILDING".into(),
             params: vec![],
         });
         registry.register(RawEntity {
             id: 2,
-            class: "IFCWALL".to_string(),
+            class: "IFCWALL".into(),
             params: vec![],
         });
 
@@ -176,4 +423,126 @@ mod tests {
         assert_eq!(stats.spatial_entities, 1);
         assert_eq!(stats.class_counts.get("IFCWALL"), Some(&1));
     }
+
+    #[test]
+    fn test_merge_preserves_class_order() {
+        let mut a = EntityRegistry::new();
+        a.populate_from_lexer(StepLexer::new("#1= IFCSPACE();#2= IFCWALL();"));
+        let mut b = EntityRegistry::new();
+        b.populate_from_lexer(StepLexer::new("#3= IFCSPACE();"));
+
+        a.merge(b);
+        assert_eq!(a.entity_count(), 3);
+        assert_eq!(a.get_by_class("IFCSPACE"), &[1, 3]);
+    }
+
+    #[test]
+    fn test_address_index_follows_remapping() {
+        let boiler = ArxAddress::from_path("/usa/ny/nyc/hq/floor-01/mech/boiler-01").unwrap();
+        let pump = ArxAddress::from_path("/usa/ny/nyc/hq/floor-01/mech/pump-01").unwrap();
+        let mut registry = EntityRegistry::new();
+        registry.set_address(1, boiler.clone());
+        registry.set_address(2, boiler.clone());
+        registry.set_address(1, pump.clone());
+        let mut other = EntityRegistry::new();
+        other.set_address(3, pump.clone());
+        registry.merge(other);
+
+        assert_eq!(registry.ids_at_address(&boiler), &[2]);
+        assert_eq!(registry.ids_at_address(&pump), &[1, 3]);
+        let pattern = AddressPattern::new("/usa/ny/*/mech/*").unwrap();
+        assert_eq!(registry.ids_matching(&pattern), vec![2, 1, 3]);
+
+        registry.clear();
+        assert!(registry.ids_matching(&pattern).is_empty());
+    }
+
+    #[test]
+    fn test_populate_parallel_small_input() {
+        let mut registry = EntityRegistry::new();
+        registry.populate_parallel(b"#1= IFCPROJECT('g',$,'P');#2= IFCBUILDING('b',$,'B');");
+        assert_eq!(registry.entity_count(), 2);
+        assert_eq!(registry.get_by_class("IFCBUILDING"), &[2]);
+    }
+
+    #[test]
+    fn test_populate_parallel_matches_sequential() {
+        let mut input = String::new();
+        for id in 100..500u64 {
+            match id % 4 {
+                0 => input.push_str(&format!("#{}= IFCSPACE('s;{}',$,#{});", id, id, id - 1)),
+                1 => input.push_str(&format!("#{}= IFCWALL('w''{}',(1.5,#{}));", id, id, id - 2)),
+                2 => input.push_str(&format!("/* ; */#{}= IFCVENDORPART(.T.,{});", id, id)),
+                _ => input.push_str(&format!("#{}= IFCCARTESIANPOINT((0.,{}.,1.));\n", id, id)),
+            }
+        }
+        // Re-registered and outlier IDs straddle chunk boundaries too
+        input.push_str("#150= IFCDOOR('again');#900000000= IFCSITE();#101= IFCSLAB();");
+        let input = input.as_bytes();
+        assert!(split_entity_chunks(input, 8, 256).len() > 1);
+
+        let mut sequential = EntityRegistry::new();
+        sequential.populate_from_lexer(StepLexer::from_bytes(input));
+        let mut chunked = EntityRegistry::new();
+        chunked.populate_chunked(input, 8, 256);
+
+        assert_eq!(chunked.entity_count(), sequential.entity_count());
+        assert_eq!(chunked.entities.base, sequential.entities.base);
+        assert_eq!(
+            chunked.entities.sparse.len(),
+            sequential.entities.sparse.len()
+        );
+        for id in (100..500).chain([900_000_000]) {
+            assert_eq!(
+                chunked.get_raw(id),
+                sequential.get_raw(id),
+                "entity #{}",
+                id
+            );
+        }
+        assert_eq!(chunked.class_map, sequential.class_map);
+        assert_eq!(
+            chunked.get_stats().class_counts,
+            sequential.get_stats().class_counts
+        );
+    }
+
+    #[test]
+    fn test_registry_sparse_outlier_ids() {
+        let mut registry = EntityRegistry::new();
+        for id in [1u64, 2, 900_000_000, 3] {
+            registry.register(RawEntity {
+                id,
+                class: "IFCWALL".into(),
+                params: vec![],
+            });
+        }
+        registry.register(RawEntity {
+            id: 2,
+            class: "IFCWALL".into(),
+            params: vec![],
+        });
+
+        assert_eq!(registry.entity_count(), 4);
+        assert!(registry.get_raw(900_000_000).is_some());
+        assert!(registry.get_raw(4).is_none());
+    }
+
+    #[test]
+    fn test_populate_lazy_materializes_on_demand() {
+        let input =
+            Arc::new(b"#1= IFCSPACE('g',$,'Office');#2= IFCCARTESIANPOINT((1.,2.,3.));".to_vec());
+        let mut registry = EntityRegistry::new();
+        registry.populate_lazy(input);
+
+        assert!(registry.is_lazy());
+        assert_eq!(registry.entity_count(), 2);
+        assert_eq!(registry.get_by_class("IFCCARTESIANPOINT"), &[2]);
+
+        let space = registry.get_raw(1).unwrap();
+        assert_eq!(space.class, "IFCSPACE");
+        assert_eq!(space.params.len(), 3);
+        assert!(registry.get_raw(3).is_none());
+        assert_eq!(registry.get_stats().spatial_entities, 1);
+    }
 }
@@ -0,0 +1,197 @@
+//! Forward and inverse relationship index over STEP entities.
+//!
+//! The resolver asks the same questions for every product ("which storey
+//! contains #n?", "which zone is #n in?", "which psets describe #n?").
+//! Answering them by scanning every `IFCREL*` entity makes resolution
+//! O(products × relationships); this index is built once per registry and
+//! turns each question into a hash lookup.
+
+use super::lexer::Param;
+use super::registry::EntityRegistry;
+use std::collections::HashMap;
+
+/// Spatial classes that may own a local placement, in lookup priority order.
+const PLACEMENT_OWNER_CLASSES: [&str; 3] = ["IFCSPACE", "IFCBUILDINGSTOREY", "IFCBUILDING"];
+
+/// Adjacency maps derived from relationship entities.
+///
+/// Every list keeps relationship order from the file, so lookups return the
+/// same answer as the first match of a linear scan.
+#[derive(Debug, Default)]
+pub struct RelationIndex {
+    /// `IfcRelAggregates`: RelatingObject → RelatedObjects.
+    aggregated_children: HashMap<u64, Vec<u64>>,
+    /// `IfcRelContainedInSpatialStructure`: RelatingStructure → RelatedElements.
+    contained_elements: HashMap<u64, Vec<u64>>,
+    /// `IfcRelContainedInSpatialStructure`: element → first containing structure.
+    container_of: HashMap<u64, u64>,
+    /// `IfcRelAssignsToGroup`: object → RelatingGroup ids.
+    groups_of: HashMap<u64, Vec<u64>>,
+    /// `IfcRelDefinesByProperties`: object → RelatingPropertyDefinition ids.
+    property_definitions_of: HashMap<u64, Vec<u64>>,
+    /// Placement id → first spatial element (space, storey, building) referencing it.
+    placement_owner: HashMap<u64, u64>,
+}
+
+impl RelationIndex {
+    /// Build the index with one pass over each relationship class.
+    pub fn build(registry: &EntityRegistry) -> Self {
+        let mut index = Self::default();
+
+        for &rel_id in registry.get_by_class("IFCRELAGGREGATES") {
+            let Some(rel) = registry.get_raw(rel_id) else {
+                continue;
+            };
+            // Param 4: RelatingObject, Param 5: RelatedObjects
+            if let Some(Param::Reference(parent)) = rel.params.get(4) {
+                if let Some(Param::List(related)) = rel.params.get(5) {
+                    index
+                        .aggregated_children
+                        .entry(*parent)
+                        .or_default()
+                        .extend(references(related));
+                }
+            }
+        }
+
+        for &rel_id in registry.get_by_class("IFCRELCONTAINEDINSPATIALSTRUCTURE") {
+            let Some(rel) = registry.get_raw(rel_id) else {
+                continue;
+            };
+            // Param 4: RelatedElements, Param 5: RelatingStructure
+            if let Some(Param::List(related)) = rel.params.get(4) {
+                let container = match rel.params.get(5) {
+                    Some(Param::Reference(id)) => Some(*id),
+                    _ => None,
+                };
+                for element in references(related) {
+                    if let Some(container) = container {
+                        index.container_of.entry(element).or_insert(container);
+                        index
+                            .contained_elements
+                            .entry(container)
+                            .or_default()
+                            .push(element);
+                    }
+                }
+            }
+        }
+
+        for &rel_id in registry.get_by_class("IFCRELASSIGNSTOGROUP") {
+            let Some(rel) = registry.get_raw(rel_id) else {
+                continue;
+            };
+            // Param 4: RelatedObjects, Param 6: RelatingGroup
+            if let (Some(Param::List(related)), Some(Param::Reference(group))) =
+                (rel.params.get(4), rel.params.get(6))
+            {
+                for object in references(related) {
+                    index.groups_of.entry(object).or_default().push(*group);
+                }
+            }
+        }
+
+        for &rel_id in registry.get_by_class("IFCRELDEFINESBYPROPERTIES") {
+            let Some(rel) = registry.get_raw(rel_id) else {
+                continue;
+            };
+            // Param 4: RelatedObjects, Param 5: RelatingPropertyDefinition
+            if let (Some(Param::List(related)), Some(Param::Reference(pset))) =
+                (rel.params.get(4), rel.params.get(5))
+            {
+                for object in references(related) {
+                    let psets = index.property_definitions_of.entry(object).or_default();
+                    // An object listed twice in one relationship still gets its pset once
+                    if psets.last() != Some(pset) {
+                        psets.push(*pset);
+                    }
+                }
+            }
+        }
+
+        for class in PLACEMENT_OWNER_CLASSES {
+            for &sp_id in registry.get_by_class(class) {
+                let Some(sp_raw) = registry.get_raw(sp_id) else {
+                    continue;
+                };
+                for param in &sp_raw.params {
+                    if let Param::Reference(pid) = param {
+                        index.placement_owner.entry(*pid).or_insert(sp_id);
+                    }
+                }
+            }
+        }
+
+        index
+    }
+
+    /// Objects aggregated by `parent` (`IfcRelAggregates`).
+    pub fn aggregated_children(&self, parent: u64) -> &[u64] {
+        slice_of(&self.aggregated_children, parent)
+    }
+
+    /// Elements contained in spatial structure `container`.
+    pub fn contained_elements(&self, container: u64) -> &[u64] {
+        slice_of(&self.contained_elements, container)
+    }
+
+    /// First spatial structure that contains `element`.
+    pub fn container_of(&self, element: u64) -> Option<u64> {
+        self.container_of.get(&element).copied()
+    }
+
+    /// Groups (`IfcZone`, `IfcGroup`, systems …) `object` is assigned to, in file order.
+    pub fn groups_of(&self, object: u64) -> &[u64] {
+        slice_of(&self.groups_of, object)
+    }
+
+    /// Property definitions attached to `object`, in file order.
+    pub fn property_definitions_of(&self, object: u64) -> &[u64] {
+        slice_of(&self.property_definitions_of, object)
+    }
+
+    /// Spatial element (space, storey, building) whose params reference `placement`.
+    pub fn placement_owner(&self, placement: u64) -> Option<u64> {
+        self.placement_owner.get(&placement).copied()
+    }
+}
+
+fn references(list: &[Param]) -> impl Iterator<Item = u64> + '_ {
+    list.iter().filter_map(|p| match p {
+        Param::Reference(id) => Some(*id),
+        _ => None,
+    })
+}
+
+fn slice_of(map: &HashMap<u64, Vec<u64>>, key: u64) -> &[u64] {
+    map.get(&key).map(|v| v.as_slice()).unwrap_or(&[])
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use crate::ifc::parser::lexer::StepLexer;
+
+    #[test]
+    fn indexes_containment_groups_and_placements() {
+        let mut registry = EntityRegistry::new();
+        registry.populate_from_lexer(StepLexer::new(
+            "#1= IFCBUILDINGSTOREY('s',$,'L1',$,$,#10);
+             #2= IFCPUMP('p',$,'P-1',$,$,#11);
+             #3= IFCZONE('z',$,'East');
+             #4= IFCRELCONTAINEDINSPATIALSTRUCTURE('r1',$,$,$,(#2),#1);
+             #5= IFCRELASSIGNSTOGROUP('r2',$,$,$,(#2),$,#3);
+             #6= IFCRELAGGREGATES('r3',$,$,$,#1,(#2));
+             #7= IFCRELDEFINESBYPROPERTIES('r4',$,$,$,(#2),#8);",
+        ));
+
+        let rel = registry.relations();
+        assert_eq!(rel.container_of(2), Some(1));
+        assert_eq!(rel.contained_elements(1), &[2]);
+        assert_eq!(rel.aggregated_children(1), &[2]);
+        assert_eq!(rel.groups_of(2), &[3]);
+        assert_eq!(rel.property_definitions_of(2), &[8]);
+        assert_eq!(rel.placement_owner(10), Some(1));
+        assert_eq!(rel.container_of(3), None);
+    }
+}
@@ -3,7 +3,7 @@
 //! This module takes raw STEP entities and resolves them into
 //! high-level ArxOS domain objects like Buildings, Floors, and Rooms.
 
-use super::geometry::GeometryResolver;
+use super::geometry::{GeometryCache, GeometryResolver};
 use super::lexer::{Param, RawEntity};
 use super::mesh::MeshResolver;
 use super::registry::EntityRegistry;
@@ -18,8 +18,28 @@ use crate::ifc::mapping::{
     PROP_ARX_WING,
 };
 use anyhow::{anyhow, Result};
+use rayon::prelude::*;
 use std::collections::HashMap;
 
+/// One storey resolved against the read-only registry.
+///
+/// Storeys resolve in parallel; the addresses they generate are applied to
+/// the registry afterwards, in storey order, so the result is deterministic.
+struct ResolvedStorey {
+    floor: Floor,
+    addresses: Vec<(u64, ArxAddress)>,
+    rooms: Vec<u64>,
+}
+
+/// Where `resolve_all` attaches one piece of equipment.
+enum Attachment {
+    Room(usize, usize, usize),
+    Wing(usize, usize),
+    NewWing(usize, String),
+    Floor(usize),
+    Fallback,
+}
+
 /// Resolver for mapping IFC entities to ArxOS domain objects.
 pub struct IfcResolver<'a> {
     registry: &'a mut EntityRegistry,
@@ -29,6 +49,10 @@ pub struct IfcResolver<'a> {
     city: String,
     resolved_rooms: std::collections::HashSet<u64>,
     warnings: Vec<MappingWarning>,
+    /// When false, product bodies are not meshed (hierarchy-only imports).
+    resolve_geometry: bool,
+    /// Placements and representation meshes shared across all products.
+    geometry_cache: GeometryCache,
 }
 
 impl<'a> IfcResolver<'a> {
@@ -41,9 +65,18 @@ impl<'a> IfcResolver<'a> {
             city: "Main".to_string(),
             resolved_rooms: std::collections::HashSet::new(),
             warnings: Vec::new(),
+            resolve_geometry: true,
+            geometry_cache: GeometryCache::new(),
         }
     }
 
+    /// Skip body/mesh extraction; placements, properties and the spatial tree
+    /// still resolve. With a lazy registry this leaves most geometry unparsed.
+    pub fn hierarchy_only(mut self) -> Self {
+        self.resolve_geometry = false;
+        self
+    }
+
     /// Set building metadata for ArxAddress generation.
     pub fn with_metadata(mut self, country: &str, state: &str, city: &str) -> Self {
         self.country = country.to_string();
@@ -94,81 +127,41 @@ impl<'a> IfcResolver<'a> {
             ));
         }
 
-        // Rehydrate the building hierarchy with the resolved equipment
+        // Rehydrate the building hierarchy with the resolved equipment.
+        // Each item is moved into exactly one container; name lookups are
+        // indexed once up front instead of scanning every room per item.
+        let room_index = Self::index_rooms(&building);
+        let floor_index = Self::index_floors(&building);
         let mut fallback_attach = 0usize;
         for mut eq in equipment_list {
-            let mut attached = false;
-            if let Some(ref addr) = eq.address {
-                let parts = addr.parts().unwrap_or_default();
-                let floor_name = parts.4;
-                let room_name = parts.5;
-
-                if !room_name.is_empty() {
-                    // Try to find the room and attach it
-                    for floor in &mut building.floors {
-                        for wing in &mut floor.wings {
-                            if let Some(room) = wing.rooms.iter_mut().find(|r| {
-                                let sanitized_r_name =
-                                    r.name.to_lowercase().replace([' ', '_'], "-");
-                                r.name == room_name || sanitized_r_name == room_name
-                            }) {
-                                eq.set_room(room.id.clone());
-                                room.equipment.push(eq.clone());
-                                attached = true;
-                                break;
-                            }
-                        }
-                        if attached {
-                            break;
-                        }
-                    }
+            let attachment = Self::attachment_for(&eq, &building, &room_index, &floor_index);
+            match attachment {
+                Attachment::Room(f, w, r) => {
+                    let room = &mut building.floors[f].wings[w].rooms[r];
+                    eq.set_room(room.id.clone());
+                    room.equipment.push(eq);
                 }
-
-                if !attached && !floor_name.is_empty() {
-                    // Try to find the floor
-                    if let Some(floor) = building.floors.iter_mut().find(|f| {
-                        let sanitized_f_name =
-                            f.name.to_lowercase().replace([' ', '_'], "-");
-                        f.name == floor_name || sanitized_f_name == floor_name
-                    }) {
-                        let wing_opt = wing_name_from_properties(&eq.properties);
-
-                        if let Some(w_name) = wing_opt {
-                            // Find or create wing on that floor
-                            if let Some(wing) = floor.wings.iter_mut().find(|w| {
-                                let sanitized_w_name =
-                                    w.name.to_lowercase().replace([' ', '_'], "-");
-                                w.name == w_name || sanitized_w_name == w_name
-                            }) {
-                                wing.equipment.push(eq.clone());
-                                attached = true;
-                            } else {
-                                let mut wing = Wing::new(w_name);
-                                wing.equipment.push(eq.clone());
-                                floor.wings.push(wing);
-                                attached = true;
-                            }
-                        } else {
-                            floor.equipment.push(eq.clone());
-                            attached = true;
-                        }
-                    }
+                Attachment::Wing(f, w) => building.floors[f].wings[w].equipment.push(eq),
+                Attachment::NewWing(f, w_name) => {
+                    let mut wing = Wing::new(w_name);
+                    wing.equipment.push(eq);
+                    building.floors[f].wings.push(wing);
                 }
-            }
-
-            if !attached {
-                // Fallback: attach to first floor
-                if let Some(floor) = building.floors.first_mut() {
-                    let name = eq.name.clone();
-                    floor.equipment.push(eq);
-                    fallback_attach += 1;
-                    self.warnings.push(
-                        MappingWarning::new(
-                            "equipment_fallback_floor",
-                            "equipment could not be placed by containment; attached to first floor",
-                        )
-                        .with_entity(name),
-                    );
+                Attachment::Floor(f) => building.floors[f].equipment.push(eq),
+                Attachment::Fallback => {
+                    // Fallback: attach to first floor
+                    if let Some(floor) = building.floors.first_mut() {
+                        let name = eq.name.clone();
+                        floor.equipment.push(eq);
+                        fallback_attach += 1;
+                        self.warnings.push(
+                            MappingWarning::new(
+                                "equipment_fallback_floor",
+                                "equipment could not be placed by containment; attached to first floor",
+                            )
+                            .with_entity(name),
+                        );
+                    }
                 }
             }
         }
@@ -186,6 +179,77 @@ impl<'a> IfcResolver<'a> {
         Ok((building, report))
     }
 
+    /// Room positions keyed by raw and sanitized name; the first room wins.
+    fn index_rooms(building: &Building) -> HashMap<String, (usize, usize, usize)> {
+        let mut index = HashMap::new();
+        for (f, floor) in building.floors.iter().enumerate() {
+            for (w, wing) in floor.wings.iter().enumerate() {
+                for (r, room) in wing.rooms.iter().enumerate() {
+                    index.entry(room.name.clone()).or_insert((f, w, r));
+                    index
+                        .entry(Self::sanitize_name(&room.name))
+                        .or_insert((f, w, r));
+                }
+            }
+        }
+        index
+    }
+
+    /// Floor positions keyed by raw and sanitized name; the first floor wins.
+    fn index_floors(building: &Building) -> HashMap<String, usize> {
+        let mut index = HashMap::new();
+        for (f, floor) in building.floors.iter().enumerate() {
+            index.entry(floor.name.clone()).or_insert(f);
+            index.entry(Self::sanitize_name(&floor.name)).or_insert(f);
+        }
+        index
+    }
+
+    fn sanitize_name(name: &str) -> String {
+        name.to_lowercase().replace([' ', '_'], "-")
+    }
+
+    /// Pick the container for `eq` from its address: room, then floor/wing.
+    fn attachment_for(
+        eq: &Equipment,
+        building: &Building,
+        room_index: &HashMap<String, (usize, usize, usize)>,
+        floor_index: &HashMap<String, usize>,
+    ) -> Attachment {
+        let Some(addr) = eq.address.as_ref() else {
+            return Attachment::Fallback;
+        };
+        let parts = addr.parts().unwrap_or_default();
+        let floor_name = parts.4;
+        let room_name = parts.5;
+
+        if !room_name.is_empty() {
+            if let Some(&(f, w, r)) = room_index.get(&room_name) {
+                return Attachment::Room(f, w, r);
+            }
+        }
+
+        if floor_name.is_empty() {
+            return Attachment::Fallback;
+        }
+        let Some(&f) = floor_index.get(&floor_name) else {
+            return Attachment::Fallback;
+        };
+        match wing_name_from_properties(&eq.properties) {
+            Some(w_name) => {
+                let existing = building.floors[f]
+                    .wings
+                    .iter()
+                    .position(|w| w.name == w_name || Self::sanitize_name(&w.name) == w_name);
+                match existing {
+                    Some(w) => Attachment::Wing(f, w),
+                    None => Attachment::NewWing(f, w_name),
+                }
+            }
+            None => Attachment::Floor(f),
+        }
+    }
+
     /// Report building-element products that exist in the file but are not imported.
     ///
     /// Pilot honesty (R2 / LossReport P0): do not claim "Warnings: none" when walls,
@@ -330,9 +394,24 @@ fn is_ignored_class(class: &str) -> bool {
             building.add_metadata_property(k, v);
         }
 
+        // Storeys only read the registry, so resolve them in parallel and
+        // apply their addresses afterwards in storey order.
         let floor_ids = self.find_children_of(id, "IFCBUILDINGSTOREY");
-        for floor_id in floor_ids {
-            building.floors.push(self.resolve_floor(floor_id, id)?);
+        let storeys: Vec<Result<ResolvedStorey>> = {
+            let this = &*self;
+            let building_addr = this.registry.get_address(id);
+            floor_ids
+                .par_iter()
+                .map(|&floor_id| this.resolve_floor(floor_id, building_addr))
+                .collect()
+        };
+        for storey in storeys {
+            let storey = storey?;
+            for (entity_id, addr) in storey.addresses {
+                self.registry.set_address(entity_id, addr);
+            }
+            self.resolved_rooms.extend(storey.rooms);
+            building.floors.push(storey.floor);
         }
 
         // --- FALLBACK FOR UNRESOLVED SPACES (ROOMS) ---
@@ -342,7 +421,12 @@ fn is_ignored_class(class: &str) -> bool {
             if !self.resolved_rooms.contains(&space_id) {
                 if let Some(first_floor) = building.floors.first_mut() {
                     // Try to resolve room. Pass floor ID if first_floor was resolved with a STEP ID, else parent building ID
-                    let room = self.resolve_room(space_id, id)?;
+                    let building_addr = self.registry.get_address(id);
+                    let (room, room_addr) = self.resolve_room(space_id, building_addr)?;
+                    self.resolved_rooms.insert(space_id);
+                    if let Some(addr) = room_addr {
+                        self.registry.set_address(space_id, addr);
+                    }
                     // Attach to first floor's default ("Main") wing
                     if let Some(wing) = first_floor.wings.iter_mut().find(|w| w.name == "Main") {
                         wing.rooms.push(room);
@@ -358,7 +442,7 @@ fn is_ignored_class(class: &str) -> bool {
         Ok(building)
     }
 
-    fn resolve_floor(&mut self, id: u64, parent_id: u64) -> Result<Floor> {
+    fn resolve_floor(&self, id: u64, parent_addr: Option<&ArxAddress>) -> Result<ResolvedStorey> {
         let (name, floor_global_id) = {
             let raw = self
                 .registry
@@ -372,9 +456,9 @@ fn is_ignored_class(class: &str) -> bool {
         };
 
         // Generate ArxAddress for Floor
-        if let Some(parent_addr) = self.registry.get_address(parent_id) {
+        let floor_addr = parent_addr.map(|parent_addr| {
             let (_, _, _, building_name, _, _, _) = parent_addr.parts().unwrap_or_default();
-            let addr = ArxAddress::new(
+            ArxAddress::new(
                 &self.country,
                 &self.state,
                 &self.city,
@@ -382,11 +466,12 @@ fn is_ignored_class(class: &str) -> bool {
                 &name,
                 "",
                 "",
-            );
-            self.registry.set_address(id, addr);
-        }
+            )
+        });
 
         let mut floor = Floor::new(name, 0); // Defaulting to level 0, can be refined with IfcStorey
+        let mut addresses = Vec::new();
+        let mut rooms = Vec::new();
 
         for room_id in self.registry.get_contained(id) {
             let is_space = if let Some(raw) = self.registry.get_raw(room_id) {
@@ -396,7 +481,11 @@ fn is_ignored_class(class: &str) -> bool {
             };
 
             if is_space {
-                let room = self.resolve_room(room_id, id)?;
+                let (room, room_addr) = self.resolve_room(room_id, floor_addr.as_ref())?;
+                rooms.push(room_id);
+                if let Some(addr) = room_addr {
+                    addresses.push((room_id, addr));
+                }
 
                 // Prefer standard IFC group/zone grouping
                 let mut wing_name = self.find_zone_of_entity(room_id);
@@ -434,11 +523,22 @@ fn is_ignored_class(class: &str) -> bool {
         );
         normalize_imported_properties(&mut floor.properties);
 
-        Ok(floor)
+        if let Some(addr) = floor_addr {
+            addresses.push((id, addr));
+        }
+        Ok(ResolvedStorey {
+            floor,
+            addresses,
+            rooms,
+        })
     }
 
-    fn resolve_room(&mut self, id: u64, parent_id: u64) -> Result<Room> {
-        self.resolved_rooms.insert(id);
+    /// Resolve one space; the caller records its address and resolved state.
+    fn resolve_room(
+        &self,
+        id: u64,
+        parent_addr: Option<&ArxAddress>,
+    ) -> Result<(Room, Option<ArxAddress>)> {
         let (name, global_id) = {
             let raw = self
                 .registry
@@ -452,10 +552,10 @@ fn is_ignored_class(class: &str) -> bool {
         };
 
         // Generate ArxAddress for Room
-        if let Some(parent_addr) = self.registry.get_address(parent_id) {
+        let room_addr = parent_addr.map(|parent_addr| {
             let (_, _, _, building_name, floor_name, _, _) =
                 parent_addr.parts().unwrap_or_default();
-            let addr = ArxAddress::new(
+            ArxAddress::new(
                 &self.country,
                 &self.state,
                 &self.city,
@@ -463,9 +563,8 @@ fn is_ignored_class(class: &str) -> bool {
                 &floor_name,
                 &name,
                 "",
-            );
-            self.registry.set_address(id, addr);
-        }
+            )
+        });
 
         let mut room = Room::new(name, RoomType::Other("Space".to_string()));
         let raw = self.registry.get_raw(id).unwrap();
@@ -482,12 +581,16 @@ fn is_ignored_class(class: &str) -> bool {
         normalize_imported_properties(&mut room.properties);
 
         // Placement + body (L2 geometry contract — building_local meters)
-        let geom_resolver = GeometryResolver::new(self.registry);
+        let geom_resolver = GeometryResolver::with_cache(self.registry, &self.geometry_cache);
         let mesh_resolver = MeshResolver::new(self.registry, &geom_resolver);
 
         // IFC4 product: ObjectPlacement @5, Representation @6; fall back for sparse files
         let placement_param = raw.params.get(5).or_else(|| raw.params.get(2));
-        let representation_param = raw.params.get(6).or_else(|| raw.params.get(4));
+        let representation_param = raw
+            .params
+            .get(6)
+            .or_else(|| raw.params.get(4))
+            .filter(|_| self.resolve_geometry);
 
         let (ox, oy, oz, transform) = if let Some(Param::Reference(placement_id)) = placement_param
         {
@@ -530,7 +633,7 @@ fn is_ignored_class(class: &str) -> bool {
         spatial.mesh = mesh_local;
         room.spatial_properties = spatial;
 
-        Ok(room)
+        Ok((room, room_addr))
     }
 
     fn resolve_site_metadata(&mut self, id: u64, building: &mut Building) -> Result<()> {
@@ -562,7 +665,7 @@ fn is_ignored_class(class: &str) -> bool {
 
     fn resolve_ar_anchors(&mut self) -> Result<Vec<Equipment>> {
         let mut anchors = Vec::new();
-        let geom_resolver = GeometryResolver::new(self.registry);
+        let geom_resolver = GeometryResolver::with_cache(self.registry, &self.geometry_cache);
         let mesh_resolver = MeshResolver::new(self.registry, &geom_resolver);
 
         for &id in self.registry.get_by_class("IFCANNOTATION") {
@@ -594,7 +697,8 @@ fn is_ignored_class(class: &str) -> bool {
                         // Resolve Properties
                         self.resolve_properties(id, &mut eq.properties);
 
-                        if let Some(Param::Reference(shape_id)) = raw.params.get(4) {
+                        let shape_param = raw.params.get(4).filter(|_| self.resolve_geometry);
+                        if let Some(Param::Reference(shape_id)) = shape_param {
                             if let Some(mesh) =
                                 mesh_resolver.extract_mesh_from_shape(*shape_id, &transform)
                             {
@@ -628,9 +732,7 @@ fn is_ignored_class(class: &str) -> bool {
         }
     }
 
-    fn resolve_equipment_under(&mut self, _building_id: u64) -> Result<Vec<Equipment>> {
-        let mut equipment_list = Vec::new();
-
+    fn resolve_equipment_under(&self, _building_id: u64) -> Result<Vec<Equipment>> {
         let classes = [
             "IFCFLOWTERMINAL",
             "IFCFLOWCONTROLLER",
@@ -653,91 +755,95 @@ fn is_ignored_class(class: &str) -> bool {
             "IFCCOMMUNICATIONSAPPLIANCE",
         ];
 
-        let geom_resolver = GeometryResolver::new(self.registry);
+        let geom_resolver = GeometryResolver::with_cache(self.registry, &self.geometry_cache);
         let mesh_resolver = MeshResolver::new(self.registry, &geom_resolver);
 
-        for &class in &classes {
-            for &id in self.registry.get_by_class(class) {
-                let eq_data = if let Some(raw) = self.registry.get_raw(id) {
-                    let name = self
-                        .extract_entity_name(raw)
-                        .unwrap_or_else(|| format!("{}_{}", class, id));
-                    let eq_type = self.map_class_to_type(class);
-                    Some((name, eq_type))
-                } else {
-                    None
-                };
-
-                if let Some((name, eq_type)) = eq_data {
-                    let mut eq = Equipment::new(name, "".to_string(), eq_type); // Empty path, using address instead
-
-                    // Generate ArxAddress for Equipment (Fixture)
-                    if let Some(container_id) = self.find_container_of(id) {
-                        if let Some(container_addr) = self.registry.get_address(container_id) {
-                            let (country, state, city, building, floor, room, _) =
-                                container_addr.parts().unwrap_or_default();
-                            eq.address = Some(ArxAddress::new(
-                                &country, &state, &city, &building, &floor, &room, &eq.name,
-                            ));
-                        }
-                    }
+        // Products are independent once containers have addresses; resolve
+        // them on the rayon pool and keep class/file order in the result.
+        let products: Vec<(&str, u64)> = classes
+            .iter()
+            .flat_map(|&class| {
+                self.registry
+                    .get_by_class(class)
+                    .iter()
+                    .map(move |&id| (class, id))
+            })
+            .collect();
+        let equipment_list = products
+            .par_iter()
+            .map(|&(class, id)| self.resolve_equipment(class, id, &geom_resolver, &mesh_resolver))
+            .collect::<Vec<_>>()
+            .into_iter()
+            .flatten()
+            .collect();
 
-                    // Prefer standard IFC group/zone grouping for wing membership
-                    if let Some(w_name) = self.find_zone_of_entity(id) {
-                        eq.properties.insert(PROP_ARX_WING.to_string(), w_name);
-                    }
+        Ok(equipment_list)
+    }
 
-                    // Resolve Properties + identity
-                    self.resolve_properties(id, &mut eq.properties);
-                    let global_id = self
-                        .registry
-                        .get_raw(id)
-                        .and_then(|raw| self.extract_string_param(raw, 0));
-                    apply_identity_on_import(
-                        &mut eq.id,
-                        &mut eq.ifc_global_id,
-                        global_id,
-                        &eq.properties,
-                    );
-                    apply_lidar_on_import(&mut eq.lidar_enrichment, &mut eq.properties);
-                    normalize_imported_properties(&mut eq.properties);
-
-                    // Placement + optional body (L2)
-                    if let Some(raw) = self.registry.get_raw(id) {
-                        let placement_param = raw.params.get(5).or_else(|| raw.params.get(2));
-                        let representation_param = raw.params.get(6).or_else(|| raw.params.get(4));
-                        if let Some(Param::Reference(placement_id)) = placement_param {
-                            let transform = geom_resolver.resolve_placement(*placement_id);
-                            let origin =
-                                transform.transform_point(&nalgebra::Vector3::new(0.0, 0.0, 0.0));
-                            eq.position = Position {
-                                x: origin.x,
-                                y: origin.y,
-                                z: origin.z,
-                                coordinate_system: COORD_BUILDING_LOCAL.to_string(),
-                            };
-
-                            if let Some(Param::Reference(shape_id)) = representation_param {
-                                if let Some(mesh_world) =
-                                    mesh_resolver.extract_mesh_from_shape(*shape_id, &transform)
-                                {
-                                    eq.mesh = Some(mesh_to_local(
-                                        &mesh_world,
-                                        origin.x,
-                                        origin.y,
-                                        origin.z,
-                                    ));
-                                }
-                            }
-                        }
-                    }
+    fn resolve_equipment(
+        &self,
+        class: &str,
+        id: u64,
+        geom_resolver: &GeometryResolver<'_>,
+        mesh_resolver: &MeshResolver<'_>,
+    ) -> Option<Equipment> {
+        let raw = self.registry.get_raw(id)?;
+        let name = self
+            .extract_entity_name(raw)
+            .unwrap_or_else(|| format!("{}_{}", class, id));
+        let eq_type = self.map_class_to_type(class);
+        let mut eq = Equipment::new(name, "".to_string(), eq_type); // Empty path, using address instead
+
+        // Generate ArxAddress for Equipment (Fixture)
+        if let Some(container_id) = self.find_container_of(id) {
+            if let Some(container_addr) = self.registry.get_address(container_id) {
+                let (country, state, city, building, floor, room, _) =
+                    container_addr.parts().unwrap_or_default();
+                eq.address = Some(ArxAddress::new(
+                    &country, &state, &city, &building, &floor, &room, &eq.name,
+                ));
+            }
+        }
+
+        // Prefer standard IFC group/zone grouping for wing membership
+        if let Some(w_name) = self.find_zone_of_entity(id) {
+            eq.properties.insert(PROP_ARX_WING.to_string(), w_name);
+        }
+
+        // Resolve Properties + identity
+        self.resolve_properties(id, &mut eq.properties);
+        let global_id = self.extract_string_param(raw, 0);
+        apply_identity_on_import(&mut eq.id, &mut eq.ifc_global_id, global_id, &eq.properties);
+        apply_lidar_on_import(&mut eq.lidar_enrichment, &mut eq.properties);
+        normalize_imported_properties(&mut eq.properties);
+
+        // Placement + optional body (L2)
+        let placement_param = raw.params.get(5).or_else(|| raw.params.get(2));
+        let representation_param = raw
+            .params
+            .get(6)
+            .or_else(|| raw.params.get(4))
+            .filter(|_| self.resolve_geometry);
+        if let Some(Param::Reference(placement_id)) = placement_param {
+            let transform = geom_resolver.resolve_placement(*placement_id);
+            let origin = transform.transform_point(&nalgebra::Vector3::new(0.0, 0.0, 0.0));
+            eq.position = Position {
+                x: origin.x,
+                y: origin.y,
+                z: origin.z,
+                coordinate_system: COORD_BUILDING_LOCAL.to_string(),
+            };
 
-                    equipment_list.push(eq);
+            if let Some(Param::Reference(shape_id)) = representation_param {
+                if let Some(mesh_world) =
+                    mesh_resolver.extract_mesh_from_shape(*shape_id, &transform)
+                {
+                    eq.mesh = Some(mesh_to_local(&mesh_world, origin.x, origin.y, origin.z));
                 }
             }
         }
 
-        Ok(equipment_list)
+        Some(eq)
     }
 
     fn map_class_to_type(&self, class: &str) -> EquipmentType {
@@ -778,20 +884,8 @@ fn is_ignored_class(class: &str) -> bool {
         // RelatedObjects: Param 4 (List of references)
         // RelatingPropertyDefinition: Param 5 (Reference to Pset)
 
-        for &rel_id in self.registry.get_by_class("IFCRELDEFINESBYPROPERTIES") {
-            if let Some(rel_raw) = self.registry.get_raw(rel_id) {
-                if let Some(Param::List(related_objects)) = rel_raw.params.get(4) {
-                    let is_related = related_objects
-                        .iter()
-                        .any(|p| matches!(p, Param::Reference(id) if *id == entity_id));
-
-                    if is_related {
-                        if let Some(Param::Reference(pset_id)) = rel_raw.params.get(5) {
-                            self.extract_property_set(*pset_id, out_props);
-                        }
-                    }
-                }
-            }
+        for &pset_id in self.registry.relations().property_definitions_of(entity_id) {
+            self.extract_property_set(pset_id, out_props);
         }
     }
 
@@ -865,26 +959,11 @@ fn is_ignored_class(class: &str) -> bool {
     // --- Relationship Discovery ---
 
     fn find_container_of(&self, entity_id: u64) -> Option<u64> {
-        // 1. Look for IFCRELCONTAINEDINSPATIALSTRUCTURE where RelatedElements contains entity_id
-        for &id in self
-            .registry
-            .get_by_class("IFCRELCONTAINEDINSPATIALSTRUCTURE")
-        {
-            if let Some(entity) = self.registry.get_raw(id) {
-                // Param 4: RelatedObjects (List of References)
-                if let Some(Param::List(elements)) = entity.params.get(4) {
-                    for item in elements {
-                        if let Param::Reference(e_id) = item {
-                            if *e_id == entity_id {
-                                // Param 5: RelatingStructure (The Container)
-                                if let Some(Param::Reference(container_id)) = entity.params.get(5) {
-                                    return Some(*container_id);
-                                }
-                            }
-                        }
-                    }
-                }
-            }
+        let relations = self.registry.relations();
+
+        // 1. IFCRELCONTAINEDINSPATIALSTRUCTURE where RelatedElements contains entity_id
+        if let Some(container_id) = relations.container_of(entity_id) {
+            return Some(container_id);
         }
 
         // 2. Fallback: Placement-based container tracking
@@ -906,17 +985,8 @@ fn is_ignored_class(class: &str) -> bool {
             let mut visited = std::collections::HashSet::new();
             while visited.insert(placement_id) {
                 // Find if any spatial structure uses this placement
-                for class in &["IFCSPACE", "IFCBUILDINGSTOREY", "IFCBUILDING"] {
-                    for &sp_id in self.registry.get_by_class(class) {
-                        if let Some(sp_raw) = self.registry.get_raw(sp_id) {
-                            let has_placement = sp_raw.params.iter().any(
-                                |p| matches!(p, Param::Reference(pid) if *pid == placement_id),
-                            );
-                            if has_placement {
-                                return Some(sp_id);
-                            }
-                        }
-                    }
+                if let Some(sp_id) = relations.placement_owner(placement_id) {
+                    return Some(sp_id);
                 }
 
                 // Walk up the local placement parent
@@ -937,30 +1007,19 @@ fn is_ignored_class(class: &str) -> bool {
     }
 
     fn find_children_of(&self, parent_id: u64, child_class: &str) -> Vec<u64> {
-        let mut children = Vec::new();
-        // Look for IFCRELAGGREGATES where RelatingObject is the parent
-        // then follow RelatedObjects list.
-        for &id in self.registry.get_by_class("IFCRELAGGREGATES") {
-            if let Some(entity) = self.registry.get_raw(id) {
-                // Param 4 is usually the parent (RelatingObject)
-                if let Some(Param::Reference(p_id)) = entity.params.get(4) {
-                    if *p_id == parent_id {
-                        // Param 5 is the list of children (RelatedObjects)
-                        if let Some(Param::List(list)) = entity.params.get(5) {
-                            for item in list {
-                                if let Param::Reference(c_id) = item {
-                                    if let Some(c_entity) = self.registry.get_raw(*c_id) {
-                                        if c_entity.class == child_class {
-                                            children.push(*c_id);
-                                        }
-                                    }
-                                }
-                            }
-                        }
-                    }
-                }
-            }
-        }
+        // IFCRELAGGREGATES where RelatingObject is the parent
+        let mut children: Vec<u64> = self
+            .registry
+            .relations()
+            .aggregated_children(parent_id)
+            .iter()
+            .copied()
+            .filter(|&c_id| {
+                self.registry
+                    .get_raw(c_id)
+                    .is_some_and(|c_entity| c_entity.class == child_class)
+            })
+            .collect();
 
         if children.is_empty() {
             // Fallback: look for direct reference to parent in child entities
@@ -982,27 +1041,14 @@ fn is_ignored_class(class: &str) -> bool {
     }
 
     fn find_zone_of_entity(&self, entity_id: u64) -> Option<String> {
-        // Look for IFCRELASSIGNSTOGROUP where RelatedObjects list contains entity_id
-        for &rel_id in self.registry.get_by_class("IFCRELASSIGNSTOGROUP") {
-            if let Some(rel) = self.registry.get_raw(rel_id) {
-                // Param 4: RelatedObjects (List of References)
-                if let Some(Param::List(related)) = rel.params.get(4) {
-                    let contains_entity = related
-                        .iter()
-                        .any(|item| matches!(item, Param::Reference(id) if *id == entity_id));
-                    if contains_entity {
-                        // Param 6: RelatingGroup (Reference to IfcZone/IfcGroup)
-                        if let Some(Param::Reference(group_id)) = rel.params.get(6) {
-                            if let Some(group_raw) = self.registry.get_raw(*group_id) {
-                                if group_raw.class == "IFCZONE" || group_raw.class == "IFCGROUP" {
-                                    // Param 2: Name
-                                    if let Some(name) = self.extract_string_param(group_raw, 2) {
-                                        if !name.trim().is_empty() {
-                                            return Some(name);
-                                        }
-                                    }
-                                }
-                            }
+        // IFCRELASSIGNSTOGROUP where RelatedObjects contains entity_id
+        for &group_id in self.registry.relations().groups_of(entity_id) {
+            if let Some(group_raw) = self.registry.get_raw(group_id) {
+                if group_raw.class == "IFCZONE" || group_raw.class == "IFCGROUP" {
+                    // Param 2: Name
+                    if let Some(name) = self.extract_string_param(group_raw, 2) {
+                        if !name.trim().is_empty() {
+                            return Some(name);
                         }
                     }
                 }
@@ -1045,7 +1091,7 @@ mod tests {
 
         let entity = RawEntity {
             id: 1,
-            class: "TEST".to_string(),
+            class: "TEST".into(),
             params: vec![Param::String("Hello".to_string())],
         };
 
@@ -1067,7 +1113,7 @@ mod tests {
         ] {
             registry.register(RawEntity {
                 id,
-                class: class.to_string(),
+                class: class.into(),
                 params: vec![],
             });
         }
@@ -0,0 +1,85 @@
+//! Memory-mapped STEP input for the native IFC parser.
+//!
+//! Large federated models (hundreds of MB) are lexed straight from the page
+//! cache instead of being copied into a `String` first. The mapping is
+//! read-only and file-backed, so it does not count against anonymous RSS.
+
+use super::lexer::StepLexer;
+use memmap2::Mmap;
+use std::fs::File;
+use std::path::Path;
+
+/// Read-only view of a STEP file on disk.
+pub struct StepSource {
+    /// `None` for zero-length files (mapping an empty file is not portable).
+    map: Option<Mmap>,
+}
+
+impl StepSource {
+    /// Memory-map the file at `path`.
+    pub fn open(path: &Path) -> std::io::Result<Self> {
+        let file = File::open(path)?;
+        if file.metadata()?.len() == 0 {
+            return Ok(Self { map: None });
+        }
+        // SAFETY: the mapping is read-only and never outlives `self`. Concurrent
+        // truncation of the file by another process is outside our contract
+        // (same as any mmap reader); callers import files they own.
+        #[allow(unsafe_code)]
+        let map = unsafe { Mmap::map(&file)? };
+        Ok(Self { map: Some(map) })
+    }
+
+    /// Raw bytes of the mapped file.
+    pub fn as_bytes(&self) -> &[u8] {
+        self.map.as_deref().unwrap_or(&[])
+    }
+
+    /// Length of the mapped file in bytes.
+    pub fn len(&self) -> usize {
+        self.as_bytes().len()
+    }
+
+    /// True for empty files.
+    pub fn is_empty(&self) -> bool {
+        self.len() == 0
+    }
+
+    /// Create a lexer borrowing from the mapping.
+    pub fn lexer(&self) -> StepLexer<'_> {
+        StepLexer::from_bytes(self.as_bytes())
+    }
+}
+
+impl AsRef<[u8]> for StepSource {
+    fn as_ref(&self) -> &[u8] {
+        self.as_bytes()
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use std::io::Write;
+    use tempfile::NamedTempFile;
+
+    #[test]
+    fn maps_file_and_lexes() {
+        let mut f = NamedTempFile::new().unwrap();
+        write!(f, "DATA;\n#1= IFCPROJECT('guid',$,'Demo');\nENDSEC;").unwrap();
+
+        let source = StepSource::open(f.path()).unwrap();
+        let mut lexer = source.lexer();
+        let entity = lexer.next_entity_ref().unwrap();
+        assert_eq!(entity.id, 1);
+        assert_eq!(entity.class, "IFCPROJECT");
+    }
+
+    #[test]
+    fn empty_file_is_empty_source() {
+        let f = NamedTempFile::new().unwrap();
+        let source = StepSource::open(f.path()).unwrap();
+        assert!(source.is_empty());
+        assert!(source.lexer().next_entity_ref().is_none());
+    }
+}
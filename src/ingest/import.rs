@@ -83,15 +83,7 @@ pub fn finalize_ingest(
         building = merge.building;
     }
 
-    promote_equipment_anchors(&mut building);
-
-    // Tag source on metadata
-    let tag = source.tag();
-    if let Some(meta) = &mut building.metadata {
-        if !meta.tags.iter().any(|t| t == tag) {
-            meta.tags.push(tag.to_string());
-        }
-    }
+    finalize_edits(&mut building, source);
 
     let validation = if options.validate {
         validate_building(&building)
@@ -121,6 +113,22 @@ pub fn finalize_ingest(
     }
 }
 
+/// Normalization every ingest applies before validation: AR marker equipment
+/// becomes anchors and the source is tagged on metadata.
+///
+/// Edits go through `Building`'s tracking, so incremental saves stay valid.
+pub(crate) fn finalize_edits(building: &mut Building, source: IngestSource) {
+    promote_equipment_anchors(building);
+
+    // Tag source on metadata
+    let tag = source.tag();
+    if let Some(meta) = &mut building.metadata {
+        if !meta.tags.iter().any(|t| t == tag) {
+            meta.tags.push(tag.to_string());
+        }
+    }
+}
+
 /// Parse IFC at `path`, optionally merge with `existing_yaml` or sibling YAML, validate.
 pub fn import_ifc_path(
     path: &Path,
@@ -257,7 +265,10 @@ fn promote_equipment_anchors(building: &mut crate::core::Building) {
         }
     }
 
+    // Floors whose equipment lists changed, for incremental saves
+    let mut touched = Vec::new();
     for floor in &mut building.floors {
+        let mut promoted = false;
         let mut floor_anchors = Vec::new();
         floor.equipment.retain(|eq| {
             if is_ar_anchor(eq) {
@@ -267,6 +278,7 @@ fn promote_equipment_anchors(building: &mut crate::core::Building) {
                 true
             }
         });
+        promoted |= !floor_anchors.is_empty();
         floor.anchors.extend(floor_anchors);
 
         for wing in &mut floor.wings {
@@ -279,6 +291,7 @@ fn promote_equipment_anchors(building: &mut crate::core::Building) {
                     true
                 }
             });
+            promoted |= !wing_anchors.is_empty();
             wing.anchors.extend(wing_anchors);
 
             for room in &mut wing.rooms {
@@ -291,8 +304,15 @@ fn promote_equipment_anchors(building: &mut crate::core::Building) {
                         true
                     }
                 });
+                promoted |= !room_anchors.is_empty();
                 room.anchors.extend(room_anchors);
             }
         }
+        if promoted {
+            touched.push(floor.id.clone());
+        }
+    }
+    for floor_id in touched {
+        building.mark_floor_dirty(&floor_id);
     }
 }
@@ -108,5 +108,36 @@ pub fn persist_building_at(
     Ok(result.building)
 }
 
+/// Like [`persist_building`], but only revalidates and rewrites what changed
+/// since `building` was last persisted this way (output is byte-identical to
+/// a full save). Intended for interactive editors that save repeatedly; edits
+/// must go through `Building`'s `&mut` accessors or mark the touched floors.
+pub fn persist_building_incremental(
+    building: Building,
+    commit: bool,
+    message: Option<&str>,
+) -> Result<Building, Box<dyn std::error::Error>> {
+    let cwd = std::env::current_dir()?;
+    persist_building_incremental_at(cwd, building, commit, message)
+}
+
+/// Like [`persist_building_incremental`], under an explicit project root.
+pub fn persist_building_incremental_at(
+    base: impl AsRef<std::path::Path>,
+    mut building: Building,
+    commit: bool,
+    message: Option<&str>,
+) -> Result<Building, Box<dyn std::error::Error>> {
+    import::finalize_edits(&mut building, IngestSource::Text);
+
+    let pm = crate::persistence::PersistenceManager::at(base.as_ref());
+    pm.save_building_incremental(&mut building)?;
+    if commit {
+        pm.commit_working_file(message)?;
+    }
+
+    Ok(building)
+}
+
 // Need Building in scope for ingest helpers
 use crate::core::Building;
@@ -21,6 +21,7 @@ pub mod ingest;
 pub mod persistence;
 pub mod resource_limits;
 pub mod spatial;
+pub mod telemetry;
 pub mod utils;
 pub mod validation;
 pub mod yaml;
@@ -0,0 +1,466 @@
+//! Incremental `building.yaml` writer.
+//!
+//! `BuildingYamlSerializer::serialize_building` always projects, sorts and
+//! emits the whole document. For a building whose edits are tracked (see
+//! `core::edits`) this module produces the same bytes by splicing sections:
+//! every floor item of `building.floors` and every item of the top-level
+//! `equipment` list is kept from the previous save unless its floor (or the
+//! item itself) was edited, and only edited floors are revalidated.
+//!
+//! Each section is serialized inside a wrapper document that places it at the
+//! nesting depth it has in `building.yaml`. The YAML emitter's output for a
+//! node depends only on that context, so the wrapper body is exactly the text
+//! the full document contains for the node. The rest of the document
+//! (building fields, anchors) is small and is serialized on every save with
+//! one placeholder item per list, which is then replaced by the concatenated
+//! sections. Anything unexpected in that process makes [`Plan::render`] return
+//! `None` and the caller falls back to a full save.
+
+use std::collections::HashMap;
+use std::sync::Arc;
+
+use serde::Serialize;
+
+use super::PersistenceResult;
+use crate::core::edits::{FloorIds, FloorSection, IdKind, SaveBaseline};
+use crate::core::{Building, Equipment, EquipmentType, Floor};
+use crate::validation::building::{validate_building_changes, BuildingValidationReport};
+use crate::yaml::{BuildingData, BUILDING_YAML_SCHEMA_VERSION};
+
+/// Name/id of the placeholder items; YAML-escaped, so it cannot collide with
+/// the text of a real section.
+const PLACEHOLDER: &str = "\u{0}arx-section\u{0}";
+
+/// Which floors of `building` can reuse their previous section.
+pub(crate) struct Plan<'a> {
+    building: &'a Building,
+    strict_addresses: bool,
+    /// Previous section per floor (parallel to `building.floors`).
+    previous: Vec<Option<&'a Arc<FloorSection>>>,
+    /// Floor needs revalidation and reserialization.
+    edited: Vec<bool>,
+    /// Floor id is unique in the building (only those are kept in the baseline).
+    unique: Vec<bool>,
+}
+
+impl<'a> Plan<'a> {
+    pub(crate) fn new(building: &'a Building, strict_addresses: bool) -> Self {
+        let baseline = building
+            .edits
+            .baseline()
+            .filter(|b| b.strict_addresses == strict_addresses);
+
+        let mut id_counts: HashMap<&str, usize> = HashMap::new();
+        for floor in &building.floors {
+            *id_counts.entry(floor.id.as_str()).or_default() += 1;
+        }
+        // Sections are keyed by floor id; floors sharing an id are always rebuilt.
+        let unique: Vec<bool> = building
+            .floors
+            .iter()
+            .map(|floor| id_counts[floor.id.as_str()] == 1)
+            .collect();
+        let previous: Vec<_> = building
+            .floors
+            .iter()
+            .zip(&unique)
+            .map(|(floor, unique)| match baseline {
+                Some(b) if *unique => b.floors.get(&floor.id),
+                _ => None,
+            })
+            .collect();
+        let edited = building
+            .floors
+            .iter()
+            .zip(&previous)
+            .map(|(floor, prev)| prev.is_none() || !building.edits.is_floor_clean(&floor.id))
+            .collect();
+
+        Self {
+            building,
+            strict_addresses,
+            previous,
+            edited,
+            unique,
+        }
+    }
+
+    /// Number of floors that will be revalidated and reserialized.
+    pub(crate) fn edited_floors(&self) -> usize {
+        self.edited.iter().filter(|e| **e).count()
+    }
+
+    /// Validation report for the save gate.
+    ///
+    /// Same errors as `validate_building` as long as only tracked mutations
+    /// happened since the previous incremental save.
+    pub(crate) fn validate(&self) -> BuildingValidationReport {
+        let clean: Vec<&FloorIds> = self
+            .previous
+            .iter()
+            .zip(&self.edited)
+            .filter(|(_, edited)| !**edited)
+            .filter_map(|(prev, _)| prev.map(|section| &section.ids))
+            .collect();
+        let declared_on_clean_floor =
+            |kind: IdKind, id: &str| clean.iter().any(|ids| ids.contains(kind, id));
+        validate_building_changes(self.building, &self.edited, &declared_on_clean_floor)
+    }
+
+    /// Render the whole `building.yaml` plus the baseline describing it.
+    ///
+    /// `None` when the document cannot be spliced safely (the caller then
+    /// does a full save).
+    pub(crate) fn render(&self) -> PersistenceResult<Option<(String, SaveBaseline)>> {
+        let building = self.building;
+
+        let mut sections = Vec::with_capacity(building.floors.len());
+        for (i, floor) in building.floors.iter().enumerate() {
+            let section = match self.previous[i] {
+                Some(prev) if !self.edited[i] => Arc::clone(prev),
+                prev => match floor_section(building, floor, prev.map(|p| &**p))? {
+                    Some(section) => Arc::new(section),
+                    None => return Ok(None),
+                },
+            };
+            sections.push(section);
+        }
+
+        // `BuildingData::from_building` + `sort_deterministically`, on keys only.
+        let mut floor_order: Vec<usize> = (0..building.floors.len()).collect();
+        floor_order.sort_by_key(|&i| building.floors[i].level);
+        let mut equipment: Vec<(usize, &Equipment)> = Vec::new();
+        for (i, floor) in building.floors.iter().enumerate() {
+            equipment.extend(floor_equipment(floor).map(|eq| (i, eq)));
+        }
+        let with_address = equipment
+            .iter()
+            .filter(|(_, eq)| eq.address.is_some())
+            .count();
+        let mut owned: Vec<Equipment>;
+        let equipment_order: Vec<(usize, &str)> =
+            if with_address == 0 || with_address == equipment.len() {
+                equipment.sort_by(|a, b| BuildingData::equipment_order(a.1, b.1));
+                equipment
+                    .iter()
+                    .map(|(i, eq)| (*i, eq.id.as_str()))
+                    .collect()
+            } else {
+                // With only some items addressed the comparator is not a total
+                // order, and the stable sort's result then depends on the
+                // element type: sort owned items exactly like the full save.
+                let floor_of: HashMap<&str, usize> = equipment
+                    .iter()
+                    .map(|(i, eq)| (eq.id.as_str(), *i))
+                    .collect();
+                if floor_of.len() != equipment.len() {
+                    return Ok(None);
+                }
+                owned = equipment.iter().map(|(_, eq)| (*eq).clone()).collect();
+                owned.sort_by(BuildingData::equipment_order);
+                owned
+                    .iter()
+                    .map(|eq| (floor_of[eq.id.as_str()], eq.id.as_str()))
+                    .collect()
+            };
+
+        let mut floor_items = Vec::with_capacity(floor_order.len());
+        for &i in &floor_order {
+            floor_items.push(sections[i].yaml.as_str());
+        }
+        let mut equipment_items = Vec::with_capacity(equipment_order.len());
+        for (i, id) in &equipment_order {
+            match sections[*i].equipment.get(*id) {
+                Some(item) => equipment_items.push(&**item),
+                None => return Ok(None),
+            }
+        }
+
+        let header = header_document(
+            building,
+            !floor_items.is_empty(),
+            !equipment_items.is_empty(),
+        );
+        let mut yaml = serde_yaml::to_string(&header)?;
+        if !floor_items.is_empty() {
+            let Some(placeholder) = floor_item(&placeholder_floor())? else {
+                return Ok(None);
+            };
+            if !splice(&mut yaml, &placeholder, &floor_items) {
+                return Ok(None);
+            }
+        }
+        if !equipment_items.is_empty() {
+            let Some(placeholder) = equipment_item(&placeholder_equipment())? else {
+                return Ok(None);
+            };
+            if !splice(&mut yaml, &placeholder, &equipment_items) {
+                return Ok(None);
+            }
+        }
+
+        let floors = building
+            .floors
+            .iter()
+            .zip(sections)
+            .zip(&self.unique)
+            .filter(|(_, unique)| **unique)
+            .map(|((floor, section), _)| (floor.id.clone(), section))
+            .collect();
+        let baseline = SaveBaseline {
+            strict_addresses: self.strict_addresses,
+            floors,
+        };
+        Ok(Some((yaml, baseline)))
+    }
+}
+
+/// Serialize one (edited) floor, keeping unedited equipment items from `previous`.
+fn floor_section(
+    building: &Building,
+    floor: &Floor,
+    previous: Option<&FloorSection>,
+) -> PersistenceResult<Option<FloorSection>> {
+    let mut sorted = floor.clone();
+    BuildingData::sort_floor(&mut sorted);
+    let Some(yaml) = floor_item(&sorted)? else {
+        return Ok(None);
+    };
+
+    let mut equipment = HashMap::new();
+    for eq in floor_equipment(floor) {
+        let reused = previous
+            .and_then(|p| p.equipment.get(&eq.id))
+            .filter(|_| building.edits.is_equipment_clean(&floor.id, &eq.id));
+        let item = match reused {
+            Some(item) => Arc::clone(item),
+            None => match equipment_item(eq)? {
+                Some(item) => Arc::from(item),
+                None => return Ok(None),
+            },
+        };
+        if equipment.insert(eq.id.clone(), item).is_some() {
+            // Duplicate ids cannot be keyed (validation rejects them anyway).
+            return Ok(None);
+        }
+    }
+
+    Ok(Some(FloorSection {
+        yaml,
+        equipment,
+        ids: FloorIds::collect(floor),
+    }))
+}
+
+/// Equipment on `floor` in `Building::get_all_equipment` order.
+fn floor_equipment(floor: &Floor) -> impl Iterator<Item = &Equipment> {
+    floor
+        .equipment
+        .iter()
+        .chain(floor.wings.iter().flat_map(|wing| {
+            wing.equipment
+                .iter()
+                .chain(wing.rooms.iter().flat_map(|room| room.equipment.iter()))
+        }))
+}
+
+/// `floor` as an item of `building.floors`.
+fn floor_item(floor: &Floor) -> PersistenceResult<Option<String>> {
+    #[derive(Serialize)]
+    struct Floors<'a> {
+        floors: &'a [Floor],
+    }
+    #[derive(Serialize)]
+    struct Doc<'a> {
+        building: Floors<'a>,
+    }
+    let yaml = serde_yaml::to_string(&Doc {
+        building: Floors {
+            floors: std::slice::from_ref(floor),
+        },
+    })?;
+    Ok(section_body(&yaml, "building:\n  floors:\n"))
+}
+
+/// `eq` as an item of the top-level `equipment` list.
+fn equipment_item(eq: &Equipment) -> PersistenceResult<Option<String>> {
+    #[derive(Serialize)]
+    struct Doc<'a> {
+        equipment: &'a [Equipment],
+    }
+    let yaml = serde_yaml::to_string(&Doc {
+        equipment: std::slice::from_ref(eq),
+    })?;
+    Ok(section_body(&yaml, "equipment:\n"))
+}
+
+/// Strip the wrapper keys; reject output whose end depends on being the last
+/// node of a document (an explicit `...` end marker after a kept block scalar).
+fn section_body(yaml: &str, wrapper: &str) -> Option<String> {
+    let body = yaml.strip_prefix(wrapper)?;
+    if body.is_empty() || body.ends_with("\n...\n") {
+        return None;
+    }
+    Some(body.to_string())
+}
+
+/// Replace the single occurrence of `placeholder` in `doc` with `items`.
+fn splice(doc: &mut String, placeholder: &str, items: &[&str]) -> bool {
+    let Some(at) = doc.find(placeholder) else {
+        return false;
+    };
+    if doc[at + placeholder.len()..].contains(placeholder) {
+        return false;
+    }
+    let len = items.iter().map(|item| item.len()).sum::<usize>();
+    let mut out = String::with_capacity(doc.len() - placeholder.len() + len);
+    out.push_str(&doc[..at]);
+    for item in items {
+        out.push_str(item);
+    }
+    out.push_str(&doc[at + placeholder.len()..]);
+    *doc = out;
+    true
+}
+
+fn placeholder_floor() -> Floor {
+    let mut floor = Floor::new(PLACEHOLDER.to_string(), 0);
+    floor.id = PLACEHOLDER.to_string();
+    floor
+}
+
+fn placeholder_equipment() -> Equipment {
+    let mut eq = Equipment::new(
+        PLACEHOLDER.to_string(),
+        PLACEHOLDER.to_string(),
+        EquipmentType::Other(PLACEHOLDER.to_string()),
+    );
+    eq.id = PLACEHOLDER.to_string();
+    eq
+}
+
+/// The sorted document without floors and equipment (one placeholder each
+/// when the real list is non-empty).
+fn header_document(building: &Building, has_floors: bool, has_equipment: bool) -> BuildingData {
+    let mut anchors = building.anchors.clone();
+    anchors.sort_by(|a, b| a.name.cmp(&b.name));
+    let mut all_anchors: Vec<_> = building.get_all_anchors().into_iter().cloned().collect();
+    all_anchors.sort_by(BuildingData::anchor_order);
+
+    let header = Building {
+        id: building.id.clone(),
+        name: building.name.clone(),
+        path: building.path.clone(),
+        description: building.description.clone(),
+        version: building.version.clone(),
+        global_bounding_box: building.global_bounding_box.clone(),
+        created_at: building.created_at,
+        updated_at: building.updated_at,
+        floors: if has_floors {
+            vec![placeholder_floor()]
+        } else {
+            Vec::new()
+        },
+        metadata: building.metadata.clone(),
+        coordinate_systems: building.coordinate_systems.clone(),
+        ifc_global_id: building.ifc_global_id.clone(),
+        address: building.address.clone(),
+        anchors,
+        pending_anchor_ids: Vec::new(),
+        claim_grace_period_days: building.claim_grace_period_days,
+        spatial_index: Default::default(),
+        edits: Default::default(),
+    };
+    BuildingData {
+        schema_version: BUILDING_YAML_SCHEMA_VERSION,
+        building: header,
+        equipment: if has_equipment {
+            vec![placeholder_equipment()]
+        } else {
+            Vec::new()
+        },
+        anchors: all_anchors,
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use crate::core::{Building, Equipment, EquipmentType, Floor};
+    use crate::persistence::PersistenceManager;
+    use crate::yaml::BuildingYamlSerializer;
+    use std::sync::Arc;
+    use tempfile::TempDir;
+
+    fn sample_building() -> Building {
+        let mut building = Building::new("Splice HQ".to_string(), "/splice-hq".to_string());
+        for level in 0..2 {
+            let mut floor = Floor::new(format!("Floor {}", level), level);
+            floor.equipment.push(Equipment::new(
+                format!("AHU-{}", level),
+                format!("/splice-hq/{}/ahu", level),
+                EquipmentType::HVAC,
+            ));
+            building.add_floor(floor);
+        }
+        building
+    }
+
+    fn saved(manager: &PersistenceManager) -> String {
+        std::fs::read_to_string(manager.building_yaml_path()).unwrap()
+    }
+
+    #[test]
+    fn incremental_save_matches_full_save_and_reuses_clean_floors() {
+        let temp = TempDir::new().unwrap();
+        let manager = PersistenceManager::at(temp.path());
+        let mut building = sample_building();
+
+        manager.save_building_incremental(&mut building).unwrap();
+        assert_eq!(
+            saved(&manager),
+            BuildingYamlSerializer::serialize_building(&building).unwrap()
+        );
+        let first = building.edits.baseline().cloned().expect("baseline");
+
+        let upper_id = building.floors[1].id.clone();
+        let eq_id = building.floors[0].equipment[0].id.clone();
+        building.find_equipment_mut(&eq_id).unwrap().name = "AHU-renamed".to_string();
+        manager.save_building_incremental(&mut building).unwrap();
+        assert_eq!(
+            saved(&manager),
+            BuildingYamlSerializer::serialize_building(&building).unwrap()
+        );
+        assert!(saved(&manager).contains("AHU-renamed"));
+
+        let second = building.edits.baseline().cloned().expect("baseline");
+        assert!(Arc::ptr_eq(
+            &first.floors[&upper_id],
+            &second.floors[&upper_id]
+        ));
+
+        building.add_floor(Floor::new("Roof".to_string(), 2));
+        manager.save_building_incremental(&mut building).unwrap();
+        assert_eq!(
+            saved(&manager),
+            BuildingYamlSerializer::serialize_building(&building).unwrap()
+        );
+    }
+
+    #[test]
+    fn incremental_save_checks_edited_floor_against_clean_ones() {
+        let temp = TempDir::new().unwrap();
+        let manager = PersistenceManager::at(temp.path());
+        let mut building = sample_building();
+        manager.save_building_incremental(&mut building).unwrap();
+        let before = saved(&manager);
+
+        let duplicate = building.floors[0].equipment[0].clone();
+        building
+            .find_floor_mut(1)
+            .unwrap()
+            .equipment
+            .push(duplicate);
+        assert!(manager.save_building_incremental(&mut building).is_err());
+        assert_eq!(saved(&manager), before);
+    }
+}
@@ -1,10 +1,12 @@
 //! Persistence for the canonical `core::Building` durable store.
 //!
-//! Single layout: `{base_path}/building.yaml` via `BuildingYamlSerializer`.
+//! Single layout: `{base_path}/building.yaml` via `BuildingYamlSerializer`,
+//! with a derived load cache in `.arxos/cache` (see [`super::snapshot`]).
 
-use super::{PersistenceError, PersistenceResult};
+use super::{incremental, snapshot, PersistenceError, PersistenceResult};
 use crate::core::Building;
-use crate::yaml::BuildingYamlSerializer;
+use crate::telemetry::{self, Phase};
+use crate::yaml::{BuildingData, BuildingYamlSerializer};
 use std::path::{Path, PathBuf};
 
 /// Canonical durable filename for a building model.
@@ -81,45 +83,90 @@ impl PersistenceManager {
     /// (e.g. `persist_building` / import already checked `has_errors()`).
     /// Do not call from CLI/agent entry points for untrusted models.
     pub fn save_building_unchecked(&self, building: &Building) -> PersistenceResult<()> {
+        let _timer = telemetry::time(Phase::YamlSave);
+        self.write_full(building)
+    }
+
+    /// Serialize the whole building and refresh the snapshot.
+    fn write_full(&self, building: &Building) -> PersistenceResult<()> {
         use std::fs;
 
         if !self.base_path.exists() {
             fs::create_dir_all(&self.base_path)?;
         }
 
-        let yaml_content = BuildingYamlSerializer::serialize_building(building)
+        let document = BuildingYamlSerializer::document(building);
+        let yaml_content = BuildingYamlSerializer::serialize_document(&document)
             .map_err(|e| PersistenceError::SerializationError(e.to_string()))?;
 
         let file_path = self.building_yaml_path();
-        fs::write(&file_path, yaml_content)?;
+        fs::write(&file_path, &yaml_content)?;
 
+        self.store_snapshot(yaml_content.as_bytes(), &document);
         Ok(())
     }
 
     /// Validate then save; hard-fail on validation errors.
     pub fn save_building_validated(&self, building: &Building) -> PersistenceResult<()> {
-        let report = crate::validation::validate_building(building);
-        if report.has_errors() {
-            let details: Vec<String> = report
-                .errors()
-                .map(|e| match &e.field {
-                    Some(f) => format!("{}: {}", f, e.message),
-                    None => e.message.clone(),
-                })
-                .collect();
-            return Err(PersistenceError::ValidationError(format!(
-                "Building validation failed ({} error(s)): {}",
-                details.len(),
-                details.join("; ")
-            )));
-        }
+        validation_gate(&crate::validation::validate_building(building))?;
         self.save_building_unchecked(building)
     }
 
+    /// Validate and save only what changed since the last incremental save.
+    ///
+    /// Writes exactly the bytes [`Self::save_building_unchecked`] would. The
+    /// first call (or any call after an untracked edit, see
+    /// [`Building::invalidate_spatial_index`]) validates and serializes the
+    /// whole building and records per-floor YAML sections on `building`;
+    /// later calls revalidate and reserialize only floors handed out through
+    /// `Building`'s `&mut` accessors and splice in the rest.
+    ///
+    /// The binary snapshot is not refreshed here; it goes stale and is
+    /// rebuilt by the next full load.
+    pub fn save_building_incremental(&self, building: &mut Building) -> PersistenceResult<()> {
+        use std::fs;
+
+        let strict = crate::validation::STRICT_ADDRESSES.load(std::sync::atomic::Ordering::Relaxed);
+        let plan = incremental::Plan::new(building, strict);
+        validation_gate(&plan.validate())?;
+
+        let _timer = telemetry::time(Phase::YamlSave);
+        let Some((yaml_content, baseline)) = plan.render()? else {
+            log::debug!("Incremental save fell back to a full save");
+            self.write_full(building)?;
+            building.edits.mark_all();
+            return Ok(());
+        };
+        debug_assert_eq!(
+            Some(yaml_content.as_str()),
+            BuildingYamlSerializer::serialize_building(building)
+                .ok()
+                .as_deref(),
+            "incremental YAML diverged from a full save"
+        );
+        log::debug!(
+            "Incremental save: {} of {} floor(s) reserialized",
+            plan.edited_floors(),
+            building.floors.len()
+        );
+
+        if !self.base_path.exists() {
+            fs::create_dir_all(&self.base_path)?;
+        }
+        fs::write(self.building_yaml_path(), &yaml_content)?;
+        building.edits.reset(baseline);
+        Ok(())
+    }
+
     /// Load `Building` from `{base}/building.yaml` only (no multi-file discovery).
+    ///
+    /// When the binary snapshot under `.arxos/cache` was produced from the
+    /// current YAML bytes it is decoded instead of parsing YAML; otherwise the
+    /// YAML is parsed and the snapshot refreshed for the next load.
     pub fn load_building_data(&self) -> PersistenceResult<Building> {
         use std::fs;
 
+        let _timer = telemetry::time(Phase::YamlLoad);
         let file_path = self.building_yaml_path();
         if !file_path.exists() {
             return Err(PersistenceError::ValidationError(format!(
@@ -128,9 +175,24 @@ impl PersistenceManager {
             )));
         }
 
-        let yaml_content = fs::read_to_string(&file_path)?;
-        BuildingYamlSerializer::deserialize_building(&yaml_content)
-            .map_err(|e| PersistenceError::SerializationError(e.to_string()))
+        let yaml_bytes = fs::read(&file_path)?;
+        if let Some(document) = snapshot::load_fresh(&self.base_path, &yaml_bytes) {
+            return Ok(document.into_building());
+        }
+
+        let yaml_content = std::str::from_utf8(&yaml_bytes)
+            .map_err(|e| PersistenceError::SerializationError(e.to_string()))?;
+        let document = BuildingYamlSerializer::deserialize_document(yaml_content)
+            .map_err(|e| PersistenceError::SerializationError(e.to_string()))?;
+        self.store_snapshot(&yaml_bytes, &document);
+        Ok(document.into_building())
+    }
+
+    /// Best-effort snapshot refresh; the YAML write/read already succeeded.
+    fn store_snapshot(&self, yaml: &[u8], document: &BuildingData) {
+        if let Err(e) = snapshot::store(&self.base_path, yaml, document) {
+            log::warn!("Failed to write building snapshot: {}", e);
+        }
     }
 
     /// Save Building, then commit with `BuildingGitManager` when a repo exists.
@@ -141,7 +203,11 @@ impl PersistenceManager {
     ) -> PersistenceResult<()> {
         // Caller (persist_building) already validated; avoid double work but keep gate if used alone.
         self.save_building_validated(building)?;
+        self.commit_working_file(message)
+    }
 
+    /// Commit the current `building.yaml` with `BuildingGitManager` when a repo exists.
+    pub fn commit_working_file(&self, message: Option<&str>) -> PersistenceResult<()> {
         if !self.has_git_repo() {
             return Ok(());
         }
@@ -173,3 +239,22 @@ impl PersistenceManager {
         self.base_path.join(".git").exists()
     }
 }
+
+/// Hard-fail with every error of `report` (warnings do not block saves).
+fn validation_gate(report: &crate::validation::BuildingValidationReport) -> PersistenceResult<()> {
+    if !report.has_errors() {
+        return Ok(());
+    }
+    let details: Vec<String> = report
+        .errors()
+        .map(|e| match &e.field {
+            Some(f) => format!("{}: {}", f, e.message),
+            None => e.message.clone(),
+        })
+        .collect();
+    Err(PersistenceError::ValidationError(format!(
+        "Building validation failed ({} error(s)): {}",
+        details.len(),
+        details.join("; ")
+    )))
+}
@@ -1,9 +1,12 @@
 //! Persistence layer for ArxOS data storage
 //!
 //! Durable Building SSOT: `{dir}/building.yaml` via `BuildingYamlSerializer`.
+//! `snapshot` keeps a derived binary copy for fast reloads.
 
 pub mod economy;
+mod incremental;
 pub mod manager;
+pub mod snapshot;
 
 use thiserror::Error;
 
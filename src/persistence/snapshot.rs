@@ -0,0 +1,198 @@
+//! Binary load cache for `building.yaml`.
+//!
+//! `building.yaml` stays the source of truth; this module keeps a derived,
+//! compact CBOR copy of the parsed document at
+//! `{base}/.arxos/cache/building.snapshot` so repeated loads of a large model
+//! can skip the YAML parser.
+//!
+//! The snapshot header carries a SHA-256 key over the exact YAML bytes it was
+//! produced from (plus the crate version, so a binary upgrade that changes the
+//! in-memory model never decodes an old layout). A snapshot is only used when
+//! its key matches the current YAML; anything else — missing file, foreign
+//! magic, stale key, truncated payload, decode failure — is a silent miss and
+//! the caller falls back to parsing YAML.
+//!
+//! Writes go through a temp file plus rename, so readers never observe a
+//! partially written snapshot and concurrent writers simply race to replace it.
+//! Set `ARX_BUILDING_SNAPSHOT=0` to disable both reading and writing.
+//!
+//! The cache directory carries its own `.gitignore`, so repositories created
+//! before `arx init` ignored `.arxos/cache/` don't commit the snapshot on the
+//! next `git add -A` (or the agent's stage-all).
+
+use std::fs;
+use std::io::Write;
+use std::path::{Path, PathBuf};
+
+use sha2::{Digest, Sha256};
+
+use super::{PersistenceError, PersistenceResult};
+use crate::yaml::BuildingData;
+
+const CACHE_DIR: &str = ".arxos/cache";
+const SNAPSHOT_FILE: &str = "building.snapshot";
+/// Ignores everything in the cache directory, itself included.
+const CACHE_GITIGNORE: &str = "# Derived load cache (rebuilt from building.yaml)\n*\n";
+
+/// File magic; the trailing byte is the container format version.
+const MAGIC: &[u8; 8] = b"ARXSNAP\x01";
+const KEY_LEN: usize = 32;
+/// `MAGIC` + key + little-endian `u64` payload length.
+const HEADER_LEN: usize = MAGIC.len() + KEY_LEN + 8;
+
+/// `{base}/.arxos/cache/building.snapshot`.
+pub fn snapshot_path(base_dir: &Path) -> PathBuf {
+    base_dir.join(CACHE_DIR).join(SNAPSHOT_FILE)
+}
+
+/// Whether snapshots are enabled (`ARX_BUILDING_SNAPSHOT`, default on).
+pub fn snapshots_enabled() -> bool {
+    match std::env::var("ARX_BUILDING_SNAPSHOT") {
+        Ok(v) => !matches!(v.trim(), "0" | "false" | "off" | "no"),
+        Err(_) => true,
+    }
+}
+
+/// Cache key for a given `building.yaml` content.
+fn snapshot_key(yaml: &[u8]) -> [u8; KEY_LEN] {
+    let mut hasher = Sha256::new();
+    hasher.update(b"arx-building-snapshot\0");
+    hasher.update(env!("CARGO_PKG_VERSION").as_bytes());
+    hasher.update([0u8]);
+    hasher.update(yaml);
+    hasher.finalize().into()
+}
+
+/// Decode the snapshot for `base_dir` if it was produced from exactly `yaml`.
+///
+/// Returns the raw (not yet rehydrated) document, or `None` on any miss.
+pub fn load_fresh(base_dir: &Path, yaml: &[u8]) -> Option<BuildingData> {
+    if !snapshots_enabled() {
+        return None;
+    }
+    let path = snapshot_path(base_dir);
+    let file = fs::File::open(&path).ok()?;
+    if (file.metadata().ok()?.len() as usize) < HEADER_LEN {
+        return None;
+    }
+    // SAFETY: snapshots are only ever replaced by atomic rename (see `store`),
+    // so the inode behind this mapping is never truncated or rewritten in place
+    // by ArxOS. The mapping is read-only and dropped before returning.
+    #[allow(unsafe_code)]
+    let map = unsafe { memmap2::Mmap::map(&file) }.ok()?;
+
+    let (magic, rest) = map.split_at(MAGIC.len());
+    let (key, rest) = rest.split_at(KEY_LEN);
+    let (len, payload) = rest.split_at(8);
+    if magic != MAGIC || key != snapshot_key(yaml) {
+        return None;
+    }
+    let len = u64::from_le_bytes(len.try_into().ok()?);
+    if len != payload.len() as u64 {
+        log::debug!("Ignoring truncated building snapshot {}", path.display());
+        return None;
+    }
+    match ciborium::from_reader::<BuildingData, _>(payload) {
+        Ok(data) => Some(data),
+        Err(e) => {
+            log::debug!(
+                "Ignoring unreadable building snapshot {}: {}",
+                path.display(),
+                e
+            );
+            None
+        }
+    }
+}
+
+/// Write the snapshot of `data`, keyed by the `yaml` bytes it corresponds to.
+///
+/// `data` must be the raw document as it round-trips through `yaml` (i.e. the
+/// sorted DTO that was serialized, or the DTO just parsed from it).
+pub fn store(base_dir: &Path, yaml: &[u8], data: &BuildingData) -> PersistenceResult<()> {
+    if !snapshots_enabled() {
+        return Ok(());
+    }
+    let mut payload = Vec::new();
+    ciborium::into_writer(data, &mut payload)
+        .map_err(|e| PersistenceError::SerializationError(e.to_string()))?;
+
+    let dir = base_dir.join(CACHE_DIR);
+    fs::create_dir_all(&dir)?;
+    let gitignore = dir.join(".gitignore");
+    if !gitignore.exists() {
+        fs::write(&gitignore, CACHE_GITIGNORE)?;
+    }
+    let mut tmp = tempfile::NamedTempFile::new_in(&dir)?;
+    {
+        let out = tmp.as_file_mut();
+        out.write_all(MAGIC)?;
+        out.write_all(&snapshot_key(yaml))?;
+        out.write_all(&(payload.len() as u64).to_le_bytes())?;
+        out.write_all(&payload)?;
+        out.flush()?;
+    }
+    tmp.persist(dir.join(SNAPSHOT_FILE))
+        .map_err(|e| PersistenceError::IoError(e.error))?;
+    Ok(())
+}
+
+/// Remove the snapshot for `base_dir`, if any.
+pub fn clear(base_dir: &Path) -> PersistenceResult<()> {
+    match fs::remove_file(snapshot_path(base_dir)) {
+        Ok(()) => Ok(()),
+        Err(e) if e.kind() == std::io::ErrorKind::NotFound => Ok(()),
+        Err(e) => Err(e.into()),
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use crate::core::{Building, Floor};
+    use crate::yaml::BuildingYamlSerializer;
+    use tempfile::TempDir;
+
+    fn sample_document() -> BuildingData {
+        let mut building = Building::new("Snapshot HQ".to_string(), "/snapshot-hq".to_string());
+        building.add_floor(Floor::new("Ground".to_string(), 0));
+        BuildingYamlSerializer::document(&building)
+    }
+
+    #[test]
+    fn snapshot_round_trips_for_matching_yaml() {
+        let temp = TempDir::new().unwrap();
+        let data = sample_document();
+        let yaml = BuildingYamlSerializer::serialize_document(&data).unwrap();
+
+        store(temp.path(), yaml.as_bytes(), &data).unwrap();
+        let loaded = load_fresh(temp.path(), yaml.as_bytes()).expect("fresh snapshot");
+        let gitignore = temp.path().join(CACHE_DIR).join(".gitignore");
+        assert_eq!(fs::read_to_string(gitignore).unwrap(), CACHE_GITIGNORE);
+
+        assert_eq!(
+            BuildingYamlSerializer::serialize_document(&loaded).unwrap(),
+            yaml
+        );
+    }
+
+    #[test]
+    fn snapshot_is_ignored_when_yaml_changes_or_file_is_damaged() {
+        let temp = TempDir::new().unwrap();
+        let data = sample_document();
+        let yaml = BuildingYamlSerializer::serialize_document(&data).unwrap();
+        store(temp.path(), yaml.as_bytes(), &data).unwrap();
+
+        let edited = yaml.replace("Snapshot HQ", "Edited HQ");
+        assert!(load_fresh(temp.path(), edited.as_bytes()).is_none());
+
+        let path = snapshot_path(temp.path());
+        let bytes = fs::read(&path).unwrap();
+        fs::write(&path, &bytes[..bytes.len() - 1]).unwrap();
+        assert!(load_fresh(temp.path(), yaml.as_bytes()).is_none());
+
+        clear(temp.path()).unwrap();
+        assert!(!path.exists());
+        clear(temp.path()).unwrap();
+    }
+}
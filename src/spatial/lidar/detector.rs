@@ -3,7 +3,8 @@ use crate::core::{
     BoundingBox, Dimensions, Equipment, EquipmentType, LidarEnrichment, Position, Room, RoomType,
     SpatialProperties,
 };
-use std::collections::{HashMap, VecDeque};
+use rayon::prelude::*;
+use std::collections::HashMap;
 
 pub struct DetectedFloor {
     pub elevation: f64,
@@ -135,7 +136,7 @@ impl RoomDetector {
     /// Detect rooms for a given floor slice
     pub fn detect_rooms(&self, points: &[Point3D], floor_elev: f64, ceil_elev: f64) -> Vec<Room> {
         let slice_points: Vec<&Point3D> = points
-            .iter()
+            .par_iter()
             .filter(|p| p.z >= (floor_elev + 0.5) && p.z < (ceil_elev - 0.5))
             .collect();
 
@@ -143,13 +144,126 @@ impl RoomDetector {
             return Vec::new();
         }
 
+        // 1-2. Bin the slice into a flat 2D occupancy grid
+        let grid = OccupancyGrid::build(&slice_points, self.grid_resolution);
+
+        // 3. Label connected components of Empty cells
+        let components = grid.free_components(self.wall_threshold);
+
+        let floor_height = ceil_elev - floor_elev;
+        let mut rooms = Vec::new();
+
+        // If it is not the external background and meets the minimum size, save as a Room
+        let interior = components
+            .iter()
+            .filter(|c| !c.touches_boundary && c.cells >= self.min_room_cells);
+        for (room_counter, component) in (1..).zip(interior) {
+            let room_min_x = grid.min_x + (component.min_col as f64 * self.grid_resolution);
+            let room_max_x = grid.min_x + (component.max_col as f64 * self.grid_resolution);
+            let room_min_y = grid.min_y + (component.min_row as f64 * self.grid_resolution);
+            let room_max_y = grid.min_y + (component.max_row as f64 * self.grid_resolution);
+
+            let center_x = (room_min_x + room_max_x) / 2.0;
+            let center_y = (room_min_y + room_max_y) / 2.0;
+            let width = room_max_x - room_min_x;
+            let depth = room_max_y - room_min_y;
+
+            let mut room = Room::new(format!("Room {}", room_counter), RoomType::Office);
+
+            room.spatial_properties = SpatialProperties {
+                position: Position {
+                    x: center_x,
+                    y: center_y,
+                    z: floor_elev,
+                    coordinate_system: "building_local".to_string(),
+                },
+                dimensions: Dimensions {
+                    width,
+                    height: floor_height,
+                    depth,
+                },
+                bounding_box: BoundingBox {
+                    min: Position {
+                        x: room_min_x,
+                        y: room_min_y,
+                        z: floor_elev,
+                        coordinate_system: "building_local".to_string(),
+                    },
+                    max: Position {
+                        x: room_max_x,
+                        y: room_max_y,
+                        z: ceil_elev,
+                        coordinate_system: "building_local".to_string(),
+                    },
+                },
+                mesh: None,
+                coordinate_system: "building_local".to_string(),
+            };
+
+            let room_points_count = grid.count_points_in(
+                &slice_points,
+                room_min_x,
+                room_max_x,
+                room_min_y,
+                room_max_y,
+            );
+
+            // Rule-based score — not a calibrated probability (see docs/lidar-confidence.md).
+            room.lidar_enrichment = Some(LidarEnrichment {
+                point_count: room_points_count,
+                confidence_score: 0.90,
+                last_scan_timestamp: Some(chrono::Utc::now()),
+                classification_heuristic: Some(
+                    "2D Occupancy Grid Connected Components".to_string(),
+                ),
+            });
+            crate::core::review::mark_proposed(&mut room.properties);
+
+            rooms.push(room);
+        }
+
+        rooms
+    }
+}
+
+/// Rows per band in the parallel labelling pass.
+const LABEL_BAND_ROWS: usize = 64;
+
+/// Row-major 2D occupancy grid over a floor slice.
+///
+/// Cell counts live in one contiguous buffer, and the slice's points are
+/// bucketed by cell (`cell_start`/`cell_points`, CSR style) so per-room
+/// queries touch only the cells under the room.
+struct OccupancyGrid {
+    rows: usize,
+    cols: usize,
+    min_x: f64,
+    min_y: f64,
+    resolution: f64,
+    counts: Vec<u32>,
+    cell_start: Vec<u32>,
+    cell_points: Vec<u32>,
+}
+
+/// One 4-connected region of free cells, in raster order of its first cell.
+struct GridComponent {
+    cells: usize,
+    min_row: usize,
+    max_row: usize,
+    min_col: usize,
+    max_col: usize,
+    touches_boundary: bool,
+}
+
+impl OccupancyGrid {
+    fn build(points: &[&Point3D], resolution: f64) -> Self {
         // 1. Compute 2D Bounds
         let mut min_x = f64::MAX;
         let mut max_x = f64::MIN;
         let mut min_y = f64::MAX;
         let mut max_y = f64::MIN;
 
-        for p in &slice_points {
+        for p in points {
             if p.x < min_x {
                 min_x = p.x;
             }
@@ -164,158 +278,172 @@ impl RoomDetector {
             }
         }
 
-        let cols = ((max_x - min_x) / self.grid_resolution).ceil() as usize + 1;
-        let rows = ((max_y - min_y) / self.grid_resolution).ceil() as usize + 1;
+        let cols = ((max_x - min_x) / resolution).ceil() as usize + 1;
+        let rows = ((max_y - min_y) / resolution).ceil() as usize + 1;
+
+        // 2. Populate counts, then bucket point indices by cell
+        let cell_of = |p: &Point3D| {
+            let c = ((p.x - min_x) / resolution) as usize;
+            let r = ((p.y - min_y) / resolution) as usize;
+            (r < rows && c < cols).then_some(r * cols + c)
+        };
+        let cells: Vec<Option<usize>> = points.par_iter().map(|p| cell_of(p)).collect();
 
-        // 2. Populate 2D occupancy grid
-        let mut grid = vec![vec![0; cols]; rows];
-        for p in &slice_points {
-            let c = ((p.x - min_x) / self.grid_resolution) as usize;
-            let r = ((p.y - min_y) / self.grid_resolution) as usize;
-            if r < rows && c < cols {
-                grid[r][c] += 1;
+        let mut counts = vec![0u32; rows * cols];
+        for &cell in cells.iter().flatten() {
+            counts[cell] += 1;
+        }
+        let mut cell_start = Vec::with_capacity(counts.len() + 1);
+        let mut running = 0u32;
+        cell_start.push(0);
+        for &count in &counts {
+            running += count;
+            cell_start.push(running);
+        }
+        let mut cursor = cell_start.clone();
+        let mut cell_points = vec![0u32; running as usize];
+        for (i, cell) in cells.iter().enumerate() {
+            if let Some(cell) = *cell {
+                cell_points[cursor[cell] as usize] = i as u32;
+                cursor[cell] += 1;
             }
         }
 
-        // 3. Flood-fill segment connected components of Empty cells
-        let mut visited = vec![vec![false; cols]; rows];
-        let mut rooms = Vec::new();
-        let mut room_counter = 1;
-
-        let floor_height = ceil_elev - floor_elev;
+        Self {
+            rows,
+            cols,
+            min_x,
+            min_y,
+            resolution,
+            counts,
+            cell_start,
+            cell_points,
+        }
+    }
 
-        for r in 0..rows {
-            for c in 0..cols {
-                if grid[r][c] < self.wall_threshold && !visited[r][c] {
-                    // Start flood fill
-                    let mut component = Vec::new();
-                    let mut queue = VecDeque::new();
-                    let mut touches_boundary = false;
-
-                    queue.push_back((r, c));
-                    visited[r][c] = true;
-
-                    while let Some((curr_r, curr_c)) = queue.pop_front() {
-                        component.push((curr_r, curr_c));
-
-                        if curr_r == 0 || curr_r == rows - 1 || curr_c == 0 || curr_c == cols - 1 {
-                            touches_boundary = true;
-                        }
-
-                        // Check 4-way neighbors
-                        let neighbors = [
-                            (curr_r.wrapping_sub(1), curr_c),
-                            (curr_r + 1, curr_c),
-                            (curr_r, curr_c.wrapping_sub(1)),
-                            (curr_r, curr_c + 1),
-                        ];
-
-                        for &(nr, nc) in &neighbors {
-                            if nr < rows
-                                && nc < cols
-                                && !visited[nr][nc]
-                                && grid[nr][nc] < self.wall_threshold
-                            {
-                                visited[nr][nc] = true;
-                                queue.push_back((nr, nc));
-                            }
-                        }
+    /// Union-find labelling of free cells (count below `wall_threshold`).
+    ///
+    /// Bands of [`LABEL_BAND_ROWS`] rows are labelled in parallel, then
+    /// stitched along band seams. Unions always hang the larger root under
+    /// the smaller, so every root is its component's first cell in raster
+    /// order and components come out in the same order a row-major flood
+    /// fill would discover them.
+    fn free_components(&self, wall_threshold: usize) -> Vec<GridComponent> {
+        let (rows, cols) = (self.rows, self.cols);
+        let free = |i: usize| (self.counts[i] as usize) < wall_threshold;
+        let mut parent: Vec<u32> = (0..(rows * cols) as u32).collect();
+
+        let band_len = LABEL_BAND_ROWS * cols;
+        parent
+            .par_chunks_mut(band_len)
+            .enumerate()
+            .for_each(|(band, labels)| {
+                let base = band * band_len;
+                for local in 0..labels.len() {
+                    if !free(base + local) {
+                        continue;
                     }
-
-                    // If it is not the external background and meets the minimum size, save as a Room
-                    if !touches_boundary && component.len() >= self.min_room_cells {
-                        let mut r_min_c = usize::MAX;
-                        let mut r_max_c = usize::MIN;
-                        let mut r_min_r = usize::MAX;
-                        let mut r_max_r = usize::MIN;
-
-                        for &(cr, cc) in &component {
-                            if cc < r_min_c {
-                                r_min_c = cc;
-                            }
-                            if cc > r_max_c {
-                                r_max_c = cc;
-                            }
-                            if cr < r_min_r {
-                                r_min_r = cr;
-                            }
-                            if cr > r_max_r {
-                                r_max_r = cr;
-                            }
-                        }
-
-                        let room_min_x = min_x + (r_min_c as f64 * self.grid_resolution);
-                        let room_max_x = min_x + (r_max_c as f64 * self.grid_resolution);
-                        let room_min_y = min_y + (r_min_r as f64 * self.grid_resolution);
-                        let room_max_y = min_y + (r_max_r as f64 * self.grid_resolution);
-
-                        let center_x = (room_min_x + room_max_x) / 2.0;
-                        let center_y = (room_min_y + room_max_y) / 2.0;
-                        let width = room_max_x - room_min_x;
-                        let depth = room_max_y - room_min_y;
-
-                        let mut room =
-                            Room::new(format!("Room {}", room_counter), RoomType::Office);
-
-                        room.spatial_properties = SpatialProperties {
-                            position: Position {
-                                x: center_x,
-                                y: center_y,
-                                z: floor_elev,
-                                coordinate_system: "building_local".to_string(),
-                            },
-                            dimensions: Dimensions {
-                                width,
-                                height: floor_height,
-                                depth,
-                            },
-                            bounding_box: BoundingBox {
-                                min: Position {
-                                    x: room_min_x,
-                                    y: room_min_y,
-                                    z: floor_elev,
-                                    coordinate_system: "building_local".to_string(),
-                                },
-                                max: Position {
-                                    x: room_max_x,
-                                    y: room_max_y,
-                                    z: ceil_elev,
-                                    coordinate_system: "building_local".to_string(),
-                                },
-                            },
-                            mesh: None,
-                            coordinate_system: "building_local".to_string(),
-                        };
-
-                        let room_points_count = slice_points
-                            .iter()
-                            .filter(|p| {
-                                p.x >= room_min_x
-                                    && p.x <= room_max_x
-                                    && p.y >= room_min_y
-                                    && p.y <= room_max_y
-                            })
-                            .count();
-
-                        // Rule-based score — not a calibrated probability (see docs/lidar-confidence.md).
-                        room.lidar_enrichment = Some(LidarEnrichment {
-                            point_count: room_points_count,
-                            confidence_score: 0.90,
-                            last_scan_timestamp: Some(chrono::Utc::now()),
-                            classification_heuristic: Some(
-                                "2D Occupancy Grid Connected Components".to_string(),
-                            ),
-                        });
-                        crate::core::review::mark_proposed(&mut room.properties);
-
-                        rooms.push(room);
-                        room_counter += 1;
+                    if local % cols > 0 && free(base + local - 1) {
+                        union(labels, base, local, local - 1);
+                    }
+                    if local >= cols && free(base + local - cols) {
+                        union(labels, base, local, local - cols);
                     }
                 }
+            });
+
+        for seam in (LABEL_BAND_ROWS..rows).step_by(LABEL_BAND_ROWS) {
+            for c in 0..cols {
+                let i = seam * cols + c;
+                if free(i) && free(i - cols) {
+                    union(&mut parent, 0, i, i - cols);
+                }
             }
         }
 
-        rooms
+        let mut components: Vec<GridComponent> = Vec::new();
+        let mut slot_of_root: HashMap<usize, usize> = HashMap::new();
+        for i in 0..rows * cols {
+            if !free(i) {
+                continue;
+            }
+            let root = find(&mut parent, 0, i);
+            let (r, c) = (i / cols, i % cols);
+            let on_boundary = r == 0 || r == rows - 1 || c == 0 || c == cols - 1;
+            let slot = *slot_of_root.entry(root).or_insert_with(|| {
+                components.push(GridComponent {
+                    cells: 0,
+                    min_row: r,
+                    max_row: r,
+                    min_col: c,
+                    max_col: c,
+                    touches_boundary: false,
+                });
+                components.len() - 1
+            });
+            let component = &mut components[slot];
+            component.cells += 1;
+            component.min_row = component.min_row.min(r);
+            component.max_row = component.max_row.max(r);
+            component.min_col = component.min_col.min(c);
+            component.max_col = component.max_col.max(c);
+            component.touches_boundary |= on_boundary;
+        }
+        components
+    }
+
+    /// Count slice points inside the closed rectangle, visiting only the
+    /// cells it covers (plus a one-cell margin against rounding at edges).
+    fn count_points_in(
+        &self,
+        points: &[&Point3D],
+        min_x: f64,
+        max_x: f64,
+        min_y: f64,
+        max_y: f64,
+    ) -> usize {
+        let to_cell = |v: f64, origin: f64, limit: usize| {
+            (((v - origin) / self.resolution).max(0.0) as usize).min(limit - 1)
+        };
+        let c0 = to_cell(min_x, self.min_x, self.cols).saturating_sub(1);
+        let c1 = (to_cell(max_x, self.min_x, self.cols) + 1).min(self.cols - 1);
+        let r0 = to_cell(min_y, self.min_y, self.rows).saturating_sub(1);
+        let r1 = (to_cell(max_y, self.min_y, self.rows) + 1).min(self.rows - 1);
+
+        let mut count = 0;
+        for r in r0..=r1 {
+            let start = self.cell_start[r * self.cols + c0] as usize;
+            let end = self.cell_start[r * self.cols + c1 + 1] as usize;
+            count += self.cell_points[start..end]
+                .iter()
+                .map(|&i| points[i as usize])
+                .filter(|p| p.x >= min_x && p.x <= max_x && p.y >= min_y && p.y <= max_y)
+                .count();
+        }
+        count
+    }
+}
+
+/// Root of `x` in a union-find forest stored as global indices offset by
+/// `base`, with path halving.
+fn find(labels: &mut [u32], base: usize, mut x: usize) -> usize {
+    loop {
+        let parent = labels[x] as usize - base;
+        if parent == x {
+            return x + base;
+        }
+        let grandparent = labels[parent] as usize - base;
+        labels[x] = (grandparent + base) as u32;
+        x = grandparent;
+    }
+}
+
+fn union(labels: &mut [u32], base: usize, a: usize, b: usize) {
+    let ra = find(labels, base, a) - base;
+    let rb = find(labels, base, b) - base;
+    if ra != rb {
+        let (low, high) = if ra < rb { (ra, rb) } else { (rb, ra) };
+        labels[high] = (low + base) as u32;
     }
 }
 
@@ -333,121 +461,62 @@ impl EquipmentDetector {
     }
 
     /// Detect equipment clusters inside a given room boundary
+    ///
+    /// Convenience wrapper that indexes `points` for this one call; when
+    /// scanning many rooms, build a [`PointPartition`] once and use
+    /// [`EquipmentDetector::detect_equipment_in`].
     pub fn detect_equipment(
         &self,
         points: &[Point3D],
         room_bbox: &BoundingBox,
         room_path: &str,
     ) -> Vec<Equipment> {
-        // 1. Filter points strictly inside the room volume, inset by 0.15m from walls
-        let inset = 0.15;
-        let r_min_x = room_bbox.min.x + inset;
-        let r_max_x = room_bbox.max.x - inset;
-        let r_min_y = room_bbox.min.y + inset;
-        let r_max_y = room_bbox.max.y - inset;
-        let r_min_z = room_bbox.min.z;
-        let r_max_z = room_bbox.max.z;
-
-        let room_points: Vec<&Point3D> = points
-            .iter()
-            .filter(|p| {
-                p.x >= r_min_x
-                    && p.x <= r_max_x
-                    && p.y >= r_min_y
-                    && p.y <= r_max_y
-                    && p.z >= r_min_z
-                    && p.z <= r_max_z
-            })
-            .collect();
+        let partition = PointPartition::new(points, room_bbox.min.z, room_bbox.max.z);
+        self.detect_equipment_in(&partition, room_bbox, room_path)
+    }
 
-        if room_points.is_empty() {
+    /// Detect equipment clusters inside a room using a prebuilt partition.
+    ///
+    /// Only the partition cells under the room are visited, and points are
+    /// referenced by index. Clusters are labelled with union-find over the
+    /// sorted occupied voxels, with neighbour lookups through a dense local
+    /// voxel table, so results are deterministic. Equipment is numbered in
+    /// voxel order.
+    pub fn detect_equipment_in(
+        &self,
+        partition: &PointPartition<'_>,
+        room_bbox: &BoundingBox,
+        room_path: &str,
+    ) -> Vec<Equipment> {
+        // 1. Select points strictly inside the room volume, inset by 0.15m from walls
+        let inset = 0.15;
+        let room_indices = partition.indices_within(
+            [
+                room_bbox.min.x + inset,
+                room_bbox.min.y + inset,
+                room_bbox.min.z,
+            ],
+            [
+                room_bbox.max.x - inset,
+                room_bbox.max.y - inset,
+                room_bbox.max.z,
+            ],
+        );
+
+        if room_indices.is_empty() {
             return Vec::new();
         }
 
-        // 2. Voxel Binning
-        let mut voxel_map: HashMap<(i32, i32, i32), Vec<Point3D>> = HashMap::new();
-        for p in &room_points {
-            let gx = (p.x / self.voxel_size).floor() as i32;
-            let gy = (p.y / self.voxel_size).floor() as i32;
-            let gz = (p.z / self.voxel_size).floor() as i32;
-            voxel_map.entry((gx, gy, gz)).or_default().push(**p);
-        }
-
-        // 3. Flood-fill Connected Components on occupied voxels (Chebyshev 26-connectivity)
-        let mut visited = std::collections::HashSet::new();
-        let mut clusters = Vec::new();
-
-        let voxels: Vec<(i32, i32, i32)> = voxel_map.keys().cloned().collect();
-
-        for voxel in &voxels {
-            if visited.contains(voxel) {
-                continue;
-            }
-
-            // Start BFS
-            let mut component_points = Vec::new();
-            let mut queue = VecDeque::new();
-            queue.push_back(*voxel);
-            visited.insert(*voxel);
-
-            while let Some(curr) = queue.pop_front() {
-                if let Some(pts) = voxel_map.get(&curr) {
-                    component_points.extend(pts.clone());
-                }
-
-                // Check 26 neighbors
-                for dx in -1..=1 {
-                    for dy in -1..=1 {
-                        for dz in -1..=1 {
-                            if dx == 0 && dy == 0 && dz == 0 {
-                                continue;
-                            }
-                            let neighbor = (curr.0 + dx, curr.1 + dy, curr.2 + dz);
-                            if voxel_map.contains_key(&neighbor) && !visited.contains(&neighbor) {
-                                visited.insert(neighbor);
-                                queue.push_back(neighbor);
-                            }
-                        }
-                    }
-                }
-            }
-
-            if component_points.len() >= self.min_points {
-                clusters.push(component_points);
-            }
-        }
+        // 2-3. Voxel binning and 26-connected labelling
+        let clusters = voxel_clusters(partition.points, &room_indices, self.voxel_size);
 
         // 4. Classify each cluster and instantiate Equipment
         let mut equipment_list = Vec::new();
 
-        for (eq_counter, cluster) in (1..).zip(clusters) {
-            let mut min_x = f64::MAX;
-            let mut max_x = f64::MIN;
-            let mut min_y = f64::MAX;
-            let mut max_y = f64::MIN;
-            let mut min_z = f64::MAX;
-            let mut max_z = f64::MIN;
-
-            for p in &cluster {
-                if p.x < min_x {
-                    min_x = p.x;
-                }
-                if p.x > max_x {
-                    max_x = p.x;
-                }
-                if p.y < min_y {
-                    min_y = p.y;
-                }
-                if p.y > max_y {
-                    max_y = p.y;
-                }
-                if p.z < min_z {
-                    min_z = p.z;
-                }
-                if p.z > max_z {
-                    max_z = p.z;
-                }
-            }
+        let kept = clusters.iter().filter(|c| c.count >= self.min_points);
+        for (eq_counter, cluster) in (1..).zip(kept) {
+            let [min_x, min_y, min_z] = cluster.min;
+            let [max_x, max_y, max_z] = cluster.max;
 
             let width = max_x - min_x;
             let depth = max_y - min_y;
@@ -501,7 +570,7 @@ impl EquipmentDetector {
                 .insert("volume".to_string(), volume.to_string());
             equipment
                 .properties
-                .insert("point_count".to_string(), cluster.len().to_string());
+                .insert("point_count".to_string(), cluster.count.to_string());
 
             // Fixed heuristic tiers — not probabilistic confidence (docs/lidar-confidence.md).
             let confidence_score = match &equipment.equipment_type {
@@ -510,7 +579,7 @@ impl EquipmentDetector {
             };
 
             equipment.lidar_enrichment = Some(LidarEnrichment {
-                point_count: cluster.len(),
+                point_count: cluster.count,
                 confidence_score,
                 last_scan_timestamp: Some(chrono::Utc::now()),
                 classification_heuristic: Some(format!(
@@ -526,3 +595,265 @@ impl EquipmentDetector {
         equipment_list
     }
 }
+
+/// Cell edge (metres) of [`PointPartition`] buckets.
+const PARTITION_CELL_SIZE: f64 = 1.0;
+
+/// Upper bound on [`PointPartition`] cells relative to indexed points; the
+/// cell size grows for sparse, very wide sites.
+const PARTITION_CELLS_PER_POINT: usize = 4;
+
+/// XY bucket index over the points of one floor slice.
+///
+/// Built once per floor; per-room queries then visit only the buckets under
+/// the room instead of rescanning the whole cloud.
+pub struct PointPartition<'a> {
+    points: &'a [Point3D],
+    cell_size: f64,
+    min_x: f64,
+    min_y: f64,
+    cols: usize,
+    rows: usize,
+    cell_start: Vec<u32>,
+    indices: Vec<u32>,
+}
+
+impl<'a> PointPartition<'a> {
+    /// Index the points of `points` with `min_z <= z <= max_z`.
+    pub fn new(points: &'a [Point3D], min_z: f64, max_z: f64) -> Self {
+        let selected: Vec<u32> = (0..points.len() as u32)
+            .into_par_iter()
+            .filter(|&i| {
+                let z = points[i as usize].z;
+                z >= min_z && z <= max_z
+            })
+            .collect();
+
+        let mut min_x = f64::MAX;
+        let mut max_x = f64::MIN;
+        let mut min_y = f64::MAX;
+        let mut max_y = f64::MIN;
+        for &i in &selected {
+            let p = &points[i as usize];
+            min_x = min_x.min(p.x);
+            max_x = max_x.max(p.x);
+            min_y = min_y.min(p.y);
+            max_y = max_y.max(p.y);
+        }
+
+        if selected.is_empty() || !(max_x - min_x).is_finite() || !(max_y - min_y).is_finite() {
+            return Self {
+                points,
+                cell_size: PARTITION_CELL_SIZE,
+                min_x: 0.0,
+                min_y: 0.0,
+                cols: 0,
+                rows: 0,
+                cell_start: vec![0],
+                indices: Vec::new(),
+            };
+        }
+
+        let max_cells = (selected.len() * PARTITION_CELLS_PER_POINT).max(1024) as f64;
+        let area = (max_x - min_x + PARTITION_CELL_SIZE) * (max_y - min_y + PARTITION_CELL_SIZE);
+        let cell_size = PARTITION_CELL_SIZE.max((area / max_cells).sqrt());
+        let cols = ((max_x - min_x) / cell_size) as usize + 1;
+        let rows = ((max_y - min_y) / cell_size) as usize + 1;
+
+        let cell_of = |p: &Point3D| {
+            let c = (((p.x - min_x) / cell_size) as usize).min(cols - 1);
+            let r = (((p.y - min_y) / cell_size) as usize).min(rows - 1);
+            r * cols + c
+        };
+        let cells: Vec<u32> = selected
+            .par_iter()
+            .map(|&i| cell_of(&points[i as usize]) as u32)
+            .collect();
+
+        let mut cell_start = vec![0u32; rows * cols + 1];
+        for &cell in &cells {
+            cell_start[cell as usize + 1] += 1;
+        }
+        let mut running = 0;
+        for start in cell_start.iter_mut() {
+            running += *start;
+            *start = running;
+        }
+        let mut cursor = cell_start.clone();
+        let mut indices = vec![0u32; selected.len()];
+        for (&i, &cell) in selected.iter().zip(&cells) {
+            indices[cursor[cell as usize] as usize] = i;
+            cursor[cell as usize] += 1;
+        }
+
+        Self {
+            points,
+            cell_size,
+            min_x,
+            min_y,
+            cols,
+            rows,
+            cell_start,
+            indices,
+        }
+    }
+
+    /// Indices of indexed points inside the closed box `[min, max]`.
+    fn indices_within(&self, min: [f64; 3], max: [f64; 3]) -> Vec<u32> {
+        if self.indices.is_empty() || min[0] > max[0] || min[1] > max[1] {
+            return Vec::new();
+        }
+        let to_cell = |v: f64, origin: f64, limit: usize| {
+            (((v - origin) / self.cell_size).max(0.0) as usize).min(limit - 1)
+        };
+        // One-cell margin against rounding at bucket edges
+        let c0 = to_cell(min[0], self.min_x, self.cols).saturating_sub(1);
+        let c1 = (to_cell(max[0], self.min_x, self.cols) + 1).min(self.cols - 1);
+        let r0 = to_cell(min[1], self.min_y, self.rows).saturating_sub(1);
+        let r1 = (to_cell(max[1], self.min_y, self.rows) + 1).min(self.rows - 1);
+
+        let mut out = Vec::new();
+        for r in r0..=r1 {
+            let start = self.cell_start[r * self.cols + c0] as usize;
+            let end = self.cell_start[r * self.cols + c1 + 1] as usize;
+            out.extend(self.indices[start..end].iter().copied().filter(|&i| {
+                let p = &self.points[i as usize];
+                p.x >= min[0]
+                    && p.x <= max[0]
+                    && p.y >= min[1]
+                    && p.y <= max[1]
+                    && p.z >= min[2]
+                    && p.z <= max[2]
+            }));
+        }
+        out
+    }
+}
+
+/// Largest local voxel box addressed through a dense lookup table; larger
+/// boxes fall back to binary search over the sorted occupied voxels.
+const MAX_DENSE_VOXELS: usize = 1 << 24;
+
+/// Point statistics of one 26-connected voxel cluster.
+struct VoxelCluster {
+    count: usize,
+    min: [f64; 3],
+    max: [f64; 3],
+}
+
+impl VoxelCluster {
+    fn empty() -> Self {
+        Self {
+            count: 0,
+            min: [f64::MAX; 3],
+            max: [f64::MIN; 3],
+        }
+    }
+
+    fn add_point(&mut self, p: &Point3D) {
+        self.count += 1;
+        for (axis, v) in [p.x, p.y, p.z].into_iter().enumerate() {
+            self.min[axis] = self.min[axis].min(v);
+            self.max[axis] = self.max[axis].max(v);
+        }
+    }
+
+    fn merge(&mut self, other: &VoxelCluster) {
+        self.count += other.count;
+        for axis in 0..3 {
+            self.min[axis] = self.min[axis].min(other.min[axis]);
+            self.max[axis] = self.max[axis].max(other.max[axis]);
+        }
+    }
+}
+
+/// Bin `indices` into voxels and return the 26-connected clusters in
+/// order of their first voxel (z, then y, then x).
+fn voxel_clusters(points: &[Point3D], indices: &[u32], voxel_size: f64) -> Vec<VoxelCluster> {
+    let voxel = |v: f64| (v / voxel_size).floor() as i32;
+    let mut keyed: Vec<((i32, i32, i32), u32)> = indices
+        .iter()
+        .map(|&i| {
+            let p = &points[i as usize];
+            ((voxel(p.z), voxel(p.y), voxel(p.x)), i)
+        })
+        .collect();
+    keyed.sort_unstable_by_key(|(key, _)| *key);
+
+    // Occupied voxels (sorted) with their point statistics
+    let mut keys: Vec<(i32, i32, i32)> = Vec::new();
+    let mut stats: Vec<VoxelCluster> = Vec::new();
+    for (key, i) in keyed {
+        if keys.last() != Some(&key) {
+            keys.push(key);
+            stats.push(VoxelCluster::empty());
+        }
+        if let Some(last) = stats.last_mut() {
+            last.add_point(&points[i as usize]);
+        }
+    }
+
+    let lo = keys.iter().fold((i32::MAX, i32::MAX, i32::MAX), |a, k| {
+        (a.0.min(k.0), a.1.min(k.1), a.2.min(k.2))
+    });
+    let hi = keys.iter().fold((i32::MIN, i32::MIN, i32::MIN), |a, k| {
+        (a.0.max(k.0), a.1.max(k.1), a.2.max(k.2))
+    });
+    let span = |a: i32, b: i32| (b as i64 - a as i64 + 1) as usize;
+    let (nz, ny, nx) = (span(lo.0, hi.0), span(lo.1, hi.1), span(lo.2, hi.2));
+    let dense_len = nz
+        .checked_mul(ny)
+        .and_then(|v| v.checked_mul(nx))
+        .filter(|&len| len <= MAX_DENSE_VOXELS);
+
+    let linear = |k: (i32, i32, i32)| {
+        ((k.0 - lo.0) as usize * ny + (k.1 - lo.1) as usize) * nx + (k.2 - lo.2) as usize
+    };
+    // Dense local table: voxel -> occupied slot + 1 (0 = empty)
+    let table: Option<Vec<u32>> = dense_len.map(|len| {
+        let mut table = vec![0u32; len];
+        for (slot, key) in keys.iter().enumerate() {
+            table[linear(*key)] = slot as u32 + 1;
+        }
+        table
+    });
+    let lookup = |k: (i32, i32, i32)| -> Option<usize> {
+        if k.0 < lo.0 || k.0 > hi.0 || k.1 < lo.1 || k.1 > hi.1 || k.2 < lo.2 || k.2 > hi.2 {
+            return None;
+        }
+        match &table {
+            Some(table) => table[linear(k)].checked_sub(1).map(|s| s as usize),
+            None => keys.binary_search(&k).ok(),
+        }
+    };
+
+    // Union each voxel with its forward half of the 26-neighbourhood
+    let mut parent: Vec<u32> = (0..keys.len() as u32).collect();
+    for (slot, &(z, y, x)) in keys.iter().enumerate() {
+        for dz in 0..=1 {
+            for dy in -1..=1 {
+                for dx in -1..=1 {
+                    if (dz, dy, dx) <= (0, 0, 0) {
+                        continue;
+                    }
+                    if let Some(neighbor) = lookup((z + dz, y + dy, x + dx)) {
+                        union(&mut parent, 0, slot, neighbor);
+                    }
+                }
+            }
+        }
+    }
+
+    // Roots are the smallest slot, so clusters come out in voxel order
+    let mut clusters: Vec<VoxelCluster> = Vec::new();
+    let mut cluster_of_root: HashMap<usize, usize> = HashMap::new();
+    for (slot, voxel_stats) in stats.iter().enumerate() {
+        let root = find(&mut parent, 0, slot);
+        let index = *cluster_of_root.entry(root).or_insert_with(|| {
+            clusters.push(VoxelCluster::empty());
+            clusters.len() - 1
+        });
+        clusters[index].merge(voxel_stats);
+    }
+    clusters
+}
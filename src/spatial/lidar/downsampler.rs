@@ -1,23 +1,130 @@
 use crate::core::spatial::Point3D;
 use crate::resource_limits::max_lidar_input_points;
-use anyhow::{bail, Result};
+use anyhow::{bail, Context, Result};
+use rayon::prelude::*;
 use std::collections::HashMap;
+use std::fs::File;
+use std::io::{BufReader, BufWriter, Read, Seek, SeekFrom, Write};
+
+/// Points gathered before a parallel binning pass.
+pub const BATCH_POINTS: usize = 64 * 1024;
+
+/// A tile spans `2^TILE_SHIFT` voxels per axis. Tiles are the unit of
+/// sharding and of spilling, so a voxel never straddles two of either.
+const TILE_SHIFT: u32 = 5;
+
+/// Shard count: two Morton bits per axis of the tile coordinate.
+const SHARD_COUNT: usize = 64;
+
+/// Spill files used once the resident voxel budget is exceeded.
+const SPILL_BUCKETS: usize = 64;
+
+/// On-disk size of one spilled voxel: key (3 x i64), sums (3 x f64), count (u64).
+const SPILL_RECORD_BYTES: usize = 56;
+
+type VoxelKey = (i64, i64, i64);
+type TileKey = (i64, i64, i64);
+type TileVoxels = HashMap<VoxelKey, VoxelAccumulator>;
 
 pub struct IngestionStats {
     pub total_points: usize,
     pub downsampled_points: usize,
 }
 
+/// Struct-of-arrays block of input coordinates.
+///
+/// Keeping each axis contiguous lets the voxel-key pass run as three
+/// independent, vectorizable loops instead of striding over `Point3D`s.
+#[derive(Debug, Clone, Default)]
+pub struct PointBatch {
+    pub xs: Vec<f64>,
+    pub ys: Vec<f64>,
+    pub zs: Vec<f64>,
+}
+
+impl PointBatch {
+    pub fn with_capacity(capacity: usize) -> Self {
+        Self {
+            xs: Vec::with_capacity(capacity),
+            ys: Vec::with_capacity(capacity),
+            zs: Vec::with_capacity(capacity),
+        }
+    }
+
+    pub fn push(&mut self, point: &Point3D) {
+        self.xs.push(point.x);
+        self.ys.push(point.y);
+        self.zs.push(point.z);
+    }
+
+    pub fn len(&self) -> usize {
+        self.xs.len()
+    }
+
+    pub fn is_empty(&self) -> bool {
+        self.xs.is_empty()
+    }
+
+    pub fn clear(&mut self) {
+        self.xs.clear();
+        self.ys.clear();
+        self.zs.clear();
+    }
+}
+
 pub struct VoxelGridFilter {
     voxel_size: f64,
     light_mode: bool,
+    max_resident_voxels: Option<usize>,
 }
 
+#[derive(Debug, Clone, Copy, Default)]
 struct VoxelAccumulator {
     sum_x: f64,
     sum_y: f64,
     sum_z: f64,
-    count: usize,
+    count: u64,
+}
+
+impl VoxelAccumulator {
+    fn add(&mut self, x: f64, y: f64, z: f64) {
+        self.sum_x += x;
+        self.sum_y += y;
+        self.sum_z += z;
+        self.count += 1;
+    }
+
+    fn merge(&mut self, other: &VoxelAccumulator) {
+        self.sum_x += other.sum_x;
+        self.sum_y += other.sum_y;
+        self.sum_z += other.sum_z;
+        self.count += other.count;
+    }
+
+    fn centroid(&self) -> Point3D {
+        let count_f = self.count as f64;
+        Point3D::new(
+            self.sum_x / count_f,
+            self.sum_y / count_f,
+            self.sum_z / count_f,
+        )
+    }
+}
+
+/// Voxels owned by one shard, grouped by tile so whole tiles can be spilled.
+#[derive(Default)]
+struct Shard {
+    tiles: HashMap<TileKey, TileVoxels>,
+    voxels: usize,
+}
+
+impl Shard {
+    fn accumulate(&mut self, key: VoxelKey, x: f64, y: f64, z: f64) {
+        let tile = self.tiles.entry(tile_of(key)).or_default();
+        let before = tile.len();
+        tile.entry(key).or_default().add(x, y, z);
+        self.voxels += tile.len() - before;
+    }
 }
 
 impl VoxelGridFilter {
@@ -25,32 +132,84 @@ impl VoxelGridFilter {
         Self {
             voxel_size,
             light_mode,
+            max_resident_voxels: None,
         }
     }
 
-    pub fn filter(
-        &self,
-        points: impl Iterator<Item = Result<Point3D>>,
-    ) -> Result<(Vec<Point3D>, IngestionStats)> {
+    /// Override the resident voxel budget (defaults to 100k in light mode,
+    /// 500k otherwise). Tiles beyond the budget are spilled to temporary
+    /// files and merged back before centroids are emitted.
+    pub fn with_max_resident_voxels(mut self, max_voxels: usize) -> Self {
+        self.max_resident_voxels = Some(max_voxels.max(1));
+        self
+    }
+
+    fn effective_voxel_size(&self) -> f64 {
         // Enforce light mode constraints
-        let voxel_size = if self.light_mode {
+        if self.light_mode {
             self.voxel_size.max(0.20)
         } else {
             self.voxel_size.max(0.01) // Prevent division-by-zero or extremely tiny voxels
-        };
+        }
+    }
 
-        let max_capacity = if self.light_mode { 100_000 } else { 500_000 };
+    fn max_capacity(&self) -> usize {
+        self.max_resident_voxels
+            .unwrap_or(if self.light_mode { 100_000 } else { 500_000 })
+    }
 
-        let mut voxel_map: HashMap<(i64, i64, i64), VoxelAccumulator> =
-            HashMap::with_capacity(max_capacity);
-        let mut filtered_points = Vec::new();
-        let mut total_points = 0;
+    pub fn filter(
+        &self,
+        points: impl Iterator<Item = Result<Point3D>>,
+    ) -> Result<(Vec<Point3D>, IngestionStats)> {
+        let mut points = points;
+        let mut pending_error = None;
+        let batches = std::iter::from_fn(move || {
+            if let Some(e) = pending_error.take() {
+                return Some(Err(e));
+            }
+            let mut batch = PointBatch::with_capacity(BATCH_POINTS);
+            while batch.len() < BATCH_POINTS {
+                match points.next() {
+                    Some(Ok(p)) => batch.push(&p),
+                    Some(Err(e)) if batch.is_empty() => return Some(Err(e)),
+                    Some(Err(e)) => {
+                        // Deliver what was read; the error surfaces on the next pull
+                        pending_error = Some(e);
+                        break;
+                    }
+                    None => break,
+                }
+            }
+            (!batch.is_empty()).then_some(Ok(batch))
+        });
+        self.filter_batches(batches)
+    }
 
+    /// Downsample a stream of coordinate blocks.
+    ///
+    /// Each block is keyed and binned in parallel into [`SHARD_COUNT`] shards
+    /// chosen by a Morton prefix of the voxel's tile. A voxel lives in exactly
+    /// one shard (and, if spilled, one spill bucket) for the whole run, so
+    /// every occupied voxel yields exactly one centroid. Output is sorted by
+    /// voxel key, making it independent of thread scheduling.
+    pub fn filter_batches(
+        &self,
+        batches: impl Iterator<Item = Result<PointBatch>>,
+    ) -> Result<(Vec<Point3D>, IngestionStats)> {
+        let voxel_size = self.effective_voxel_size();
+        let max_capacity = self.max_capacity();
         let max_input = max_lidar_input_points();
 
-        for point_result in points {
-            let p = point_result?;
-            total_points += 1;
+        let mut shards: Vec<Shard> = (0..SHARD_COUNT).map(|_| Shard::default()).collect();
+        let mut spill = SpillStore::default();
+        let mut keys: Vec<VoxelKey> = Vec::new();
+        let mut order: Vec<u32> = Vec::new();
+        let mut total_points = 0;
+
+        for batch in batches {
+            let batch = batch?;
+            total_points += batch.len();
             if total_points > max_input {
                 bail!(
                     "LiDAR input exceeded pilot point limit ({} points). \
@@ -60,32 +219,30 @@ impl VoxelGridFilter {
                 );
             }
 
-            let key = (
-                (p.x / voxel_size).floor() as i64,
-                (p.y / voxel_size).floor() as i64,
-                (p.z / voxel_size).floor() as i64,
-            );
+            bin_batch(&batch, voxel_size, &mut shards, &mut keys, &mut order);
 
-            let entry = voxel_map.entry(key).or_insert(VoxelAccumulator {
-                sum_x: 0.0,
-                sum_y: 0.0,
-                sum_z: 0.0,
-                count: 0,
-            });
-
-            entry.sum_x += p.x;
-            entry.sum_y += p.y;
-            entry.sum_z += p.z;
-            entry.count += 1;
-
-            // Bounded memory protection: flush if capacity reached
-            if voxel_map.len() >= max_capacity {
-                self.flush_voxels(&mut voxel_map, &mut filtered_points);
+            // Bounded memory protection: spill whole tiles, never split voxels
+            let resident: usize = shards.iter().map(|s| s.voxels).sum();
+            if resident >= max_capacity {
+                spill.spill_tiles(&mut shards, resident - max_capacity / 2)?;
             }
         }
 
-        // Final flush
-        self.flush_voxels(&mut voxel_map, &mut filtered_points);
+        let mut centroids = if spill.is_empty() {
+            shards
+                .into_par_iter()
+                .flat_map_iter(|shard| {
+                    shard
+                        .tiles
+                        .into_values()
+                        .flat_map(|tile| tile.into_iter().map(|(k, acc)| (k, acc.centroid())))
+                })
+                .collect::<Vec<_>>()
+        } else {
+            spill.merge_with(shards)?
+        };
+        centroids.par_sort_unstable_by_key(|(key, _)| *key);
+        let filtered_points: Vec<Point3D> = centroids.into_iter().map(|(_, p)| p).collect();
 
         let stats = IngestionStats {
             total_points,
@@ -94,22 +251,280 @@ impl VoxelGridFilter {
 
         Ok((filtered_points, stats))
     }
+}
 
-    fn flush_voxels(
-        &self,
-        voxel_map: &mut HashMap<(i64, i64, i64), VoxelAccumulator>,
-        filtered_points: &mut Vec<Point3D>,
-    ) {
-        for accum in voxel_map.values() {
-            if accum.count > 0 {
-                let count_f = accum.count as f64;
-                filtered_points.push(Point3D::new(
-                    accum.sum_x / count_f,
-                    accum.sum_y / count_f,
-                    accum.sum_z / count_f,
-                ));
+/// Key every point of `batch`, counting-sort the indices by shard, then let
+/// each shard fold its own slice in parallel. Shards are disjoint, so no
+/// locking or post-merge is needed.
+fn bin_batch(
+    batch: &PointBatch,
+    voxel_size: f64,
+    shards: &mut [Shard],
+    keys: &mut Vec<VoxelKey>,
+    order: &mut Vec<u32>,
+) {
+    let n = batch.len();
+    keys.clear();
+    keys.resize(n, (0, 0, 0));
+    keys.par_chunks_mut(4096)
+        .zip(batch.xs.par_chunks(4096))
+        .zip(batch.ys.par_chunks(4096))
+        .zip(batch.zs.par_chunks(4096))
+        .for_each(|(((out, xs), ys), zs)| {
+            for (i, key) in out.iter_mut().enumerate() {
+                *key = (
+                    (xs[i] / voxel_size).floor() as i64,
+                    (ys[i] / voxel_size).floor() as i64,
+                    (zs[i] / voxel_size).floor() as i64,
+                );
+            }
+        });
+
+    let mut offsets = [0usize; SHARD_COUNT + 1];
+    for key in keys.iter() {
+        offsets[shard_of(tile_of(*key)) + 1] += 1;
+    }
+    let mut running = 0;
+    for offset in offsets.iter_mut() {
+        running += *offset;
+        *offset = running;
+    }
+    let mut cursor = offsets;
+    order.clear();
+    order.resize(n, 0);
+    for (i, key) in keys.iter().enumerate() {
+        let s = shard_of(tile_of(*key));
+        order[cursor[s]] = i as u32;
+        cursor[s] += 1;
+    }
+
+    let keys = &*keys;
+    let order = &*order;
+    shards.par_iter_mut().enumerate().for_each(|(s, shard)| {
+        for &i in &order[offsets[s]..offsets[s + 1]] {
+            let i = i as usize;
+            shard.accumulate(keys[i], batch.xs[i], batch.ys[i], batch.zs[i]);
+        }
+    });
+}
+
+fn tile_of(key: VoxelKey) -> TileKey {
+    (
+        key.0 >> TILE_SHIFT,
+        key.1 >> TILE_SHIFT,
+        key.2 >> TILE_SHIFT,
+    )
+}
+
+/// Interleave the low two bits of each tile axis (a 6-bit Morton prefix), so
+/// neighbouring tiles land on different shards and dense regions spread out.
+fn shard_of(tile: TileKey) -> usize {
+    let (x, y, z) = (tile.0 as u64, tile.1 as u64, tile.2 as u64);
+    let mut code = 0;
+    for bit in 0..2 {
+        code |= ((x >> bit) & 1) << (3 * bit)
+            | ((y >> bit) & 1) << (3 * bit + 1)
+            | ((z >> bit) & 1) << (3 * bit + 2);
+    }
+    code as usize
+}
+
+fn bucket_of(tile: TileKey) -> usize {
+    let mixed = (tile.0 as u64).wrapping_mul(0x9E37_79B9_7F4A_7C15)
+        ^ (tile.1 as u64).wrapping_mul(0xC2B2_AE3D_27D4_EB4F)
+        ^ (tile.2 as u64).wrapping_mul(0x1656_67B1_9E37_79F9);
+    (mixed >> 58) as usize % SPILL_BUCKETS
+}
+
+/// Temporary files holding partial accumulators for evicted tiles.
+///
+/// A tile evicted more than once simply appends again; records for the same
+/// voxel are summed when the bucket is read back.
+#[derive(Default)]
+struct SpillStore {
+    buckets: Vec<Option<BufWriter<File>>>,
+}
+
+impl SpillStore {
+    fn is_empty(&self) -> bool {
+        self.buckets.is_empty()
+    }
+
+    /// Evict the largest tiles until at least `target` voxels are freed.
+    fn spill_tiles(&mut self, shards: &mut [Shard], target: usize) -> Result<()> {
+        if self.buckets.is_empty() {
+            self.buckets = (0..SPILL_BUCKETS).map(|_| None).collect();
+        }
+
+        let mut candidates: Vec<(usize, usize, TileKey)> = shards
+            .iter()
+            .enumerate()
+            .flat_map(|(s, shard)| shard.tiles.iter().map(move |(t, v)| (v.len(), s, *t)))
+            .collect();
+        candidates.sort_unstable_by(|a, b| b.0.cmp(&a.0));
+
+        let mut freed = 0;
+        for (_, s, tile) in candidates {
+            if freed >= target {
+                break;
+            }
+            let Some(voxels) = shards[s].tiles.remove(&tile) else {
+                continue;
+            };
+            shards[s].voxels -= voxels.len();
+            freed += voxels.len();
+
+            let bucket = bucket_of(tile);
+            let writer = match &mut self.buckets[bucket] {
+                Some(writer) => writer,
+                slot => slot.insert(BufWriter::new(
+                    tempfile::tempfile().context("Failed to create voxel spill file")?,
+                )),
+            };
+            for (key, acc) in voxels {
+                let mut record = [0u8; SPILL_RECORD_BYTES];
+                record[0..8].copy_from_slice(&key.0.to_le_bytes());
+                record[8..16].copy_from_slice(&key.1.to_le_bytes());
+                record[16..24].copy_from_slice(&key.2.to_le_bytes());
+                record[24..32].copy_from_slice(&acc.sum_x.to_le_bytes());
+                record[32..40].copy_from_slice(&acc.sum_y.to_le_bytes());
+                record[40..48].copy_from_slice(&acc.sum_z.to_le_bytes());
+                record[48..56].copy_from_slice(&acc.count.to_le_bytes());
+                writer.write_all(&record)?;
+            }
+        }
+        Ok(())
+    }
+
+    /// Fold the resident tiles into their spill buckets and emit one centroid
+    /// per voxel, one bucket at a time so peak memory stays near one bucket.
+    fn merge_with(self, shards: Vec<Shard>) -> Result<Vec<(VoxelKey, Point3D)>> {
+        let mut resident: Vec<Vec<TileVoxels>> = (0..SPILL_BUCKETS).map(|_| Vec::new()).collect();
+        for shard in shards {
+            for (tile, voxels) in shard.tiles {
+                resident[bucket_of(tile)].push(voxels);
+            }
+        }
+
+        let mut centroids = Vec::new();
+        for (bucket, writer) in self.buckets.into_iter().enumerate() {
+            let mut merged: TileVoxels = HashMap::new();
+            if let Some(writer) = writer {
+                let mut file = writer
+                    .into_inner()
+                    .map_err(|e| e.into_error())
+                    .context("Failed to flush voxel spill file")?;
+                file.seek(SeekFrom::Start(0))?;
+                let mut reader = BufReader::new(file);
+                let mut record = [0u8; SPILL_RECORD_BYTES];
+                loop {
+                    match reader.read_exact(&mut record) {
+                        Ok(()) => {}
+                        Err(e) if e.kind() == std::io::ErrorKind::UnexpectedEof => break,
+                        Err(e) => return Err(e).context("Failed to read voxel spill file"),
+                    }
+                    let word = |i: usize| {
+                        let mut bytes = [0u8; 8];
+                        bytes.copy_from_slice(&record[i * 8..i * 8 + 8]);
+                        bytes
+                    };
+                    let key = (
+                        i64::from_le_bytes(word(0)),
+                        i64::from_le_bytes(word(1)),
+                        i64::from_le_bytes(word(2)),
+                    );
+                    let acc = VoxelAccumulator {
+                        sum_x: f64::from_le_bytes(word(3)),
+                        sum_y: f64::from_le_bytes(word(4)),
+                        sum_z: f64::from_le_bytes(word(5)),
+                        count: u64::from_le_bytes(word(6)),
+                    };
+                    merged.entry(key).or_default().merge(&acc);
+                }
+            }
+            for voxels in std::mem::take(&mut resident[bucket]) {
+                for (key, acc) in voxels {
+                    merged.entry(key).or_default().merge(&acc);
+                }
             }
+            centroids.extend(merged.into_iter().map(|(k, acc)| (k, acc.centroid())));
         }
-        voxel_map.clear();
+        Ok(centroids)
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    fn scatter(count: usize) -> Vec<Point3D> {
+        // Deterministic pseudo-random cloud with many points per voxel
+        let mut state = 0x2545_F491_4F6C_DD1Du64;
+        let mut next = move || {
+            state ^= state << 13;
+            state ^= state >> 7;
+            state ^= state << 17;
+            (state >> 11) as f64 / (1u64 << 53) as f64
+        };
+        (0..count)
+            .map(|_| Point3D::new(next() * 40.0 - 20.0, next() * 40.0, next() * 12.0))
+            .collect()
+    }
+
+    fn sequential_reference(points: &[Point3D], voxel_size: f64) -> Vec<Point3D> {
+        let mut map: HashMap<VoxelKey, VoxelAccumulator> = HashMap::new();
+        for p in points {
+            let key = (
+                (p.x / voxel_size).floor() as i64,
+                (p.y / voxel_size).floor() as i64,
+                (p.z / voxel_size).floor() as i64,
+            );
+            map.entry(key).or_default().add(p.x, p.y, p.z);
+        }
+        let mut out: Vec<_> = map.into_iter().collect();
+        out.sort_unstable_by_key(|(k, _)| *k);
+        out.into_iter().map(|(_, acc)| acc.centroid()).collect()
+    }
+
+    fn assert_same_points(a: &[Point3D], b: &[Point3D]) {
+        assert_eq!(a.len(), b.len());
+        for (p, q) in a.iter().zip(b) {
+            assert!((p.x - q.x).abs() < 1e-9 && (p.y - q.y).abs() < 1e-9);
+            assert!((p.z - q.z).abs() < 1e-9);
+        }
+    }
+
+    #[test]
+    fn parallel_matches_sequential_binning() {
+        let points = scatter(BATCH_POINTS * 2 + 123);
+        let filter = VoxelGridFilter::new(0.5, false);
+        let (filtered, stats) = filter.filter(points.iter().map(|p| Ok(*p))).unwrap();
+
+        assert_eq!(stats.total_points, points.len());
+        assert_same_points(&filtered, &sequential_reference(&points, 0.5));
+    }
+
+    #[test]
+    fn spilling_never_duplicates_voxels() {
+        let points = scatter(BATCH_POINTS * 3);
+        let reference = sequential_reference(&points, 0.5);
+        assert!(reference.len() > 1_000);
+
+        // Budget far below the voxel count forces repeated tile spills
+        let filter = VoxelGridFilter::new(0.5, false).with_max_resident_voxels(500);
+        let (filtered, stats) = filter.filter(points.iter().map(|p| Ok(*p))).unwrap();
+
+        assert_eq!(stats.downsampled_points, reference.len());
+        assert_same_points(&filtered, &reference);
+    }
+
+    #[test]
+    fn input_errors_propagate_after_partial_batches() {
+        let points = vec![
+            Ok(Point3D::new(0.0, 0.0, 0.0)),
+            Err(anyhow::anyhow!("bad line")),
+        ];
+        let filter = VoxelGridFilter::new(1.0, false);
+        assert!(filter.filter(points.into_iter()).is_err());
     }
 }
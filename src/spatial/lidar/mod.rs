@@ -1,6 +1,8 @@
 use crate::core::spatial::Point3D;
 use crate::core::{Building, Wing};
+use crate::telemetry::{self, Phase, Stopwatch};
 use anyhow::Result;
+use rayon::prelude::*;
 use std::path::Path;
 
 pub mod detector;
@@ -23,14 +25,31 @@ impl LidarPipeline {
     pub fn process<P: AsRef<Path>>(&self, path: P) -> Result<Building> {
         let path = path.as_ref();
         println!("🚀 Reading points from {}...", path.display());
-        let points = parser::stream_points(path)?;
+        let open = Stopwatch::start();
+        let mut blocks = parser::stream_point_blocks(path)?;
+        let mut read_time = open.elapsed().unwrap_or_default();
 
         println!("🧹 Filtering point cloud via voxel downsampler...");
         let downsampler = downsampler::VoxelGridFilter::new(self.voxel_size, self.light_mode);
-        let (downsampled_points, stats) = downsampler.filter(points)?;
+        // Reads are interleaved with filtering; time them per block
+        let timed_blocks = std::iter::from_fn(|| {
+            let read = Stopwatch::start();
+            let block = blocks.next();
+            read_time += read.elapsed().unwrap_or_default();
+            block
+        });
+        let mut downsample = telemetry::time(Phase::LidarDownsample);
+        let filtered = downsampler.filter_batches(timed_blocks);
+        downsample.exclude(read_time);
+        drop(downsample);
+        telemetry::record(Phase::LidarRead, read_time);
+        let (downsampled_points, stats) = filtered?;
 
         println!("🏢 Reconstructing building structure...");
-        let building = self.reconstruct_building(path, downsampled_points, stats)?;
+        let building = {
+            let _detect = telemetry::time(Phase::LidarDetect);
+            self.reconstruct_building(path, downsampled_points, stats)?
+        };
 
         Ok(building)
     }
@@ -96,33 +115,44 @@ impl LidarPipeline {
         let mut total_rooms = 0;
         let mut total_equipment = 0;
 
-        for (idx, &elev) in floor_elevations.iter().enumerate() {
-            let ceil_elev = if idx + 1 < floor_elevations.len() {
-                floor_elevations[idx + 1]
-            } else {
-                max_z
-            };
+        let ceiling_of = |idx: usize| floor_elevations.get(idx + 1).copied().unwrap_or(max_z);
+
+        // Floor slices are independent, so segment them concurrently
+        let floor_rooms: Vec<Vec<crate::core::Room>> = floor_elevations
+            .par_iter()
+            .enumerate()
+            .map(|(idx, &elev)| room_detector.detect_rooms(&points, elev, ceiling_of(idx)))
+            .collect();
 
+        for (idx, rooms) in floor_rooms.into_iter().enumerate() {
             let mut floor = crate::core::Floor::new(format!("Floor {}", idx + 1), idx as i32);
             floor.level = idx as i32;
 
-            let rooms = room_detector.detect_rooms(&points, elev, ceil_elev);
             println!("🚪 Segmented {} room(s) on Floor {}", rooms.len(), idx + 1);
             total_rooms += rooms.len();
 
-            let mut wing = Wing::new("Main".to_string());
-            for mut r in rooms {
-                let room_path = format!(
-                    "/building/{}/{}",
-                    floor.name.to_lowercase().replace(" ", "-"),
-                    r.name.to_lowercase().replace(" ", "-")
-                );
-                let equipment = eq_detector.detect_equipment(
-                    &points,
-                    &r.spatial_properties.bounding_box,
-                    &room_path,
-                );
+            // Index the floor's points once; rooms then query only their buckets
+            let floor_slug = floor.name.to_lowercase().replace(" ", "-");
+            let partition =
+                detector::PointPartition::new(&points, floor_elevations[idx], ceiling_of(idx));
+            let room_equipment: Vec<Vec<crate::core::Equipment>> = rooms
+                .par_iter()
+                .map(|r| {
+                    let room_path = format!(
+                        "/building/{}/{}",
+                        floor_slug,
+                        r.name.to_lowercase().replace(" ", "-")
+                    );
+                    eq_detector.detect_equipment_in(
+                        &partition,
+                        &r.spatial_properties.bounding_box,
+                        &room_path,
+                    )
+                })
+                .collect();
 
+            let mut wing = Wing::new("Main".to_string());
+            for (mut r, equipment) in rooms.into_iter().zip(room_equipment) {
                 println!(
                     "   Plugged in {} equipment item(s) in {}",
                     equipment.len(),
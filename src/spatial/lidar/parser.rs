@@ -1,22 +1,31 @@
+use super::downsampler::{PointBatch, BATCH_POINTS};
 use crate::core::spatial::Point3D;
-use anyhow::{anyhow, Result};
+use anyhow::{anyhow, bail, Result};
 use las::Read;
+use memmap2::Mmap;
 use std::fs::File;
-use std::io::{BufRead, BufReader};
 use std::path::Path;
 
-/// Stream points from a point cloud file (CSV, XYZ, PLY, or LAS)
-pub fn stream_points(path: &Path) -> Result<Box<dyn Iterator<Item = Result<Point3D>>>> {
+/// Points per block yielded by [`stream_point_blocks`].
+pub const BLOCK_POINTS: usize = BATCH_POINTS;
+
+enum PointFormat {
+    Las,
+    Ply,
+    Text,
+}
+
+fn detect_format(path: &Path) -> PointFormat {
     // 1. Try to detect by reading the first few bytes
     if let Ok(mut file) = File::open(path) {
         use std::io::Read;
         let mut magic = [0u8; 4];
         if file.read_exact(&mut magic).is_ok() {
             if &magic == b"LASF" {
-                return Ok(Box::new(stream_las(path)?));
+                return PointFormat::Las;
             }
             if &magic[..3] == b"ply" {
-                return Ok(Box::new(stream_ply(path)?));
+                return PointFormat::Ply;
             }
         }
     }
@@ -28,144 +37,398 @@ pub fn stream_points(path: &Path) -> Result<Box<dyn Iterator<Item = Result<Point
         .map(|s| s.to_lowercase());
 
     match extension.as_deref() {
-        Some("csv") | Some("xyz") | Some("txt") => Ok(Box::new(stream_xyz_csv(path)?)),
-        Some("ply") => Ok(Box::new(stream_ply(path)?)),
-        Some("las") | Some("laz") => Ok(Box::new(stream_las(path)?)),
-        _ => {
-            // Default fallback to text-based parsing
-            Ok(Box::new(stream_xyz_csv(path)?))
+        Some("ply") => PointFormat::Ply,
+        Some("las") | Some("laz") => PointFormat::Las,
+        // CSV, XYZ, TXT and anything unknown default to text-based parsing
+        _ => PointFormat::Text,
+    }
+}
+
+/// Stream fixed-size struct-of-arrays blocks of up to [`BLOCK_POINTS`]
+/// points from a point cloud file (CSV, XYZ, PLY, or LAS).
+///
+/// Files are memory-mapped: uncompressed LAS records are decoded in place
+/// and text formats are tokenized over the raw bytes, so no per-point
+/// allocation or dispatch happens. A parse error ends the stream.
+pub fn stream_point_blocks(path: &Path) -> Result<Box<dyn Iterator<Item = Result<PointBatch>>>> {
+    match detect_format(path) {
+        PointFormat::Las => match MappedLas::open(path)? {
+            Some(las) => Ok(Box::new(las)),
+            // Compressed or exotic record layouts go through the `las` crate
+            None => Ok(Box::new(batch_points(stream_las(path)?))),
+        },
+        PointFormat::Ply => Ok(Box::new(TextBlocks::open_ply(path)?)),
+        PointFormat::Text => Ok(Box::new(TextBlocks::open(path, TextDialect::Xyz)?)),
+    }
+}
+
+/// Stream points from a point cloud file (CSV, XYZ, PLY, or LAS)
+///
+/// Per-point view over [`stream_point_blocks`]; bulk consumers should use
+/// the block API directly.
+pub fn stream_points(path: &Path) -> Result<Box<dyn Iterator<Item = Result<Point3D>>>> {
+    let mut blocks = stream_point_blocks(path)?;
+    let mut current = PointBatch::default();
+    let mut index = 0;
+    Ok(Box::new(std::iter::from_fn(move || loop {
+        if index < current.len() {
+            let p = Point3D::new(current.xs[index], current.ys[index], current.zs[index]);
+            index += 1;
+            return Some(Ok(p));
         }
+        match blocks.next()? {
+            Ok(block) => {
+                current = block;
+                index = 0;
+            }
+            Err(e) => return Some(Err(e)),
+        }
+    })))
+}
+
+fn map_file(path: &Path) -> Result<Option<Mmap>> {
+    let file = File::open(path)?;
+    if file.metadata()?.len() == 0 {
+        return Ok(None);
     }
+    // SAFETY: the mapping is read-only and owned by the reader that uses it.
+    // Concurrent truncation of the file by another process is outside our
+    // contract (same as any mmap reader); callers import files they own.
+    #[allow(unsafe_code)]
+    let map = unsafe { Mmap::map(&file)? };
+    Ok(Some(map))
 }
 
-struct XyzIterator {
-    reader: BufReader<File>,
+#[derive(Clone, Copy, PartialEq)]
+enum TextDialect {
+    /// Comma/space/tab/semicolon separated, `#` comments.
+    Xyz,
+    /// Whitespace separated vertex rows after the PLY header.
+    Ply,
 }
 
-impl Iterator for XyzIterator {
-    type Item = Result<Point3D>;
+impl TextDialect {
+    fn is_separator(self, b: u8) -> bool {
+        match self {
+            TextDialect::Xyz => matches!(b, b',' | b' ' | b'\t' | b';' | b'\r'),
+            TextDialect::Ply => b.is_ascii_whitespace(),
+        }
+    }
 
-    fn next(&mut self) -> Option<Self::Item> {
-        let mut line = String::new();
+    fn label(self) -> &'static str {
+        match self {
+            TextDialect::Xyz => "",
+            TextDialect::Ply => "PLY ",
+        }
+    }
+}
+
+/// Line-oriented text reader over a memory-mapped file.
+struct TextBlocks {
+    map: Option<Mmap>,
+    pos: usize,
+    dialect: TextDialect,
+    failed: bool,
+}
+
+impl TextBlocks {
+    fn open(path: &Path, dialect: TextDialect) -> Result<Self> {
+        Ok(Self {
+            map: map_file(path)?,
+            pos: 0,
+            dialect,
+            failed: false,
+        })
+    }
+
+    /// Lightweight ASCII PLY parser (streaming after header)
+    fn open_ply(path: &Path) -> Result<Self> {
+        let mut blocks = Self::open(path, TextDialect::Ply)?;
+        let bytes = blocks.map.as_deref().unwrap_or(&[]);
+        let mut pos = 0;
         loop {
-            line.clear();
-            match self.reader.read_line(&mut line) {
-                Ok(0) => return None, // EOF
-                Ok(_) => {
-                    let trimmed = line.trim();
-                    if trimmed.is_empty() || trimmed.starts_with('#') {
-                        continue;
-                    }
-                    let parts: Vec<&str> = trimmed
-                        .split([',', ' ', '\t', ';'])
-                        .filter(|s| !s.is_empty())
-                        .collect();
-
-                    if parts.len() < 3 {
-                        return Some(Err(anyhow!("Invalid point line format: '{}'", trimmed)));
-                    }
-
-                    let x = match parts[0].parse::<f64>() {
-                        Ok(val) => val,
-                        Err(_) => return Some(Err(anyhow!("Failed to parse x: '{}'", parts[0]))),
-                    };
-                    let y = match parts[1].parse::<f64>() {
-                        Ok(val) => val,
-                        Err(_) => return Some(Err(anyhow!("Failed to parse y: '{}'", parts[1]))),
-                    };
-                    let z = match parts[2].parse::<f64>() {
-                        Ok(val) => val,
-                        Err(_) => return Some(Err(anyhow!("Failed to parse z: '{}'", parts[2]))),
-                    };
-
-                    return Some(Ok(Point3D::new(x, y, z)));
-                }
-                Err(e) => return Some(Err(anyhow!("Failed to read line: {}", e))),
+            if pos >= bytes.len() {
+                return Err(anyhow!("Reached EOF before PLY header ended"));
             }
+            let end = line_end(bytes, pos);
+            let line = bytes[pos..end].trim_ascii();
+            pos = end + 1;
+            if line == b"end_header" {
+                break;
+            }
+        }
+        blocks.pos = pos;
+        Ok(blocks)
+    }
+
+    fn parse_line(&self, line: &[u8], batch: &mut PointBatch) -> Result<()> {
+        let dialect = self.dialect;
+        let mut fields = line
+            .split(|&b| dialect.is_separator(b))
+            .filter(|f| !f.is_empty());
+        let mut coords = [0.0f64; 3];
+        for (axis, coord) in ["x", "y", "z"].iter().zip(coords.iter_mut()) {
+            let Some(field) = fields.next() else {
+                match dialect {
+                    TextDialect::Xyz => bail!(
+                        "Invalid point line format: '{}'",
+                        String::from_utf8_lossy(line)
+                    ),
+                    TextDialect::Ply => bail!(
+                        "Invalid PLY vertex format: '{}'",
+                        String::from_utf8_lossy(line)
+                    ),
+                }
+            };
+            *coord = parse_f64(field).ok_or_else(|| {
+                anyhow!(
+                    "Failed to parse {}{}: '{}'",
+                    dialect.label(),
+                    axis,
+                    String::from_utf8_lossy(field)
+                )
+            })?;
         }
+        batch.xs.push(coords[0]);
+        batch.ys.push(coords[1]);
+        batch.zs.push(coords[2]);
+        Ok(())
     }
 }
 
-/// Simple space/comma-separated value parser (streaming)
-fn stream_xyz_csv(path: &Path) -> Result<impl Iterator<Item = Result<Point3D>>> {
-    let file = File::open(path)?;
-    let reader = BufReader::new(file);
-    Ok(XyzIterator { reader })
+impl Iterator for TextBlocks {
+    type Item = Result<PointBatch>;
+
+    fn next(&mut self) -> Option<Self::Item> {
+        let bytes = self.map.as_deref().unwrap_or(&[]);
+        if self.failed || self.pos >= bytes.len() {
+            return None;
+        }
+        let mut batch = PointBatch::with_capacity(BLOCK_POINTS);
+        while batch.len() < BLOCK_POINTS && self.pos < bytes.len() {
+            let end = line_end(bytes, self.pos);
+            let line = bytes[self.pos..end].trim_ascii();
+            self.pos = end + 1;
+            if line.is_empty() || (self.dialect == TextDialect::Xyz && line[0] == b'#') {
+                continue;
+            }
+            if let Err(e) = self.parse_line(line, &mut batch) {
+                self.failed = true;
+                return Some(Err(e));
+            }
+        }
+        (!batch.is_empty()).then_some(Ok(batch))
+    }
 }
 
-struct PlyIterator {
-    reader: BufReader<File>,
+fn line_end(bytes: &[u8], from: usize) -> usize {
+    bytes[from..]
+        .iter()
+        .position(|&b| b == b'\n')
+        .map_or(bytes.len(), |i| from + i)
 }
 
-impl Iterator for PlyIterator {
-    type Item = Result<Point3D>;
+/// Fast decimal float parser for point rows.
+///
+/// Plain decimals with at most 19 significant digits and a small exponent
+/// take the exact fast path (one integer accumulation and a single
+/// multiply/divide by an exactly representable power of ten, which rounds
+/// correctly). Anything else falls back to `str::parse`.
+fn parse_f64(field: &[u8]) -> Option<f64> {
+    const POW10: [f64; 23] = [
+        1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11, 1e12, 1e13, 1e14, 1e15, 1e16,
+        1e17, 1e18, 1e19, 1e20, 1e21, 1e22,
+    ];
+    let slow = || std::str::from_utf8(field).ok()?.parse::<f64>().ok();
 
-    fn next(&mut self) -> Option<Self::Item> {
-        let mut line = String::new();
-        loop {
-            line.clear();
-            match self.reader.read_line(&mut line) {
-                Ok(0) => return None,
-                Ok(_) => {
-                    let trimmed = line.trim();
-                    if trimmed.is_empty() {
-                        continue;
-                    }
-                    let parts: Vec<&str> = trimmed.split_whitespace().collect();
-                    if parts.len() < 3 {
-                        return Some(Err(anyhow!("Invalid PLY vertex format: '{}'", trimmed)));
-                    }
-
-                    let x = match parts[0].parse::<f64>() {
-                        Ok(val) => val,
-                        Err(_) => {
-                            return Some(Err(anyhow!("Failed to parse PLY x: '{}'", parts[0])))
-                        }
-                    };
-                    let y = match parts[1].parse::<f64>() {
-                        Ok(val) => val,
-                        Err(_) => {
-                            return Some(Err(anyhow!("Failed to parse PLY y: '{}'", parts[1])))
-                        }
-                    };
-                    let z = match parts[2].parse::<f64>() {
-                        Ok(val) => val,
-                        Err(_) => {
-                            return Some(Err(anyhow!("Failed to parse PLY z: '{}'", parts[2])))
-                        }
-                    };
-
-                    return Some(Ok(Point3D::new(x, y, z)));
-                }
-                Err(e) => return Some(Err(anyhow!("Failed to read line: {}", e))),
+    let (negative, mut rest) = match field.split_first() {
+        Some((b'-', rest)) => (true, rest),
+        Some((b'+', rest)) => (false, rest),
+        _ => (false, field),
+    };
+    let mut mantissa: u64 = 0;
+    let mut digits = 0u32;
+    let mut exponent: i32 = 0;
+    let mut seen_digit = false;
+
+    while let Some((&b, tail)) = rest.split_first() {
+        if !b.is_ascii_digit() {
+            break;
+        }
+        seen_digit = true;
+        if mantissa != 0 || b != b'0' {
+            digits += 1;
+        }
+        mantissa = mantissa.wrapping_mul(10).wrapping_add((b - b'0') as u64);
+        rest = tail;
+    }
+    if let Some((b'.', tail)) = rest.split_first() {
+        rest = tail;
+        while let Some((&b, tail)) = rest.split_first() {
+            if !b.is_ascii_digit() {
+                break;
+            }
+            seen_digit = true;
+            if mantissa != 0 || b != b'0' {
+                digits += 1;
+            }
+            mantissa = mantissa.wrapping_mul(10).wrapping_add((b - b'0') as u64);
+            exponent -= 1;
+            rest = tail;
+        }
+    }
+    if !seen_digit {
+        return slow();
+    }
+    if let Some((b'e' | b'E', tail)) = rest.split_first() {
+        let (exp_negative, mut exp_digits) = match tail.split_first() {
+            Some((b'-', t)) => (true, t),
+            Some((b'+', t)) => (false, t),
+            _ => (false, tail),
+        };
+        if exp_digits.is_empty() || exp_digits.len() > 4 {
+            return slow();
+        }
+        let mut value: i32 = 0;
+        while let Some((&b, t)) = exp_digits.split_first() {
+            if !b.is_ascii_digit() {
+                return None;
             }
+            value = value * 10 + (b - b'0') as i32;
+            exp_digits = t;
         }
+        exponent += if exp_negative { -value } else { value };
+        rest = &[];
+    }
+    if !rest.is_empty() {
+        return slow();
     }
+    // 2^53: every mantissa below it is exact in an f64
+    if digits > 19 || mantissa >= 1 << 53 || !(-22..=22).contains(&exponent) {
+        return slow();
+    }
+
+    let magnitude = mantissa as f64;
+    let value = if exponent < 0 {
+        magnitude / POW10[(-exponent) as usize]
+    } else {
+        magnitude * POW10[exponent as usize]
+    };
+    Some(if negative { -value } else { value })
 }
 
-/// Lightweight ASCII PLY parser (streaming after header)
-fn stream_ply(path: &Path) -> Result<impl Iterator<Item = Result<Point3D>>> {
-    let file = File::open(path)?;
-    let mut reader = BufReader::new(file);
+/// Uncompressed LAS point records decoded straight from the mapping.
+///
+/// Every point data format (0-10) starts with the scaled `X`, `Y`, `Z`
+/// `i32` triple, so only the record stride differs between formats.
+struct MappedLas {
+    map: Mmap,
+    next: usize,
+    count: usize,
+    data_offset: usize,
+    record_len: usize,
+    scale: [f64; 3],
+    offset: [f64; 3],
+}
 
-    // 1. Parse header
-    let mut header_ended = false;
-    let mut line = String::new();
+impl MappedLas {
+    /// `Ok(None)` when the file must go through the `las` crate instead
+    /// (LAZ-compressed or unknown record formats).
+    fn open(path: &Path) -> Result<Option<Self>> {
+        let Some(map) = map_file(path)? else {
+            bail!("LAS file is empty: {}", path.display());
+        };
+        let bytes: &[u8] = &map;
+        if bytes.len() < 227 || &bytes[0..4] != b"LASF" {
+            bail!("Invalid LAS header in {}", path.display());
+        }
+        let u16_at = |at: usize| u16::from_le_bytes([bytes[at], bytes[at + 1]]);
+        let u32_at = |at: usize| {
+            u32::from_le_bytes([bytes[at], bytes[at + 1], bytes[at + 2], bytes[at + 3]])
+        };
+        let f64_at = |at: usize| {
+            let mut raw = [0u8; 8];
+            raw.copy_from_slice(&bytes[at..at + 8]);
+            f64::from_le_bytes(raw)
+        };
+
+        let (version_minor, header_size) = (bytes[25], u16_at(94) as usize);
+        let data_offset = u32_at(96) as usize;
+        let format = bytes[104];
+        let record_len = u16_at(105) as usize;
+        if format & 0xC0 != 0 || format > 10 || record_len < 12 {
+            return Ok(None);
+        }
 
-    while !header_ended {
-        line.clear();
-        let bytes_read = reader.read_line(&mut line)?;
-        if bytes_read == 0 {
-            return Err(anyhow!("Reached EOF before PLY header ended"));
+        let mut count = u32_at(107) as usize;
+        if count == 0 && version_minor >= 4 && header_size >= 255 && bytes.len() >= 255 {
+            let mut raw = [0u8; 8];
+            raw.copy_from_slice(&bytes[247..255]);
+            count = u64::from_le_bytes(raw) as usize;
         }
+        // Never trust the header past the end of the file
+        let available = bytes.len().saturating_sub(data_offset) / record_len;
+        let count = count.min(available);
 
-        let trimmed = line.trim();
-        if trimmed == "end_header" {
-            header_ended = true;
+        let scale = [f64_at(131), f64_at(139), f64_at(147)];
+        let offset = [f64_at(155), f64_at(163), f64_at(171)];
+        Ok(Some(Self {
+            map,
+            next: 0,
+            count,
+            data_offset,
+            record_len,
+            scale,
+            offset,
+        }))
+    }
+}
+
+impl Iterator for MappedLas {
+    type Item = Result<PointBatch>;
+
+    fn next(&mut self) -> Option<Self::Item> {
+        if self.next >= self.count {
+            return None;
         }
+        let end = (self.next + BLOCK_POINTS).min(self.count);
+        let mut batch = PointBatch::with_capacity(end - self.next);
+        let first = self.data_offset + self.next * self.record_len;
+        let records = &self.map[first..self.data_offset + end * self.record_len];
+        let raw =
+            |r: &[u8], at: usize| i32::from_le_bytes([r[at], r[at + 1], r[at + 2], r[at + 3]]);
+        for record in records.chunks_exact(self.record_len) {
+            // Same transform as `las::Transform::direct`
+            batch
+                .xs
+                .push(self.scale[0] * f64::from(raw(record, 0)) + self.offset[0]);
+            batch
+                .ys
+                .push(self.scale[1] * f64::from(raw(record, 4)) + self.offset[1]);
+            batch
+                .zs
+                .push(self.scale[2] * f64::from(raw(record, 8)) + self.offset[2]);
+        }
+        self.next = end;
+        Some(Ok(batch))
     }
+}
 
-    Ok(PlyIterator { reader })
+/// Group a per-point iterator into blocks; used for the `las` crate fallback.
+fn batch_points(
+    mut points: impl Iterator<Item = Result<Point3D>>,
+) -> impl Iterator<Item = Result<PointBatch>> {
+    std::iter::from_fn(move || {
+        let mut batch = PointBatch::with_capacity(BLOCK_POINTS);
+        while batch.len() < BLOCK_POINTS {
+            match points.next() {
+                Some(Ok(p)) => batch.push(&p),
+                Some(Err(e)) => return Some(Err(e)),
+                None => break,
+            }
+        }
+        (!batch.is_empty()).then_some(Ok(batch))
+    })
 }
 
 struct LasIterator<'a> {
@@ -189,3 +452,45 @@ fn stream_las(path: &Path) -> Result<impl Iterator<Item = Result<Point3D>> + 'st
     let reader = las::Reader::from_path(path)?;
     Ok(LasIterator { reader })
 }
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    #[test]
+    fn fast_float_matches_std_parse() {
+        let samples = [
+            "0",
+            "-0",
+            "1",
+            "+2.5",
+            "-3.",
+            ".5",
+            "12.345678",
+            "-0.000123",
+            "1e3",
+            "2.5E-4",
+            "123456789.123456789",
+            "9007199254740993",
+            "1e300",
+            "4.9e-324",
+            "0.1",
+            "inf",
+            "-NaN",
+        ];
+        for sample in samples {
+            let expected: f64 = sample.parse().unwrap();
+            let parsed = parse_f64(sample.as_bytes()).unwrap();
+            assert!(
+                parsed.to_bits() == expected.to_bits() || (parsed.is_nan() && expected.is_nan()),
+                "{sample}: {parsed} != {expected}"
+            );
+        }
+        for bad in ["", "-", "1.2.3", "abc", "1e", "1ex"] {
+            assert!(
+                parse_f64(bad.as_bytes()).is_none(),
+                "{bad} should not parse"
+            );
+        }
+    }
+}
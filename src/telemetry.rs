@@ -0,0 +1,320 @@
+//! Lock-free latency histograms for the hot paths.
+//!
+//! Each pipeline phase (IFC lex/register/resolve/export, LiDAR
+//! read/downsample/detect, YAML load/save, git commit) records into a static
+//! [`LatencyHistogram`] through a [`PhaseTimer`] guard. Recording is a few
+//! relaxed atomic adds, so timers stay on in release builds; with the
+//! `tracing` feature each timer also opens a `phase` span. The agent renders
+//! the histograms on `/metrics` (see `docs/resource-limits.md`).
+//!
+//! `Instant` panics in the browser build, so timers are inert on wasm32.
+
+use std::fmt::Write as _;
+use std::sync::atomic::{AtomicU64, Ordering};
+use std::time::{Duration, Instant};
+
+use serde::{Deserialize, Serialize};
+
+/// Bucket upper bounds in microseconds, from 100µs to one minute.
+const BUCKET_BOUNDS_US: [u64; 18] = [
+    100, 250, 500, 1_000, 2_500, 5_000, 10_000, 25_000, 50_000, 100_000, 250_000, 500_000,
+    1_000_000, 2_500_000, 5_000_000, 10_000_000, 30_000_000, 60_000_000,
+];
+
+/// One slot per bound plus the `+Inf` overflow.
+const BUCKETS: usize = BUCKET_BOUNDS_US.len() + 1;
+
+/// Fixed-bucket latency histogram safe to share between threads.
+#[derive(Debug)]
+pub struct LatencyHistogram {
+    buckets: [AtomicU64; BUCKETS],
+    count: AtomicU64,
+    sum_us: AtomicU64,
+}
+
+impl Default for LatencyHistogram {
+    fn default() -> Self {
+        Self::new()
+    }
+}
+
+impl LatencyHistogram {
+    pub const fn new() -> Self {
+        Self {
+            buckets: [const { AtomicU64::new(0) }; BUCKETS],
+            count: AtomicU64::new(0),
+            sum_us: AtomicU64::new(0),
+        }
+    }
+
+    pub fn observe(&self, elapsed: Duration) {
+        let us = u64::try_from(elapsed.as_micros()).unwrap_or(u64::MAX);
+        let bucket = BUCKET_BOUNDS_US.partition_point(|&bound| bound < us);
+        self.buckets[bucket].fetch_add(1, Ordering::Relaxed);
+        self.count.fetch_add(1, Ordering::Relaxed);
+        self.sum_us.fetch_add(us, Ordering::Relaxed);
+    }
+
+    /// Point-in-time copy; concurrent observations may land in either side.
+    pub fn snapshot(&self) -> HistogramSnapshot {
+        HistogramSnapshot {
+            buckets: std::array::from_fn(|i| self.buckets[i].load(Ordering::Relaxed)),
+            count: self.count.load(Ordering::Relaxed),
+            sum: Duration::from_micros(self.sum_us.load(Ordering::Relaxed)),
+        }
+    }
+}
+
+/// Copy of a [`LatencyHistogram`] for rendering.
+#[derive(Debug, Clone, PartialEq, Eq)]
+pub struct HistogramSnapshot {
+    /// Per-bucket (not cumulative) observation counts.
+    buckets: [u64; BUCKETS],
+    pub count: u64,
+    pub sum: Duration,
+}
+
+impl HistogramSnapshot {
+    /// Upper bound of the bucket holding quantile `q` (0..=1), or `None`
+    /// when nothing was observed or it fell in the `+Inf` bucket.
+    pub fn quantile_upper_bound(&self, q: f64) -> Option<Duration> {
+        if self.count == 0 {
+            return None;
+        }
+        let rank = ((q.clamp(0.0, 1.0) * self.count as f64).ceil() as u64).max(1);
+        let mut seen = 0;
+        for (bucket, n) in self.buckets.iter().enumerate() {
+            seen += n;
+            if seen >= rank {
+                return BUCKET_BOUNDS_US
+                    .get(bucket)
+                    .copied()
+                    .map(Duration::from_micros);
+            }
+        }
+        None
+    }
+
+    /// Append the `_bucket`, `_sum` and `_count` series for one label set
+    /// (e.g. `phase="ifc_lex"`) in Prometheus text format.
+    pub fn write_prometheus(&self, out: &mut String, name: &str, labels: &str) {
+        let sep = if labels.is_empty() { "" } else { "," };
+        let mut cumulative = 0;
+        for (bucket, n) in self.buckets.iter().enumerate() {
+            cumulative += n;
+            let le = match BUCKET_BOUNDS_US.get(bucket) {
+                Some(&us) => (us as f64 / 1e6).to_string(),
+                None => "+Inf".to_string(),
+            };
+            let _ = writeln!(
+                out,
+                "{name}_bucket{{{labels}{sep}le=\"{le}\"}} {cumulative}"
+            );
+        }
+        let labels = if labels.is_empty() {
+            String::new()
+        } else {
+            format!("{{{labels}}}")
+        };
+        let _ = writeln!(out, "{name}_sum{labels} {}", self.sum.as_secs_f64());
+        let _ = writeln!(out, "{name}_count{labels} {}", self.count);
+    }
+}
+
+/// Append a histogram family (`# HELP`, `# TYPE`, then every series).
+///
+/// Series with no observations are left out, as client libraries do for
+/// label sets that were never used, keeping idle scrapes small.
+pub fn write_histogram_family<'a>(
+    out: &mut String,
+    name: &str,
+    help: &str,
+    series: impl IntoIterator<Item = (String, &'a LatencyHistogram)>,
+) {
+    let _ = writeln!(out, "# HELP {name} {help}");
+    let _ = writeln!(out, "# TYPE {name} histogram");
+    for (labels, histogram) in series {
+        let snapshot = histogram.snapshot();
+        if snapshot.count > 0 {
+            snapshot.write_prometheus(out, name, &labels);
+        }
+    }
+}
+
+/// Timed stages of the import/export and persistence pipelines.
+#[derive(Debug, Clone, Copy, PartialEq, Eq, Hash)]
+pub enum Phase {
+    /// Tokenizing IFC entity lines.
+    IfcLex,
+    /// Merging lexed entities into the registry.
+    IfcRegister,
+    /// Resolving references and building the domain model.
+    IfcResolve,
+    IfcExport,
+    /// Opening and decoding LiDAR point blocks.
+    LidarRead,
+    /// Voxel filtering, excluding the reads it drives.
+    LidarDownsample,
+    /// Plane detection and building reconstruction.
+    LidarDetect,
+    YamlLoad,
+    YamlSave,
+    GitCommit,
+}
+
+impl Phase {
+    pub const ALL: [Phase; 10] = [
+        Phase::IfcLex,
+        Phase::IfcRegister,
+        Phase::IfcResolve,
+        Phase::IfcExport,
+        Phase::LidarRead,
+        Phase::LidarDownsample,
+        Phase::LidarDetect,
+        Phase::YamlLoad,
+        Phase::YamlSave,
+        Phase::GitCommit,
+    ];
+
+    /// Label value used on `/metrics` and in `phase` spans.
+    pub fn as_str(self) -> &'static str {
+        match self {
+            Phase::IfcLex => "ifc_lex",
+            Phase::IfcRegister => "ifc_register",
+            Phase::IfcResolve => "ifc_resolve",
+            Phase::IfcExport => "ifc_export",
+            Phase::LidarRead => "lidar_read",
+            Phase::LidarDownsample => "lidar_downsample",
+            Phase::LidarDetect => "lidar_detect",
+            Phase::YamlLoad => "yaml_load",
+            Phase::YamlSave => "yaml_save",
+            Phase::GitCommit => "git_commit",
+        }
+    }
+}
+
+static PHASE_LATENCY: [LatencyHistogram; Phase::ALL.len()] =
+    [const { LatencyHistogram::new() }; Phase::ALL.len()];
+
+/// Process-wide histogram for `phase`.
+pub fn phase_latency(phase: Phase) -> &'static LatencyHistogram {
+    &PHASE_LATENCY[phase as usize]
+}
+
+/// Record a phase timed by other means (e.g. accumulated over a stream).
+pub fn record(phase: Phase, elapsed: Duration) {
+    phase_latency(phase).observe(elapsed);
+}
+
+/// Time `phase` until the returned guard drops.
+pub fn time(phase: Phase) -> PhaseTimer {
+    PhaseTimer {
+        phase,
+        watch: Stopwatch::start(),
+        excluded: Duration::ZERO,
+        #[cfg(feature = "tracing")]
+        _span: tracing::debug_span!("phase", phase = phase.as_str()).entered(),
+    }
+}
+
+/// Monotonic timer that reads `None` where `Instant` is unavailable.
+#[derive(Debug, Clone, Copy)]
+pub struct Stopwatch(Option<Instant>);
+
+impl Stopwatch {
+    pub fn start() -> Self {
+        Self((!cfg!(target_arch = "wasm32")).then(Instant::now))
+    }
+
+    pub fn elapsed(&self) -> Option<Duration> {
+        self.0.map(|start| start.elapsed())
+    }
+}
+
+/// Guard returned by [`time`]; records its phase on drop.
+#[must_use = "the phase is only timed while the guard is alive"]
+#[derive(Debug)]
+pub struct PhaseTimer {
+    phase: Phase,
+    watch: Stopwatch,
+    excluded: Duration,
+    #[cfg(feature = "tracing")]
+    _span: tracing::span::EnteredSpan,
+}
+
+impl PhaseTimer {
+    /// Leave `elapsed` out of this phase because another phase recorded it.
+    pub fn exclude(&mut self, elapsed: Duration) {
+        self.excluded += elapsed;
+    }
+}
+
+impl Drop for PhaseTimer {
+    fn drop(&mut self) {
+        if let Some(elapsed) = self.watch.elapsed() {
+            record(self.phase, elapsed.saturating_sub(self.excluded));
+        }
+    }
+}
+
+/// Hit/miss/eviction counters a cache reports for `/metrics`.
+#[derive(Debug, Clone, Copy, Default, PartialEq, Eq, Serialize, Deserialize)]
+pub struct CacheStats {
+    pub hits: u64,
+    pub misses: u64,
+    pub evictions: u64,
+    pub entries: u64,
+    pub bytes: u64,
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    #[test]
+    fn observations_land_in_le_buckets() {
+        let histogram = LatencyHistogram::new();
+        histogram.observe(Duration::from_micros(100));
+        histogram.observe(Duration::from_micros(101));
+        histogram.observe(Duration::from_millis(3));
+        histogram.observe(Duration::from_secs(120));
+
+        let snapshot = histogram.snapshot();
+        assert_eq!(snapshot.count, 4);
+        assert_eq!(
+            snapshot.quantile_upper_bound(0.25),
+            Some(Duration::from_micros(100))
+        );
+        assert_eq!(
+            snapshot.quantile_upper_bound(0.5),
+            Some(Duration::from_micros(250))
+        );
+        assert_eq!(
+            snapshot.quantile_upper_bound(0.75),
+            Some(Duration::from_millis(5))
+        );
+        assert_eq!(snapshot.quantile_upper_bound(1.0), None);
+
+        let mut out = String::new();
+        snapshot.write_prometheus(&mut out, "arx_test_seconds", "phase=\"ifc_lex\"");
+        assert!(out.contains("arx_test_seconds_bucket{phase=\"ifc_lex\",le=\"0.0001\"} 1\n"));
+        assert!(out.contains("arx_test_seconds_bucket{phase=\"ifc_lex\",le=\"0.005\"} 3\n"));
+        assert!(out.contains("arx_test_seconds_bucket{phase=\"ifc_lex\",le=\"60\"} 3\n"));
+        assert!(out.contains("arx_test_seconds_bucket{phase=\"ifc_lex\",le=\"+Inf\"} 4\n"));
+        assert!(out.contains("arx_test_seconds_count{phase=\"ifc_lex\"} 4\n"));
+    }
+
+    #[test]
+    fn timer_records_phase_minus_excluded_time() {
+        let before = phase_latency(Phase::LidarDownsample).snapshot().count;
+        {
+            let mut timer = time(Phase::LidarDownsample);
+            timer.exclude(Duration::from_secs(3600));
+        }
+        // Other tests may time the same phase concurrently
+        assert!(phase_latency(Phase::LidarDownsample).snapshot().count > before);
+        for (i, phase) in Phase::ALL.into_iter().enumerate() {
+            assert_eq!(phase as usize, i, "{} out of order", phase.as_str());
+        }
+    }
+}
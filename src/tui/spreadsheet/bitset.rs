@@ -0,0 +1,82 @@
+//! Fixed-size bitset shared by the filter index (row indices) and the
+//! search index (cell ids)
+
+/// Fixed-size set of indices below the length given to [`BitSet::new`]
+///
+/// Storage is rounded up to whole words; setting an index beyond it is a
+/// no-op, and such an index is never a member.
+#[derive(Debug, Clone, PartialEq)]
+pub struct BitSet {
+    words: Vec<u64>,
+}
+
+impl BitSet {
+    pub fn new(len: usize) -> Self {
+        Self {
+            words: vec![0; len.div_ceil(64)],
+        }
+    }
+
+    pub fn set(&mut self, index: usize, on: bool) {
+        if let Some(word) = self.words.get_mut(index / 64) {
+            let bit = 1u64 << (index % 64);
+            if on {
+                *word |= bit;
+            } else {
+                *word &= !bit;
+            }
+        }
+    }
+
+    pub fn insert(&mut self, index: usize) {
+        self.set(index, true);
+    }
+
+    pub fn contains(&self, index: usize) -> bool {
+        self.words
+            .get(index / 64)
+            .is_some_and(|word| word & (1u64 << (index % 64)) != 0)
+    }
+
+    pub fn intersect(&mut self, other: &BitSet) {
+        for (word, other) in self.words.iter_mut().zip(&other.words) {
+            *word &= *other;
+        }
+    }
+
+    /// Members in ascending order
+    pub fn iter(&self) -> impl Iterator<Item = usize> + '_ {
+        self.words.iter().enumerate().flat_map(|(i, &word)| {
+            let mut rest = word;
+            std::iter::from_fn(move || {
+                if rest == 0 {
+                    return None;
+                }
+                let bit = rest.trailing_zeros() as usize;
+                rest &= rest - 1;
+                Some(i * 64 + bit)
+            })
+        })
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    #[test]
+    fn members_round_trip_across_words() {
+        let mut set = BitSet::new(128);
+        for index in [0, 63, 64, 127, 128] {
+            set.insert(index);
+        }
+        set.set(63, false);
+        assert_eq!(set.iter().collect::<Vec<_>>(), vec![0, 64, 127]);
+        assert!(!set.contains(128));
+
+        let mut other = BitSet::new(128);
+        other.insert(64);
+        set.intersect(&other);
+        assert_eq!(set.iter().collect::<Vec<_>>(), vec![64]);
+    }
+}
@@ -0,0 +1,184 @@
+//! Column-major cache of rendered cell values
+//!
+//! Data sources render each row once (on load, and again after `set_cell`
+//! touches it) instead of on every cell read. Each column is a vector of
+//! cells holding the value's variant plus its display text; enum columns
+//! intern their text, so 40k rows of "HVAC" share one allocation.
+
+use super::super::types::{CellType, CellValue, ColumnDefinition};
+use std::collections::HashSet;
+use std::sync::Arc;
+
+/// One rendered cell.
+///
+/// String payloads live only in `display`; `value` keeps the variant (with an
+/// empty, unallocated `String`) or the non-string value itself.
+#[derive(Debug, Clone)]
+struct CachedCell {
+    value: CellValue,
+    display: Arc<str>,
+}
+
+impl CachedCell {
+    fn to_value(&self) -> CellValue {
+        let text = || self.display.to_string();
+        match &self.value {
+            CellValue::Text(_) => CellValue::Text(text()),
+            CellValue::Enum(_) => CellValue::Enum(text()),
+            CellValue::Date(_) => CellValue::Date(text()),
+            CellValue::UUID(_) => CellValue::UUID(text()),
+            CellValue::Reference(_) => CellValue::Reference(text()),
+            other => other.clone(),
+        }
+    }
+}
+
+/// Pre-rendered cells for every row of a data source, stored by column.
+#[derive(Debug, Default)]
+pub struct CellCache {
+    columns: Vec<Vec<CachedCell>>,
+    /// Columns whose display strings are interned (enum columns).
+    interned: Vec<bool>,
+    pool: HashSet<Arc<str>>,
+}
+
+impl CellCache {
+    pub fn new(columns: &[ColumnDefinition]) -> Self {
+        Self {
+            columns: vec![Vec::new(); columns.len()],
+            interned: columns
+                .iter()
+                .map(|c| matches!(c.data_type, CellType::Enum(_)))
+                .collect(),
+            pool: HashSet::new(),
+        }
+    }
+
+    /// Drop every row (the column layout is kept).
+    pub fn clear(&mut self) {
+        for column in &mut self.columns {
+            column.clear();
+        }
+        self.pool.clear();
+    }
+
+    pub fn row_count(&self) -> usize {
+        self.columns.first().map_or(0, Vec::len)
+    }
+
+    /// Append a rendered row; `cells` must yield one value per column.
+    pub fn push_row(&mut self, cells: impl IntoIterator<Item = CellValue>) {
+        let row = self.row_count();
+        for (col, value) in cells.into_iter().enumerate() {
+            let cell = self.cache_cell(col, value);
+            self.columns[col].push(cell);
+        }
+        debug_assert!(self.columns.iter().all(|c| c.len() == row + 1));
+    }
+
+    /// Replace a row after its underlying item changed.
+    pub fn set_row(&mut self, row: usize, cells: impl IntoIterator<Item = CellValue>) {
+        for (col, value) in cells.into_iter().enumerate() {
+            let cell = self.cache_cell(col, value);
+            self.columns[col][row] = cell;
+        }
+    }
+
+    pub fn value(&self, row: usize, col: usize) -> Option<CellValue> {
+        self.cell(row, col).map(CachedCell::to_value)
+    }
+
+    /// Display text of a cell, as `CellValue`'s `Display` would render it.
+    pub fn display(&self, row: usize, col: usize) -> Option<&str> {
+        self.cell(row, col).map(|c| &*c.display)
+    }
+
+    fn cell(&self, row: usize, col: usize) -> Option<&CachedCell> {
+        self.columns.get(col)?.get(row)
+    }
+
+    fn cache_cell(&mut self, col: usize, value: CellValue) -> CachedCell {
+        let (display, value) = match value {
+            CellValue::Text(s) => (s, CellValue::Text(String::new())),
+            CellValue::Enum(s) => (s, CellValue::Enum(String::new())),
+            CellValue::Date(s) => (s, CellValue::Date(String::new())),
+            CellValue::UUID(s) => (s, CellValue::UUID(String::new())),
+            CellValue::Reference(s) => (s, CellValue::Reference(String::new())),
+            other => (other.to_string(), other),
+        };
+        let display = if self.interned[col] {
+            self.intern(display)
+        } else {
+            Arc::from(display)
+        };
+        CachedCell { value, display }
+    }
+
+    fn intern(&mut self, text: String) -> Arc<str> {
+        if let Some(shared) = self.pool.get(text.as_str()) {
+            return shared.clone();
+        }
+        let shared: Arc<str> = Arc::from(text);
+        self.pool.insert(shared.clone());
+        shared
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    fn column(id: &str, data_type: CellType) -> ColumnDefinition {
+        ColumnDefinition {
+            id: id.to_string(),
+            label: id.to_string(),
+            data_type,
+            editable: true,
+            width: None,
+            validation: None,
+            enum_values: None,
+        }
+    }
+
+    #[test]
+    fn cache_round_trips_values_and_interns_enums() {
+        let columns = vec![
+            column("name", CellType::Text),
+            column("type", CellType::Enum(vec!["HVAC".to_string()])),
+            column("area", CellType::Number),
+        ];
+        let mut cache = CellCache::new(&columns);
+        for name in ["AHU-1", "AHU-2"] {
+            cache.push_row([
+                CellValue::Text(name.to_string()),
+                CellValue::Enum("HVAC".to_string()),
+                CellValue::Number(12.5),
+            ]);
+        }
+
+        assert_eq!(cache.row_count(), 2);
+        assert_eq!(
+            cache.value(1, 0),
+            Some(CellValue::Text("AHU-2".to_string()))
+        );
+        assert_eq!(cache.value(0, 2), Some(CellValue::Number(12.5)));
+        assert_eq!(cache.display(0, 2), Some("12.5"));
+        assert!(Arc::ptr_eq(
+            &cache.cell(0, 1).unwrap().display,
+            &cache.cell(1, 1).unwrap().display
+        ));
+
+        cache.set_row(
+            0,
+            [
+                CellValue::Text("Boiler".to_string()),
+                CellValue::Enum("Plumbing".to_string()),
+                CellValue::Empty,
+            ],
+        );
+        assert_eq!(cache.display(0, 0), Some("Boiler"));
+        assert_eq!(cache.value(0, 2), Some(CellValue::Empty));
+        assert_eq!(cache.value(0, 3), None);
+        assert_eq!(cache.value(2, 0), None);
+    }
+}
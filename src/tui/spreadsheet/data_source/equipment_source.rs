@@ -4,8 +4,10 @@
 //! viewing and editing equipment properties with Git integration.
 
 use super::super::types::{CellType, CellValue, ColumnDefinition, ValidationRule};
+use super::cell_cache::CellCache;
 use super::trait_def::SpreadsheetDataSource;
 use crate::core::{Building, Equipment, EquipmentHealthStatus, EquipmentStatus, EquipmentType};
+use std::borrow::Cow;
 use std::collections::{HashMap, HashSet};
 use std::error::Error;
 
@@ -17,11 +19,20 @@ use std::error::Error;
 /// - Cell-level read/write operations
 /// - Change tracking
 /// - Git integration for saves
+///
+/// Cells are rendered once into a [`CellCache`] and re-rendered per row
+/// when `set_cell` changes it, so reads during scrolling and search are
+/// lookups.
 pub struct EquipmentDataSource {
     equipment: Vec<Equipment>,
     building_data: Building,
     building_name: String,
     modified_rows: HashSet<usize>,
+    columns: Vec<ColumnDefinition>,
+    /// Address of each row's parent (floor, wing or room), without the
+    /// equipment segment; `None` when the equipment is not placed.
+    address_prefixes: Vec<Option<String>>,
+    cells: CellCache,
 }
 
 impl EquipmentDataSource {
@@ -42,12 +53,19 @@ impl EquipmentDataSource {
             .cloned()
             .collect();
 
-        Self {
+        let columns = Self::column_definitions();
+        let cells = CellCache::new(&columns);
+        let mut source = Self {
             equipment,
             building_data,
             building_name,
             modified_rows: HashSet::new(),
-        }
+            columns,
+            address_prefixes: Vec::new(),
+            cells,
+        };
+        source.rebuild_cells();
+        source
     }
 
     /// Get equipment type enum values
@@ -74,45 +92,91 @@ impl EquipmentDataSource {
         ]
     }
 
-    fn get_equipment_address(&self, eq: &Equipment) -> String {
+    /// Parent address of every equipment id, in one pass over the building.
+    ///
+    /// The first placement wins, matching a floor → wing → room search.
+    fn parent_addresses(&self) -> HashMap<&str, String> {
+        let building = slug(&self.building_name);
+        let mut parents = HashMap::new();
         for floor in &self.building_data.floors {
-            if floor.equipment.iter().any(|e| e.id == eq.id) {
-                return format!(
-                    "/usa/ny/brooklyn/{}/floor-{}/{}",
-                    self.building_name.to_lowercase().replace(" ", "-"),
-                    floor.level,
-                    eq.name.to_lowercase().replace(" ", "-")
-                );
+            let floor_prefix = format!("/usa/ny/brooklyn/{}/floor-{}", building, floor.level);
+            for eq in &floor.equipment {
+                parents
+                    .entry(eq.id.as_str())
+                    .or_insert_with(|| floor_prefix.clone());
             }
             for wing in &floor.wings {
-                if wing.equipment.iter().any(|e| e.id == eq.id) {
-                    return format!(
-                        "/usa/ny/brooklyn/{}/floor-{}/wing-{}/{}",
-                        self.building_name.to_lowercase().replace(" ", "-"),
-                        floor.level,
-                        wing.name.to_lowercase().replace(" ", "-"),
-                        eq.name.to_lowercase().replace(" ", "-")
-                    );
+                for eq in &wing.equipment {
+                    parents
+                        .entry(eq.id.as_str())
+                        .or_insert_with(|| format!("{}/wing-{}", floor_prefix, slug(&wing.name)));
                 }
                 for room in &wing.rooms {
-                    if room.equipment.iter().any(|e| e.id == eq.id) {
-                        return format!(
-                            "/usa/ny/brooklyn/{}/floor-{}/{}/{}",
-                            self.building_name.to_lowercase().replace(" ", "-"),
-                            floor.level,
-                            room.name.to_lowercase().replace(" ", "-"),
-                            eq.name.to_lowercase().replace(" ", "-")
-                        );
+                    for eq in &room.equipment {
+                        parents
+                            .entry(eq.id.as_str())
+                            .or_insert_with(|| format!("{}/{}", floor_prefix, slug(&room.name)));
                     }
                 }
             }
         }
-        "No address".to_string()
+        parents
     }
-}
 
-impl SpreadsheetDataSource for EquipmentDataSource {
-    fn columns(&self) -> Vec<ColumnDefinition> {
+    fn equipment_address(&self, row: usize) -> String {
+        match &self.address_prefixes[row] {
+            Some(prefix) => format!("{}/{}", prefix, slug(&self.equipment[row].name)),
+            None => "No address".to_string(),
+        }
+    }
+
+    /// Cell values of one row, in column order.
+    fn render_row(&self, row: usize) -> Vec<CellValue> {
+        let equipment = &self.equipment[row];
+        // Use health_status if available, otherwise use status
+        let status_str = if let Some(health_status) = &equipment.health_status {
+            match health_status {
+                EquipmentHealthStatus::Healthy => "Healthy",
+                EquipmentHealthStatus::Warning => "Warning",
+                EquipmentHealthStatus::Critical => "Critical",
+                EquipmentHealthStatus::Unknown => "Unknown",
+            }
+        } else {
+            match equipment.status {
+                EquipmentStatus::Active => "Active",
+                EquipmentStatus::Inactive => "Inactive",
+                EquipmentStatus::Maintenance => "Maintenance",
+                EquipmentStatus::OutOfOrder => "OutOfOrder",
+                EquipmentStatus::Unknown => "Unknown",
+            }
+        };
+        vec![
+            CellValue::Text(self.equipment_address(row)),
+            CellValue::UUID(equipment.id.clone()),
+            CellValue::Text(equipment.name.clone()),
+            CellValue::Enum(format!("{:?}", equipment.equipment_type)),
+            CellValue::Enum(status_str.to_string()),
+        ]
+    }
+
+    /// Recompute parent addresses and every cached cell.
+    fn rebuild_cells(&mut self) {
+        let parents = self.parent_addresses();
+        let prefixes = self
+            .equipment
+            .iter()
+            .map(|eq| parents.get(eq.id.as_str()).cloned())
+            .collect();
+        self.address_prefixes = prefixes;
+
+        self.cells.clear();
+        for row in 0..self.equipment.len() {
+            let cells = self.render_row(row);
+            self.cells.push_row(cells);
+        }
+    }
+
+    fn column_definitions() -> Vec<ColumnDefinition> {
         vec![
             ColumnDefinition {
                 id: "equipment.address".to_string(),
@@ -161,68 +225,57 @@ impl SpreadsheetDataSource for EquipmentDataSource {
             },
         ]
     }
+}
+
+/// Address segment form of a name (`"Main Hall"` → `"main-hall"`).
+fn slug(name: &str) -> String {
+    name.to_lowercase().replace(' ', "-")
+}
+
+impl SpreadsheetDataSource for EquipmentDataSource {
+    fn columns(&self) -> Vec<ColumnDefinition> {
+        self.columns.clone()
+    }
 
     fn row_count(&self) -> usize {
         self.equipment.len()
     }
 
     fn get_cell(&self, row: usize, col: usize) -> Result<CellValue, Box<dyn Error>> {
-        let equipment = self
-            .equipment
-            .get(row)
-            .ok_or_else(|| format!("Row {} out of bounds", row))?;
-
-        let columns = self.columns();
-        let column = columns
-            .get(col)
-            .ok_or_else(|| format!("Column {} out of bounds", col))?;
+        if row >= self.equipment.len() {
+            return Err(format!("Row {} out of bounds", row).into());
+        }
+        Ok(self
+            .cells
+            .value(row, col)
+            .ok_or_else(|| format!("Column {} out of bounds", col))?)
+    }
 
-        match column.id.as_str() {
-            "equipment.address" => Ok(CellValue::Text(self.get_equipment_address(equipment))),
-            "equipment.id" => Ok(CellValue::UUID(equipment.id.clone())),
-            "equipment.name" => Ok(CellValue::Text(equipment.name.clone())),
-            "equipment.type" => Ok(CellValue::Enum(format!("{:?}", equipment.equipment_type))),
-            "equipment.status" => {
-                // Use health_status if available, otherwise use status
-                let status_str = if let Some(health_status) = &equipment.health_status {
-                    match health_status {
-                        EquipmentHealthStatus::Healthy => "Healthy",
-                        EquipmentHealthStatus::Warning => "Warning",
-                        EquipmentHealthStatus::Critical => "Critical",
-                        EquipmentHealthStatus::Unknown => "Unknown",
-                    }
-                } else {
-                    match equipment.status {
-                        EquipmentStatus::Active => "Active",
-                        EquipmentStatus::Inactive => "Inactive",
-                        EquipmentStatus::Maintenance => "Maintenance",
-                        EquipmentStatus::OutOfOrder => "OutOfOrder",
-                        EquipmentStatus::Unknown => "Unknown",
-                    }
-                };
-                Ok(CellValue::Enum(status_str.to_string()))
-            }
-            _ => Ok(CellValue::Empty),
+    fn cell_display(&self, row: usize, col: usize) -> Result<Cow<'_, str>, Box<dyn Error>> {
+        if row >= self.equipment.len() {
+            return Err(format!("Row {} out of bounds", row).into());
         }
+        Ok(Cow::Borrowed(
+            self.cells
+                .display(row, col)
+                .ok_or_else(|| format!("Column {} out of bounds", col))?,
+        ))
     }
 
     fn set_cell(&mut self, row: usize, col: usize, value: CellValue) -> Result<(), Box<dyn Error>> {
-        // Get column ID first before mutable borrow
-        let column_id = {
-            let columns = self.columns();
-            columns
-                .get(col)
-                .ok_or_else(|| format!("Column {} out of bounds", col))?
-                .id
-                .clone()
-        };
+        let column_id = self
+            .columns
+            .get(col)
+            .ok_or_else(|| format!("Column {} out of bounds", col))?
+            .id
+            .as_str();
 
         let equipment = self
             .equipment
             .get_mut(row)
             .ok_or_else(|| format!("Row {} out of bounds", row))?;
 
-        match column_id.as_str() {
+        match column_id {
             "equipment.name" => {
                 if let CellValue::Text(name) = value {
                     equipment.name = name;
@@ -278,11 +331,13 @@ impl SpreadsheetDataSource for EquipmentDataSource {
             }
         }
 
+        let cells = self.render_row(row);
+        self.cells.set_row(row, cells);
         Ok(())
     }
 
     fn save(&mut self, commit: bool) -> Result<(), Box<dyn Error>> {
-        use crate::ingest::persist_building;
+        use crate::ingest::persist_building_incremental;
 
         let mut building = self.building_data.clone();
         let mut modified_count = 0;
@@ -306,7 +361,7 @@ impl SpreadsheetDataSource for EquipmentDataSource {
             "Update equipment via spreadsheet ({} items modified)",
             modified_count
         );
-        let building = persist_building(building, commit, Some(&message))?;
+        let building = persist_building_incremental(building, commit, Some(&message))?;
         self.building_data = building;
         self.modified_rows.clear();
         Ok(())
@@ -329,6 +384,7 @@ impl SpreadsheetDataSource for EquipmentDataSource {
             .into_iter()
             .cloned()
             .collect();
+        self.rebuild_cells();
 
         // Clear modified rows
         self.modified_rows.clear();
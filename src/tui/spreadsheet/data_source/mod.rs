@@ -6,6 +6,7 @@
 //! # Module Structure
 //!
 //! - `trait_def` - Core SpreadsheetDataSource trait
+//! - `cell_cache` - Column-major cache of rendered cells used by the sources
 //! - `equipment_source` - Equipment data implementation
 //! - `room_source` - Room data implementation
 //! - `sensor_source` - Sensor data implementation (read-only)
@@ -24,6 +25,7 @@
 //! let cell_value = data_source.get_cell(0, 0)?;
 //! ```
 
+pub mod cell_cache;
 pub mod equipment_source;
 pub mod room_source;
 // Sensor spreadsheet source removed with hardware stack (revisit later).
@@ -4,8 +4,10 @@
 //! viewing and editing room properties with Git integration.
 
 use super::super::types::{CellType, CellValue, ColumnDefinition, ValidationRule};
+use super::cell_cache::CellCache;
 use super::trait_def::SpreadsheetDataSource;
 use crate::core::{Building, Room, RoomType};
+use std::borrow::Cow;
 use std::collections::{HashMap, HashSet};
 use std::error::Error;
 
@@ -18,11 +20,16 @@ use std::error::Error;
 /// - Change tracking
 /// - Git integration for saves
 /// - Automatic area/volume calculations
+///
+/// Cells are rendered once into a [`CellCache`] and re-rendered per row
+/// when `set_cell` changes it.
 pub struct RoomDataSource {
     rooms: Vec<Room>,
     building_data: Building,
     building_name: String,
     modified_rows: HashSet<usize>,
+    columns: Vec<ColumnDefinition>,
+    cells: CellCache,
 }
 
 impl RoomDataSource {
@@ -39,12 +46,18 @@ impl RoomDataSource {
         // Collect all rooms from all floors (rooms are now in wings) using Building inherent query
         let rooms = building_data.get_all_rooms().into_iter().cloned().collect();
 
-        Self {
+        let columns = Self::column_definitions();
+        let cells = CellCache::new(&columns);
+        let mut source = Self {
             rooms,
             building_data,
             building_name,
             modified_rows: HashSet::new(),
-        }
+            columns,
+            cells,
+        };
+        source.rebuild_cells();
+        source
     }
 
     /// Get room type enum values
@@ -64,10 +77,30 @@ impl RoomDataSource {
             "Electrical".to_string(),
         ]
     }
-}
 
-impl SpreadsheetDataSource for RoomDataSource {
-    fn columns(&self) -> Vec<ColumnDefinition> {
+    /// Cell values of one room, in column order.
+    fn render_row(room: &Room) -> Vec<CellValue> {
+        let dimensions = &room.spatial_properties.dimensions;
+        vec![
+            // RoomData doesn't have address field yet, so show "No address"
+            CellValue::Text("No address".to_string()),
+            CellValue::UUID(room.id.clone()),
+            CellValue::Text(room.name.clone()),
+            CellValue::Enum(format!("{:?}", room.room_type)),
+            // Area and volume are calculated from dimensions
+            CellValue::Number(dimensions.width * dimensions.depth),
+            CellValue::Number(dimensions.width * dimensions.depth * dimensions.height),
+        ]
+    }
+
+    fn rebuild_cells(&mut self) {
+        self.cells.clear();
+        for room in &self.rooms {
+            self.cells.push_row(Self::render_row(room));
+        }
+    }
+
+    fn column_definitions() -> Vec<ColumnDefinition> {
         vec![
             ColumnDefinition {
                 id: "room.address".to_string(),
@@ -125,64 +158,52 @@ impl SpreadsheetDataSource for RoomDataSource {
             },
         ]
     }
+}
+
+impl SpreadsheetDataSource for RoomDataSource {
+    fn columns(&self) -> Vec<ColumnDefinition> {
+        self.columns.clone()
+    }
 
     fn row_count(&self) -> usize {
         self.rooms.len()
     }
 
     fn get_cell(&self, row: usize, col: usize) -> Result<CellValue, Box<dyn Error>> {
-        let room = self
-            .rooms
-            .get(row)
-            .ok_or_else(|| format!("Row {} out of bounds", row))?;
-
-        let columns = self.columns();
-        let column = columns
-            .get(col)
-            .ok_or_else(|| format!("Column {} out of bounds", col))?;
+        if row >= self.rooms.len() {
+            return Err(format!("Row {} out of bounds", row).into());
+        }
+        Ok(self
+            .cells
+            .value(row, col)
+            .ok_or_else(|| format!("Column {} out of bounds", col))?)
+    }
 
-        match column.id.as_str() {
-            "room.address" => {
-                // RoomData doesn't have address field yet, so show "No address"
-                Ok(CellValue::Text("No address".to_string()))
-            }
-            "room.id" => Ok(CellValue::UUID(room.id.clone())),
-            "room.name" => Ok(CellValue::Text(room.name.clone())),
-            "room.type" => Ok(CellValue::Enum(format!("{:?}", room.room_type))),
-            "room.area" => {
-                // Calculate area from dimensions
-                let area = room.spatial_properties.dimensions.width
-                    * room.spatial_properties.dimensions.depth;
-                Ok(CellValue::Number(area))
-            }
-            "room.volume" => {
-                // Calculate volume from dimensions
-                let volume = room.spatial_properties.dimensions.width
-                    * room.spatial_properties.dimensions.depth
-                    * room.spatial_properties.dimensions.height;
-                Ok(CellValue::Number(volume))
-            }
-            _ => Ok(CellValue::Empty),
+    fn cell_display(&self, row: usize, col: usize) -> Result<Cow<'_, str>, Box<dyn Error>> {
+        if row >= self.rooms.len() {
+            return Err(format!("Row {} out of bounds", row).into());
         }
+        Ok(Cow::Borrowed(
+            self.cells
+                .display(row, col)
+                .ok_or_else(|| format!("Column {} out of bounds", col))?,
+        ))
     }
 
     fn set_cell(&mut self, row: usize, col: usize, value: CellValue) -> Result<(), Box<dyn Error>> {
-        // Get column ID first before mutable borrow
-        let column_id = {
-            let columns = self.columns();
-            columns
-                .get(col)
-                .ok_or_else(|| format!("Column {} out of bounds", col))?
-                .id
-                .clone()
-        };
+        let column_id = self
+            .columns
+            .get(col)
+            .ok_or_else(|| format!("Column {} out of bounds", col))?
+            .id
+            .as_str();
 
         let room = self
             .rooms
             .get_mut(row)
             .ok_or_else(|| format!("Row {} out of bounds", row))?;
 
-        match column_id.as_str() {
+        match column_id {
             "room.name" => {
                 if let CellValue::Text(name) = value {
                     room.name = name;
@@ -250,11 +271,12 @@ impl SpreadsheetDataSource for RoomDataSource {
             }
         }
 
+        self.cells.set_row(row, Self::render_row(&self.rooms[row]));
         Ok(())
     }
 
     fn save(&mut self, commit: bool) -> Result<(), Box<dyn Error>> {
-        use crate::ingest::persist_building;
+        use crate::ingest::persist_building_incremental;
 
         let mut building = self.building_data.clone();
         let mut modified_count = 0;
@@ -278,7 +300,7 @@ impl SpreadsheetDataSource for RoomDataSource {
             "Update rooms via spreadsheet ({} items modified)",
             modified_count
         );
-        let building = persist_building(building, commit, Some(&message))?;
+        let building = persist_building_incremental(building, commit, Some(&message))?;
         self.building_data = building;
         self.modified_rows.clear();
         Ok(())
@@ -301,6 +323,7 @@ impl SpreadsheetDataSource for RoomDataSource {
             .into_iter()
             .cloned()
             .collect();
+        self.rebuild_cells();
 
         // Clear modified rows
         self.modified_rows.clear();
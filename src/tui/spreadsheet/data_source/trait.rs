@@ -3,6 +3,7 @@
 //! Defines the core trait for data sources that provide spreadsheet data.
 
 use super::super::types::{CellValue, ColumnDefinition};
+use std::borrow::Cow;
 use std::error::Error;
 
 /// Trait for data sources that provide spreadsheet data
@@ -60,6 +61,16 @@ pub trait SpreadsheetDataSource: Send + Sync {
     /// Returns the cell value or an error if the indices are out of bounds.
     fn get_cell(&self, row: usize, col: usize) -> Result<CellValue, Box<dyn Error>>;
 
+    /// Get the display text of the cell at (row, col)
+    ///
+    /// Equivalent to `get_cell(row, col)?.to_string()`. Sources that keep a
+    /// rendered cell cache override this to borrow the cached text. Search
+    /// reads cells through it (index snapshots, refreshes after edits and
+    /// unindexed matching); viewport loading reads the `CellCache` directly.
+    fn cell_display(&self, row: usize, col: usize) -> Result<Cow<'_, str>, Box<dyn Error>> {
+        Ok(Cow::Owned(self.get_cell(row, col)?.to_string()))
+    }
+
     /// Set cell value at (row, col)
     ///
     /// # Arguments
@@ -1,11 +1,16 @@
 //! Filtering and sorting functionality
 //!
-//! Handles column filtering and multi-column sorting
+//! Handles column filtering and multi-column sorting. Results are maintained
+//! incrementally through the grid's [`FilterIndex`]: each filter keeps a
+//! bitset of the rows it accepts, and sorting works on cached per-column ranks
+//! and the previous row ordering.
 
+use crate::tui::spreadsheet::bitset::BitSet;
 use crate::tui::spreadsheet::types::{
     CellValue, ColumnFilter, ColumnSort, FilterCondition, Grid, SortOrder,
 };
 use std::cmp::Ordering;
+use std::collections::HashMap;
 
 /// Apply filter to grid
 pub fn apply_filter(
@@ -15,6 +20,7 @@ pub fn apply_filter(
 ) -> Result<(), Box<dyn std::error::Error>> {
     // Remove existing filter for this column if any
     grid.filters.retain(|f| f.column_idx != column_idx);
+    grid.filter_index.masks.remove(&column_idx);
 
     // Add new filter
     grid.filters.push(ColumnFilter {
@@ -22,8 +28,8 @@ pub fn apply_filter(
         condition,
     });
 
-    // Reapply all filters
-    apply_all_filters(grid);
+    // Only the new filter's column is evaluated
+    refresh_view(grid);
 
     Ok(())
 }
@@ -31,106 +37,259 @@ pub fn apply_filter(
 /// Remove filter for a column
 pub fn remove_filter(grid: &mut Grid, column_idx: usize) {
     grid.filters.retain(|f| f.column_idx != column_idx);
-    apply_all_filters(grid);
+    grid.filter_index.masks.remove(&column_idx);
+    refresh_view(grid);
 }
 
 /// Clear all filters
 pub fn clear_filters(grid: &mut Grid) {
     grid.filters.clear();
-    grid.filtered_rows = (0..grid.original_row_count).collect();
+    grid.filter_index.masks.clear();
+    refresh_view(grid);
 }
 
-/// Apply all filters to grid
-fn apply_all_filters(grid: &mut Grid) {
-    if grid.filters.is_empty() {
-        grid.filtered_rows = (0..grid.original_row_count).collect();
-        return;
+/// Recompute `filtered_rows` from the cached filter and sort state
+fn refresh_view(grid: &mut Grid) {
+    let mut index = std::mem::take(&mut grid.filter_index);
+    index.sync(grid);
+    grid.filtered_rows = index.visible_rows(grid);
+    grid.filter_index = index;
+}
+
+/// Cached filter and sort state of a grid
+///
+/// Each active filter owns a bitset of the rows it accepts, keyed by column:
+/// adding a filter evaluates only its column, removing one evaluates nothing,
+/// and the visible rows are the intersection. Columns used for sorting are
+/// ranked once (equal values share a rank), and the sorted permutation of all
+/// rows is kept, so re-filtering a sorted grid is a linear pass and a new sort
+/// starts from the previous ordering. `Grid::get_cell_mut` reports edits
+/// through [`mark_dirty`](Self::mark_dirty).
+#[derive(Debug, Default)]
+pub struct FilterIndex {
+    row_count: usize,
+    masks: HashMap<usize, BitSet>,
+    ranks: HashMap<usize, Vec<u32>>,
+    /// Every row, ordered by `sorted_by`
+    order: Vec<usize>,
+    sorted_by: Vec<(usize, SortOrder)>,
+    dirty: Vec<(usize, usize)>,
+    /// Too many edits to track individually; rebuild on next use
+    stale: bool,
+}
+
+impl FilterIndex {
+    /// Record that the cell at (row, col) may have changed
+    pub fn mark_dirty(&mut self, row: usize, col: usize) {
+        if self.stale || (self.masks.is_empty() && self.ranks.is_empty()) {
+            return;
+        }
+        self.dirty.push((row, col));
+        if self.dirty.len() > self.row_count {
+            self.dirty.clear();
+            self.stale = true;
+        }
     }
 
-    grid.filtered_rows.clear();
+    /// Bring the masks in line with the grid's rows and filters
+    fn sync(&mut self, grid: &Grid) {
+        let row_count = grid.original_row_count;
+        if self.stale || self.row_count != row_count {
+            *self = Self {
+                row_count,
+                ..Self::default()
+            };
+        }
 
-    for row_idx in 0..grid.original_row_count {
-        let mut matches = true;
+        self.masks
+            .retain(|col, _| grid.filters.iter().any(|f| f.column_idx == *col));
+        for (row, col) in std::mem::take(&mut self.dirty) {
+            if let Some(mask) = self.masks.get_mut(&col) {
+                if let Some(filter) = grid.filters.iter().find(|f| f.column_idx == col) {
+                    let matcher = CompiledFilter::new(&filter.condition);
+                    mask.set(row, matcher.matches_row(grid, row, col));
+                }
+            }
+            if self.ranks.remove(&col).is_some() {
+                // Keep `order` as the starting point for the re-sort
+                self.sorted_by.clear();
+            }
+        }
 
         for filter in &grid.filters {
-            if let Some(cell) = grid
-                .rows
-                .get(row_idx)
-                .and_then(|r| r.get(filter.column_idx))
-            {
-                if !matches_filter(&cell.value, &filter.condition) {
-                    matches = false;
-                    break;
+            let col = filter.column_idx;
+            if self.masks.contains_key(&col) {
+                continue;
+            }
+            let matcher = CompiledFilter::new(&filter.condition);
+            let mut mask = BitSet::new(row_count);
+            for row in 0..row_count {
+                if matcher.matches_row(grid, row, col) {
+                    mask.set(row, true);
                 }
-            } else {
-                matches = false;
-                break;
             }
+            self.masks.insert(col, mask);
         }
+    }
+
+    /// Visible rows, in sort order when the grid is sorted
+    fn visible_rows(&mut self, grid: &Grid) -> Vec<usize> {
+        let mut masks = grid
+            .filters
+            .iter()
+            .filter_map(|f| self.masks.get(&f.column_idx));
+        let combined = masks.next().map(|first| {
+            let mut combined = first.clone();
+            for mask in masks {
+                combined.intersect(mask);
+            }
+            combined
+        });
 
-        if matches {
-            grid.filtered_rows.push(row_idx);
+        if grid.sort_order.is_empty() {
+            return match combined {
+                Some(rows) => rows.iter().collect(),
+                None => (0..self.row_count).collect(),
+            };
         }
-    }
 
-    // Reapply sort after filtering
-    if !grid.sort_order.is_empty() {
-        apply_sort(grid);
+        self.sort(grid);
+        match combined {
+            Some(rows) => self
+                .order
+                .iter()
+                .copied()
+                .filter(|&row| rows.contains(row))
+                .collect(),
+            None => self.order.clone(),
+        }
     }
-}
 
-/// Check if cell value matches filter condition
-fn matches_filter(value: &CellValue, condition: &FilterCondition) -> bool {
-    match condition {
-        FilterCondition::Contains(pattern) => {
-            let value_str = value.to_string().to_lowercase();
-            value_str.contains(&pattern.to_lowercase())
-        }
-        FilterCondition::StartsWith(pattern) => {
-            let value_str = value.to_string().to_lowercase();
-            value_str.starts_with(&pattern.to_lowercase())
+    /// Order every row by the grid's sort columns
+    fn sort(&mut self, grid: &Grid) {
+        let wanted: Vec<(usize, SortOrder)> = grid
+            .sort_order
+            .iter()
+            .map(|s| (s.column_idx, s.order))
+            .collect();
+        if wanted == self.sorted_by && self.order.len() == self.row_count {
+            return;
         }
-        FilterCondition::EndsWith(pattern) => {
-            let value_str = value.to_string().to_lowercase();
-            value_str.ends_with(&pattern.to_lowercase())
+
+        for &(col, _) in &wanted {
+            self.ranks
+                .entry(col)
+                .or_insert_with(|| rank_column(grid, col, self.row_count));
         }
-        FilterCondition::Equals(pattern) => {
-            value.to_string().to_lowercase() == pattern.to_lowercase()
+        let keys: Vec<(&[u32], SortOrder)> = wanted
+            .iter()
+            .map(|&(col, order)| (self.ranks[&col].as_slice(), order))
+            .collect();
+
+        // Stable sort of the previous ordering: rows tied on every key keep
+        // their relative order, and mostly sorted input sorts quickly.
+        let mut order = std::mem::take(&mut self.order);
+        if order.len() != self.row_count {
+            order = (0..self.row_count).collect();
         }
-        FilterCondition::NotEquals(pattern) => {
-            value.to_string().to_lowercase() != pattern.to_lowercase()
+        order.sort_by(|&a, &b| {
+            for &(ranks, sort_order) in &keys {
+                let cmp = match sort_order {
+                    SortOrder::Ascending => ranks[a].cmp(&ranks[b]),
+                    SortOrder::Descending => ranks[b].cmp(&ranks[a]),
+                };
+                if cmp != Ordering::Equal {
+                    return cmp;
+                }
+            }
+            Ordering::Equal
+        });
+
+        self.order = order;
+        self.sorted_by = wanted;
+    }
+}
+
+/// Dense sort rank of every row's value in one column
+fn rank_column(grid: &Grid, col: usize, row_count: usize) -> Vec<u32> {
+    let value = |row: usize| grid.get_cell(row, col).map(|c| &c.value);
+    let mut rows: Vec<usize> = (0..row_count).collect();
+    rows.sort_by(|&a, &b| compare_cells(value(a), value(b)));
+
+    let mut ranks = vec![0; row_count];
+    let mut rank = 0;
+    for (i, &row) in rows.iter().enumerate() {
+        if i > 0 && compare_cells(value(rows[i - 1]), value(row)) != Ordering::Equal {
+            rank += 1;
         }
-        FilterCondition::GreaterThan(threshold) => match value {
-            CellValue::Number(n) => *n > *threshold,
-            CellValue::Integer(i) => (*i as f64) > *threshold,
-            _ => false,
-        },
-        FilterCondition::LessThan(threshold) => match value {
-            CellValue::Number(n) => *n < *threshold,
-            CellValue::Integer(i) => (*i as f64) < *threshold,
-            _ => false,
-        },
-        FilterCondition::InRange(min, max) => match value {
-            CellValue::Number(n) => *n >= *min && *n <= *max,
-            CellValue::Integer(i) => {
-                let n = *i as f64;
-                n >= *min && n <= *max
+        ranks[row] = rank;
+    }
+    ranks
+}
+
+/// A filter condition with its patterns lowercased and glob compiled once
+enum CompiledFilter {
+    Contains(String),
+    StartsWith(String),
+    EndsWith(String),
+    Equals(String),
+    NotEquals(String),
+    GreaterThan(f64),
+    LessThan(f64),
+    InRange(f64, f64),
+    IsIn(Vec<String>),
+    Glob(Option<glob::Pattern>),
+}
+
+impl CompiledFilter {
+    fn new(condition: &FilterCondition) -> Self {
+        match condition {
+            FilterCondition::Contains(p) => Self::Contains(p.to_lowercase()),
+            FilterCondition::StartsWith(p) => Self::StartsWith(p.to_lowercase()),
+            FilterCondition::EndsWith(p) => Self::EndsWith(p.to_lowercase()),
+            FilterCondition::Equals(p) => Self::Equals(p.to_lowercase()),
+            FilterCondition::NotEquals(p) => Self::NotEquals(p.to_lowercase()),
+            FilterCondition::GreaterThan(t) => Self::GreaterThan(*t),
+            FilterCondition::LessThan(t) => Self::LessThan(*t),
+            FilterCondition::InRange(min, max) => Self::InRange(*min, *max),
+            FilterCondition::IsIn(values) => {
+                Self::IsIn(values.iter().map(|v| v.to_lowercase()).collect())
             }
-            _ => false,
-        },
-        FilterCondition::IsIn(values) => {
-            let value_str = value.to_string();
-            values
-                .iter()
-                .any(|v| v.to_lowercase() == value_str.to_lowercase())
+            // An invalid pattern matches nothing
+            FilterCondition::Glob(pattern) => Self::Glob(glob::Pattern::new(pattern).ok()),
         }
-        FilterCondition::Glob(pattern) => {
-            // Try to compile and match glob pattern
-            if let Ok(glob_pattern) = glob::Pattern::new(pattern) {
-                glob_pattern.matches(&value.to_string())
-            } else {
-                false
+    }
+
+    /// Rows without a cell in the column never match
+    fn matches_row(&self, grid: &Grid, row: usize, col: usize) -> bool {
+        grid.get_cell(row, col)
+            .is_some_and(|cell| self.matches(&cell.value))
+    }
+
+    /// Check if cell value matches filter condition
+    fn matches(&self, value: &CellValue) -> bool {
+        let lower = || value.to_string().to_lowercase();
+        let number = || match value {
+            CellValue::Number(n) => Some(*n),
+            CellValue::Integer(i) => Some(*i as f64),
+            _ => None,
+        };
+        match self {
+            Self::Contains(pattern) => lower().contains(pattern.as_str()),
+            Self::StartsWith(pattern) => lower().starts_with(pattern.as_str()),
+            Self::EndsWith(pattern) => lower().ends_with(pattern.as_str()),
+            Self::Equals(pattern) => lower() == *pattern,
+            Self::NotEquals(pattern) => lower() != *pattern,
+            Self::GreaterThan(threshold) => number().is_some_and(|n| n > *threshold),
+            Self::LessThan(threshold) => number().is_some_and(|n| n < *threshold),
+            Self::InRange(min, max) => number().is_some_and(|n| n >= *min && n <= *max),
+            Self::IsIn(values) => {
+                let value_str = lower();
+                values.iter().any(|v| *v == value_str)
             }
+            Self::Glob(pattern) => pattern
+                .as_ref()
+                .is_some_and(|p| p.matches(&value.to_string())),
         }
     }
 }
@@ -154,47 +313,19 @@ pub fn sort_by_column(
         },
     });
 
-    apply_sort(grid);
+    refresh_view(grid);
 
     Ok(())
 }
 
-/// Apply sort to filtered rows
-fn apply_sort(grid: &mut Grid) {
-    if grid.sort_order.is_empty() {
-        return;
+/// Compare two (possibly missing) cells; a missing cell sorts first
+fn compare_cells(a: Option<&CellValue>, b: Option<&CellValue>) -> Ordering {
+    match (a, b) {
+        (Some(a), Some(b)) => compare_cell_values(a, b),
+        (Some(_), None) => Ordering::Greater,
+        (None, Some(_)) => Ordering::Less,
+        (None, None) => Ordering::Equal,
     }
-
-    grid.filtered_rows.sort_by(|a, b| {
-        let mut ordering = Ordering::Equal;
-
-        for sort in &grid.sort_order {
-            let a_row = *a;
-            let b_row = *b;
-
-            let a_cell = grid.rows.get(a_row).and_then(|r| r.get(sort.column_idx));
-            let b_cell = grid.rows.get(b_row).and_then(|r| r.get(sort.column_idx));
-
-            let cmp = match (a_cell, b_cell) {
-                (Some(a_c), Some(b_c)) => compare_cell_values(&a_c.value, &b_c.value),
-                (Some(_), None) => Ordering::Greater,
-                (None, Some(_)) => Ordering::Less,
-                (None, None) => Ordering::Equal,
-            };
-
-            ordering = match sort.order {
-                SortOrder::Ascending => cmp,
-                SortOrder::Descending => cmp.reverse(),
-            };
-
-            // If not equal, use this comparison (multi-column sort)
-            if ordering != Ordering::Equal {
-                break;
-            }
-        }
-
-        ordering
-    });
 }
 
 /// Compare two cell values
@@ -592,4 +723,49 @@ mod tests {
         // Should not match anything due to invalid pattern
         assert_eq!(grid.filtered_rows.len(), 0);
     }
+
+    #[test]
+    fn test_filters_track_cell_edits() {
+        let mut grid = create_test_grid();
+
+        apply_filter(&mut grid, 1, FilterCondition::GreaterThan(20.0)).unwrap();
+        assert_eq!(grid.filtered_rows, vec![3, 4]);
+
+        // Editing a filtered column updates that row's bit on the next change
+        grid.get_cell_mut(0, 1).unwrap().value = CellValue::Number(99.0);
+        apply_filter(
+            &mut grid,
+            0,
+            FilterCondition::StartsWith("test".to_string()),
+        )
+        .unwrap();
+        assert_eq!(grid.filtered_rows, vec![0, 3, 4]);
+
+        remove_filter(&mut grid, 1);
+        assert_eq!(grid.filtered_rows, vec![0, 1, 2, 3, 4]);
+    }
+
+    #[test]
+    fn test_sort_reuses_order_across_filters() {
+        let mut grid = create_test_grid();
+        for (row, name) in ["b", "a", "b", "a", "c"].iter().enumerate() {
+            grid.get_cell_mut(row, 0).unwrap().value = CellValue::Text(name.to_string());
+        }
+
+        sort_by_column(&mut grid, 0, true).unwrap();
+        assert_eq!(grid.filtered_rows, vec![1, 3, 0, 2, 4]);
+
+        // Secondary key breaks ties within the primary groups
+        sort_by_column(&mut grid, 1, false).unwrap();
+        assert_eq!(grid.filtered_rows, vec![3, 1, 2, 0, 4]);
+
+        apply_filter(&mut grid, 1, FilterCondition::LessThan(35.0)).unwrap();
+        assert_eq!(grid.filtered_rows, vec![3, 1, 2, 0]);
+
+        // An edit to a sort column re-ranks it
+        grid.get_cell_mut(4, 0).unwrap().value = CellValue::Text("0".to_string());
+        grid.get_cell_mut(4, 1).unwrap().value = CellValue::Number(0.0);
+        clear_filters(&mut grid);
+        assert_eq!(grid.filtered_rows, vec![4, 3, 1, 2, 0]);
+    }
 }
@@ -2,6 +2,7 @@
 //!
 //! Provides Excel-like spreadsheet interface for viewing and editing building data.
 
+pub mod bitset;
 pub mod clipboard;
 pub mod data_source;
 pub mod editor;
@@ -13,6 +14,7 @@ pub mod navigation;
 pub mod render;
 pub mod save_state;
 pub mod search;
+pub mod search_index;
 pub mod types;
 pub mod undo_redo;
 pub mod validation;
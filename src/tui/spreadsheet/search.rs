@@ -1,16 +1,68 @@
 //! Search/find functionality for spreadsheet
 //!
-//! Handles searching across cells and navigating to matches
+//! Handles searching across cells and navigating to matches. Searches run in
+//! bounded steps over a background-built [`SearchIndex`].
 
+use crate::tui::spreadsheet::bitset::BitSet;
 use crate::tui::spreadsheet::data_source::SpreadsheetDataSource;
+use crate::tui::spreadsheet::search_index::{CellTextSnapshot, PendingIndex, SearchIndex};
 use crate::tui::spreadsheet::types::Grid;
+use std::borrow::Cow;
 
 /// Check if a pattern contains glob wildcards
 fn is_glob_pattern(pattern: &str) -> bool {
     pattern.contains('*') || pattern.contains('?')
 }
 
+/// How a search compares cell text (already case-folded as needed)
+#[derive(Debug)]
+enum Matcher {
+    Substring(String),
+    /// `None` when the pattern does not compile: nothing matches
+    Glob(Option<glob::Pattern>),
+}
+
+impl Matcher {
+    fn matches(&self, text: &str) -> bool {
+        match self {
+            Matcher::Substring(query) => text.contains(query.as_str()),
+            Matcher::Glob(pattern) => pattern.as_ref().is_some_and(|p| p.matches(text)),
+        }
+    }
+}
+
+/// A search in progress, advanced by [`SearchState::search_step`]
+#[derive(Debug)]
+struct SearchProgress {
+    matcher: Matcher,
+    /// Original row of each grid row, in display order
+    rows: Vec<usize>,
+    columns: usize,
+    next_row: usize,
+    /// Cells worth checking; `None` means all of them
+    candidates: Option<BitSet>,
+    /// Cells matched so far, kept for query refinement
+    found: BitSet,
+}
+
+/// The last search that ran to completion
+#[derive(Debug)]
+struct CompletedSearch {
+    query: String,
+    case_sensitive: bool,
+    rows: Vec<usize>,
+    found: BitSet,
+}
+
 /// Search state
+///
+/// Searches run incrementally: [`start_search`](Self::start_search) sets one
+/// up and [`search_step`](Self::search_step) scans a bounded number of cells
+/// per call, so matches stream in over several frames and a new query simply
+/// replaces the running search. Cell text comes from the background-built
+/// [`SearchIndex`] when available (see [`build_index`](Self::build_index)),
+/// whose trigrams limit which cells are checked; a query that extends the
+/// previous one only re-checks the previous matches.
 #[derive(Debug)]
 pub struct SearchState {
     pub query: String,
@@ -20,6 +72,10 @@ pub struct SearchState {
     pub match_index: usize,
     pub is_active: bool, // Whether search is currently active
     pub use_glob: bool,  // Whether to use glob pattern matching
+    index: Option<SearchIndex>,
+    pending_index: Option<PendingIndex>,
+    progress: Option<SearchProgress>,
+    completed: Option<CompletedSearch>,
 }
 
 impl SearchState {
@@ -34,16 +90,23 @@ impl SearchState {
             match_index: 0,
             is_active: false,
             use_glob,
+            index: None,
+            pending_index: None,
+            progress: None,
+            completed: None,
         }
     }
 
     /// Update query and detect glob pattern
+    ///
+    /// Cancels any search still in progress.
     pub fn update_query(&mut self, query: String) {
         self.query = query.clone();
         self.use_glob = is_glob_pattern(&query);
         self.matches.clear();
         self.current_match = None;
         self.match_index = 0;
+        self.progress = None;
     }
 
     /// Activate search mode
@@ -56,12 +119,53 @@ impl SearchState {
         self.is_active = false;
     }
 
-    /// Find all matches in grid
-    pub fn find_matches(&mut self, grid: &Grid, data_source: &dyn SpreadsheetDataSource) {
+    /// Start (re)building the search index for `data_source` in the background
+    ///
+    /// Call again after reloading the data source.
+    pub fn build_index(&mut self, data_source: &dyn SpreadsheetDataSource) {
+        self.index = None;
+        self.completed = None;
+        self.pending_index = Some(SearchIndex::spawn(CellTextSnapshot::capture(data_source)));
+    }
+
+    /// Install the background-built index once it is ready
+    ///
+    /// Returns true when an index was installed by this call.
+    pub fn poll_index(&mut self) -> bool {
+        let Some(index) = self.pending_index.as_mut().and_then(PendingIndex::try_take) else {
+            return false;
+        };
+        self.pending_index = None;
+        self.index = Some(index);
+        true
+    }
+
+    /// Refresh one cell of the index after it was edited
+    pub fn cell_changed(
+        &mut self,
+        row: usize,
+        col: usize,
+        data_source: &dyn SpreadsheetDataSource,
+    ) {
+        if let (Some(index), Ok(text)) = (self.index.as_mut(), data_source.cell_display(row, col)) {
+            index.update_cell(row, col, &text);
+        }
+        self.completed = None;
+    }
+
+    /// Whether a started search still has cells to scan
+    pub fn is_searching(&self) -> bool {
+        self.progress.is_some()
+    }
+
+    /// Set up a search for the current query, replacing any running one
+    pub fn start_search(&mut self, grid: &Grid) {
         self.matches.clear();
+        self.current_match = None;
+        self.match_index = 0;
+        self.progress = None;
 
         if self.query.is_empty() {
-            self.current_match = None;
             return;
         }
 
@@ -70,50 +174,135 @@ impl SearchState {
         } else {
             self.query.to_lowercase()
         };
-
-        // Try to compile glob pattern if using glob
-        let glob_pattern = if self.use_glob {
-            glob::Pattern::new(&query).ok()
+        let rows: Vec<usize> = (0..grid.row_count())
+            .map(|row_idx| grid.get_original_row(row_idx).unwrap_or(row_idx))
+            .collect();
+        let columns = grid.column_count();
+        let cell_count = rows.iter().max().map_or(0, |max| (max + 1) * columns);
+
+        // Trigram candidates, when the index matches this grid's layout
+        let folded = self.query.to_lowercase();
+        let literals: Vec<&str> = if !self.use_glob {
+            vec![folded.as_str()]
+        } else if folded.contains('[') {
+            Vec::new()
         } else {
-            None
+            folded.split(['*', '?']).collect()
         };
+        let mut candidates = self
+            .index
+            .as_ref()
+            .filter(|index| index.columns() == columns && index.cell_count() >= cell_count)
+            .and_then(|index| index.candidates(literals));
+
+        // Refinement: a longer query can only match cells the shorter one did
+        if let Some(done) = &self.completed {
+            if !self.use_glob
+                && !is_glob_pattern(&done.query)
+                && done.case_sensitive == self.case_sensitive
+                && query.contains(done.query.as_str())
+                && done.rows == rows
+            {
+                match &mut candidates {
+                    Some(cells) => cells.intersect(&done.found),
+                    None => candidates = Some(done.found.clone()),
+                }
+            }
+        }
 
-        for row_idx in 0..grid.row_count() {
-            let original_row = grid.get_original_row(row_idx).unwrap_or(row_idx);
-            for col_idx in 0..grid.column_count() {
-                if let Ok(cell_value) = data_source.get_cell(original_row, col_idx) {
-                    let cell_str = if self.case_sensitive {
-                        cell_value.to_string()
-                    } else {
-                        cell_value.to_string().to_lowercase()
-                    };
+        let matcher = if self.use_glob {
+            Matcher::Glob(glob::Pattern::new(&query).ok())
+        } else {
+            Matcher::Substring(query)
+        };
+        self.progress = Some(SearchProgress {
+            matcher,
+            rows,
+            columns,
+            next_row: 0,
+            candidates,
+            found: BitSet::new(cell_count),
+        });
+    }
 
-                    let matches = if self.use_glob {
-                        // Use glob pattern matching
-                        if let Some(ref pattern) = glob_pattern {
-                            pattern.matches(&cell_str)
-                        } else {
-                            false
-                        }
-                    } else {
-                        // Simple string contains
-                        cell_str.contains(&query)
+    /// Scan up to `max_cells` more cells of the running search
+    ///
+    /// Matches are appended to `matches` in display order; the first one
+    /// becomes `current_match`. Returns true once the search is complete (or
+    /// none is running).
+    pub fn search_step(
+        &mut self,
+        data_source: &dyn SpreadsheetDataSource,
+        max_cells: usize,
+    ) -> bool {
+        let Some(mut progress) = self.progress.take() else {
+            return true;
+        };
+        let index = self
+            .index
+            .as_ref()
+            .filter(|index| index.columns() == progress.columns);
+
+        let mut scanned = 0;
+        while progress.next_row < progress.rows.len() && scanned < max_cells {
+            let row_idx = progress.next_row;
+            let original_row = progress.rows[row_idx];
+            progress.next_row += 1;
+
+            for col_idx in 0..progress.columns {
+                let cell_id = original_row * progress.columns + col_idx;
+                if let Some(candidates) = &progress.candidates {
+                    if !candidates.contains(cell_id) {
+                        continue;
+                    }
+                }
+                scanned += 1;
+
+                let cell_str: Cow<'_, str> =
+                    match index.and_then(|i| i.text(original_row, col_idx, self.case_sensitive)) {
+                        Some(text) => Cow::Borrowed(text),
+                        None => match data_source.cell_display(original_row, col_idx) {
+                            Ok(text) if self.case_sensitive => text,
+                            Ok(text) => text.to_lowercase().into(),
+                            Err(_) => continue,
+                        },
                     };
 
-                    if matches {
-                        self.matches.push((row_idx, col_idx));
+                if progress.matcher.matches(&cell_str) {
+                    progress.found.insert(cell_id);
+                    if self.matches.is_empty() {
+                        self.match_index = 0;
+                        self.current_match = Some((row_idx, col_idx));
                     }
+                    self.matches.push((row_idx, col_idx));
                 }
             }
         }
 
-        if !self.matches.is_empty() {
-            self.match_index = 0;
-            self.current_match = Some(self.matches[0]);
-        } else {
-            self.current_match = None;
-            self.match_index = 0;
+        if progress.next_row < progress.rows.len() {
+            self.progress = Some(progress);
+            return false;
         }
+        self.completed = Some(CompletedSearch {
+            query: match progress.matcher {
+                Matcher::Substring(query) => query,
+                Matcher::Glob(_) => self.query.clone(),
+            },
+            case_sensitive: self.case_sensitive,
+            rows: progress.rows,
+            found: progress.found,
+        });
+        true
+    }
+
+    /// Find all matches in grid
+    ///
+    /// Runs the whole search at once; interactive callers use
+    /// [`start_search`](Self::start_search) and
+    /// [`search_step`](Self::search_step) instead.
+    pub fn find_matches(&mut self, grid: &Grid, data_source: &dyn SpreadsheetDataSource) {
+        self.start_search(grid);
+        self.search_step(data_source, usize::MAX);
     }
 
     /// Navigate to next match
@@ -417,4 +606,46 @@ mod tests {
         search.deactivate();
         assert!(!search.is_active);
     }
+
+    #[test]
+    fn test_indexed_search_streams_and_refines() {
+        let grid = create_test_grid();
+        let data_source = MockDataSource {
+            data: ["AHU-1", "Boiler", "ahu-2", "Valve", "AHU-12"]
+                .iter()
+                .map(|s| vec![s.to_string()])
+                .collect(),
+        };
+        let mut search = SearchState::new("ahu".to_string(), false);
+        search.build_index(&data_source);
+        let deadline = std::time::Instant::now() + std::time::Duration::from_secs(5);
+        while !search.poll_index() {
+            assert!(
+                std::time::Instant::now() < deadline,
+                "index build timed out"
+            );
+            std::thread::yield_now();
+        }
+
+        search.start_search(&grid);
+        assert!(!search.search_step(&data_source, 1));
+        assert_eq!(search.matches, vec![(0, 0)]);
+        assert_eq!(search.current_match, Some((0, 0)));
+        while !search.search_step(&data_source, 1) {}
+        assert_eq!(search.matches, vec![(0, 0), (2, 0), (4, 0)]);
+
+        // Typing more narrows the previous matches
+        search.update_query("ahu-1".to_string());
+        search.start_search(&grid);
+        assert!(search.search_step(&data_source, 2));
+        assert_eq!(search.matches, vec![(0, 0), (4, 0)]);
+
+        // A changed query cancels the running search
+        search.update_query("valve".to_string());
+        search.start_search(&grid);
+        search.update_query("boiler".to_string());
+        assert!(!search.is_searching());
+        search.find_matches(&grid, &data_source);
+        assert_eq!(search.matches, vec![(1, 0)]);
+    }
 }
@@ -0,0 +1,231 @@
+//! Trigram index over the display text of a sheet
+//!
+//! The UI thread copies every cell's display text into one arena
+//! ([`CellTextSnapshot::capture`], a borrow-and-copy per cell thanks to the
+//! data sources' cell caches); lowercasing and trigram extraction then run on a
+//! background thread ([`SearchIndex::spawn`]). Data sources are `Send + Sync`,
+//! but search only borrows one from the editor, which keeps editing it while
+//! the index builds; the copy gives the thread owned text and a consistent
+//! view. Queries of three or more bytes only verify cells holding every
+//! trigram of the query.
+
+use crate::tui::spreadsheet::bitset::BitSet;
+use crate::tui::spreadsheet::data_source::SpreadsheetDataSource;
+use std::collections::HashMap;
+use std::sync::mpsc::{self, Receiver, TryRecvError};
+use std::thread;
+
+type Span = (u32, u32);
+
+/// Display text of every cell, copied on the UI thread
+#[derive(Debug, Default)]
+pub struct CellTextSnapshot {
+    columns: usize,
+    text: String,
+    spans: Vec<Span>,
+}
+
+impl CellTextSnapshot {
+    /// Copy the display text of every cell of `source`, row-major
+    pub fn capture(source: &dyn SpreadsheetDataSource) -> Self {
+        let columns = source.columns().len();
+        let mut snapshot = Self {
+            columns,
+            ..Self::default()
+        };
+        for row in 0..source.row_count() {
+            for col in 0..columns {
+                let text = source.cell_display(row, col).unwrap_or_default();
+                let span = push_text(&mut snapshot.text, &text);
+                snapshot.spans.push(span);
+            }
+        }
+        snapshot
+    }
+}
+
+fn push_text(arena: &mut String, text: &str) -> Span {
+    let start = arena.len() as u32;
+    arena.push_str(text);
+    (start, text.len() as u32)
+}
+
+fn span_text(arena: &str, (start, len): Span) -> &str {
+    &arena[start as usize..(start + len) as usize]
+}
+
+/// Lowercased cell text plus a trigram → cell posting index
+#[derive(Debug, Default)]
+pub struct SearchIndex {
+    columns: usize,
+    raw: String,
+    raw_spans: Vec<Span>,
+    lower: String,
+    lower_spans: Vec<Span>,
+    /// Cell ids containing each byte trigram of the lowercased text. Lists
+    /// may hold stale ids after [`update_cell`](Self::update_cell); matches
+    /// are always verified against the text.
+    trigrams: HashMap<[u8; 3], Vec<u32>>,
+}
+
+impl SearchIndex {
+    pub fn build(snapshot: CellTextSnapshot) -> Self {
+        let mut index = Self {
+            columns: snapshot.columns,
+            raw_spans: Vec::with_capacity(snapshot.spans.len()),
+            lower_spans: Vec::with_capacity(snapshot.spans.len()),
+            ..Self::default()
+        };
+        for (id, &span) in snapshot.spans.iter().enumerate() {
+            index.add_cell(id as u32, span_text(&snapshot.text, span));
+        }
+        index.raw = snapshot.text;
+        index.raw_spans = snapshot.spans;
+        index
+    }
+
+    /// Build the index on a background thread
+    pub fn spawn(snapshot: CellTextSnapshot) -> PendingIndex {
+        let (tx, rx) = mpsc::channel();
+        thread::spawn(move || {
+            // The receiver is gone if the sheet was closed meanwhile
+            let _ = tx.send(Self::build(snapshot));
+        });
+        PendingIndex { rx }
+    }
+
+    pub fn columns(&self) -> usize {
+        self.columns
+    }
+
+    pub fn cell_count(&self) -> usize {
+        self.lower_spans.len()
+    }
+
+    fn cell_id(&self, row: usize, col: usize) -> Option<usize> {
+        let id = row.checked_mul(self.columns)? + col;
+        (col < self.columns && id < self.cell_count()).then_some(id)
+    }
+
+    /// Cell text, lowercased unless `case_sensitive`
+    pub fn text(&self, row: usize, col: usize, case_sensitive: bool) -> Option<&str> {
+        let id = self.cell_id(row, col)?;
+        Some(if case_sensitive {
+            span_text(&self.raw, self.raw_spans[id])
+        } else {
+            span_text(&self.lower, self.lower_spans[id])
+        })
+    }
+
+    /// Replace one cell's text after an edit (the old text stays in the arena)
+    pub fn update_cell(&mut self, row: usize, col: usize, text: &str) {
+        let Some(id) = self.cell_id(row, col) else {
+            return;
+        };
+        self.raw_spans[id] = push_text(&mut self.raw, text);
+        let lower = text.to_lowercase();
+        let span = push_text(&mut self.lower, &lower);
+        self.lower_spans[id] = span;
+        self.index_trigrams(id as u32, span);
+    }
+
+    fn add_cell(&mut self, id: u32, text: &str) {
+        let lower = text.to_lowercase();
+        let span = push_text(&mut self.lower, &lower);
+        self.lower_spans.push(span);
+        self.index_trigrams(id, span);
+    }
+
+    fn index_trigrams(&mut self, id: u32, span: Span) {
+        let bytes = span_text(&self.lower, span).as_bytes();
+        for window in bytes.windows(3) {
+            let postings = self
+                .trigrams
+                .entry([window[0], window[1], window[2]])
+                .or_default();
+            if postings.last() != Some(&id) {
+                postings.push(id);
+            }
+        }
+    }
+
+    /// Cells that can contain all of `literals` (already lowercased), or
+    /// `None` when no literal is long enough to narrow the search
+    pub fn candidates<'a>(&self, literals: impl IntoIterator<Item = &'a str>) -> Option<BitSet> {
+        let mut lists: Vec<&[u32]> = Vec::new();
+        for literal in literals {
+            for window in literal.as_bytes().windows(3) {
+                match self.trigrams.get(&[window[0], window[1], window[2]]) {
+                    Some(postings) => lists.push(postings),
+                    None => return Some(BitSet::new(self.cell_count())),
+                }
+            }
+        }
+        lists.sort_by_key(|postings| postings.len());
+        let (first, rest) = lists.split_first()?;
+
+        let mut cells = BitSet::new(self.cell_count());
+        for &id in first.iter() {
+            cells.insert(id as usize);
+        }
+        for postings in rest {
+            let mut next = BitSet::new(self.cell_count());
+            for &id in postings.iter() {
+                next.insert(id as usize);
+            }
+            cells.intersect(&next);
+        }
+        Some(cells)
+    }
+}
+
+/// Index being built in the background
+#[derive(Debug)]
+pub struct PendingIndex {
+    rx: Receiver<SearchIndex>,
+}
+
+impl PendingIndex {
+    /// The finished index, once; `None` while building or if the build died
+    pub fn try_take(&mut self) -> Option<SearchIndex> {
+        match self.rx.try_recv() {
+            Ok(index) => Some(index),
+            Err(TryRecvError::Empty | TryRecvError::Disconnected) => None,
+        }
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    fn index(cells: &[&str], columns: usize) -> SearchIndex {
+        let mut snapshot = CellTextSnapshot {
+            columns,
+            ..CellTextSnapshot::default()
+        };
+        for cell in cells {
+            let span = push_text(&mut snapshot.text, cell);
+            snapshot.spans.push(span);
+        }
+        SearchIndex::build(snapshot)
+    }
+
+    #[test]
+    fn trigrams_narrow_candidates() {
+        let mut index = index(&["AHU-1", "Boiler", "ahu-2", "Valve"], 2);
+        assert_eq!(index.text(1, 0, false), Some("ahu-2"));
+        assert_eq!(index.text(0, 1, true), Some("Boiler"));
+        assert_eq!(index.text(2, 0, false), None);
+
+        let cells = index.candidates(["ahu"]).unwrap();
+        assert!(cells.contains(0) && cells.contains(2));
+        assert!(!cells.contains(1) && !cells.contains(3));
+        assert!(index.candidates(["zzz"]).unwrap() == BitSet::new(4));
+        assert!(index.candidates(["ah"]).is_none());
+
+        index.update_cell(1, 1, "AHU-3");
+        assert!(index.candidates(["ahu-"]).unwrap().contains(3));
+        assert_eq!(index.text(1, 1, false), Some("ahu-3"));
+    }
+}
@@ -2,6 +2,7 @@
 //!
 //! Defines cell values, column definitions, validation rules, and grid structures.
 
+use super::filter_sort::FilterIndex;
 use serde::{Deserialize, Serialize};
 use std::fmt;
 
@@ -162,6 +163,7 @@ pub struct Grid {
     pub original_row_count: usize, // Original row count before filtering
     pub column_visibility: std::collections::HashSet<usize>,
     pub address_modal: Option<String>, // Full address path to show in modal // Hidden column indices
+    pub filter_index: FilterIndex,     // Cached filter/sort state, see filter_sort
 }
 
 impl Grid {
@@ -192,6 +194,7 @@ impl Grid {
             original_row_count,
             column_visibility: std::collections::HashSet::new(), // All columns visible by default
             address_modal: None,
+            filter_index: FilterIndex::default(),
         }
     }
 
@@ -227,6 +230,7 @@ impl Grid {
     }
 
     pub fn get_cell_mut(&mut self, row: usize, col: usize) -> Option<&mut Cell> {
+        self.filter_index.mark_dirty(row, col);
         self.rows.get_mut(row)?.get_mut(col)
     }
 
@@ -1,8 +1,10 @@
 //! Post-ingest validation of the canonical `Building` model.
 
-use crate::core::Building;
+use crate::core::edits::IdKind;
+use crate::core::{Anchor, Building, Floor};
 use crate::ifc::mapping::COORD_BUILDING_LOCAL;
 use super::rules::{ValidationResult, ValidationSeverity};
+use std::collections::HashSet;
 use std::sync::atomic::{AtomicBool, Ordering};
 
 /// Global flag controlling whether address validation checks reserved system prefixes strictly (as errors) or leniently (as warnings).
@@ -63,7 +65,103 @@ impl BuildingValidationReport {
 /// Validate structural and semantic invariants of a building after any ingest path.
 pub fn validate_building(building: &Building) -> BuildingValidationReport {
     let mut report = BuildingValidationReport::default();
+    let no_clean_floors = |_: IdKind, _: &str| false;
+    let mut seen = Seen::new(&no_clean_floors);
+    validate_header(&mut report, building, &mut seen);
+    for floor in &building.floors {
+        validate_floor(&mut report, floor, &mut seen);
+    }
+    validate_poses(&mut report, &seen);
+    report
+}
+
+/// Validate building-level fields plus only the floors flagged in `edited`
+/// (parallel to `building.floors`).
+///
+/// Used by incremental saves: floors that were not edited since they last
+/// passed validation are skipped, and `clean` answers whether one of those
+/// floors declares a given id/address, so duplicate-id errors and pose-target
+/// resolution across floors match [`validate_building`]. Warnings and infos
+/// are only reported for the validated parts.
+pub(crate) fn validate_building_changes(
+    building: &Building,
+    edited: &[bool],
+    clean: &dyn Fn(IdKind, &str) -> bool,
+) -> BuildingValidationReport {
+    let mut report = BuildingValidationReport::default();
+    let mut seen = Seen::new(clean);
+    validate_header(&mut report, building, &mut seen);
+    for (floor, _) in building.floors.iter().zip(edited).filter(|(_, e)| **e) {
+        validate_floor(&mut report, floor, &mut seen);
+    }
+    validate_poses(&mut report, &seen);
+    report
+}
+
+/// Ids and addresses registered so far, plus anchors whose poses are checked last.
+struct Seen<'a> {
+    rooms: HashSet<String>,
+    equipment: HashSet<String>,
+    anchors: HashSet<String>,
+    addresses: HashSet<String>,
+    pose_sources: Vec<&'a Anchor>,
+    /// Ids declared by floors that are not being revalidated.
+    clean: &'a dyn Fn(IdKind, &str) -> bool,
+}
+
+impl<'a> Seen<'a> {
+    fn new(clean: &'a dyn Fn(IdKind, &str) -> bool) -> Self {
+        Self {
+            rooms: HashSet::new(),
+            equipment: HashSet::new(),
+            anchors: HashSet::new(),
+            addresses: HashSet::new(),
+            pose_sources: Vec::new(),
+            clean,
+        }
+    }
+
+    fn set(&mut self, kind: IdKind) -> &mut HashSet<String> {
+        match kind {
+            IdKind::Room => &mut self.rooms,
+            IdKind::Equipment => &mut self.equipment,
+            IdKind::Anchor => &mut self.anchors,
+            IdKind::Address => &mut self.addresses,
+        }
+    }
+
+    /// Register `id`; false when it was already declared.
+    fn insert(&mut self, kind: IdKind, id: &str) -> bool {
+        let fresh = self.set(kind).insert(id.to_string());
+        fresh && !(self.clean)(kind, id)
+    }
+
+    fn address(&mut self, address: &Option<crate::core::domain::ArxAddress>) {
+        if let Some(ref addr) = address {
+            self.addresses.insert(addr.path.clone());
+        }
+    }
+
+    fn anchor(&mut self, report: &mut BuildingValidationReport, anchor: &'a Anchor, field: &str) {
+        self.pose_sources.push(anchor);
+        validate_address(report, &anchor.address, field);
+        self.address(&anchor.address);
+        if !self.insert(IdKind::Anchor, &anchor.id) {
+            report.results.push(ValidationResult {
+                rule_id: "anchor.id.duplicate".into(),
+                message: format!("Duplicate anchor id {}", anchor.id),
+                severity: ValidationSeverity::Error,
+                field: Some(anchor.id.clone()),
+            });
+        }
+    }
+}
 
+fn validate_header<'a>(
+    report: &mut BuildingValidationReport,
+    building: &'a Building,
+    seen: &mut Seen<'a>,
+) {
     if building.name.trim().is_empty() {
         report.results.push(ValidationResult {
             rule_id: "building.name.required".into(),
@@ -109,222 +207,171 @@ pub fn validate_building(building: &Building) -> BuildingValidationReport {
         });
     }
 
-    let mut seen_room_ids = std::collections::HashSet::new();
-    let mut seen_eq_ids = std::collections::HashSet::new();
-    let mut seen_anchor_ids = std::collections::HashSet::new();
-    let mut all_valid_addresses = std::collections::HashSet::new();
-    let mut all_anchors = Vec::new();
-
     // Validate Building address
-    validate_address(&mut report, &building.address, "building.address");
-    if let Some(ref addr) = building.address {
-        all_valid_addresses.insert(addr.path.clone());
-    }
+    validate_address(report, &building.address, "building.address");
+    seen.address(&building.address);
 
     // Validate Building-level anchors
     for anchor in &building.anchors {
-        all_anchors.push(anchor);
-        validate_address(&mut report, &anchor.address, &format!("building.anchor[{}].address", anchor.name));
-        if let Some(ref addr) = anchor.address {
-            all_valid_addresses.insert(addr.path.clone());
-        }
-        if !seen_anchor_ids.insert(anchor.id.clone()) {
-            report.results.push(ValidationResult {
-                rule_id: "anchor.id.duplicate".into(),
-                message: format!("Duplicate anchor id {}", anchor.id),
-                severity: ValidationSeverity::Error,
-                field: Some(anchor.id.clone()),
-            });
-        }
+        seen.anchor(report, anchor, &format!("building.anchor[{}].address", anchor.name));
     }
+}
 
-    for floor in &building.floors {
-        if floor.name.trim().is_empty() {
-            report.results.push(ValidationResult {
-                rule_id: "floor.name.required".into(),
-                message: "Floor name must not be empty".into(),
-                severity: ValidationSeverity::Error,
-                field: Some(format!("floor[{}].name", floor.level)),
-            });
-        }
+fn validate_floor<'a>(report: &mut BuildingValidationReport, floor: &'a Floor, seen: &mut Seen<'a>) {
+    if floor.name.trim().is_empty() {
+        report.results.push(ValidationResult {
+            rule_id: "floor.name.required".into(),
+            message: "Floor name must not be empty".into(),
+            severity: ValidationSeverity::Error,
+            field: Some(format!("floor[{}].name", floor.level)),
+        });
+    }
+
+    validate_address(report, &floor.address, &format!("floor[{}].address", floor.name));
+    seen.address(&floor.address);
+
+    // Validate Floor-level anchors
+    for anchor in &floor.anchors {
+        seen.anchor(report, anchor, &format!("floor[{}].anchor[{}].address", floor.name, anchor.name));
+    }
 
-        validate_address(&mut report, &floor.address, &format!("floor[{}].address", floor.name));
-        if let Some(ref addr) = floor.address {
-            all_valid_addresses.insert(addr.path.clone());
+    if floor.wings.is_empty() && floor.equipment.is_empty() {
+        report.results.push(ValidationResult {
+            rule_id: "floor.empty".into(),
+            message: format!("Floor '{}' has no wings or equipment", floor.name),
+            severity: ValidationSeverity::Info,
+            field: Some(format!("floor[{}]", floor.name)),
+        });
+    }
+
+    for wing in &floor.wings {
+        validate_address(report, &wing.address, &format!("floor[{}]/wing[{}].address", floor.name, wing.name));
+        seen.address(&wing.address);
+
+        // Validate Wing-level anchors
+        for anchor in &wing.anchors {
+            seen.anchor(report, anchor, &format!("floor[{}]/wing[{}].anchor[{}].address", floor.name, wing.name, anchor.name));
         }
 
-        // Validate Floor-level anchors
-        for anchor in &floor.anchors {
-            all_anchors.push(anchor);
-            validate_address(&mut report, &anchor.address, &format!("floor[{}].anchor[{}].address", floor.name, anchor.name));
-            if let Some(ref addr) = anchor.address {
-                all_valid_addresses.insert(addr.path.clone());
+        for room in &wing.rooms {
+            if room.name.trim().is_empty() {
+                report.results.push(ValidationResult {
+                    rule_id: "room.name.required".into(),
+                    message: "Room name must not be empty".into(),
+                    severity: ValidationSeverity::Error,
+                    field: Some(format!("{}/{}/room", floor.name, wing.name)),
+                });
             }
-            if !seen_anchor_ids.insert(anchor.id.clone()) {
+
+            if !seen.insert(IdKind::Room, &room.id) {
                 report.results.push(ValidationResult {
-                    rule_id: "anchor.id.duplicate".into(),
-                    message: format!("Duplicate anchor id {}", anchor.id),
+                    rule_id: "room.id.duplicate".into(),
+                    message: format!("Duplicate room id {}", room.id),
                     severity: ValidationSeverity::Error,
-                    field: Some(anchor.id.clone()),
+                    field: Some(room.id.clone()),
                 });
             }
-        }
 
-        if floor.wings.is_empty() && floor.equipment.is_empty() {
-            report.results.push(ValidationResult {
-                rule_id: "floor.empty".into(),
-                message: format!("Floor '{}' has no wings or equipment", floor.name),
-                severity: ValidationSeverity::Info,
-                field: Some(format!("floor[{}]", floor.name)),
-            });
-        }
+            validate_address(report, &room.address, &format!("room[{}].address", room.name));
+            seen.address(&room.address);
 
-        for wing in &floor.wings {
-            validate_address(&mut report, &wing.address, &format!("floor[{}]/wing[{}].address", floor.name, wing.name));
-            if let Some(ref addr) = wing.address {
-                all_valid_addresses.insert(addr.path.clone());
+            // Validate Room-level anchors
+            for anchor in &room.anchors {
+                seen.anchor(report, anchor, &format!("room[{}].anchor[{}].address", room.name, anchor.name));
             }
 
-            // Validate Wing-level anchors
-            for anchor in &wing.anchors {
-                all_anchors.push(anchor);
-                validate_address(&mut report, &anchor.address, &format!("floor[{}]/wing[{}].anchor[{}].address", floor.name, wing.name, anchor.name));
-                if let Some(ref addr) = anchor.address {
-                    all_valid_addresses.insert(addr.path.clone());
-                }
-                if !seen_anchor_ids.insert(anchor.id.clone()) {
+            if let Some(ref gid) = room.ifc_global_id {
+                if !(gid.len() == 22 || gid.is_empty()) && gid.len() != 22 {
                     report.results.push(ValidationResult {
-                        rule_id: "anchor.id.duplicate".into(),
-                        message: format!("Duplicate anchor id {}", anchor.id),
-                        severity: ValidationSeverity::Error,
-                        field: Some(anchor.id.clone()),
+                        rule_id: "room.ifc_global_id.format".into(),
+                        message: format!(
+                            "Room '{}' ifc_global_id length {} (expected 22 for IFC GlobalId)",
+                            room.name,
+                            gid.len()
+                        ),
+                        severity: ValidationSeverity::Warning,
+                        field: Some(format!("room[{}].ifc_global_id", room.name)),
                     });
                 }
             }
 
-            for room in &wing.rooms {
-                if room.name.trim().is_empty() {
-                    report.results.push(ValidationResult {
-                        rule_id: "room.name.required".into(),
-                        message: "Room name must not be empty".into(),
-                        severity: ValidationSeverity::Error,
-                        field: Some(format!("{}/{}/room", floor.name, wing.name)),
-                    });
-                }
-
-                if !seen_room_ids.insert(room.id.clone()) {
-                    report.results.push(ValidationResult {
-                        rule_id: "room.id.duplicate".into(),
-                        message: format!("Duplicate room id {}", room.id),
-                        severity: ValidationSeverity::Error,
-                        field: Some(room.id.clone()),
-                    });
-                }
-
-                validate_address(&mut report, &room.address, &format!("room[{}].address", room.name));
-                if let Some(ref addr) = room.address {
-                    all_valid_addresses.insert(addr.path.clone());
-                }
-
-                // Validate Room-level anchors
-                for anchor in &room.anchors {
-                    all_anchors.push(anchor);
-                    validate_address(&mut report, &anchor.address, &format!("room[{}].anchor[{}].address", room.name, anchor.name));
-                    if let Some(ref addr) = anchor.address {
-                        all_valid_addresses.insert(addr.path.clone());
-                    }
-                    if !seen_anchor_ids.insert(anchor.id.clone()) {
-                        report.results.push(ValidationResult {
-                            rule_id: "anchor.id.duplicate".into(),
-                            message: format!("Duplicate anchor id {}", anchor.id),
-                            severity: ValidationSeverity::Error,
-                            field: Some(anchor.id.clone()),
-                        });
-                    }
-                }
+            let d = &room.spatial_properties.dimensions;
+            if d.width < 0.0 || d.depth < 0.0 || d.height < 0.0 {
+                report.results.push(ValidationResult {
+                    rule_id: "room.dimensions.negative".into(),
+                    message: format!("Room '{}' has negative dimensions", room.name),
+                    severity: ValidationSeverity::Error,
+                    field: Some(format!("room[{}].dimensions", room.name)),
+                });
+            }
 
-                if let Some(ref gid) = room.ifc_global_id {
-                    if !(gid.len() == 22 || gid.is_empty()) && gid.len() != 22 {
-                        report.results.push(ValidationResult {
-                            rule_id: "room.ifc_global_id.format".into(),
-                            message: format!(
-                                "Room '{}' ifc_global_id length {} (expected 22 for IFC GlobalId)",
-                                room.name,
-                                gid.len()
-                            ),
-                            severity: ValidationSeverity::Warning,
-                            field: Some(format!("room[{}].ifc_global_id", room.name)),
-                        });
-                    }
-                }
+            if !room.spatial_properties.bounding_box.is_valid() {
+                report.results.push(ValidationResult {
+                    rule_id: "room.bbox.invalid".into(),
+                    message: format!(
+                        "Room '{}' has invalid bounding box (min > max)",
+                        room.name
+                    ),
+                    severity: ValidationSeverity::Warning,
+                    field: Some(format!("room[{}].bounding_box", room.name)),
+                });
+            }
 
-                let d = &room.spatial_properties.dimensions;
-                if d.width < 0.0 || d.depth < 0.0 || d.height < 0.0 {
-                    report.results.push(ValidationResult {
-                        rule_id: "room.dimensions.negative".into(),
-                        message: format!("Room '{}' has negative dimensions", room.name),
-                        severity: ValidationSeverity::Error,
-                        field: Some(format!("room[{}].dimensions", room.name)),
-                    });
-                }
+            if let Some(ref enr) = room.lidar_enrichment {
+                validate_enrichment(
+                    report,
+                    &format!("room[{}]", room.name),
+                    enr.confidence_score,
+                    enr.point_count,
+                );
+            }
 
-                if !room.spatial_properties.bounding_box.is_valid() {
+            for k in room.properties.keys() {
+                if k.contains("Pset_Arx") && k.matches("Pset_").count() > 1 {
                     report.results.push(ValidationResult {
-                        rule_id: "room.bbox.invalid".into(),
+                        rule_id: "props.double_prefix".into(),
                         message: format!(
-                            "Room '{}' has invalid bounding box (min > max)",
-                            room.name
+                            "Room '{}' has double-prefixed property key '{}'",
+                            room.name, k
                         ),
                         severity: ValidationSeverity::Warning,
-                        field: Some(format!("room[{}].bounding_box", room.name)),
+                        field: Some(k.clone()),
                     });
                 }
-
-                if let Some(ref enr) = room.lidar_enrichment {
-                    validate_enrichment(
-                        &mut report,
-                        &format!("room[{}]", room.name),
-                        enr.confidence_score,
-                        enr.point_count,
-                    );
-                }
-
-                for k in room.properties.keys() {
-                    if k.contains("Pset_Arx") && k.matches("Pset_").count() > 1 {
-                        report.results.push(ValidationResult {
-                            rule_id: "props.double_prefix".into(),
-                            message: format!(
-                                "Room '{}' has double-prefixed property key '{}'",
-                                room.name, k
-                            ),
-                            severity: ValidationSeverity::Warning,
-                            field: Some(k.clone()),
-                        });
-                    }
-                }
-
-                for eq in &room.equipment {
-                    validate_equipment(&mut report, eq, &mut seen_eq_ids, &room.name, &mut all_valid_addresses);
-                }
             }
-            for eq in &wing.equipment {
-                validate_equipment(&mut report, eq, &mut seen_eq_ids, &wing.name, &mut all_valid_addresses);
+
+            for eq in &room.equipment {
+                validate_equipment(report, eq, seen, &room.name);
             }
         }
-        for eq in &floor.equipment {
-            validate_equipment(&mut report, eq, &mut seen_eq_ids, &floor.name, &mut all_valid_addresses);
+        for eq in &wing.equipment {
+            validate_equipment(report, eq, seen, &wing.name);
         }
     }
+    for eq in &floor.equipment {
+        validate_equipment(report, eq, seen, &floor.name);
+    }
+}
 
-    // Validate Relative Poses target resolution
-    for anchor in all_anchors {
+// Validate Relative Poses target resolution
+fn validate_poses(report: &mut BuildingValidationReport, seen: &Seen<'_>) {
+    let declared = |kind, id: &str| {
+        let local = match kind {
+            IdKind::Room => &seen.rooms,
+            IdKind::Equipment => &seen.equipment,
+            IdKind::Anchor => &seen.anchors,
+            IdKind::Address => &seen.addresses,
+        };
+        local.contains(id) || (seen.clean)(kind, id)
+    };
+    for anchor in &seen.pose_sources {
         for pose in &anchor.relative_poses {
             let target_exists = if pose.target_id.starts_with('/') {
-                all_valid_addresses.contains(&pose.target_id)
+                declared(IdKind::Address, &pose.target_id)
             } else {
-                seen_anchor_ids.contains(&pose.target_id)
-                    || seen_eq_ids.contains(&pose.target_id)
-                    || seen_room_ids.contains(&pose.target_id)
+                declared(IdKind::Anchor, &pose.target_id)
+                    || declared(IdKind::Equipment, &pose.target_id)
+                    || declared(IdKind::Room, &pose.target_id)
             };
 
             if !target_exists {
@@ -340,8 +387,6 @@ pub fn validate_building(building: &Building) -> BuildingValidationReport {
             }
         }
     }
-
-    report
 }
 
 fn validate_address(
@@ -376,9 +421,8 @@ fn validate_address(
 fn validate_equipment(
     report: &mut BuildingValidationReport,
     eq: &crate::core::Equipment,
-    seen_eq_ids: &mut std::collections::HashSet<String>,
+    seen: &mut Seen<'_>,
     context: &str,
-    all_valid_addresses: &mut std::collections::HashSet<String>,
 ) {
     if eq.name.trim().is_empty() {
         report.results.push(ValidationResult {
@@ -388,7 +432,7 @@ fn validate_equipment(
             field: Some(format!("{}/equipment", context)),
         });
     }
-    if !seen_eq_ids.insert(eq.id.clone()) {
+    if !seen.insert(IdKind::Equipment, &eq.id) {
         report.results.push(ValidationResult {
             rule_id: "equipment.id.duplicate".into(),
             message: format!("Duplicate equipment id {}", eq.id),
@@ -398,9 +442,7 @@ fn validate_equipment(
     }
 
     validate_address(report, &eq.address, &format!("equipment[{}].address", eq.name));
-    if let Some(ref addr) = eq.address {
-        all_valid_addresses.insert(addr.path.clone());
-    }
+    seen.address(&eq.address);
 
     if let Some(ref enr) = eq.lidar_enrichment {
         validate_enrichment(
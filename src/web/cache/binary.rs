@@ -4,14 +4,15 @@
 //! metadata Warm Cache budget. Integrates with the Anchor's type-safe MapRef enum.
 
 use crate::core::MapRef;
-use std::collections::HashMap;
+use super::lru::LruCache;
+use std::sync::Arc;
 
 /// Manages loading and caching of heavy binary spatial descriptors (.map).
 pub struct BinaryAssetCache {
-    /// In-memory or OPFS binary cache maps, keyed by serialized MapRef string.
-    pub assets: HashMap<String, Vec<u8>>,
-    /// Access tracking (LRU) for asset eviction.
-    pub lru_keys: Vec<String>,
+    /// In-memory or OPFS binary cache maps, keyed by serialized MapRef string,
+    /// in O(1) LRU order. Buffers are shared, so hits hand out a reference count
+    /// rather than a copy of the map.
+    pub assets: LruCache<Arc<[u8]>>,
     /// Limit for binary assets (200MB).
     pub max_budget_bytes: usize,
     /// Current calculated footprint in bytes.
@@ -36,8 +37,7 @@ impl BinaryAssetCache {
     /// Initialize the Binary Asset Cache with a 200MB budget.
     pub fn new() -> Self {
         Self {
-            assets: HashMap::new(),
-            lru_keys: Vec::new(),
+            assets: LruCache::new(),
             max_budget_bytes: 200 * 1024 * 1024, // 200MB
             current_footprint_bytes: 0,
             hits: 0,
@@ -48,16 +48,11 @@ impl BinaryAssetCache {
     }
 
     /// Hydrate a binary SLAM/feature map on-demand based on its MapRef source.
-    pub fn load_asset(&mut self, map_ref: &MapRef) -> Result<Vec<u8>, String> {
+    pub fn load_asset(&mut self, map_ref: &MapRef) -> Result<Arc<[u8]>, String> {
         let key = map_ref.to_string();
 
         if let Some(data) = self.assets.get(&key) {
             self.hits += 1;
-            // Update LRU queue
-            if let Some(pos) = self.lru_keys.iter().position(|x| x == &key) {
-                self.lru_keys.remove(pos);
-            }
-            self.lru_keys.push(key);
             return Ok(data.clone());
         }
 
@@ -111,28 +106,29 @@ impl BinaryAssetCache {
         self.last_latency_ms = (end_time - start_time).max(0) as u64;
 
         // Cache the newly fetched binary asset
-        self.insert_asset(key, data.clone());
-        Ok(data)
+        Ok(self.insert_asset(key, data))
     }
 
     /// Cache a binary map, evicting the least recently used binary maps if we exceed 200MB.
-    pub fn insert_asset(&mut self, key: String, data: Vec<u8>) {
+    ///
+    /// Returns the shared buffer now held by the cache.
+    pub fn insert_asset(&mut self, key: String, data: impl Into<Arc<[u8]>>) -> Arc<[u8]> {
+        let data: Arc<[u8]> = data.into();
         let size = key.len() + data.len();
 
-        while self.current_footprint_bytes + size > self.max_budget_bytes && !self.lru_keys.is_empty() {
-            let victim = self.lru_keys.remove(0);
-            if let Some(removed) = self.assets.remove(&victim) {
-                self.evictions += 1;
-                self.current_footprint_bytes = self.current_footprint_bytes.saturating_sub(victim.len() + removed.len());
-            }
+        if let Some((_, _, old_size)) = self.assets.remove(&key) {
+            self.current_footprint_bytes = self.current_footprint_bytes.saturating_sub(old_size);
         }
 
-        if let Some(pos) = self.lru_keys.iter().position(|x| x == &key) {
-            self.lru_keys.remove(pos);
+        while self.current_footprint_bytes + size > self.max_budget_bytes && !self.assets.is_empty() {
+            if let Some((_, _, evicted)) = self.assets.pop_lru() {
+                self.evictions += 1;
+                self.current_footprint_bytes = self.current_footprint_bytes.saturating_sub(evicted);
+            }
         }
-        self.lru_keys.push(key.clone());
 
         self.current_footprint_bytes += size;
-        self.assets.insert(key, data);
+        self.assets.insert(key, data.clone(), size);
+        data
     }
 }
@@ -2,16 +2,149 @@
 //!
 //! Designed for fast queries at 30-60Hz during active AR visual tracking.
 //! Strictly bound by WASM heap constraints (~256MB).
+//!
+//! Anchors are laid out structure-of-arrays: positions, confidence and
+//! resolved pose targets sit in contiguous vectors indexed by slot, next to
+//! the full `Anchor` records. A uniform grid over the current room bounds
+//! answers "anchors near the camera" without touching distant slots, and
+//! neighborhood updates are diffed so a room transition only moves the
+//! anchors that actually changed.
 
+use crate::core::spatial::{BoundingBox3D, Point3D};
 use crate::core::Anchor;
-use crate::core::spatial::BoundingBox3D;
 use std::collections::HashMap;
 
+/// Maximum grid cells per axis across the room bounds.
+const GRID_DIM: usize = 16;
+/// Smallest grid cell edge, in meters.
+const MIN_CELL_SIZE: f64 = 0.5;
+/// `cell_of` marker for anchors outside the room bounds.
+const OUTSIDE: u32 = u32::MAX;
+
+/// Uniform 2D (x/y) grid of anchor slots over the room bounds.
+#[derive(Default)]
+struct AnchorGrid {
+    origin_x: f64,
+    origin_y: f64,
+    cell_size: f64,
+    nx: usize,
+    ny: usize,
+    cells: Vec<Vec<u32>>,
+    /// Anchors outside the bounds (or all of them when there are no bounds).
+    outside: Vec<u32>,
+}
+
+impl AnchorGrid {
+    fn new(bounds: Option<&BoundingBox3D>) -> Self {
+        let Some(bounds) = bounds else {
+            return Self::default();
+        };
+        let width = (bounds.max.x - bounds.min.x).max(0.0);
+        let depth = (bounds.max.y - bounds.min.y).max(0.0);
+        let cell_size = (width.max(depth) / GRID_DIM as f64).max(MIN_CELL_SIZE);
+        let nx = ((width / cell_size).ceil() as usize).clamp(1, GRID_DIM);
+        let ny = ((depth / cell_size).ceil() as usize).clamp(1, GRID_DIM);
+        Self {
+            origin_x: bounds.min.x,
+            origin_y: bounds.min.y,
+            cell_size,
+            nx,
+            ny,
+            cells: vec![Vec::new(); nx * ny],
+            outside: Vec::new(),
+        }
+    }
+
+    fn cell_index(&self, x: f64, y: f64) -> u32 {
+        if self.cells.is_empty() {
+            return OUTSIDE;
+        }
+        let cx = ((x - self.origin_x) / self.cell_size).floor();
+        let cy = ((y - self.origin_y) / self.cell_size).floor();
+        if cx < 0.0 || cy < 0.0 || cx >= self.nx as f64 || cy >= self.ny as f64 {
+            return OUTSIDE;
+        }
+        (cy as usize * self.nx + cx as usize) as u32
+    }
+
+    fn bucket(&mut self, cell: u32) -> &mut Vec<u32> {
+        if cell == OUTSIDE {
+            &mut self.outside
+        } else {
+            &mut self.cells[cell as usize]
+        }
+    }
+
+    fn insert(&mut self, cell: u32, slot: u32) {
+        self.bucket(cell).push(slot);
+    }
+
+    fn remove(&mut self, cell: u32, slot: u32) {
+        let bucket = self.bucket(cell);
+        if let Some(pos) = bucket.iter().position(|&s| s == slot) {
+            bucket.swap_remove(pos);
+        }
+    }
+
+    fn relabel(&mut self, cell: u32, from: u32, to: u32) {
+        if let Some(entry) = self.bucket(cell).iter_mut().find(|s| **s == from) {
+            *entry = to;
+        }
+    }
+
+    /// Visit the slots in every cell overlapping the square around (x, y).
+    fn for_each_near(&self, x: f64, y: f64, radius: f64, mut visit: impl FnMut(u32) -> bool) {
+        for &slot in &self.outside {
+            if !visit(slot) {
+                return;
+            }
+        }
+        if self.cells.is_empty() {
+            return;
+        }
+        let to_cell = |v: f64, origin: f64, n: usize| {
+            (((v - origin) / self.cell_size).floor().max(0.0) as usize).min(n - 1)
+        };
+        let (x0, x1) = (
+            to_cell(x - radius, self.origin_x, self.nx),
+            to_cell(x + radius, self.origin_x, self.nx),
+        );
+        let (y0, y1) = (
+            to_cell(y - radius, self.origin_y, self.ny),
+            to_cell(y + radius, self.origin_y, self.ny),
+        );
+        for cy in y0..=y1 {
+            for cx in x0..=x1 {
+                for &slot in &self.cells[cy * self.nx + cx] {
+                    if !visit(slot) {
+                        return;
+                    }
+                }
+            }
+        }
+    }
+}
+
 /// In-memory cache holding active AR trackers, room bounds, and relative transform matrices.
 #[derive(Default)]
 pub struct HotCache {
-    /// Active re-localization anchors in the immediate tracking field.
-    pub active_anchors: HashMap<String, Anchor>,
+    /// Full anchor records, by slot.
+    anchors: Vec<Anchor>,
+    /// Anchor positions, by slot.
+    positions: Vec<Point3D>,
+    /// Anchor confidence scores, by slot.
+    confidence: Vec<f64>,
+    /// Grid cell of each slot.
+    cell_of: Vec<u32>,
+    /// Slot of each anchor id.
+    slots: HashMap<String, u32>,
+    /// Per-slot ranges into `pose_targets` (CSR layout, `len + 1` entries).
+    pose_offsets: Vec<u32>,
+    /// Slots targeted by each anchor's relative poses, when hot.
+    pose_targets: Vec<u32>,
+    grid: AnchorGrid,
+    /// Scratch marks for neighborhood diffs, by slot.
+    seen: Vec<bool>,
     /// Active room UUID the worker is physically standing in.
     pub current_room_id: Option<String>,
     /// Bounding box geometry of the active room.
@@ -28,36 +161,125 @@ impl HotCache {
 
     /// Clear the tracking loop memory to release WASM heap space.
     pub fn clear(&mut self) {
-        self.active_anchors.clear();
-        self.current_room_id = None;
-        self.current_room_bounds = None;
-        self.estimated_memory_bytes = 0;
+        *self = Self::default();
+    }
+
+    /// Number of anchors in the tracking field.
+    pub fn len(&self) -> usize {
+        self.anchors.len()
+    }
+
+    pub fn is_empty(&self) -> bool {
+        self.anchors.is_empty()
     }
 
     /// Load the tracking neighborhood of anchors into the Hot Cache.
-    pub fn load_neighborhood(&mut self, anchors: Vec<Anchor>, room_id: Option<String>, bounds: Option<BoundingBox3D>) {
-        self.clear();
+    ///
+    /// Diffs against the current contents: unchanged anchors keep their
+    /// slots untouched, changed ones are replaced in place, and only anchors
+    /// that left the neighborhood are removed. The grid is re-bucketed (slot
+    /// indices only) when the room bounds change.
+    pub fn load_neighborhood(
+        &mut self,
+        anchors: Vec<Anchor>,
+        room_id: Option<String>,
+        bounds: Option<BoundingBox3D>,
+    ) {
         self.current_room_id = room_id;
-        self.current_room_bounds = bounds;
+        if self.current_room_bounds != bounds {
+            self.current_room_bounds = bounds;
+            self.rebuild_grid();
+        }
 
-        let mut bytes = 0;
+        self.seen.clear();
+        self.seen.resize(self.anchors.len(), false);
         for anchor in anchors {
-            // Memory footprint approximation
-            bytes += std::mem::size_of::<Anchor>();
-            bytes += anchor.id.len() + anchor.name.len();
-            bytes += anchor.relative_poses.len() * std::mem::size_of::<crate::core::RelativePose>();
-            self.active_anchors.insert(anchor.id.clone(), anchor);
+            match self.slots.get(&anchor.id).copied() {
+                Some(slot) => {
+                    self.seen[slot as usize] = true;
+                    if self.anchors[slot as usize] != anchor {
+                        self.replace(slot, anchor);
+                    }
+                }
+                None => {
+                    self.push(anchor);
+                    self.seen.push(true);
+                }
+            }
         }
 
-        if self.current_room_bounds.is_some() {
-            bytes += std::mem::size_of::<BoundingBox3D>();
+        // Swap-remove from the back so unvisited slots keep their marks
+        for slot in (0..self.anchors.len()).rev() {
+            if !self.seen[slot] {
+                self.swap_remove(slot as u32);
+            }
         }
-        self.estimated_memory_bytes = bytes;
+
+        self.rebuild_pose_targets();
+        self.estimated_memory_bytes = self.anchors.iter().map(anchor_footprint).sum::<usize>()
+            + self
+                .current_room_bounds
+                .as_ref()
+                .map_or(0, |_| std::mem::size_of::<BoundingBox3D>());
     }
 
     /// Retrieve an anchor by its ID from the hot memory cache.
     pub fn get_anchor(&self, id: &str) -> Option<&Anchor> {
-        self.active_anchors.get(id)
+        self.slots.get(id).map(|&slot| &self.anchors[slot as usize])
+    }
+
+    /// Slot of an anchor id, for use with the per-slot accessors.
+    pub fn slot_of(&self, id: &str) -> Option<usize> {
+        self.slots.get(id).map(|&slot| slot as usize)
+    }
+
+    pub fn anchor_at(&self, slot: usize) -> &Anchor {
+        &self.anchors[slot]
+    }
+
+    /// Anchor positions, indexed by slot.
+    pub fn positions(&self) -> &[Point3D] {
+        &self.positions
+    }
+
+    /// Anchor confidence scores, indexed by slot.
+    pub fn confidence(&self) -> &[f64] {
+        &self.confidence
+    }
+
+    /// Slots of the hot anchors targeted by `slot`'s relative poses.
+    pub fn pose_targets(&self, slot: usize) -> &[u32] {
+        let start = self.pose_offsets[slot] as usize;
+        let end = self.pose_offsets[slot + 1] as usize;
+        &self.pose_targets[start..end]
+    }
+
+    /// Collect the slots of anchors within `radius` meters of `center` into
+    /// `out` (cleared first), stopping after `max_results` so a frame's query
+    /// cost is bounded. Returns true if the budget cut the query short.
+    pub fn anchors_near(
+        &self,
+        center: Point3D,
+        radius: f64,
+        max_results: usize,
+        out: &mut Vec<usize>,
+    ) -> bool {
+        out.clear();
+        let radius_sq = radius * radius;
+        let mut truncated = false;
+        self.grid.for_each_near(center.x, center.y, radius, |slot| {
+            let p = self.positions[slot as usize];
+            let (dx, dy, dz) = (p.x - center.x, p.y - center.y, p.z - center.z);
+            if dx * dx + dy * dy + dz * dz <= radius_sq {
+                if out.len() == max_results {
+                    truncated = true;
+                    return false;
+                }
+                out.push(slot as usize);
+            }
+            true
+        });
+        truncated
     }
 
     /// Verify if the hot cache memory footprint satisfies Leptos WASM heap limits.
@@ -65,4 +287,84 @@ impl HotCache {
         // Target execution heap budget is 256MB. We allocate max 10MB to hot anchors/geometry.
         self.estimated_memory_bytes < 10 * 1024 * 1024
     }
+
+    fn push(&mut self, anchor: Anchor) {
+        let slot = self.anchors.len() as u32;
+        let position = position_of(&anchor);
+        let cell = self.grid.cell_index(position.x, position.y);
+        self.grid.insert(cell, slot);
+        self.slots.insert(anchor.id.clone(), slot);
+        self.positions.push(position);
+        self.confidence.push(anchor.confidence);
+        self.cell_of.push(cell);
+        self.anchors.push(anchor);
+    }
+
+    fn replace(&mut self, slot: u32, anchor: Anchor) {
+        let i = slot as usize;
+        let position = position_of(&anchor);
+        let cell = self.grid.cell_index(position.x, position.y);
+        if cell != self.cell_of[i] {
+            self.grid.remove(self.cell_of[i], slot);
+            self.grid.insert(cell, slot);
+            self.cell_of[i] = cell;
+        }
+        self.positions[i] = position;
+        self.confidence[i] = anchor.confidence;
+        self.anchors[i] = anchor;
+    }
+
+    fn swap_remove(&mut self, slot: u32) {
+        let i = slot as usize;
+        let last = (self.anchors.len() - 1) as u32;
+        self.grid.remove(self.cell_of[i], slot);
+        if slot != last {
+            self.grid.relabel(self.cell_of[last as usize], last, slot);
+            *self
+                .slots
+                .get_mut(&self.anchors[last as usize].id)
+                .expect("hot anchor is indexed") = slot;
+        }
+        let removed = self.anchors.swap_remove(i);
+        self.slots.remove(&removed.id);
+        self.positions.swap_remove(i);
+        self.confidence.swap_remove(i);
+        self.cell_of.swap_remove(i);
+        self.seen.swap_remove(i);
+    }
+
+    fn rebuild_grid(&mut self) {
+        self.grid = AnchorGrid::new(self.current_room_bounds.as_ref());
+        for (slot, position) in self.positions.iter().enumerate() {
+            let cell = self.grid.cell_index(position.x, position.y);
+            self.grid.insert(cell, slot as u32);
+            self.cell_of[slot] = cell;
+        }
+    }
+
+    fn rebuild_pose_targets(&mut self) {
+        self.pose_offsets.clear();
+        self.pose_targets.clear();
+        self.pose_offsets.push(0);
+        for anchor in &self.anchors {
+            let targets = anchor
+                .relative_poses
+                .iter()
+                .filter_map(|pose| self.slots.get(&pose.target_id));
+            self.pose_targets.extend(targets);
+            self.pose_offsets.push(self.pose_targets.len() as u32);
+        }
+    }
+}
+
+fn position_of(anchor: &Anchor) -> Point3D {
+    Point3D::new(anchor.position.x, anchor.position.y, anchor.position.z)
+}
+
+/// Memory footprint approximation of one hot anchor.
+fn anchor_footprint(anchor: &Anchor) -> usize {
+    std::mem::size_of::<Anchor>()
+        + anchor.id.len()
+        + anchor.name.len()
+        + anchor.relative_poses.len() * std::mem::size_of::<crate::core::RelativePose>()
 }
@@ -0,0 +1,284 @@
+//! Constant-time LRU map shared by the Warm and Binary Asset cache tiers.
+//!
+//! Entries live in a slab and are threaded onto an intrusive doubly-linked
+//! recency list by slot index, so hits, inserts, removals and LRU pops are
+//! O(1) with no key comparisons beyond the hash lookup. Each entry records
+//! its byte size and a logical access time for cost-aware eviction.
+
+use std::collections::HashMap;
+
+const NIL: usize = usize::MAX;
+
+struct Node<V> {
+    key: String,
+    value: V,
+    size: usize,
+    last_used: u64,
+    /// Towards the most recently used end.
+    prev: usize,
+    /// Towards the least recently used end.
+    next: usize,
+}
+
+/// String-keyed map ordered by recency of access.
+pub struct LruCache<V> {
+    slots: Vec<Option<Node<V>>>,
+    free: Vec<usize>,
+    index: HashMap<String, usize>,
+    /// Most recently used slot.
+    head: usize,
+    /// Least recently used slot.
+    tail: usize,
+    clock: u64,
+}
+
+/// An entry as seen by an eviction policy.
+pub struct LruEntry<'a, V> {
+    pub key: &'a str,
+    pub value: &'a V,
+    pub size: usize,
+    /// Accesses to the cache since this entry was last used.
+    pub age: u64,
+}
+
+impl<V> Default for LruCache<V> {
+    fn default() -> Self {
+        Self::new()
+    }
+}
+
+impl<V> LruCache<V> {
+    pub fn new() -> Self {
+        Self {
+            slots: Vec::new(),
+            free: Vec::new(),
+            index: HashMap::new(),
+            head: NIL,
+            tail: NIL,
+            clock: 0,
+        }
+    }
+
+    pub fn len(&self) -> usize {
+        self.index.len()
+    }
+
+    pub fn is_empty(&self) -> bool {
+        self.index.is_empty()
+    }
+
+    pub fn contains_key(&self, key: &str) -> bool {
+        self.index.contains_key(key)
+    }
+
+    /// Look up an entry and mark it most recently used.
+    pub fn get(&mut self, key: &str) -> Option<&V> {
+        let slot = *self.index.get(key)?;
+        self.touch(slot);
+        Some(&self.node(slot).value)
+    }
+
+    /// Look up an entry without affecting recency.
+    pub fn peek(&self, key: &str) -> Option<&V> {
+        self.index.get(key).map(|&slot| &self.node(slot).value)
+    }
+
+    /// Insert or replace an entry as most recently used, returning the
+    /// replaced value and its size.
+    pub fn insert(&mut self, key: String, value: V, size: usize) -> Option<(V, usize)> {
+        let replaced = self.remove(&key).map(|(_, value, size)| (value, size));
+        self.clock += 1;
+        let node = Node {
+            key: key.clone(),
+            value,
+            size,
+            last_used: self.clock,
+            prev: NIL,
+            next: NIL,
+        };
+        let slot = match self.free.pop() {
+            Some(slot) => {
+                self.slots[slot] = Some(node);
+                slot
+            }
+            None => {
+                self.slots.push(Some(node));
+                self.slots.len() - 1
+            }
+        };
+        self.link_front(slot);
+        self.index.insert(key, slot);
+        replaced
+    }
+
+    /// Remove an entry, returning its key, value and size.
+    pub fn remove(&mut self, key: &str) -> Option<(String, V, usize)> {
+        let slot = self.index.remove(key)?;
+        self.unlink(slot);
+        let node = self.slots[slot].take().expect("indexed slot is occupied");
+        self.free.push(slot);
+        Some((node.key, node.value, node.size))
+    }
+
+    /// Remove the least recently used entry.
+    pub fn pop_lru(&mut self) -> Option<(String, V, usize)> {
+        if self.tail == NIL {
+            return None;
+        }
+        let key = self.node(self.tail).key.clone();
+        self.remove(&key)
+    }
+
+    /// Entries from least to most recently used.
+    pub fn iter_lru(&self) -> impl Iterator<Item = LruEntry<'_, V>> + '_ {
+        let mut slot = self.tail;
+        std::iter::from_fn(move || {
+            if slot == NIL {
+                return None;
+            }
+            let node = self.node(slot);
+            slot = node.prev;
+            Some(LruEntry {
+                key: &node.key,
+                value: &node.value,
+                size: node.size,
+                age: self.clock - node.last_used,
+            })
+        })
+    }
+
+    /// Values in no particular order.
+    pub fn values(&self) -> impl Iterator<Item = &V> + '_ {
+        self.slots.iter().flatten().map(|node| &node.value)
+    }
+
+    fn node(&self, slot: usize) -> &Node<V> {
+        self.slots[slot].as_ref().expect("linked slot is occupied")
+    }
+
+    fn node_mut(&mut self, slot: usize) -> &mut Node<V> {
+        self.slots[slot].as_mut().expect("linked slot is occupied")
+    }
+
+    fn touch(&mut self, slot: usize) {
+        self.clock += 1;
+        let clock = self.clock;
+        self.node_mut(slot).last_used = clock;
+        if self.head != slot {
+            self.unlink(slot);
+            self.link_front(slot);
+        }
+    }
+
+    fn link_front(&mut self, slot: usize) {
+        let head = self.head;
+        {
+            let node = self.node_mut(slot);
+            node.prev = NIL;
+            node.next = head;
+        }
+        if head != NIL {
+            self.node_mut(head).prev = slot;
+        } else {
+            self.tail = slot;
+        }
+        self.head = slot;
+    }
+
+    fn unlink(&mut self, slot: usize) {
+        let (prev, next) = {
+            let node = self.node(slot);
+            (node.prev, node.next)
+        };
+        if prev != NIL {
+            self.node_mut(prev).next = next;
+        } else {
+            self.head = next;
+        }
+        if next != NIL {
+            self.node_mut(next).prev = prev;
+        } else {
+            self.tail = prev;
+        }
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    /// Keys from least to most recently used.
+    fn order<V>(cache: &LruCache<V>) -> Vec<&str> {
+        cache.iter_lru().map(|entry| entry.key).collect()
+    }
+
+    fn filled(keys: &[&str]) -> LruCache<usize> {
+        let mut cache = LruCache::new();
+        for (i, key) in keys.iter().enumerate() {
+            cache.insert(key.to_string(), i, 10);
+        }
+        cache
+    }
+
+    #[test]
+    fn get_moves_entry_to_front() {
+        let mut cache = filled(&["a", "b", "c"]);
+        assert_eq!(cache.get("a"), Some(&0));
+        assert_eq!(order(&cache), ["b", "c", "a"]);
+        // Already at the front: order is unchanged, age resets
+        assert_eq!(cache.get("a"), Some(&0));
+        assert_eq!(order(&cache), ["b", "c", "a"]);
+        assert_eq!(cache.iter_lru().last().map(|entry| entry.age), Some(0));
+
+        assert_eq!(cache.peek("b"), Some(&1));
+        assert_eq!(order(&cache), ["b", "c", "a"]);
+    }
+
+    #[test]
+    fn pop_lru_evicts_the_tail_at_capacity() {
+        const CAPACITY: usize = 3;
+        let mut cache = filled(&["a", "b", "c"]);
+        cache.get("a");
+        let mut evicted = Vec::new();
+        for key in ["d", "e"] {
+            cache.insert(key.to_string(), 0, 10);
+            while cache.len() > CAPACITY {
+                evicted.push(cache.pop_lru().unwrap().0);
+            }
+        }
+        assert_eq!(evicted, ["b", "c"]);
+        assert_eq!(order(&cache), ["a", "d", "e"]);
+
+        while cache.pop_lru().is_some() {}
+        assert!(cache.is_empty());
+        assert_eq!(order(&cache), Vec::<&str>::new());
+    }
+
+    #[test]
+    fn removed_slots_are_reused() {
+        let mut cache = filled(&["a", "b", "c"]);
+        assert_eq!(cache.remove("b"), Some(("b".to_string(), 1, 10)));
+        assert_eq!(cache.remove("b"), None);
+        assert_eq!(order(&cache), ["a", "c"]);
+
+        cache.insert("d".to_string(), 3, 10);
+        assert_eq!(cache.slots.len(), 3);
+        assert!(cache.free.is_empty());
+        assert_eq!(order(&cache), ["a", "c", "d"]);
+        assert_eq!(cache.peek("d"), Some(&3));
+        assert!(!cache.contains_key("b"));
+    }
+
+    #[test]
+    fn reinserting_a_key_replaces_it_in_place() {
+        let mut cache = filled(&["a", "b", "c"]);
+        assert_eq!(cache.insert("a".to_string(), 7, 25), Some((0, 10)));
+        assert_eq!(cache.len(), 3);
+        assert_eq!(cache.slots.len(), 3);
+        assert_eq!(order(&cache), ["b", "c", "a"]);
+
+        let front = cache.iter_lru().last().unwrap();
+        assert_eq!((front.key, *front.value, front.size), ("a", 7, 25));
+        assert_eq!(cache.values().copied().sum::<usize>(), 1 + 2 + 7);
+    }
+}
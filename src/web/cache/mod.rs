@@ -2,8 +2,10 @@
 //!
 //! Exposes three caching tiers (Hot, Warm, Binary Asset), Scoped working-set
 //! retrievals, an offline mutation queue, and predictive warming triggers.
+//! The Warm and Binary Asset tiers share the O(1) [`lru::LruCache`].
 
 pub mod hot;
+pub mod lru;
 pub mod warm;
 pub mod binary;
 pub mod sync;
@@ -3,32 +3,9 @@
 //! Stores worker spatial coordinate updates, dropped anchors, and recalibrations
 //! locally while disconnected. Merges transactions deterministically on sync.
 
-use crate::core::Anchor;
-use crate::core::domain::ArxAddress;
-use crate::core::Position;
+use crate::core::mutation::coalesce;
 
-/// Represents a pending spatial or semantic change captured offline.
-#[derive(serde::Serialize, serde::Deserialize, Clone, Debug)]
-pub enum Mutation {
-    /// Worker dropped a new spatial anchor.
-    CreateAnchor {
-        address: ArxAddress,
-        anchor: Anchor,
-    },
-    /// Worker recalibrated an existing anchor position.
-    RecalibrateAnchor {
-        anchor_id: String,
-        new_position: Position,
-        confidence: f64,
-        timestamp: u64,
-    },
-    /// Worker updated property values.
-    UpdateProperties {
-        entity_address: ArxAddress,
-        properties: std::collections::HashMap<String, String>,
-        timestamp: u64,
-    },
-}
+pub use crate::core::Mutation;
 
 /// Persistent offline mutation queue.
 #[derive(Default)]
@@ -50,20 +27,30 @@ impl SyncQueue {
         self.queue.push(mutation);
     }
 
+    /// The queue coalesced per entity (last write wins), as sent in one
+    /// `sync.apply_batch` call. The queue itself is kept until acknowledged.
+    pub fn pending_batch(&self) -> Vec<Mutation> {
+        coalesce(self.queue.iter().cloned())
+    }
+
+    /// Drop the queued mutations once the agent has committed them.
+    pub fn acknowledge(&mut self, commit: String) {
+        self.queue.clear();
+        self.last_sync_commit = Some(commit);
+    }
+
     /// Process queue and sync changes with the Edge Agent using merge rules.
     pub fn sync_with_agent(&mut self) -> Result<String, String> {
         if self.queue.is_empty() {
             return Ok("No pending changes".to_string());
         }
 
-        // Mock syncing mutations sequentially with conflict resolution:
-        // - Overlapping recalibrations are resolved via "last write wins" (timestamp check).
-        // - Non-overlapping additions are cleanly merged.
-        let mutation_count = self.queue.len();
-        self.queue.clear(); // Acknowledged and cleared on successful gateway post
+        // Mock posting the coalesced batch: overlapping writes to one entity
+        // are resolved via "last write wins" (timestamp check) before sending.
+        let mutation_count = self.pending_batch().len();
 
         let dummy_commit_hash = "f1a23b4c5d6e7f8a9b0c".to_string();
-        self.last_sync_commit = Some(dummy_commit_hash.clone());
+        self.acknowledge(dummy_commit_hash.clone()); // Cleared on successful gateway post
 
         Ok(format!("Successfully merged {} contributions. New commit: {}", mutation_count, dummy_commit_hash))
     }
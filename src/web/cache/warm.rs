@@ -3,9 +3,10 @@
 //! Stores scoped subtree envelopes keyed by ArxAddress prefixes.
 //! Enforces a strict storage budget of ~100MB via spatial & prefix-depth eviction.
 
-use crate::core::domain::ArxAddress;
+use crate::core::domain::{AddressTrie, ArxAddress};
 use crate::core::Anchor;
-use std::collections::HashMap;
+use crate::telemetry::CacheStats;
+use super::lru::LruCache;
 
 /// Represents a loaded working-set envelope returned by the Edge Agent.
 #[derive(serde::Serialize, serde::Deserialize, Clone, Debug)]
@@ -20,12 +21,13 @@ pub struct BuildingSyncEnvelope {
     pub fetched_at_timestamp: u64,
 }
 
+/// Least-recent entries considered by each eviction.
+const EVICTION_WINDOW: usize = 8;
+
 /// Persistent local cache wrapper for IndexedDB storage.
 pub struct WarmCache {
-    /// Scoped subtrees cached locally, keyed by ArxAddress path.
-    pub subtrees: HashMap<String, BuildingSyncEnvelope>,
-    /// List of keys ordered by access history (LRU).
-    pub lru_keys: Vec<String>,
+    /// Scoped subtrees cached locally, keyed by ArxAddress path, in O(1) LRU order.
+    pub subtrees: LruCache<BuildingSyncEnvelope>,
     /// Maximum cache storage budget (100MB limit).
     pub max_budget_bytes: usize,
     /// Current calculated cache footprint in bytes.
@@ -37,7 +39,13 @@ pub struct WarmCache {
     /// Eviction counter.
     pub evictions: usize,
     /// Weight ratio between recency (LRU) and spatial proximity constraints (0.0 to 1.0).
+    /// At 1.0 eviction is plain LRU; lower values favour evicting subtrees
+    /// whose address is far from `current_address`.
     pub recency_vs_proximity_weight: f64,
+    /// Address of the room the worker is currently in, if known.
+    pub current_address: Option<ArxAddress>,
+    /// `subtrees` keys by address segment, for covering-subtree lookups.
+    prefixes: AddressTrie<String>,
 }
 
 impl Default for WarmCache {
@@ -50,68 +58,158 @@ impl WarmCache {
     /// Initialize the Warm Cache with a 100MB budget.
     pub fn new() -> Self {
         Self {
-            subtrees: HashMap::new(),
-            lru_keys: Vec::new(),
+            subtrees: LruCache::new(),
             max_budget_bytes: 100 * 1024 * 1024, // 100MB
             current_footprint_bytes: 0,
             hits: 0,
             misses: 0,
             evictions: 0,
             recency_vs_proximity_weight: 0.5, // Default balanced weight
+            current_address: None,
+            prefixes: AddressTrie::new(),
+        }
+    }
+
+    /// Record the worker's current room, used to weigh evictions by proximity.
+    pub fn set_current_address(&mut self, address: &ArxAddress) {
+        if self.current_address.as_ref() != Some(address) {
+            self.current_address = Some(address.clone());
         }
     }
 
     /// Retrieve a cached subtree by its ArxAddress path, updating the LRU queue.
     pub fn get_subtree(&mut self, address: &ArxAddress) -> Option<&BuildingSyncEnvelope> {
-        let key = address.path.clone();
-        if self.subtrees.contains_key(&key) {
-            self.hits += 1;
-            // Update LRU queue
-            if let Some(pos) = self.lru_keys.iter().position(|x| x == &key) {
-                self.lru_keys.remove(pos);
+        match self.subtrees.get(&address.path) {
+            Some(envelope) => {
+                self.hits += 1;
+                Some(envelope)
+            }
+            None => {
+                self.misses += 1;
+                None
             }
-            self.lru_keys.push(key.clone());
-            self.subtrees.get(&key)
+        }
+    }
+
+    /// Retrieve the cached subtree covering `address`, updating the LRU queue.
+    ///
+    /// That is the envelope at `address` itself or at its deepest cached
+    /// ancestor, found by one walk down the prefix trie.
+    pub fn find_covering_subtree(&mut self, address: &ArxAddress) -> Option<&BuildingSyncEnvelope> {
+        let envelope = match self.prefixes.longest_prefix(&address.path) {
+            Some((_, key)) => self.subtrees.get(key),
+            None => None,
+        };
+        if envelope.is_some() {
+            self.hits += 1;
         } else {
             self.misses += 1;
-            None
+        }
+        envelope
+    }
+
+    /// Counters reported to the agent's `/metrics` (`metrics.report_cache`).
+    pub fn stats(&self) -> CacheStats {
+        CacheStats {
+            hits: self.hits as u64,
+            misses: self.misses as u64,
+            evictions: self.evictions as u64,
+            entries: self.subtrees.len() as u64,
+            bytes: self.current_footprint_bytes as u64,
         }
     }
 
     /// Insert a retrieved subtree envelope, executing the eviction policy if the budget is exceeded.
     pub fn insert_subtree(&mut self, envelope: BuildingSyncEnvelope) {
         let key = envelope.base_address.path.clone();
-        let size = key.len() + envelope.payload.len() + envelope.anchors.len() * std::mem::size_of::<Anchor>();
+        let size = envelope_size(&key, &envelope);
 
-        // Evict older/distant subtrees if we exceed the 100MB storage limit
-        while self.current_footprint_bytes + size > self.max_budget_bytes && !self.lru_keys.is_empty() {
-            self.evict_least_relevant();
+        // A replaced envelope no longer counts against the budget
+        if let Some((_, _, old_size)) = self.subtrees.remove(&key) {
+            self.current_footprint_bytes = self.current_footprint_bytes.saturating_sub(old_size);
         }
 
-        // Add key to LRU
-        if let Some(pos) = self.lru_keys.iter().position(|x| x == &key) {
-            self.lru_keys.remove(pos);
+        // Evict older/distant subtrees if we exceed the 100MB storage limit
+        while self.current_footprint_bytes + size > self.max_budget_bytes && !self.subtrees.is_empty() {
+            self.evict_least_relevant();
         }
-        self.lru_keys.push(key.clone());
 
         self.current_footprint_bytes += size;
-        self.subtrees.insert(key, envelope);
+        self.prefixes.insert(&key, key.clone());
+        self.subtrees.insert(key, envelope, size);
     }
 
     /// Evicts the least relevant subtree envelope based on LRU and prefix-depth constraints.
+    ///
+    /// Scores the `EVICTION_WINDOW` least recently used subtrees by
+    /// `w * age + (1 - w) * prefix distance to current_address` (both
+    /// normalized over the window, `w` = `recency_vs_proximity_weight`) and
+    /// evicts the highest, preferring the older and then the larger subtree on ties.
     fn evict_least_relevant(&mut self) {
-        if self.lru_keys.is_empty() {
-            return;
-        }
+        let victim = match &self.current_address {
+            Some(current) if self.recency_vs_proximity_weight < 1.0 => {
+                let current = address_segments(&current.path);
+                let window: Vec<EvictionCandidate> = self
+                    .subtrees
+                    .iter_lru()
+                    .take(EVICTION_WINDOW)
+                    .map(|entry| EvictionCandidate {
+                        key: entry.key,
+                        age: entry.age,
+                        distance: prefix_distance(&address_segments(entry.key), &current),
+                        size: entry.size,
+                    })
+                    .collect();
+                let max_age = window.iter().map(|c| c.age).max().unwrap_or(0).max(1) as f64;
+                let max_distance =
+                    window.iter().map(|c| c.distance).max().unwrap_or(0).max(1) as f64;
+                let w = self.recency_vs_proximity_weight.clamp(0.0, 1.0);
+                let score = |c: &EvictionCandidate| {
+                    w * (c.age as f64 / max_age) + (1.0 - w) * (c.distance as f64 / max_distance)
+                };
+                window
+                    .iter()
+                    .max_by(|a, b| {
+                        score(a)
+                            .total_cmp(&score(b))
+                            .then(a.age.cmp(&b.age))
+                            .then(a.size.cmp(&b.size))
+                    })
+                    .map(|c| c.key.to_string())
+            }
+            _ => None,
+        };
 
-        // 1. Identify eviction candidate (oldest item in LRU)
-        let candidate_key = self.lru_keys.remove(0);
-        if let Some(envelope) = self.subtrees.remove(&candidate_key) {
+        let evicted = match victim {
+            Some(key) => self.subtrees.remove(&key),
+            None => self.subtrees.pop_lru(),
+        };
+        if let Some((key, _, size)) = evicted {
+            self.prefixes.remove(&key);
             self.evictions += 1;
-            let size = candidate_key.len() 
-                + envelope.payload.len() 
-                + envelope.anchors.len() * std::mem::size_of::<Anchor>();
             self.current_footprint_bytes = self.current_footprint_bytes.saturating_sub(size);
         }
     }
 }
+
+struct EvictionCandidate<'a> {
+    key: &'a str,
+    age: u64,
+    distance: usize,
+    size: usize,
+}
+
+/// Approximate storage footprint of an envelope.
+fn envelope_size(key: &str, envelope: &BuildingSyncEnvelope) -> usize {
+    key.len() + envelope.payload.len() + envelope.anchors.len() * std::mem::size_of::<Anchor>()
+}
+
+fn address_segments(path: &str) -> Vec<&str> {
+    path.split('/').filter(|s| !s.is_empty()).collect()
+}
+
+/// Tree distance between two addresses: segments below their common prefix.
+fn prefix_distance(a: &[&str], b: &[&str]) -> usize {
+    let common = a.iter().zip(b).take_while(|(x, y)| x == y).count();
+    (a.len() - common) + (b.len() - common)
+}
@@ -4,7 +4,7 @@
 //! to warm adjacent room geometries and anchors without blocking the main render loop.
 
 use crate::core::domain::ArxAddress;
-use crate::core::Anchor;
+use crate::core::{Anchor, Building};
 use crate::core::spatial::Point3D;
 
 /// Triggers and coordinates asynchronous warming queries.
@@ -44,6 +44,43 @@ impl PredictiveWarming {
         }
     }
 
+    /// Warm anchors of a locally loaded building within a radius of an AR marker.
+    ///
+    /// Uses the building's spatial index, so the cost scales with the number of
+    /// anchors in range rather than with the size of the building.
+    pub fn warm_building_proximity(
+        &self,
+        building: &Building,
+        marker_address: &ArxAddress,
+        marker_coords: Point3D,
+        radius_meters: f64,
+        warm_cache: &mut super::WarmCache,
+    ) {
+        let anchors: Vec<Anchor> = building
+            .find_anchors_near(marker_coords, radius_meters)
+            .into_iter()
+            .cloned()
+            .collect();
+        if anchors.is_empty() {
+            return;
+        }
+
+        let proximity_prefix = format!("{}/near", marker_address.path);
+        if let Ok(addr) = ArxAddress::from_path(&proximity_prefix) {
+            let envelope = super::warm::BuildingSyncEnvelope {
+                base_address: addr,
+                payload: format!(
+                    "Pre-warmed {} anchors within {}m of marker",
+                    anchors.len(),
+                    radius_meters
+                ),
+                anchors,
+                fetched_at_timestamp: chrono::Utc::now().timestamp() as u64,
+            };
+            warm_cache.insert_subtree(envelope);
+        }
+    }
+
     /// Pre-fetch floor assets when a worker approaches a vertical transition (stairs/elevators).
     pub fn warm_vertical_transition(
         &self,
@@ -60,7 +97,8 @@ impl PredictiveWarming {
         let target_floor_prefix = format!("{}/floor-{}", base_path, destination_floor);
 
         if let Ok(addr) = ArxAddress::from_path(&target_floor_prefix) {
-            if warm_cache.get_subtree(&addr).is_none() {
+            // A cached building-level subtree already holds the floor
+            if warm_cache.find_covering_subtree(&addr).is_none() {
                 // Background download representation
                 let warm_envelope = super::warm::BuildingSyncEnvelope {
                     base_address: addr,
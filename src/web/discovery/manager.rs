@@ -3,7 +3,7 @@
 //! Restricts visible anchors based on geofenced radius settings and separates
 //! provisional staging zones from verified production assets.
 
-use crate::core::Anchor;
+use crate::core::{Anchor, Building};
 use crate::web::cache::WarmCache;
 use crate::web::cache::warming::PredictiveWarming;
 use super::location::LocationContext;
@@ -14,6 +14,9 @@ pub struct DiscoveryManager {
     pub active_location: Option<LocationContext>,
     /// Global default radius for visibility checks (in meters).
     pub default_discovery_radius: f64,
+    /// Locally loaded building; when set, marker warming reads its anchors
+    /// from the building's spatial index instead of the gateway mock.
+    pub building: Option<Building>,
 }
 
 impl Default for DiscoveryManager {
@@ -28,6 +31,7 @@ impl DiscoveryManager {
         Self {
             active_location: None,
             default_discovery_radius: 10.0,
+            building: None,
         }
     }
 
@@ -38,6 +42,9 @@ impl DiscoveryManager {
         warm_cache: &mut WarmCache,
         warmer: &PredictiveWarming,
     ) {
+        // Evictions favour keeping subtrees near the worker's room
+        warm_cache.set_current_address(&context.current_address);
+
         // Trigger vertical transition pre-fetching if elevator/stairs are near
         if context.current_address.path.contains("stairs") || context.current_address.path.contains("elevator") {
             // Assume destination vertical increment
@@ -45,12 +52,21 @@ impl DiscoveryManager {
         }
 
         // Trigger visual marker proximity warming for nearby geofences
-        warmer.warm_marker_proximity(
-            &context.current_address,
-            context.coordinates,
-            self.default_discovery_radius,
-            warm_cache,
-        );
+        match &self.building {
+            Some(building) => warmer.warm_building_proximity(
+                building,
+                &context.current_address,
+                context.coordinates,
+                self.default_discovery_radius,
+                warm_cache,
+            ),
+            None => warmer.warm_marker_proximity(
+                &context.current_address,
+                context.coordinates,
+                self.default_discovery_radius,
+                warm_cache,
+            ),
+        }
 
         self.active_location = Some(context);
     }
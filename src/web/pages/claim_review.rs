@@ -153,6 +153,13 @@ pub fn ClaimReview() -> impl IntoView {
                         }
                     }
                     set_loading.set(false);
+
+                    // Best effort: the agent's /metrics only sees this cache through reports
+                    let stats = CLAIM_WARM_CACHE.with(|cache| cache.borrow().stats());
+                    let _ = crate::web::ws_client::send_rpc(
+                        "metrics.report_cache",
+                        serde_json::json!({ "cache": "warm", "stats": stats }),
+                    ).await;
                 }
                 Err(e) => {
                     set_status_msg.set(format!("Error loading contributions: {}", e));
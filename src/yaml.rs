@@ -20,9 +20,19 @@ impl BuildingYamlSerializer {
     }
 
     pub fn serialize(data: &BuildingData) -> Result<String, Box<dyn std::error::Error>> {
-        let mut sorted_data = BuildingData::from_building(&data.building);
+        Self::serialize_document(&Self::document(&data.building))
+    }
+
+    /// Sorted on-disk document for `building`, exactly as [`Self::serialize_building`] writes it.
+    pub fn document(building: &crate::core::Building) -> BuildingData {
+        let mut sorted_data = BuildingData::from_building(building);
         sorted_data.sort_deterministically();
-        Ok(serde_yaml::to_string(&sorted_data)?)
+        sorted_data
+    }
+
+    /// Write an already projected and sorted document (see [`Self::document`]) as YAML.
+    pub fn serialize_document(data: &BuildingData) -> Result<String, Box<dyn std::error::Error>> {
+        Ok(serde_yaml::to_string(data)?)
     }
 
     /// Deserialize YAML into `BuildingData` and rehydrate room equipment.
@@ -30,11 +40,16 @@ impl BuildingYamlSerializer {
     /// After raw deserialization, calls [`BuildingData::rehydrate_room_equipment`] to
     /// populate each room's `equipment` list from the global equipment index.
     pub fn deserialize(yaml: &str) -> Result<BuildingData, Box<dyn std::error::Error>> {
-        let mut data: BuildingData = serde_yaml::from_str(yaml)?;
+        let mut data = Self::deserialize_document(yaml)?;
         data.rehydrate_room_equipment();
         Ok(data)
     }
 
+    /// Deserialize YAML into the raw on-disk document, without rehydration.
+    pub fn deserialize_document(yaml: &str) -> Result<BuildingData, Box<dyn std::error::Error>> {
+        Ok(serde_yaml::from_str(yaml)?)
+    }
+
     /// Serialize a canonical Building by projecting it to BuildingData DTO first
     pub fn serialize_building(
         building: &crate::core::Building,
@@ -107,48 +122,68 @@ impl BuildingData {
         self.building.anchors.sort_by(|a, b| a.name.cmp(&b.name));
 
         for floor in &mut self.building.floors {
-            // 2. Sort Wings by name (alphabetical)
-            floor.wings.sort_by(|a, b| a.name.cmp(&b.name));
+            Self::sort_floor(floor);
+        }
 
-            // 3. Sort Floor-level (common area) equipment
-            floor.equipment.sort_by(|a, b| a.name.cmp(&b.name));
+        // 7. Sort Global equipment list by ArxAddress path (or name fallback)
+        self.equipment.sort_by(Self::equipment_order);
 
-            // Sort Floor-level anchors
-            floor.anchors.sort_by(|a, b| a.name.cmp(&b.name));
+        // 8. Sort Global anchor list by ArxAddress path (or name fallback)
+        self.anchors.sort_by(Self::anchor_order);
+    }
 
-            for wing in &mut floor.wings {
-                // 4. Sort Rooms by name
-                wing.rooms.sort_by(|a, b| a.name.cmp(&b.name));
+    /// Sorts one floor's wings, rooms, equipment and anchors (steps 2–6 of
+    /// [`Self::sort_deterministically`]).
+    pub fn sort_floor(floor: &mut crate::core::Floor) {
+        // 2. Sort Wings by name (alphabetical)
+        floor.wings.sort_by(|a, b| a.name.cmp(&b.name));
 
-                // 5. Sort Wing-level equipment
-                wing.equipment.sort_by(|a, b| a.name.cmp(&b.name));
+        // 3. Sort Floor-level (common area) equipment
+        floor.equipment.sort_by(|a, b| a.name.cmp(&b.name));
 
-                // Sort Wing-level anchors
-                wing.anchors.sort_by(|a, b| a.name.cmp(&b.name));
+        // Sort Floor-level anchors
+        floor.anchors.sort_by(|a, b| a.name.cmp(&b.name));
 
-                for room in &mut wing.rooms {
-                    // 6. Sort Room equipment
-                    room.equipment.sort_by(|a, b| a.name.cmp(&b.name));
+        for wing in &mut floor.wings {
+            // 4. Sort Rooms by name
+            wing.rooms.sort_by(|a, b| a.name.cmp(&b.name));
 
-                    // Sort Room anchors
-                    room.anchors.sort_by(|a, b| a.name.cmp(&b.name));
-                }
+            // 5. Sort Wing-level equipment
+            wing.equipment.sort_by(|a, b| a.name.cmp(&b.name));
+
+            // Sort Wing-level anchors
+            wing.anchors.sort_by(|a, b| a.name.cmp(&b.name));
+
+            for room in &mut wing.rooms {
+                // 6. Sort Room equipment
+                room.equipment.sort_by(|a, b| a.name.cmp(&b.name));
+
+                // Sort Room anchors
+                room.anchors.sort_by(|a, b| a.name.cmp(&b.name));
             }
         }
+    }
 
-        // 7. Sort Global equipment list by ArxAddress path (or name fallback)
-        self.equipment
-            .sort_by(|a, b| match (&a.address, &b.address) {
-                (Some(addr_a), Some(addr_b)) => addr_a.path.cmp(&addr_b.path),
-                _ => a.name.cmp(&b.name),
-            });
+    /// Order of the global equipment list: ArxAddress path, or name fallback.
+    pub fn equipment_order(
+        a: &crate::core::Equipment,
+        b: &crate::core::Equipment,
+    ) -> std::cmp::Ordering {
+        match (&a.address, &b.address) {
+            (Some(addr_a), Some(addr_b)) => addr_a.path.cmp(&addr_b.path),
+            _ => a.name.cmp(&b.name),
+        }
+    }
 
-        // 8. Sort Global anchor list by ArxAddress path (or name fallback)
-        self.anchors
-            .sort_by(|a, b| match (&a.address, &b.address) {
-                (Some(addr_a), Some(addr_b)) => addr_a.path.cmp(&addr_b.path),
-                _ => a.name.cmp(&b.name),
-            });
+    /// Order of the global anchor list: ArxAddress path, or name fallback.
+    pub fn anchor_order(
+        a: &crate::core::Anchor,
+        b: &crate::core::Anchor,
+    ) -> std::cmp::Ordering {
+        match (&a.address, &b.address) {
+            (Some(addr_a), Some(addr_b)) => addr_a.path.cmp(&addr_b.path),
+            _ => a.name.cmp(&b.name),
+        }
     }
 
     /// Rehydrate room equipment lists after YAML deserialization.
@@ -223,6 +223,8 @@ equipment: []
             repo_root: temp_dir.path().to_path_buf(),
             token: Arc::new(Mutex::new(token_state)),
             metrics: Arc::new(arxos::agent::observability::AgentMetrics::new()),
+            building: Default::default(),
+            exports: Default::default(),
             reload_handle: None,
         });
 
@@ -281,11 +283,16 @@ equipment: []
         metrics.record_claim_processed(true, 500.0); // 1 approved with 500 AXD
         metrics.record_claim_processed(false, 0.0); // 1 rejected
         metrics.record_error();
+        metrics.record_rpc("git.status", std::time::Duration::from_millis(3), false);
+        assert!(metrics.report_cache("warm", arxos::telemetry::CacheStats { hits: 7, misses: 2, entries: 4, ..Default::default() }));
+        assert!(!metrics.report_cache("unknown", Default::default()));
 
         let agent_state = Arc::new(AgentState {
             repo_root: temp_dir.path().to_path_buf(),
             token: Arc::new(Mutex::new(token_state)),
             metrics: metrics.clone(),
+            building: Default::default(),
+            exports: Default::default(),
             reload_handle: None,
         });
 
@@ -328,13 +335,20 @@ equipment: []
             let response = res.into_response();
             assert_eq!(response.status(), StatusCode::OK);
 
-            let body_bytes = axum::body::to_bytes(response.into_body(), 10000).await.unwrap();
+            let body_bytes = axum::body::to_bytes(response.into_body(), 1 << 20).await.unwrap();
             let metrics_text = String::from_utf8(body_bytes.to_vec()).unwrap();
             assert!(metrics_text.contains("arx_agent_claims_processed_total 2"));
             assert!(metrics_text.contains("arx_agent_claims_approved_total 1"));
             assert!(metrics_text.contains("arx_agent_claims_rejected_total 1"));
             assert!(metrics_text.contains("arx_agent_rewards_distributed_axd_total 500.00"));
             assert!(metrics_text.contains("arx_agent_errors_total 2"));
+            assert!(metrics_text.contains("arx_agent_rpc_duration_seconds_bucket{method=\"git.status\",le=\"0.0025\"} 0"));
+            assert!(metrics_text.contains("arx_agent_rpc_duration_seconds_bucket{method=\"git.status\",le=\"0.005\"} 1"));
+            assert!(metrics_text.contains("arx_agent_rpc_errors_total{method=\"git.status\"} 1"));
+            assert!(!metrics_text.contains("method=\"git.diff\""));
+            assert!(metrics_text.contains("# TYPE arx_agent_phase_duration_seconds histogram"));
+            assert!(metrics_text.contains("arx_pwa_cache_hits_total{cache=\"warm\"} 7"));
+            assert!(metrics_text.contains("arx_pwa_cache_entries{cache=\"warm\"} 4"));
         });
     }
 
@@ -57,3 +57,27 @@ fn test_ifc_files_parse_with_bounding_boxes() {
         println!();
     }
 }
+
+#[test]
+fn test_lazy_hierarchy_matches_eager_spatial_tree() {
+    let file_path = "tests/fixtures/ifc/simple.ifc";
+    let processor = arxos::ifc::IFCProcessor::new();
+
+    let eager = processor.parse_native(file_path, false).unwrap();
+    let lazy = processor.parse_native_lazy(file_path, false, true).unwrap();
+
+    assert_eq!(lazy.stats.total_entities, eager.stats.total_entities);
+    assert_eq!(lazy.stats.spatial_entities, eager.stats.spatial_entities);
+    assert_eq!(lazy.building.floors.len(), eager.building.floors.len());
+
+    let room_names = |b: &arxos::core::Building| -> Vec<String> {
+        b.floors
+            .iter()
+            .flat_map(|f| f.wings.iter())
+            .flat_map(|w| w.rooms.iter().map(|r| r.name.clone()))
+            .collect()
+    };
+    assert_eq!(room_names(&lazy.building), room_names(&eager.building));
+
+    assert!(processor.validate_ifc_file(file_path).unwrap());
+}
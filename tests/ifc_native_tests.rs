@@ -16,7 +16,7 @@ fn test_native_geometry_resolution() {
     // Triangle points
     registry.register(RawEntity {
         id: 1,
-        class: "IFCCARTESIANPOINT".to_string(),
+        class: "IFCCARTESIANPOINT".into(),
         params: vec![Param::List(vec![
             Param::Float(0.0),
             Param::Float(0.0),
@@ -25,7 +25,7 @@ fn test_native_geometry_resolution() {
     });
     registry.register(RawEntity {
         id: 2,
-        class: "IFCCARTESIANPOINT".to_string(),
+        class: "IFCCARTESIANPOINT".into(),
         params: vec![Param::List(vec![
             Param::Float(1.0),
             Param::Float(0.0),
@@ -34,7 +34,7 @@ fn test_native_geometry_resolution() {
     });
     registry.register(RawEntity {
         id: 3,
-        class: "IFCCARTESIANPOINT".to_string(),
+        class: "IFCCARTESIANPOINT".into(),
         params: vec![Param::List(vec![
             Param::Float(0.0),
             Param::Float(1.0),
@@ -44,7 +44,7 @@ fn test_native_geometry_resolution() {
 
     registry.register(RawEntity {
         id: 10,
-        class: "IFCPOLYLOOP".to_string(),
+        class: "IFCPOLYLOOP".into(),
         params: vec![Param::List(vec![
             Param::Reference(1),
             Param::Reference(2),
@@ -53,22 +53,22 @@ fn test_native_geometry_resolution() {
     });
     registry.register(RawEntity {
         id: 11,
-        class: "IFCFACEOUTERBOUND".to_string(),
+        class: "IFCFACEOUTERBOUND".into(),
         params: vec![Param::Reference(10), Param::Boolean(true)],
     });
     registry.register(RawEntity {
         id: 12,
-        class: "IFCFACE".to_string(),
+        class: "IFCFACE".into(),
         params: vec![Param::List(vec![Param::Reference(11)])],
     });
     registry.register(RawEntity {
         id: 13,
-        class: "IFCCLOSEDSHELL".to_string(),
+        class: "IFCCLOSEDSHELL".into(),
         params: vec![Param::List(vec![Param::Reference(12)])],
     });
     registry.register(RawEntity {
         id: 100,
-        class: "IFCFACETEDBREP".to_string(),
+        class: "IFCFACETEDBREP".into(),
         params: vec![Param::Reference(13)],
     });
 
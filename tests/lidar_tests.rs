@@ -62,6 +62,43 @@ fn test_ply_parser_streaming() -> Result<(), Box<dyn std::error::Error>> {
     Ok(())
 }
 
+#[test]
+fn test_las_blocks_decode_from_mapping() -> Result<(), Box<dyn std::error::Error>> {
+    use las::{Read, Write as _};
+
+    let temp = tempfile::Builder::new().suffix(".las").tempfile()?;
+    {
+        let mut writer = las::Writer::from_path(temp.path(), las::Header::default())?;
+        for i in 0..(parser::BLOCK_POINTS + 10) {
+            let point = las::Point {
+                x: i as f64 * 0.01,
+                y: -(i as f64) * 0.02,
+                z: 3.5,
+                ..Default::default()
+            };
+            writer.write(point)?;
+        }
+        writer.close()?;
+    }
+
+    let blocks: Vec<_> = parser::stream_point_blocks(temp.path())?.collect::<Result<_, _>>()?;
+    assert_eq!(blocks.len(), 2);
+    assert_eq!(blocks[0].len(), parser::BLOCK_POINTS);
+    assert_eq!(blocks[1].len(), 10);
+
+    // Mapped decoding must agree with the `las` crate reader bit for bit
+    let mut reader = las::Reader::from_path(temp.path())?;
+    let expected: Vec<las::Point> = reader.points().collect::<Result<_, _>>()?;
+    let decoded = blocks
+        .iter()
+        .flat_map(|b| (0..b.len()).map(move |i| (b.xs[i], b.ys[i], b.zs[i])));
+    for (point, (x, y, z)) in expected.iter().zip(decoded) {
+        assert_eq!((point.x, point.y, point.z), (x, y, z));
+    }
+
+    Ok(())
+}
+
 #[test]
 fn test_voxel_grid_filter_downsample() -> Result<(), Box<dyn std::error::Error>> {
     let filter = VoxelGridFilter::new(1.0, false);
@@ -215,6 +252,34 @@ fn test_lidar_pipeline_phase2_detection() -> Result<(), Box<dyn std::error::Erro
     Ok(())
 }
 
+#[test]
+fn test_room_detector_labels_across_grid_bands() {
+    use arxos::spatial::lidar::detector::RoomDetector;
+
+    // 4 x 4 rooms of 5 m on a 0.2 m grid: ~100 rows, so components span
+    // several labelling bands and must be stitched at the seams
+    let mut points = Vec::new();
+    for z in [1.0, 2.0] {
+        for line in 0..=4 {
+            let fixed = line as f64 * 5.0;
+            let mut val = 0.0;
+            while val <= 20.0 {
+                points.push(Point3D::new(fixed, val, z));
+                points.push(Point3D::new(val, fixed, z));
+                val += 0.05;
+            }
+        }
+    }
+
+    let rooms = RoomDetector::new(0.20, 1, 9).detect_rooms(&points, 0.0, 4.0);
+    assert_eq!(rooms.len(), 16);
+
+    // Raster order: the first room sits in the lowest row of cells
+    let first = &rooms[0].spatial_properties.bounding_box;
+    assert!(first.min.x < 5.0 && first.min.y < 5.0);
+    assert_eq!(rooms[15].name, "Room 16");
+}
+
 #[test]
 fn test_lidar_pipeline_phase3_detection() -> Result<(), Box<dyn std::error::Error>> {
     use arxos::core::EquipmentType;
@@ -290,6 +355,53 @@ fn test_lidar_pipeline_phase3_detection() -> Result<(), Box<dyn std::error::Erro
     Ok(())
 }
 
+#[test]
+fn test_equipment_detector_shared_partition() {
+    use arxos::core::{BoundingBox, Position};
+    use arxos::spatial::lidar::detector::{EquipmentDetector, PointPartition};
+
+    let corner = |x: f64, y: f64, z: f64| Position {
+        x,
+        y,
+        z,
+        coordinate_system: "building_local".to_string(),
+    };
+
+    // One compact block per room along X, two rooms
+    let mut points = Vec::new();
+    for room in 0..2 {
+        let base = room as f64 * 10.0 + 2.0;
+        for i in 0..6 {
+            for j in 0..6 {
+                for k in 0..6 {
+                    points.push(Point3D::new(
+                        base + i as f64 * 0.2,
+                        2.0 + j as f64 * 0.2,
+                        1.0 + k as f64 * 0.2,
+                    ));
+                }
+            }
+        }
+    }
+
+    let detector = EquipmentDetector::new(0.40, 4);
+    let partition = PointPartition::new(&points, 0.0, 4.0);
+    for room in 0..2 {
+        let x0 = room as f64 * 10.0;
+        let bbox = BoundingBox {
+            min: corner(x0, 0.0, 0.0),
+            max: corner(x0 + 8.0, 8.0, 4.0),
+        };
+        let shared = detector.detect_equipment_in(&partition, &bbox, "/building/f/r");
+        let direct = detector.detect_equipment(&points, &bbox, "/building/f/r");
+
+        assert_eq!(shared.len(), 1);
+        assert_eq!(shared.len(), direct.len());
+        assert_eq!(shared[0].properties.get("point_count").unwrap(), "216");
+        assert_eq!(shared[0].position.x, direct[0].position.x);
+    }
+}
+
 #[test]
 fn test_lidar_pipeline_incremental_merge() -> Result<(), Box<dyn std::error::Error>> {
     use arxos::core::{
@@ -2,7 +2,7 @@
 
 #[cfg(feature = "web")]
 mod web_tests {
-    use arxos::core::{Anchor, Position, MapRef, RelativePose, PoseType};
+    use arxos::core::{Anchor, Building, Position, MapRef, RelativePose, PoseType};
     use arxos::core::domain::ArxAddress;
     use arxos::core::spatial::Point3D;
     use arxos::web::cache::{WarmCache, BinaryAssetCache, SyncQueue};
@@ -56,6 +56,114 @@ mod web_tests {
         assert_eq!(binary_cache.hits, 1);
     }
 
+    #[test]
+    fn test_warm_cache_evicts_distant_subtrees_first() {
+        let mut warm_cache = WarmCache::new();
+        warm_cache.max_budget_bytes = 400;
+        let room = ArxAddress::from_path("/building/hq/floor-1/room-101").unwrap();
+        warm_cache.set_current_address(&room);
+
+        let envelope = |path: &str| BuildingSyncEnvelope {
+            base_address: ArxAddress::from_path(path).unwrap(),
+            anchors: vec![],
+            payload: "x".repeat(100),
+            fetched_at_timestamp: 1000,
+        };
+        warm_cache.insert_subtree(envelope("/building/hq/floor-1/room-101"));
+        warm_cache.insert_subtree(envelope("/building/annex/floor-9"));
+        warm_cache.insert_subtree(envelope("/building/hq/floor-1/room-103"));
+        // Over budget: the annex floor is newer than the worker's room but far away
+        warm_cache.insert_subtree(envelope("/building/hq/floor-1/room-102"));
+
+        assert_eq!(warm_cache.evictions, 1);
+        assert!(warm_cache.get_subtree(&room).is_some());
+        assert!(!warm_cache.subtrees.contains_key("/building/annex/floor-9"));
+
+        // Pure recency evicts the least recently used subtree
+        warm_cache.recency_vs_proximity_weight = 1.0;
+        warm_cache.insert_subtree(envelope("/building/annex/floor-8"));
+        assert!(!warm_cache.subtrees.contains_key("/building/hq/floor-1/room-103"));
+        assert!(warm_cache.current_footprint_bytes <= warm_cache.max_budget_bytes);
+    }
+
+    #[test]
+    fn test_binary_asset_hits_share_buffer() {
+        let mut binary_cache = BinaryAssetCache::new();
+        let map_ref = MapRef::Local {
+            path: "maps/floor-1.map".to_string(),
+        };
+
+        let data = binary_cache.load_asset(&map_ref).unwrap();
+        let hit_data = binary_cache.load_asset(&map_ref).unwrap();
+        assert!(std::sync::Arc::ptr_eq(&data, &hit_data));
+    }
+
+    #[test]
+    fn test_hot_cache_diffs_neighborhood_and_queries_grid() {
+        use arxos::core::spatial::BoundingBox3D;
+        use arxos::web::cache::HotCache;
+
+        let anchor = |name: &str, x: f64, y: f64| {
+            Anchor::new(
+                name.to_string(),
+                Position { x, y, z: 0.0, coordinate_system: "local".to_string() },
+                0.9,
+            )
+        };
+        let bounds = Some(BoundingBox3D::new(
+            Point3D::new(0.0, 0.0, 0.0),
+            Point3D::new(20.0, 10.0, 3.0),
+        ));
+        let mut hot = HotCache::new();
+        let mut panel = anchor("panel", 1.0, 1.0);
+        let valve = anchor("valve", 18.0, 9.0);
+        let hallway = anchor("hallway", 30.0, 0.0); // outside the room bounds
+        panel.relative_poses.push(RelativePose {
+            target_id: valve.id.clone(),
+            pose_type: PoseType::AnchorToAnchor,
+            x: 17.0, y: 8.0, z: 0.0,
+            roll: 0.0, pitch: 0.0, yaw: 0.0,
+        });
+        hot.load_neighborhood(
+            vec![panel.clone(), valve.clone(), hallway.clone()],
+            Some("room-101".to_string()),
+            bounds.clone(),
+        );
+
+        let mut near = Vec::new();
+        assert!(!hot.anchors_near(Point3D::new(0.0, 0.0, 0.0), 3.0, 8, &mut near));
+        assert_eq!(near.len(), 1);
+        assert_eq!(hot.anchor_at(near[0]).name, "panel");
+        hot.anchors_near(Point3D::new(29.0, 0.0, 0.0), 2.0, 8, &mut near);
+        assert_eq!(hot.anchor_at(near[0]).name, "hallway");
+        let panel_slot = hot.slot_of(&panel.id).unwrap();
+        assert_eq!(hot.pose_targets(panel_slot), &[hot.slot_of(&valve.id).unwrap() as u32]);
+        // The per-frame result budget truncates large queries
+        assert!(hot.anchors_near(Point3D::new(10.0, 5.0, 0.0), 100.0, 2, &mut near));
+        assert_eq!(near.len(), 2);
+
+        // Next neighborhood: panel leaves, valve moves, a new anchor arrives
+        let mut moved_valve = valve.clone();
+        moved_valve.position.x = 2.0;
+        moved_valve.position.y = 2.0;
+        let pump = anchor("pump", 5.0, 5.0);
+        hot.load_neighborhood(
+            vec![moved_valve.clone(), hallway.clone(), pump.clone()],
+            Some("room-101".to_string()),
+            bounds,
+        );
+        assert_eq!(hot.len(), 3);
+        assert!(hot.get_anchor(&panel.id).is_none());
+        hot.anchors_near(Point3D::new(1.0, 1.0, 0.0), 2.0, 8, &mut near);
+        assert_eq!(near.len(), 1);
+        assert_eq!(hot.anchor_at(near[0]).name, "valve");
+        for expected in [&moved_valve, &hallway, &pump] {
+            let slot = hot.slot_of(&expected.id).unwrap();
+            assert_eq!(hot.positions()[slot].x, expected.position.x);
+        }
+        assert!(hot.is_memory_within_limits());
+    }
+
     #[test]
     fn test_discovery_radius_filtering_and_provisional_status() {
         let mut warm_cache = WarmCache::new();
@@ -100,6 +208,35 @@ mod web_tests {
         assert!(manager.is_provisional());
     }
 
+    #[test]
+    fn test_marker_warming_uses_loaded_building() {
+        let mut building = Building::new("HQ".to_string(), "/building/hq".to_string());
+        for (name, x) in [("near-pin", 3.0), ("far-pin", 40.0)] {
+            building.anchors.push(Anchor::new(
+                name.to_string(),
+                Position { x, y: 0.0, z: 0.0, coordinate_system: "local".to_string() },
+                0.9,
+            ));
+        }
+        let mut manager = DiscoveryManager::new();
+        manager.building = Some(building);
+        let mut warm_cache = WarmCache::new();
+
+        let marker = ArxAddress::from_path("/building/hq/floor-1").unwrap();
+        let location = LocationContext {
+            current_address: marker.clone(),
+            coordinates: Point3D::new(0.0, 0.0, 0.0),
+            confidence: 1.0,
+        };
+        manager.update_position(location, &mut warm_cache, &PredictiveWarming);
+
+        // Only the building's anchors in range are warmed, no mock geometry
+        let near = ArxAddress::from_path("/building/hq/floor-1/near").unwrap();
+        let envelope = warm_cache.get_subtree(&near).expect("warmed subtree");
+        let names: Vec<&str> = envelope.anchors.iter().map(|a| a.name.as_str()).collect();
+        assert_eq!(names, vec!["near-pin"]);
+    }
+
     #[test]
     fn test_hud_compilation_and_task_resolver() {
         let mut sync_queue = SyncQueue::new();